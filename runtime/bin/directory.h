@@ -269,6 +269,9 @@ class Directory {
   static CObject* ListNextRequest(const CObjectArray& request);
   static CObject* ListStopRequest(const CObjectArray& request);
   static CObject* RenameRequest(const CObjectArray& request);
+  static CObject* WalkStartRequest(const CObjectArray& request);
+  static CObject* WalkNextRequest(const CObjectArray& request);
+  static CObject* WalkStopRequest(const CObjectArray& request);
 
  private:
   DISALLOW_ALLOCATION();
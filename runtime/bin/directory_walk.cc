@@ -0,0 +1,85 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/directory_walk.h"
+
+#include <errno.h>  // NOLINT
+
+#include "bin/directory.h"
+
+
+namespace dart {
+namespace bin {
+
+// The walk requests are kept apart from the other directory requests in
+// directory.cc, which is also linked into programs without the IOService.
+
+CObject* Directory::WalkStartRequest(const CObjectArray& request) {
+  if (request.Length() == 2 &&
+      request[0]->IsString() &&
+      request[1]->IsBool()) {
+    CObjectString path(request[0]);
+    CObjectBool stat(request[1]);
+    DirectoryWalk* walk = DirectoryWalk::Start(path.CString(), stat.Value());
+    if (walk == NULL) {
+      if (errno == ENOSYS) {
+        // Tell the caller to list the directory in the ordinary way.
+        return CObject::Null();
+      }
+      // Report the error like a failing ListStartRequest does.
+      CObject* err = CObject::NewOSError();
+      CObjectArray* error = new CObjectArray(CObject::NewArray(3));
+      error->SetAt(0, new CObjectInt32(CObject::NewInt32(kListError)));
+      error->SetAt(1, request[0]);
+      error->SetAt(2, err);
+      return error;
+    }
+    return new CObjectIntptr(CObject::NewIntptr(
+        reinterpret_cast<intptr_t>(walk)));
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+CObject* Directory::WalkNextRequest(const CObjectArray& request) {
+  if (request.Length() == 1 && request[0]->IsIntptr()) {
+    CObjectIntptr ptr(request[0]);
+    DirectoryWalk* walk = reinterpret_cast<DirectoryWalk*>(ptr.Value());
+    return walk->Next();
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+CObject* Directory::WalkStopRequest(const CObjectArray& request) {
+  if (request.Length() == 1 && request[0]->IsIntptr()) {
+    CObjectIntptr ptr(request[0]);
+    DirectoryWalk* walk = reinterpret_cast<DirectoryWalk*>(ptr.Value());
+    walk->Stop();
+    return CObject::True();
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+#if !defined(TARGET_OS_LINUX)
+DirectoryWalk* DirectoryWalk::Start(const char* path, bool stat) {
+  errno = ENOSYS;
+  return NULL;
+}
+
+
+CObject* DirectoryWalk::Next() {
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void DirectoryWalk::Stop() {
+  UNREACHABLE();
+}
+#endif  // !defined(TARGET_OS_LINUX)
+
+}  // namespace bin
+}  // namespace dart
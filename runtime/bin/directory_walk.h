@@ -0,0 +1,91 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef BIN_DIRECTORY_WALK_H_
+#define BIN_DIRECTORY_WALK_H_
+
+#include "bin/builtin.h"
+#include "bin/dartutils.h"
+#include "bin/thread.h"
+
+
+namespace dart {
+namespace bin {
+
+class DirectoryWalkChunk;
+class DirectoryWalkTask;
+
+// A recursive directory listing that reads the subdirectories of the tree on
+// a set of worker threads. Symbolic links are reported as links and are not
+// followed.
+//
+// The workers record the entries they find in chunks, which are turned into
+// response arrays when the listing is asked for its next results. Entries of
+// different directories are interleaved, but a directory is always reported
+// before its contents. When too many results are waiting to be picked up,
+// the remaining directories are put aside until the listing is asked for
+// results again.
+class DirectoryWalk {
+ public:
+  // Creates a walk of the directory with the given path, which must end in
+  // a path separator. Returns NULL, with errno set, if the directory cannot
+  // be opened. Returns NULL, with errno set to ENOSYS, if walks are not
+  // supported on this platform, in which case the caller should list the
+  // directory in the ordinary way.
+  static DirectoryWalk* Start(const char* path, bool stat);
+
+  // Returns an array with the results found since the last call, waiting
+  // until there are some. Each entry takes two elements, its type and path,
+  // or four if the walk stats its entries, with the size and modification
+  // time in milliseconds following. Like FileSystemEntity.stat, these are
+  // taken from the target of a link, and are -1 for a broken link. Errors
+  // are reported as an entry of type kListError with the error response in
+  // place of the path. The last entry is of type kListDone.
+  CObject* Next();
+
+  // Stops the walk and waits for the workers to let go of it.
+  void Stop();
+
+  // Called by a worker before reading the directory of a task. Returns
+  // false if the walk has put the task aside or dropped it instead.
+  bool ShouldRead(DirectoryWalkTask* task);
+
+  // Called by a worker when it has read the directory of a task, with the
+  // entries found and the tasks for its subdirectories.
+  void Publish(DirectoryWalkChunk* chunk, DirectoryWalkTask* subdirectories);
+
+  bool stat() const { return stat_; }
+
+ private:
+  // The number of bytes of results that may wait to be picked up before
+  // directories are put aside.
+  static const intptr_t kMaxBuffered = 1 * MB;
+
+  explicit DirectoryWalk(bool stat)
+      : stat_(stat),
+        cancelled_(false),
+        tasks_(0),
+        buffered_(0),
+        first_(NULL),
+        last_(NULL),
+        deferred_(NULL) {}
+  ~DirectoryWalk();
+
+  Monitor monitor_;
+  const bool stat_;
+  bool cancelled_;
+  // Number of tasks that are queued, running or deferred.
+  intptr_t tasks_;
+  intptr_t buffered_;
+  DirectoryWalkChunk* first_;
+  DirectoryWalkChunk* last_;
+  DirectoryWalkTask* deferred_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWalk);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // BIN_DIRECTORY_WALK_H_
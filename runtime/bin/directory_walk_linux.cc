@@ -0,0 +1,463 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/globals.h"
+#if defined(TARGET_OS_LINUX)
+
+#include "bin/directory_walk.h"
+
+#include <dirent.h>  // NOLINT
+#include <errno.h>  // NOLINT
+#include <fcntl.h>  // NOLINT
+#include <stdlib.h>  // NOLINT
+#include <string.h>  // NOLINT
+#include <sys/param.h>  // NOLINT
+#include <sys/stat.h>  // NOLINT
+#include <sys/syscall.h>  // NOLINT
+#include <unistd.h>  // NOLINT
+
+#include "bin/directory.h"
+#include "bin/file.h"
+#include "bin/lockers.h"
+#include "bin/platform.h"
+#include "bin/utils.h"
+#include "bin/worker_pool.h"
+#include "platform/signal_blocker.h"
+#include "platform/utils.h"
+
+
+namespace dart {
+namespace bin {
+
+// A directory waiting to be read. The path ends in a path separator. The
+// file descriptor is only open for the directory the walk starts in.
+class DirectoryWalkTask : public WorkerJob {
+ public:
+  DirectoryWalkTask(DirectoryWalk* walk, char* path, intptr_t length, int fd)
+      : walk_(walk), path_(path), length_(length), fd_(fd), next_(NULL) {}
+
+  ~DirectoryWalkTask() {
+    free(path_);
+    if (fd_ != -1) {
+      VOID_TEMP_FAILURE_RETRY(close(fd_));
+    }
+  }
+
+  // Reads the directory on a worker thread, unless the walk puts the task
+  // aside or drops it.
+  virtual void Run();
+
+  DirectoryWalk* walk() const { return walk_; }
+  const char* path() const { return path_; }
+  intptr_t length() const { return length_; }
+
+  int TakeFd() {
+    int fd = fd_;
+    fd_ = -1;
+    return fd;
+  }
+
+  DirectoryWalkTask* next() const { return next_; }
+  void set_next(DirectoryWalkTask* next) { next_ = next; }
+
+ private:
+  DirectoryWalk* walk_;
+  char* path_;
+  intptr_t length_;
+  int fd_;
+  DirectoryWalkTask* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWalkTask);
+};
+
+
+// The entries found in one directory. Each entry is a header followed by
+// its zero terminated path, padded to a multiple of 8 bytes.
+class DirectoryWalkChunk {
+ public:
+  struct Header {
+    int32_t type;
+    int32_t error;
+    int64_t size;
+    int64_t modified;
+    intptr_t path_length;
+  };
+
+  DirectoryWalkChunk()
+      : data_(NULL), length_(0), capacity_(0), count_(0), next_(NULL) {}
+
+  ~DirectoryWalkChunk() {
+    free(data_);
+  }
+
+  void Add(ListType type, const char* path, intptr_t path_length,
+           int64_t size, int64_t modified) {
+    Header header = { type, 0, size, modified, path_length };
+    Append(header, path);
+  }
+
+  void AddError(const char* path, int error) {
+    Header header = { kListError, error, -1, -1,
+                      static_cast<intptr_t>(strlen(path)) };
+    Append(header, path);
+  }
+
+  // Returns the header of the entry at the given offset and advances the
+  // offset to the next entry.
+  const Header* EntryAt(intptr_t* offset, const char** path) const {
+    const Header* header = reinterpret_cast<const Header*>(data_ + *offset);
+    *path = data_ + *offset + sizeof(Header);
+    *offset += EntrySize(header->path_length);
+    return header;
+  }
+
+  intptr_t length() const { return length_; }
+  intptr_t count() const { return count_; }
+
+  DirectoryWalkChunk* next() const { return next_; }
+  void set_next(DirectoryWalkChunk* next) { next_ = next; }
+
+ private:
+  static const intptr_t kInitialCapacity = 4 * KB;
+
+  static intptr_t EntrySize(intptr_t path_length) {
+    return Utils::RoundUp(sizeof(Header) + path_length + 1, 8);
+  }
+
+  void Append(const Header& header, const char* path) {
+    intptr_t size = EntrySize(header.path_length);
+    if (length_ + size > capacity_) {
+      intptr_t capacity = (capacity_ == 0) ? kInitialCapacity : capacity_;
+      while (length_ + size > capacity) {
+        capacity *= 2;
+      }
+      data_ = reinterpret_cast<char*>(realloc(data_, capacity));
+      capacity_ = capacity;
+    }
+    memmove(data_ + length_, &header, sizeof(header));
+    memmove(data_ + length_ + sizeof(header), path, header.path_length);
+    data_[length_ + sizeof(header) + header.path_length] = '\0';
+    length_ += size;
+    count_++;
+  }
+
+  char* data_;
+  intptr_t length_;
+  intptr_t capacity_;
+  intptr_t count_;
+  DirectoryWalkChunk* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirectoryWalkChunk);
+};
+
+
+// Hands a list of tasks to the worker pool.
+static void EnqueueTasks(DirectoryWalkTask* tasks) {
+  while (tasks != NULL) {
+    DirectoryWalkTask* task = tasks;
+    tasks = task->next();
+    task->set_next(NULL);
+    WorkerPool::Enqueue(task);
+  }
+}
+
+
+static bool IsDotOrDotDot(const char* name) {
+  return (name[0] == '.') &&
+         ((name[1] == '\0') || ((name[1] == '.') && (name[2] == '\0')));
+}
+
+
+static int64_t TimespecToMilliseconds(const struct timespec& t) {
+  return static_cast<int64_t>(t.tv_sec) * 1000L +
+      static_cast<int64_t>(t.tv_nsec) / 1000000L;
+}
+
+
+// The size of the buffer that getdents64 fills with entries.
+static const intptr_t kDirectoryBufferSize = 32 * KB;
+
+
+static void ReadDirectory(DirectoryWalkTask* task) {
+  DirectoryWalk* walk = task->walk();
+  DirectoryWalkChunk* chunk = new DirectoryWalkChunk();
+  DirectoryWalkTask* subdirectories = NULL;
+  int fd = task->TakeFd();
+  if (fd == -1) {
+    fd = TEMP_FAILURE_RETRY(
+        open64(task->path(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  }
+  if (fd == -1) {
+    chunk->AddError(task->path(), errno);
+  } else {
+    char* buffer = reinterpret_cast<char*>(malloc(kDirectoryBufferSize));
+    char path[PATH_MAX + 1];
+    intptr_t length = task->length();
+    memmove(path, task->path(), length);
+    // getdents64 fills the buffer with as many entries as fit, including
+    // their d_type, so most entries are classified without a stat call.
+    while (true) {
+      intptr_t bytes = NO_RETRY_EXPECTED(
+          syscall(SYS_getdents64, fd, buffer, kDirectoryBufferSize));
+      if (bytes <= 0) {
+        if (bytes < 0) {
+          chunk->AddError(task->path(), errno);
+        }
+        break;
+      }
+      intptr_t offset = 0;
+      while (offset < bytes) {
+        struct dirent64* entry =
+            reinterpret_cast<struct dirent64*>(buffer + offset);
+        offset += entry->d_reclen;
+        if (IsDotOrDotDot(entry->d_name)) continue;
+        intptr_t name_length = strlen(entry->d_name);
+        // Leave room for the path separator of a subdirectory.
+        if (length + name_length + 1 > PATH_MAX) {
+          errno = ENAMETOOLONG;
+          chunk->AddError(task->path(), errno);
+          continue;
+        }
+        memmove(path + length, entry->d_name, name_length + 1);
+        int type = entry->d_type;
+        int64_t size = -1;
+        int64_t modified = -1;
+        if (walk->stat() || (type == DT_UNKNOWN)) {
+          struct stat64 info;
+          if (TEMP_FAILURE_RETRY(fstatat64(fd, entry->d_name, &info,
+                                           AT_SYMLINK_NOFOLLOW)) == -1) {
+            chunk->AddError(path, errno);
+            continue;
+          }
+          type = IFTODT(info.st_mode);
+          size = info.st_size;
+          modified = TimespecToMilliseconds(info.st_mtim);
+          if (walk->stat() && (type == DT_LNK)) {
+            // Like FileSystemEntity.stat, report the size and modification
+            // time of the target, or -1 for a broken link.
+            if (TEMP_FAILURE_RETRY(fstatat64(fd, entry->d_name, &info, 0)) ==
+                0) {
+              size = info.st_size;
+              modified = TimespecToMilliseconds(info.st_mtim);
+            } else {
+              size = -1;
+              modified = -1;
+            }
+          }
+        }
+        if (type == DT_DIR) {
+          chunk->Add(kListDirectory, path, length + name_length,
+                     size, modified);
+          char* child = reinterpret_cast<char*>(malloc(length + name_length +
+                                                       2));
+          memmove(child, path, length + name_length);
+          child[length + name_length] = File::PathSeparator()[0];
+          child[length + name_length + 1] = '\0';
+          DirectoryWalkTask* subdirectory = new DirectoryWalkTask(
+              walk, child, length + name_length + 1, -1);
+          subdirectory->set_next(subdirectories);
+          subdirectories = subdirectory;
+        } else if (type == DT_LNK) {
+          chunk->Add(kListLink, path, length + name_length, size, modified);
+        } else {
+          chunk->Add(kListFile, path, length + name_length, size, modified);
+        }
+      }
+    }
+    free(buffer);
+    VOID_TEMP_FAILURE_RETRY(close(fd));
+  }
+  delete task;
+  walk->Publish(chunk, subdirectories);
+}
+
+
+void DirectoryWalkTask::Run() {
+  if (walk_->ShouldRead(this)) {
+    ReadDirectory(this);
+  }
+}
+
+
+DirectoryWalk* DirectoryWalk::Start(const char* path, bool stat) {
+  intptr_t length = strlen(path);
+  if (length > PATH_MAX) {
+    errno = ENAMETOOLONG;
+    return NULL;
+  }
+  int fd = TEMP_FAILURE_RETRY(
+      open64(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+  if (fd == -1) {
+    return NULL;
+  }
+  if (!WorkerPool::Start()) {
+    VOID_TEMP_FAILURE_RETRY(close(fd));
+    errno = ENOSYS;
+    return NULL;
+  }
+  DirectoryWalk* walk = new DirectoryWalk(stat);
+  walk->tasks_ = 1;
+  WorkerPool::Enqueue(new DirectoryWalkTask(walk, strdup(path), length, fd));
+  return walk;
+}
+
+
+DirectoryWalk::~DirectoryWalk() {
+  ASSERT(tasks_ == 0);
+  ASSERT(deferred_ == NULL);
+  while (first_ != NULL) {
+    DirectoryWalkChunk* chunk = first_;
+    first_ = chunk->next();
+    delete chunk;
+  }
+}
+
+
+bool DirectoryWalk::ShouldRead(DirectoryWalkTask* task) {
+  MonitorLocker ml(&monitor_);
+  if (cancelled_) {
+    delete task;
+    tasks_--;
+    ml.NotifyAll();
+    return false;
+  }
+  if (buffered_ >= kMaxBuffered) {
+    task->set_next(deferred_);
+    deferred_ = task;
+    return false;
+  }
+  return true;
+}
+
+
+void DirectoryWalk::Publish(DirectoryWalkChunk* chunk,
+                            DirectoryWalkTask* subdirectories) {
+  {
+    MonitorLocker ml(&monitor_);
+    tasks_--;
+    if (cancelled_) {
+      delete chunk;
+      while (subdirectories != NULL) {
+        DirectoryWalkTask* task = subdirectories;
+        subdirectories = task->next();
+        delete task;
+      }
+    } else {
+      if (chunk->count() == 0) {
+        delete chunk;
+      } else {
+        buffered_ += chunk->length();
+        if (last_ == NULL) {
+          first_ = last_ = chunk;
+        } else {
+          last_->set_next(chunk);
+          last_ = chunk;
+        }
+      }
+      for (DirectoryWalkTask* task = subdirectories;
+           task != NULL;
+           task = task->next()) {
+        tasks_++;
+      }
+    }
+    ml.NotifyAll();
+  }
+  // The subdirectories are only handed out once the entries for them have
+  // been published, so that a directory is reported before its contents.
+  EnqueueTasks(subdirectories);
+}
+
+
+CObject* DirectoryWalk::Next() {
+  DirectoryWalkChunk* chunks;
+  DirectoryWalkTask* deferred;
+  bool done;
+  {
+    MonitorLocker ml(&monitor_);
+    while ((first_ == NULL) && (tasks_ > 0)) {
+      ml.Wait();
+    }
+    chunks = first_;
+    first_ = last_ = NULL;
+    buffered_ = 0;
+    deferred = deferred_;
+    deferred_ = NULL;
+    done = (tasks_ == 0);
+  }
+  EnqueueTasks(deferred);
+
+  intptr_t stride = stat_ ? 4 : 2;
+  intptr_t count = done ? 1 : 0;
+  for (DirectoryWalkChunk* chunk = chunks;
+       chunk != NULL;
+       chunk = chunk->next()) {
+    count += chunk->count();
+  }
+  CObjectArray* response = new CObjectArray(CObject::NewArray(count * stride));
+  intptr_t index = 0;
+  while (chunks != NULL) {
+    DirectoryWalkChunk* chunk = chunks;
+    chunks = chunk->next();
+    intptr_t offset = 0;
+    while (offset < chunk->length()) {
+      const char* path;
+      const DirectoryWalkChunk::Header* header = chunk->EntryAt(&offset, &path);
+      response->SetAt(index++, new CObjectInt32(
+          CObject::NewInt32(header->type)));
+      if (header->type == kListError) {
+        OSError os_error;
+        os_error.SetCodeAndMessage(OSError::kSystem, header->error);
+        CObjectArray* error = new CObjectArray(CObject::NewArray(3));
+        error->SetAt(0, new CObjectInt32(CObject::NewInt32(kListError)));
+        error->SetAt(1, new CObjectString(CObject::NewString(path)));
+        error->SetAt(2, CObject::NewOSError(&os_error));
+        response->SetAt(index++, error);
+      } else {
+        response->SetAt(index++, new CObjectString(CObject::NewString(path)));
+      }
+      if (stat_) {
+        response->SetAt(index++, new CObjectInt64(
+            CObject::NewInt64(header->size)));
+        response->SetAt(index++, new CObjectInt64(
+            CObject::NewInt64(header->modified)));
+      }
+    }
+    delete chunk;
+  }
+  if (done) {
+    response->SetAt(index++, new CObjectInt32(CObject::NewInt32(kListDone)));
+    response->SetAt(index++, CObject::Null());
+    if (stat_) {
+      response->SetAt(index++, CObject::Null());
+      response->SetAt(index++, CObject::Null());
+    }
+  }
+  ASSERT(index == count * stride);
+  return response;
+}
+
+
+void DirectoryWalk::Stop() {
+  {
+    MonitorLocker ml(&monitor_);
+    cancelled_ = true;
+    while (deferred_ != NULL) {
+      DirectoryWalkTask* task = deferred_;
+      deferred_ = task->next();
+      delete task;
+      tasks_--;
+    }
+    // Tasks that are still queued are dropped by the workers, and running
+    // ones are waited for.
+    while (tasks_ > 0) {
+      ml.Wait();
+    }
+  }
+  delete this;
+}
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // defined(TARGET_OS_LINUX)
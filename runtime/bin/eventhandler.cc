@@ -15,44 +15,133 @@ namespace dart {
 namespace bin {
 
 
+int64_t TimeoutQueue::slack_ = 0;
+int64_t TimeoutQueue::wakeups_ = 0;
+int64_t TimeoutQueue::total_wakeup_latency_ = 0;
+int64_t TimeoutQueue::max_wakeup_latency_ = 0;
+
+
+TimeoutQueue::TimeoutQueue()
+    : heap_(NULL),
+      count_(0),
+      capacity_(0),
+      ports_(&SamePort, 16) {}
+
+
+TimeoutQueue::~TimeoutQueue() {
+  for (intptr_t i = 0; i < count_; i++) {
+    delete heap_[i];
+  }
+  free(heap_);
+}
+
+
+int64_t TimeoutQueue::CurrentWakeup() const {
+  const int64_t timeout = CurrentTimeout();
+  if (slack_ <= 1) {
+    return timeout;
+  }
+  return ((timeout + slack_ - 1) / slack_) * slack_;
+}
+
+
 void TimeoutQueue::UpdateTimeout(Dart_Port port, int64_t timeout) {
-  // Find port if present.
-  Timeout* last = NULL;
-  Timeout* current = timeouts_;
-  while (current != NULL) {
-    if (current->port() == port) {
-      // Found.
-      if (timeout < 0) {
-        // Remove from list and delete existing.
-        if (last != NULL) {
-          last->set_next(current->next());
-        } else {
-          timeouts_ = current->next();
-        }
-        delete current;
-      } else {
-        // Update timeout.
-        current->set_timeout(timeout);
+  const uint32_t hash = PortHash(port);
+  HashMap::Entry* entry = ports_.Lookup(&port, hash, false);
+  if (entry == NULL) {
+    if (timeout < 0) {
+      return;
+    }
+    if (count_ == capacity_) {
+      capacity_ = (capacity_ == 0) ? 16 : capacity_ * 2;
+      heap_ = reinterpret_cast<Timeout**>(
+          realloc(heap_, capacity_ * sizeof(Timeout*)));
+      if (heap_ == NULL) {
+        FATAL("Out of memory in TimeoutQueue.");
       }
-      break;
     }
-    last = current;
-    current = current->next();
+    Timeout* current = new Timeout(port, timeout);
+    Place(current, count_++);
+    SiftUp(current);
+    // Key the entry by the port stored in the timeout, which outlives the
+    // lookup key.
+    entry = ports_.Lookup(current->port_address(), hash, true);
+    entry->value = current;
+    return;
+  }
+  Timeout* current = reinterpret_cast<Timeout*>(entry->value);
+  if (timeout < 0) {
+    ports_.Remove(&port, hash);
+    Timeout* last = heap_[--count_];
+    if (last != current) {
+      Place(last, current->index());
+      SiftUp(last);
+      SiftDown(last);
+    }
+    delete current;
+    return;
+  }
+  const int64_t old_timeout = current->timeout();
+  current->set_timeout(timeout);
+  if (timeout < old_timeout) {
+    SiftUp(current);
+  } else {
+    SiftDown(current);
+  }
+}
+
+
+intptr_t TimeoutQueue::PostExpired(int64_t now) {
+  if (HasTimeout() && (CurrentWakeup() <= now)) {
+    const int64_t latency = now - CurrentWakeup();
+    wakeups_++;
+    total_wakeup_latency_ += latency;
+    if (latency > max_wakeup_latency_) {
+      max_wakeup_latency_ = latency;
+    }
   }
-  if (current == NULL && timeout >= 0) {
-    // Not found, create a new.
-    timeouts_ = new Timeout(port, timeout, timeouts_);
+  intptr_t posted = 0;
+  while (HasTimeout() && (CurrentTimeout() <= now)) {
+    DartUtils::PostNull(CurrentPort());
+    RemoveCurrent();
+    posted++;
+  }
+  return posted;
+}
+
+
+void TimeoutQueue::SiftUp(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  while (index > 0) {
+    const intptr_t parent = (index - 1) / 2;
+    if (heap_[parent]->timeout() <= timeout->timeout()) {
+      break;
+    }
+    Place(heap_[parent], index);
+    index = parent;
   }
-  // Clear and find next timeout.
-  next_timeout_ = NULL;
-  current = timeouts_;
-  while (current != NULL) {
-    if (next_timeout_ == NULL ||
-        current->timeout() < next_timeout_->timeout()) {
-      next_timeout_ = current;
+  Place(timeout, index);
+}
+
+
+void TimeoutQueue::SiftDown(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  while (true) {
+    intptr_t child = 2 * index + 1;
+    if (child >= count_) {
+      break;
+    }
+    if (((child + 1) < count_) &&
+        (heap_[child + 1]->timeout() < heap_[child]->timeout())) {
+      child++;
+    }
+    if (timeout->timeout() <= heap_[child]->timeout()) {
+      break;
     }
-    current = current->next();
+    Place(heap_[child], index);
+    index = child;
   }
+  Place(timeout, index);
 }
 
 
@@ -54,14 +54,18 @@ enum MessageFlags {
     ((data & (1 << kListeningSocket)) != 0)  // NOLINT
 #define TOKEN_COUNT(data) (data & ((1 << kCloseCommand) - 1))
 
+// Pending timeouts, one per port, kept in a binary min-heap ordered by
+// timeout. A hash map from port to heap entry makes updating or removing the
+// timeout of a port O(log n).
 class TimeoutQueue {
  private:
   class Timeout {
    public:
-    Timeout(Dart_Port port, int64_t timeout, Timeout* next)
-        : port_(port), timeout_(timeout), next_(next) {}
+    Timeout(Dart_Port port, int64_t timeout)
+        : port_(port), timeout_(timeout), index_(-1) {}
 
     Dart_Port port() const { return port_; }
+    Dart_Port* port_address() { return &port_; }
 
     int64_t timeout() const { return timeout_; }
     void set_timeout(int64_t timeout) {
@@ -69,45 +73,92 @@ class TimeoutQueue {
       timeout_ = timeout;
     }
 
-    Timeout* next() const { return next_; }
-    void set_next(Timeout* next) {
-      next_ = next;
-    }
+    // Position of this timeout in the heap.
+    intptr_t index() const { return index_; }
+    void set_index(intptr_t index) { index_ = index; }
 
    private:
     Dart_Port port_;
     int64_t timeout_;
-    Timeout* next_;
+    intptr_t index_;
   };
 
  public:
-  TimeoutQueue() : next_timeout_(NULL), timeouts_(NULL) {}
-
-  ~TimeoutQueue() {
-    while (HasTimeout()) RemoveCurrent();
-  }
+  TimeoutQueue();
+  ~TimeoutQueue();
 
-  bool HasTimeout() const { return next_timeout_ != NULL; }
+  bool HasTimeout() const { return count_ > 0; }
 
   int64_t CurrentTimeout() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->timeout();
+    ASSERT(HasTimeout());
+    return heap_[0]->timeout();
   }
 
   Dart_Port CurrentPort() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->port();
+    ASSERT(HasTimeout());
+    return heap_[0]->port();
   }
 
+  // The time the event handler should wake up at to handle the current
+  // timeout. With a timer slack the wakeup is rounded up to a multiple of the
+  // slack so that timeouts close to each other share a single wakeup.
+  int64_t CurrentWakeup() const;
+
   void RemoveCurrent() {
     UpdateTimeout(CurrentPort(), -1);
   }
 
+  // Sets the timeout of 'port'. A negative timeout removes it.
   void UpdateTimeout(Dart_Port port, int64_t timeout);
 
+  // Posts null to all ports whose timeout is not after 'now' and removes
+  // their timeouts. Returns the number of ports notified.
+  intptr_t PostExpired(int64_t now);
+
+  static int64_t slack() { return slack_; }
+  static void set_slack(int64_t millis) {
+    ASSERT(millis >= 0);
+    slack_ = millis;
+  }
+
+  // The number of timer wakeups and how late the event handler handled them,
+  // in milliseconds. Only the event handler thread updates these, other
+  // threads may read slightly stale values without locking.
+  static int64_t wakeups() { return wakeups_; }
+  static int64_t total_wakeup_latency() { return total_wakeup_latency_; }
+  static int64_t max_wakeup_latency() { return max_wakeup_latency_; }
+
  private:
-  Timeout* next_timeout_;
-  Timeout* timeouts_;
+  static bool SamePort(void* key1, void* key2) {
+    return *reinterpret_cast<Dart_Port*>(key1) ==
+        *reinterpret_cast<Dart_Port*>(key2);
+  }
+
+  static uint32_t PortHash(Dart_Port port) {
+    return static_cast<uint32_t>(port ^ (port >> 32));
+  }
+
+  void Place(Timeout* timeout, intptr_t index) {
+    heap_[index] = timeout;
+    timeout->set_index(index);
+  }
+
+  void SiftUp(Timeout* timeout);
+  void SiftDown(Timeout* timeout);
+
+  Timeout** heap_;
+  intptr_t count_;
+  intptr_t capacity_;
+  HashMap ports_;
+
+  // Timer slack in milliseconds, shared by all timeout queues.
+  static int64_t slack_;
+
+  static int64_t wakeups_;
+  static int64_t total_wakeup_latency_;
+  static int64_t max_wakeup_latency_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeoutQueue);
 };
 
 
@@ -24,6 +24,7 @@
 #include "bin/lockers.h"
 #include "bin/socket.h"
 #include "bin/thread.h"
+#include "bin/utils.h"
 #include "platform/utils.h"
 
 
@@ -195,6 +196,19 @@ void EventHandlerImplementation::WakeupHandler(intptr_t id,
 }
 
 
+void EventHandlerImplementation::UpdateTimerFd() {
+  struct itimerspec it;
+  memset(&it, 0, sizeof(it));
+  if (timeout_queue_.HasTimeout()) {
+    int64_t millis = timeout_queue_.CurrentWakeup();
+    it.it_value.tv_sec = millis / 1000;
+    it.it_value.tv_nsec = (millis % 1000) * 1000000;
+  }
+  VOID_NO_RETRY_EXPECTED(
+      timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &it, NULL));
+}
+
+
 void EventHandlerImplementation::HandleInterruptFd() {
   const intptr_t MAX_MESSAGES = kInterruptMessageSize;
   InterruptMessage msg[MAX_MESSAGES];
@@ -203,15 +217,7 @@ void EventHandlerImplementation::HandleInterruptFd() {
   for (ssize_t i = 0; i < bytes / kInterruptMessageSize; i++) {
     if (msg[i].id == kTimerId) {
       timeout_queue_.UpdateTimeout(msg[i].dart_port, msg[i].data);
-      struct itimerspec it;
-      memset(&it, 0, sizeof(it));
-      if (timeout_queue_.HasTimeout()) {
-        int64_t millis = timeout_queue_.CurrentTimeout();
-        it.it_value.tv_sec = millis / 1000;
-        it.it_value.tv_nsec = (millis % 1000) * 1000000;
-      }
-      VOID_NO_RETRY_EXPECTED(
-          timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &it, NULL));
+      UpdateTimerFd();
     } else if (msg[i].id == kShutdownId) {
       shutdown_ = true;
     } else {
@@ -330,8 +336,14 @@ void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
       VOID_TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
           read(timer_fd_, &val, sizeof(val)));
       if (timeout_queue_.HasTimeout()) {
-        DartUtils::PostNull(timeout_queue_.CurrentPort());
-        timeout_queue_.RemoveCurrent();
+        // Fire every timeout that expired, not just the current one, so that
+        // timeouts coalesced into this wakeup are all handled.
+        if (timeout_queue_.PostExpired(
+                TimerUtils::GetCurrentTimeMilliseconds()) == 0) {
+          DartUtils::PostNull(timeout_queue_.CurrentPort());
+          timeout_queue_.RemoveCurrent();
+        }
+        UpdateTimerFd();
       }
     } else {
       DescriptorInfo* di =
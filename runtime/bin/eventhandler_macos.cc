@@ -393,7 +393,7 @@ int64_t EventHandlerImplementation::GetTimeout() {
   if (!timeout_queue_.HasTimeout()) {
     return kInfinityTimeout;
   }
-  int64_t millis = timeout_queue_.CurrentTimeout() -
+  int64_t millis = timeout_queue_.CurrentWakeup() -
       TimerUtils::GetCurrentTimeMilliseconds();
   return (millis < 0) ? 0 : millis;
 }
@@ -401,11 +401,9 @@ int64_t EventHandlerImplementation::GetTimeout() {
 
 void EventHandlerImplementation::HandleTimeout() {
   if (timeout_queue_.HasTimeout()) {
-    int64_t millis = timeout_queue_.CurrentTimeout() -
-        TimerUtils::GetCurrentTimeMilliseconds();
-    if (millis <= 0) {
-      DartUtils::PostNull(timeout_queue_.CurrentPort());
-      timeout_queue_.RemoveCurrent();
+    int64_t now = TimerUtils::GetCurrentTimeMilliseconds();
+    if (timeout_queue_.CurrentWakeup() <= now) {
+      timeout_queue_.PostExpired(now);
     }
   }
 }
@@ -87,5 +87,57 @@ UNIT_TEST_CASE(CircularLinkedList) {
   list.Remove(4242);
 }
 
+
+UNIT_TEST_CASE(TimeoutQueue) {
+  TimeoutQueue queue;
+
+  EXPECT(!queue.HasTimeout());
+
+  // Test: Current timeout is the earliest one, independent of insertion
+  // order.
+  for (int i = 100; i >= 1; i--) {
+    queue.UpdateTimeout(i, (i * 37) % 101);
+  }
+  EXPECT(queue.HasTimeout());
+  EXPECT_EQ(1, queue.CurrentTimeout());
+  EXPECT_EQ(71, queue.CurrentPort());
+
+
+  // Test: Updating a timeout moves the port in both directions.
+  queue.UpdateTimeout(50, 0);
+  EXPECT_EQ(50, queue.CurrentPort());
+  EXPECT_EQ(0, queue.CurrentTimeout());
+  queue.UpdateTimeout(50, 1000);
+  EXPECT_EQ(71, queue.CurrentPort());
+
+
+  // Test: Removing non-existent port leaves queue un-changed.
+  queue.UpdateTimeout(4242, -1);
+  EXPECT_EQ(71, queue.CurrentPort());
+
+
+  // Test: Removing current timeouts yields non-decreasing timeouts.
+  int64_t last = -1;
+  intptr_t count = 0;
+  while (queue.HasTimeout()) {
+    EXPECT(queue.CurrentTimeout() >= last);
+    last = queue.CurrentTimeout();
+    queue.RemoveCurrent();
+    count++;
+  }
+  EXPECT_EQ(100, count);
+  EXPECT_EQ(1000, last);
+
+
+  // Test: Timer slack rounds wakeups up to a multiple of the slack.
+  queue.UpdateTimeout(1, 1001);
+  EXPECT_EQ(1001, queue.CurrentWakeup());
+  TimeoutQueue::set_slack(50);
+  EXPECT_EQ(1050, queue.CurrentWakeup());
+  queue.UpdateTimeout(1, 1050);
+  EXPECT_EQ(1050, queue.CurrentWakeup());
+  TimeoutQueue::set_slack(0);
+}
+
 }  // namespace bin
 }  // namespace dart
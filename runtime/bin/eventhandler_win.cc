@@ -1230,8 +1230,13 @@ void EventHandlerImplementation::HandleConnect(
 
 void EventHandlerImplementation::HandleTimeout() {
   if (!timeout_queue_.HasTimeout()) return;
-  DartUtils::PostNull(timeout_queue_.CurrentPort());
-  timeout_queue_.RemoveCurrent();
+  int64_t now = TimerUtils::GetCurrentTimeMilliseconds();
+  if (timeout_queue_.PostExpired(now) == 0) {
+    // Woken up before the current timeout expired; still notify its port as
+    // the Dart side reschedules early wakeups.
+    DartUtils::PostNull(timeout_queue_.CurrentPort());
+    timeout_queue_.RemoveCurrent();
+  }
 }
 
 
@@ -1296,7 +1301,7 @@ int64_t EventHandlerImplementation::GetTimeout() {
   if (!timeout_queue_.HasTimeout()) {
     return kInfinityTimeout;
   }
-  int64_t millis = timeout_queue_.CurrentTimeout() -
+  int64_t millis = timeout_queue_.CurrentWakeup() -
       TimerUtils::GetCurrentTimeMilliseconds();
   return (millis < 0) ? 0 : millis;
 }
@@ -7,7 +7,11 @@
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
 #include "bin/io_buffer.h"
+#include "bin/lockers.h"
+#include "bin/thread.h"
 #include "bin/utils.h"
+#include "platform/hashmap.h"
+#include "platform/utils.h"
 
 #include "include/dart_api.h"
 #include "include/dart_tools_api.h"
@@ -453,6 +457,182 @@ void FUNCTION_NAME(File_Lock)(Dart_NativeArguments args) {
 }
 
 
+// A memory mapped region of a file handed out to Dart as external typed
+// data. Mappings are registered by address so that File_AdviseMapping and
+// File_SyncMapping only operate on memory that was actually mapped by
+// File_Map. Finalizers can run on any thread, so the registry is protected
+// by a mutex.
+class FileMapping {
+ public:
+  FileMapping(uint8_t* address, int64_t length)
+      : address_(address), length_(length) {}
+
+  uint8_t* address() const { return address_; }
+  int64_t length() const { return length_; }
+
+  static void Register(FileMapping* mapping) {
+    MutexLocker ml(mutex_);
+    HashMap::Entry* entry =
+        mappings_->Lookup(mapping->address_, Hash(mapping->address_), true);
+    ASSERT(entry->value == NULL);
+    entry->value = mapping;
+  }
+
+  static FileMapping* Lookup(uint8_t* address) {
+    MutexLocker ml(mutex_);
+    HashMap::Entry* entry = mappings_->Lookup(address, Hash(address), false);
+    if (entry == NULL) {
+      return NULL;
+    }
+    return reinterpret_cast<FileMapping*>(entry->value);
+  }
+
+  static void Finalize(void* isolate_callback_data,
+                       Dart_WeakPersistentHandle handle,
+                       void* peer) {
+    FileMapping* mapping = reinterpret_cast<FileMapping*>(peer);
+    {
+      MutexLocker ml(mutex_);
+      mappings_->Remove(mapping->address_, Hash(mapping->address_));
+    }
+    File::Unmap(mapping->address_, mapping->length_);
+    delete mapping;
+  }
+
+ private:
+  static uint32_t Hash(uint8_t* address) {
+    return Utils::WordHash(reinterpret_cast<intptr_t>(address));
+  }
+
+  static Mutex* mutex_;
+  static HashMap* mappings_;
+
+  uint8_t* address_;
+  int64_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(FileMapping);
+};
+
+
+Mutex* FileMapping::mutex_ = new Mutex();
+HashMap* FileMapping::mappings_ =
+    new HashMap(&HashMap::SamePointerValue, 16);
+
+
+void FUNCTION_NAME(File_Map)(Dart_NativeArguments args) {
+  File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
+  ASSERT(file != NULL);
+  int64_t position;
+  int64_t length;
+  int64_t mode;
+  if (DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &position) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 2), &length) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 3), &mode)) {
+    // Accessing a mapping beyond the end of the file faults, so the region
+    // must lie within the file.
+    if ((mode >= File::kMapMin) && (mode <= File::kMapMax) &&
+        (position >= 0) && (length > 0) && (length <= kIntptrMax) &&
+        (position <= file->Length() - length)) {
+      uint8_t* address =
+          file->Map(position, length, static_cast<File::MapMode>(mode));
+      if (address == NULL) {
+        Dart_Handle err = DartUtils::NewDartOSError();
+        if (Dart_IsError(err)) Dart_PropagateError(err);
+        Dart_SetReturnValue(args, err);
+        return;
+      }
+      Dart_Handle result = Dart_NewExternalTypedData(
+          Dart_TypedData_kUint8, address, static_cast<intptr_t>(length));
+      if (Dart_IsError(result)) {
+        File::Unmap(address, length);
+        Dart_PropagateError(result);
+      }
+      FileMapping* mapping = new FileMapping(address, length);
+      FileMapping::Register(mapping);
+      // The pages are backed by the file and can be dropped by the OS at any
+      // time, so they are not reported as external allocation. Otherwise
+      // mapping a large file would force needless garbage collections.
+      Dart_NewWeakPersistentHandle(result, mapping, 0, FileMapping::Finalize);
+      Dart_SetReturnValue(args, result);
+      return;
+    }
+  }
+
+  OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+  Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+  if (Dart_IsError(err)) Dart_PropagateError(err);
+  Dart_SetReturnValue(args, err);
+}
+
+
+// Returns the mapping backing the typed data argument, or NULL if the typed
+// data was not returned by File_Map.
+static FileMapping* GetFileMapping(Dart_Handle handle) {
+  if (!Dart_IsTypedData(handle)) {
+    return NULL;
+  }
+  Dart_TypedData_Type type;
+  void* data;
+  intptr_t length;
+  Dart_Handle result = Dart_TypedDataAcquireData(handle, &type, &data, &length);
+  if (Dart_IsError(result)) Dart_PropagateError(result);
+  result = Dart_TypedDataReleaseData(handle);
+  if (Dart_IsError(result)) Dart_PropagateError(result);
+  // External data does not move, so the address stays valid after the
+  // data has been released.
+  FileMapping* mapping = FileMapping::Lookup(reinterpret_cast<uint8_t*>(data));
+  if ((mapping == NULL) || (mapping->length() != length)) {
+    return NULL;
+  }
+  return mapping;
+}
+
+
+void FUNCTION_NAME(File_AdviseMapping)(Dart_NativeArguments args) {
+  FileMapping* mapping = GetFileMapping(Dart_GetNativeArgument(args, 0));
+  int64_t advice;
+  if ((mapping != NULL) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &advice) &&
+      (advice >= File::kAdviceMin) && (advice <= File::kAdviceMax)) {
+    if (File::AdviseMapping(mapping->address(),
+                            mapping->length(),
+                            static_cast<File::MapAdvice>(advice))) {
+      Dart_SetReturnValue(args, Dart_True());
+    } else {
+      Dart_Handle err = DartUtils::NewDartOSError();
+      if (Dart_IsError(err)) Dart_PropagateError(err);
+      Dart_SetReturnValue(args, err);
+    }
+    return;
+  }
+
+  OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+  Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+  if (Dart_IsError(err)) Dart_PropagateError(err);
+  Dart_SetReturnValue(args, err);
+}
+
+
+void FUNCTION_NAME(File_SyncMapping)(Dart_NativeArguments args) {
+  FileMapping* mapping = GetFileMapping(Dart_GetNativeArgument(args, 0));
+  if (mapping != NULL) {
+    if (File::SyncMapping(mapping->address(), mapping->length())) {
+      Dart_SetReturnValue(args, Dart_True());
+    } else {
+      Dart_Handle err = DartUtils::NewDartOSError();
+      if (Dart_IsError(err)) Dart_PropagateError(err);
+      Dart_SetReturnValue(args, err);
+    }
+    return;
+  }
+
+  OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+  Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+  if (Dart_IsError(err)) Dart_PropagateError(err);
+  Dart_SetReturnValue(args, err);
+}
+
+
 void FUNCTION_NAME(File_Create)(Dart_NativeArguments args) {
   const char* str =
       DartUtils::GetStringValue(Dart_GetNativeArgument(args, 0));
@@ -1067,7 +1247,7 @@ CObject* File::ReadIntoRequest(const CObjectArray& request) {
 }
 
 
-static int SizeInBytes(Dart_TypedData_Type type) {
+int File::TypedDataElementSize(Dart_TypedData_Type type) {
   switch (type) {
     case Dart_TypedData_kInt8:
     case Dart_TypedData_kUint8:
@@ -1107,8 +1287,8 @@ CObject* File::WriteFromRequest(const CObjectArray& request) {
       uint8_t* buffer_start;
       if (request[1]->IsTypedData()) {
         CObjectTypedData typed_data(request[1]);
-        start = start * SizeInBytes(typed_data.Type());
-        length = length * SizeInBytes(typed_data.Type());
+        start = start * TypedDataElementSize(typed_data.Type());
+        length = length * TypedDataElementSize(typed_data.Type());
         buffer_start = typed_data.Buffer() + start;
       } else {
         CObjectArray array(request[1]);
@@ -83,6 +83,25 @@ class File {
     kLockMax = 2
   };
 
+  enum MapMode {
+    // These match the values of FileMapMode in file.dart.
+    kMapMin = 0,
+    kMapReadOnly = 0,
+    kMapReadWrite = 1,
+    kMapMax = 1
+  };
+
+  enum MapAdvice {
+    // These match the values of FileMapAdvice in file.dart.
+    kAdviceMin = 0,
+    kAdviceNormal = 0,
+    kAdviceSequential = 1,
+    kAdviceRandom = 2,
+    kAdviceWillNeed = 3,
+    kAdviceDontNeed = 4,
+    kAdviceMax = 4
+  };
+
   ~File();
 
   intptr_t GetFD();
@@ -122,6 +141,21 @@ class File {
   // Lock range of a file.
   bool Lock(LockType lock, int64_t start, int64_t end);
 
+  // Map length bytes of the file starting at position into memory and
+  // return the address of the first byte, or NULL on failure. With
+  // kMapReadOnly the mapping is copy-on-write and changes never reach the
+  // file. With kMapReadWrite changes are written back to the file, which
+  // must have been opened for writing.
+  uint8_t* Map(int64_t position, int64_t length, MapMode mode);
+
+  // Unmap, advise the OS about the expected access pattern of, or write back
+  // the changes to a mapping returned by Map. The address and length must be
+  // the ones of the original mapping.
+  static bool Unmap(uint8_t* address, int64_t length);
+  static bool AdviseMapping(uint8_t* address, int64_t length,
+                            MapAdvice advice);
+  static bool SyncMapping(uint8_t* address, int64_t length);
+
   // Returns whether the file has been closed.
   bool IsClosed();
 
@@ -158,6 +192,9 @@ class File {
 
   static FileOpenMode DartModeToFileMode(DartFileOpenMode mode);
 
+  // Size in bytes of the elements of typed data of the given type.
+  static int TypedDataElementSize(Dart_TypedData_Type type);
+
   static CObject* ExistsRequest(const CObjectArray& request);
   static CObject* CreateRequest(const CObjectArray& request);
   static CObject* DeleteRequest(const CObjectArray& request);
@@ -10,6 +10,7 @@
 #include <errno.h>  // NOLINT
 #include <fcntl.h>  // NOLINT
 #include <copyfile.h>  // NOLINT
+#include <sys/mman.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 #include <libgen.h>  // NOLINT
@@ -20,6 +21,7 @@
 #include "bin/log.h"
 
 #include "platform/signal_blocker.h"
+#include "platform/utils.h"
 
 namespace dart {
 namespace bin {
@@ -137,6 +139,80 @@ bool File::Lock(File::LockType lock, int64_t start, int64_t end) {
 }
 
 
+static intptr_t PageSize() {
+  static const intptr_t page_size = sysconf(_SC_PAGESIZE);
+  return page_size;
+}
+
+
+uint8_t* File::Map(int64_t position, int64_t length, MapMode mode) {
+  ASSERT(handle_->fd() >= 0);
+  ASSERT((position >= 0) && (length > 0));
+  // The file offset of a mapping must be page aligned, so map from the start
+  // of the page containing position.
+  int64_t delta = position % PageSize();
+  // Read-only mappings are private and writable so that writes through the
+  // returned typed data modify a private copy instead of faulting.
+  int flags = (mode == kMapReadWrite) ? MAP_SHARED : MAP_PRIVATE;
+  void* address = mmap(NULL,
+                       length + delta,
+                       PROT_READ | PROT_WRITE,
+                       flags,
+                       handle_->fd(),
+                       position - delta);
+  if (address == MAP_FAILED) {
+    return NULL;
+  }
+  return reinterpret_cast<uint8_t*>(address) + delta;
+}
+
+
+static void* MappingStart(uint8_t* address, int64_t* length) {
+  uword start = Utils::RoundDown(reinterpret_cast<uword>(address), PageSize());
+  *length += reinterpret_cast<uword>(address) - start;
+  return reinterpret_cast<void*>(start);
+}
+
+
+bool File::Unmap(uint8_t* address, int64_t length) {
+  void* start = MappingStart(address, &length);
+  return munmap(start, length) == 0;
+}
+
+
+bool File::AdviseMapping(uint8_t* address, int64_t length, MapAdvice advice) {
+  int value;
+  switch (advice) {
+    case kAdviceNormal:
+      value = MADV_NORMAL;
+      break;
+    case kAdviceSequential:
+      value = MADV_SEQUENTIAL;
+      break;
+    case kAdviceRandom:
+      value = MADV_RANDOM;
+      break;
+    case kAdviceWillNeed:
+      value = MADV_WILLNEED;
+      break;
+    case kAdviceDontNeed:
+      value = MADV_DONTNEED;
+      break;
+    default:
+      UNREACHABLE();
+      return false;
+  }
+  void* start = MappingStart(address, &length);
+  return madvise(start, length, value) == 0;
+}
+
+
+bool File::SyncMapping(uint8_t* address, int64_t length) {
+  void* start = MappingStart(address, &length);
+  return msync(start, length, MS_SYNC) == 0;
+}
+
+
 int64_t File::Length() {
   ASSERT(handle_->fd() >= 0);
   struct stat st;
@@ -40,6 +40,12 @@ patch class _RandomAccessFile {
   /* patch */ static _flush(int id) native "File_Flush";
   /* patch */ static _lock(int id, int lock, int start, int end)
       native "File_Lock";
+  /* patch */ static _map(int id, int position, int length, int mode)
+      native "File_Map";
+  /* patch */ static _adviseMapping(Uint8List mapping, int advice)
+      native "File_AdviseMapping";
+  /* patch */ static _syncMapping(Uint8List mapping)
+      native "File_SyncMapping";
 }
 
 
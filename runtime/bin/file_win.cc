@@ -145,6 +145,79 @@ bool File::Lock(File::LockType lock, int64_t start, int64_t end) {
 }
 
 
+static intptr_t AllocationGranularity() {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwAllocationGranularity;
+}
+
+
+uint8_t* File::Map(int64_t position, int64_t length, MapMode mode) {
+  ASSERT(handle_->fd() >= 0);
+  ASSERT((position >= 0) && (length > 0));
+  HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(handle_->fd()));
+  // Views must start at a multiple of the allocation granularity, so map
+  // from the start of the block containing position.
+  int64_t delta = position % AllocationGranularity();
+  int64_t start = position - delta;
+  int64_t end = position + length;
+  // Read-only mappings are copy-on-write so that writes through the
+  // returned typed data modify a private copy instead of faulting.
+  DWORD protect = (mode == kMapReadWrite) ? PAGE_READWRITE : PAGE_WRITECOPY;
+  DWORD access = (mode == kMapReadWrite) ? FILE_MAP_WRITE : FILE_MAP_COPY;
+  HANDLE mapping = CreateFileMappingW(handle,
+                                      NULL,
+                                      protect,
+                                      Utils::High32Bits(end),
+                                      Utils::Low32Bits(end),
+                                      NULL);
+  if (mapping == NULL) {
+    return NULL;
+  }
+  void* address = MapViewOfFile(mapping,
+                                access,
+                                Utils::High32Bits(start),
+                                Utils::Low32Bits(start),
+                                static_cast<SIZE_T>(length + delta));
+  // The view keeps the file mapping object alive.
+  DWORD error = GetLastError();
+  CloseHandle(mapping);
+  SetLastError(error);
+  if (address == NULL) {
+    return NULL;
+  }
+  return reinterpret_cast<uint8_t*>(address) + delta;
+}
+
+
+static void* MappingStart(uint8_t* address, int64_t* length) {
+  uword start = Utils::RoundDown(reinterpret_cast<uword>(address),
+                                 AllocationGranularity());
+  *length += reinterpret_cast<uword>(address) - start;
+  return reinterpret_cast<void*>(start);
+}
+
+
+bool File::Unmap(uint8_t* address, int64_t length) {
+  void* start = MappingStart(address, &length);
+  return UnmapViewOfFile(start) != 0;
+}
+
+
+bool File::AdviseMapping(uint8_t* address, int64_t length, MapAdvice advice) {
+  // There is no equivalent of madvise for file mappings that is available
+  // on all supported versions of Windows. The advice is only a hint, so it
+  // is ignored.
+  return true;
+}
+
+
+bool File::SyncMapping(uint8_t* address, int64_t length) {
+  void* start = MappingStart(address, &length);
+  return FlushViewOfFile(start, static_cast<SIZE_T>(length)) != 0;
+}
+
+
 int64_t File::Length() {
   ASSERT(handle_->fd() >= 0);
   struct __stat64 st;
@@ -5,6 +5,9 @@
 #include "bin/dartutils.h"
 #include "bin/filter.h"
 #include "bin/io_buffer.h"
+#include "bin/lockers.h"
+#include "bin/platform.h"
+#include "bin/worker_pool.h"
 
 #include "include/dart_api.h"
 
@@ -142,6 +145,35 @@ void FUNCTION_NAME(Filter_CreateZLibDeflate)(Dart_NativeArguments args) {
   }
 }
 
+void FUNCTION_NAME(Filter_CreateParallelGZipDeflate)(
+    Dart_NativeArguments args) {
+  Dart_Handle filter_obj = Dart_GetNativeArgument(args, 0);
+  Dart_Handle level_obj = Dart_GetNativeArgument(args, 1);
+  int64_t level = DartUtils::GetInt64ValueCheckRange(level_obj, kMinInt32,
+      kMaxInt32);
+  Dart_Handle window_bits_obj = Dart_GetNativeArgument(args, 2);
+  int64_t window_bits = DartUtils::GetIntegerValue(window_bits_obj);
+  Dart_Handle mLevel_obj = Dart_GetNativeArgument(args, 3);
+  int64_t mem_level = DartUtils::GetIntegerValue(mLevel_obj);
+  Dart_Handle strategy_obj = Dart_GetNativeArgument(args, 4);
+  int64_t strategy = DartUtils::GetIntegerValue(strategy_obj);
+  Filter* filter = new ParallelGZipDeflateFilter(
+      static_cast<int32_t>(level),
+      static_cast<int32_t>(window_bits),
+      static_cast<int32_t>(mem_level),
+      static_cast<int32_t>(strategy));
+  if (!filter->Init()) {
+    delete filter;
+    Dart_ThrowException(DartUtils::NewInternalError(
+        "Failed to create ParallelGZipDeflateFilter"));
+  }
+  Dart_Handle result = Filter::SetFilterPointerNativeField(filter_obj, filter);
+  if (Dart_IsError(result)) {
+    delete filter;
+    Dart_PropagateError(result);
+  }
+}
+
 void FUNCTION_NAME(Filter_Process)(Dart_NativeArguments args) {
   Dart_Handle filter_obj = Dart_GetNativeArgument(args, 0);
   Filter* filter = GetFilter(filter_obj);
@@ -152,9 +184,18 @@ void FUNCTION_NAME(Filter_Process)(Dart_NativeArguments args) {
   intptr_t length;
   Dart_TypedData_Type type;
   uint8_t* buffer = NULL;
+  bool owns_buffer = true;
   Dart_Handle result = Dart_TypedDataAcquireData(
       data_obj, &type, reinterpret_cast<void**>(&buffer), &length);
-  if (!Dart_IsError(result)) {
+  if (!Dart_IsError(result) &&
+      (Dart_GetTypeOfExternalTypedData(data_obj) != Dart_TypedData_kInvalid)) {
+    // The contents of external typed data never move, so the filter can
+    // read them in place. The caller drains the filter before it returns to
+    // Dart, which keeps data_obj alive while the filter uses it.
+    Dart_TypedDataReleaseData(data_obj);
+    buffer += start;
+    owns_buffer = false;
+  } else if (!Dart_IsError(result)) {
     uint8_t* zlib_buffer = new uint8_t[chunk_length];
     if (zlib_buffer == NULL) {
       Dart_TypedDataReleaseData(data_obj);
@@ -178,8 +219,8 @@ void FUNCTION_NAME(Filter_Process)(Dart_NativeArguments args) {
     }
   }
   // Process will take ownership of buffer, if successful.
-  if (!filter->Process(buffer, chunk_length)) {
-    delete[] buffer;
+  if (!filter->Process(buffer, chunk_length, owns_buffer)) {
+    if (owns_buffer) delete[] buffer;
     EndFilter(filter_obj, filter);
     Dart_ThrowException(DartUtils::NewInternalError(
         "Call to Process while still processing data"));
@@ -213,6 +254,21 @@ void FUNCTION_NAME(Filter_Processed)(Dart_NativeArguments args) {
         "Filter error, bad data"));
   } else if (read == 0) {
     Dart_SetReturnValue(args, Dart_Null());
+  } else if (read >= filter->processed_buffer_size() / 2) {
+    // Hand out the processed buffer itself instead of copying large chunks.
+    // It goes back to the pool when the typed data is collected.
+    uint8_t* buffer = filter->TakeProcessedBuffer();
+    Dart_Handle result =
+        Dart_NewExternalTypedData(Dart_TypedData_kUint8, buffer, read);
+    if (Dart_IsError(result)) {
+      FilterBufferPool::Return(buffer);
+      Dart_PropagateError(result);
+    }
+    Dart_NewWeakPersistentHandle(result,
+                                 buffer,
+                                 FilterBufferPool::kBufferSize,
+                                 FilterBufferPool::Finalizer);
+    Dart_SetReturnValue(args, result);
   } else {
     uint8_t* io_buffer;
     Dart_Handle result = IOBuffer::Allocate(read, &io_buffer);
@@ -247,9 +303,65 @@ Dart_Handle Filter::GetFilterPointerNativeField(Dart_Handle filter,
 }
 
 
+Mutex* FilterBufferPool::mutex_ = new Mutex();
+uint8_t* FilterBufferPool::buffers_[kMaxPooledBuffers];
+intptr_t FilterBufferPool::count_ = 0;
+
+
+uint8_t* FilterBufferPool::Take() {
+  {
+    MutexLocker ml(mutex_);
+    if (count_ > 0) {
+      return buffers_[--count_];
+    }
+  }
+  return new uint8_t[kBufferSize];
+}
+
+
+void FilterBufferPool::Return(uint8_t* buffer) {
+  {
+    MutexLocker ml(mutex_);
+    if (count_ < kMaxPooledBuffers) {
+      buffers_[count_++] = buffer;
+      return;
+    }
+  }
+  delete[] buffer;
+}
+
+
+void FilterBufferPool::Finalizer(void* isolate_callback_data,
+                                 Dart_WeakPersistentHandle handle,
+                                 void* buffer) {
+  Return(reinterpret_cast<uint8_t*>(buffer));
+}
+
+
+Filter::~Filter() {
+  ReleaseCurrentBuffer();
+  FilterBufferPool::Return(processed_buffer_);
+}
+
+
+uint8_t* Filter::TakeProcessedBuffer() {
+  uint8_t* buffer = processed_buffer_;
+  processed_buffer_ = FilterBufferPool::Take();
+  return buffer;
+}
+
+
+void Filter::ReleaseCurrentBuffer() {
+  if (owns_current_buffer_) {
+    delete[] current_buffer_;
+  }
+  current_buffer_ = NULL;
+  owns_current_buffer_ = false;
+}
+
+
 ZLibDeflateFilter::~ZLibDeflateFilter() {
   delete[] dictionary_;
-  delete[] current_buffer_;
   if (initialized()) deflateEnd(&stream_);
 }
 
@@ -283,10 +395,13 @@ bool ZLibDeflateFilter::Init() {
 }
 
 
-bool ZLibDeflateFilter::Process(uint8_t* data, intptr_t length) {
-  if (current_buffer_ != NULL) return false;
+bool ZLibDeflateFilter::Process(uint8_t* data,
+                                intptr_t length,
+                                bool owns_data) {
+  if (current_buffer() != NULL) return false;
   stream_.avail_in = length;
-  stream_.next_in = current_buffer_ = data;
+  stream_.next_in = data;
+  set_current_buffer(data, owns_data);
   return true;
 }
 
@@ -314,8 +429,7 @@ intptr_t ZLibDeflateFilter::Processed(uint8_t* buffer,
         error = true;
   }
 
-  delete[] current_buffer_;
-  current_buffer_ = NULL;
+  ReleaseCurrentBuffer();
   // Either 0 Byte processed or error
   return error ? -1 : 0;
 }
@@ -323,7 +437,6 @@ intptr_t ZLibDeflateFilter::Processed(uint8_t* buffer,
 
 ZLibInflateFilter::~ZLibInflateFilter() {
   delete[] dictionary_;
-  delete[] current_buffer_;
   if (initialized()) inflateEnd(&stream_);
 }
 
@@ -347,10 +460,13 @@ bool ZLibInflateFilter::Init() {
 }
 
 
-bool ZLibInflateFilter::Process(uint8_t* data, intptr_t length) {
-  if (current_buffer_ != NULL) return false;
+bool ZLibInflateFilter::Process(uint8_t* data,
+                                intptr_t length,
+                                bool owns_data) {
+  if (current_buffer() != NULL) return false;
   stream_.avail_in = length;
-  stream_.next_in = current_buffer_ = data;
+  stream_.next_in = data;
+  set_current_buffer(data, owns_data);
   return true;
 }
 
@@ -398,11 +514,305 @@ intptr_t ZLibInflateFilter::Processed(uint8_t* buffer,
       error = true;
   }
 
-  delete[] current_buffer_;
-  current_buffer_ = NULL;
+  ReleaseCurrentBuffer();
   // Either 0 Byte processed or error
   return error ? -1 : 0;
 }
 
+
+// A block of input of a ParallelGZipDeflateFilter. The input buffer holds
+// the dictionary, the up to 32KB of input preceding the block, followed by
+// the data of the block itself.
+class GZipBlock : public WorkerJob {
+ public:
+  static const intptr_t kBlockSize = ParallelGZipDeflateFilter::kBlockSize;
+  static const intptr_t kDictionarySize =
+      ParallelGZipDeflateFilter::kDictionarySize;
+
+  GZipBlock(ParallelGZipDeflateFilter* filter, GZipBlock* previous)
+      : filter_(filter),
+        input_(new uint8_t[kDictionarySize + kBlockSize]),
+        dictionary_length_(0),
+        length_(0),
+        last_(false),
+        output_(NULL),
+        output_length_(0),
+        position_(0),
+        crc_(0),
+        done_(false),
+        failed_(false),
+        next_(NULL) {
+    if (previous != NULL) {
+      intptr_t available = previous->dictionary_length_ + previous->length_;
+      dictionary_length_ = available < kDictionarySize
+          ? available : kDictionarySize;
+      memmove(input_,
+              previous->input_ + available - dictionary_length_,
+              dictionary_length_);
+    }
+  }
+
+  ~GZipBlock() {
+    delete[] input_;
+    delete[] output_;
+  }
+
+  virtual void Run() {
+    filter_->Compress(this);
+  }
+
+  // Copies as much of data as fits into the block.
+  intptr_t Append(const uint8_t* data, intptr_t length) {
+    intptr_t count = kBlockSize - length_;
+    if (length < count) count = length;
+    memmove(input_ + dictionary_length_ + length_, data, count);
+    length_ += count;
+    return count;
+  }
+
+  // Compresses the block into a raw deflate stream ending on a byte
+  // boundary, or in a final block if this is the last block.
+  bool Deflate(int32_t level,
+               int32_t window_bits,
+               int32_t mem_level,
+               int32_t strategy);
+
+  // Copies the compressed output not yet read into buffer.
+  intptr_t Read(uint8_t* buffer, intptr_t length) {
+    intptr_t count = output_length_ - position_;
+    if (length < count) count = length;
+    memmove(buffer, output_ + position_, count);
+    position_ += count;
+    return count;
+  }
+
+  ParallelGZipDeflateFilter* filter() const { return filter_; }
+  intptr_t length() const { return length_; }
+  bool full() const { return length_ == kBlockSize; }
+  bool last() const { return last_; }
+  void set_last(bool value) { last_ = value; }
+  bool consumed() const { return position_ == output_length_; }
+  uint32_t crc() const { return crc_; }
+  bool done() const { return done_; }
+  bool failed() const { return failed_; }
+  void MarkDone(bool success) {
+    done_ = true;
+    failed_ = !success;
+  }
+  GZipBlock* next() const { return next_; }
+  void set_next(GZipBlock* value) { next_ = value; }
+
+ private:
+  // The sync flush marker is not covered by deflateBound.
+  static const intptr_t kFlushSlack = 16;
+
+  uint8_t* data() const { return input_ + dictionary_length_; }
+
+  ParallelGZipDeflateFilter* filter_;
+  uint8_t* input_;
+  intptr_t dictionary_length_;
+  intptr_t length_;
+  bool last_;
+  uint8_t* output_;
+  intptr_t output_length_;
+  intptr_t position_;
+  uint32_t crc_;
+  bool done_;
+  bool failed_;
+  GZipBlock* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(GZipBlock);
+};
+
+
+bool GZipBlock::Deflate(int32_t level,
+                        int32_t window_bits,
+                        int32_t mem_level,
+                        int32_t strategy) {
+  crc_ = crc32(crc32(0L, Z_NULL, 0), data(), length_);
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level, Z_DEFLATED, -window_bits, mem_level,
+                   strategy) != Z_OK) {
+    return false;
+  }
+  if ((dictionary_length_ > 0) &&
+      (deflateSetDictionary(&stream, input_, dictionary_length_) != Z_OK)) {
+    deflateEnd(&stream);
+    return false;
+  }
+  intptr_t capacity = deflateBound(&stream, length_) + kFlushSlack;
+  output_ = new uint8_t[capacity];
+  stream.next_in = data();
+  stream.avail_in = length_;
+  stream.next_out = output_;
+  stream.avail_out = capacity;
+  int flush = last_ ? Z_FINISH : Z_SYNC_FLUSH;
+  int result = deflate(&stream, flush);
+  while ((result == Z_OK) && (stream.avail_out == 0)) {
+    // Out of output space, which deflateBound should prevent. Grow the
+    // buffer and continue.
+    uint8_t* output = new uint8_t[2 * capacity];
+    memmove(output, output_, capacity);
+    delete[] output_;
+    output_ = output;
+    stream.next_out = output_ + capacity;
+    stream.avail_out = capacity;
+    capacity *= 2;
+    result = deflate(&stream, flush);
+  }
+  output_length_ = capacity - stream.avail_out;
+  deflateEnd(&stream);
+  if (last_) {
+    return result == Z_STREAM_END;
+  }
+  return ((result == Z_OK) || (result == Z_BUF_ERROR)) &&
+         (stream.avail_in == 0);
+}
+
+
+ParallelGZipDeflateFilter::~ParallelGZipDeflateFilter() {
+  {
+    // The workers refer to the filter until they are done with its blocks.
+    MonitorLocker ml(&monitor_);
+    while (pending_ > 0) {
+      ml.Wait();
+    }
+  }
+  delete filling_;
+  while (first_ != NULL) {
+    GZipBlock* block = first_;
+    first_ = block->next();
+    delete block;
+  }
+}
+
+
+bool ParallelGZipDeflateFilter::Init() {
+  // Check the parameters up front, failures on the worker threads are only
+  // reported once the output is read.
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (deflateInit2(&stream, level_, Z_DEFLATED, -window_bits_, mem_level_,
+                   strategy_) != Z_OK) {
+    return false;
+  }
+  deflateEnd(&stream);
+  crc_ = crc32(0L, Z_NULL, 0);
+  filling_ = new GZipBlock(this, NULL);
+  set_initialized(true);
+  return true;
+}
+
+
+bool ParallelGZipDeflateFilter::Process(uint8_t* data,
+                                        intptr_t length,
+                                        bool owns_data) {
+  if (filling_ == NULL) return false;
+  intptr_t position = 0;
+  while (position < length) {
+    position += filling_->Append(data + position, length - position);
+    if (filling_->full()) {
+      Dispatch(false);
+    }
+  }
+  if (owns_data) {
+    delete[] data;
+  }
+  return true;
+}
+
+
+void ParallelGZipDeflateFilter::Dispatch(bool last) {
+  GZipBlock* block = filling_;
+  block->set_last(last);
+  filling_ = last ? NULL : new GZipBlock(this, block);
+  {
+    MonitorLocker ml(&monitor_);
+    if (last_ == NULL) {
+      first_ = last_ = block;
+    } else {
+      last_->set_next(block);
+      last_ = block;
+    }
+    pending_++;
+  }
+  if (WorkerPool::Start()) {
+    WorkerPool::Enqueue(block);
+  } else {
+    // No worker thread could be started, compress on the calling thread.
+    Compress(block);
+  }
+}
+
+
+void ParallelGZipDeflateFilter::Compress(GZipBlock* block) {
+  bool success = block->Deflate(level_, window_bits_, mem_level_, strategy_);
+  MonitorLocker ml(&monitor_);
+  block->MarkDone(success);
+  pending_--;
+  ml.NotifyAll();
+}
+
+
+static intptr_t WriteUint32LE(uint8_t* buffer, uint32_t value) {
+  for (intptr_t i = 0; i < 4; i++) {
+    buffer[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+  return 4;
+}
+
+
+intptr_t ParallelGZipDeflateFilter::Processed(uint8_t* buffer,
+                                              intptr_t length,
+                                              bool flush,
+                                              bool end) {
+  if (end) {
+    if (!finished_) {
+      Dispatch(true);
+      finished_ = true;
+    }
+  } else if (flush && (filling_ != NULL) && (filling_->length() > 0)) {
+    Dispatch(false);
+  }
+  intptr_t written = 0;
+  if (!header_written_) {
+    // Minimal gzip header: deflate, no flags, no time stamp, unknown OS.
+    static const uint8_t kHeader[] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 255 };
+    memmove(buffer, kHeader, sizeof(kHeader));
+    written += sizeof(kHeader);
+    header_written_ = true;
+  }
+  MonitorLocker ml(&monitor_);
+  while ((first_ != NULL) && (written < length)) {
+    GZipBlock* block = first_;
+    if (!block->done()) {
+      // Unless all output is asked for, hand out what is ready and let the
+      // workers continue in the background.
+      if (!flush && !end) break;
+      ml.Wait();
+      continue;
+    }
+    if (block->failed()) {
+      return -1;
+    }
+    written += block->Read(buffer + written, length - written);
+    if (block->consumed()) {
+      crc_ = crc32_combine(crc_, block->crc(), block->length());
+      total_length_ += static_cast<uint32_t>(block->length());
+      first_ = block->next();
+      if (first_ == NULL) last_ = NULL;
+      delete block;
+    }
+  }
+  if (finished_ && (first_ == NULL) && !trailer_written_ &&
+      (length - written >= 8)) {
+    written += WriteUint32LE(buffer + written, crc_);
+    written += WriteUint32LE(buffer + written, total_length_);
+    trailer_written_ = true;
+  }
+  return written;
+}
+
 }  // namespace bin
 }  // namespace dart
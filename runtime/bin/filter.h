@@ -6,6 +6,7 @@
 #define BIN_FILTER_H_
 
 #include "bin/builtin.h"
+#include "bin/thread.h"
 #include "bin/utils.h"
 
 #include "zlib/zlib.h"
@@ -14,18 +15,44 @@
 namespace dart {
 namespace bin {
 
+// Recycles the fixed size buffers filters write their output to. Buffers
+// handed out to Dart as external typed data are returned to the pool by their
+// finalizer, which may run on any thread.
+class FilterBufferPool {
+ public:
+  static const intptr_t kBufferSize = 64 * KB;
+
+  static uint8_t* Take();
+  static void Return(uint8_t* buffer);
+
+  static void Finalizer(void* isolate_callback_data,
+                        Dart_WeakPersistentHandle handle,
+                        void* buffer);
+
+ private:
+  static const intptr_t kMaxPooledBuffers = 32;
+
+  static Mutex* mutex_;
+  static uint8_t* buffers_[kMaxPooledBuffers];
+  static intptr_t count_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(FilterBufferPool);
+};
+
 class Filter {
  public:
-  virtual ~Filter() {}
+  virtual ~Filter();
 
   virtual bool Init() = 0;
 
   /**
-   * On a successful call to Process, Process will take ownership of data. On
-   * successive calls to either Processed or ~Filter, data will be freed with
-   * a delete[] call.
+   * On a successful call to Process, Process will take ownership of data if
+   * owns_data is true. On successive calls to either Processed or ~Filter,
+   * data will be freed with a delete[] call. If owns_data is false, the data
+   * must stay valid and in place until Processed returns 0.
    */
-  virtual bool Process(uint8_t* data, intptr_t length) = 0;
+  virtual bool Process(uint8_t* data, intptr_t length, bool owns_data) = 0;
   virtual intptr_t Processed(uint8_t* buffer, intptr_t length, bool finish,
                              bool end) = 0;
 
@@ -37,14 +64,34 @@ class Filter {
   bool initialized() const { return initialized_; }
   void set_initialized(bool value) { initialized_ = value; }
   uint8_t* processed_buffer() { return processed_buffer_; }
-  intptr_t processed_buffer_size() const { return kFilterBufferSize; }
+  intptr_t processed_buffer_size() const {
+    return FilterBufferPool::kBufferSize;
+  }
+
+  // Hands the processed buffer over to the caller, who must eventually give
+  // it back with FilterBufferPool::Return, and replaces it with a buffer
+  // from the pool.
+  uint8_t* TakeProcessedBuffer();
 
  protected:
-  Filter() : initialized_(false) {}
+  Filter()
+      : current_buffer_(NULL),
+        owns_current_buffer_(false),
+        processed_buffer_(FilterBufferPool::Take()),
+        initialized_(false) {}
+
+  // Input of the last call to Process, NULL once it has been consumed.
+  uint8_t* current_buffer() const { return current_buffer_; }
+  void set_current_buffer(uint8_t* data, bool owns_data) {
+    current_buffer_ = data;
+    owns_current_buffer_ = owns_data;
+  }
+  void ReleaseCurrentBuffer();
 
  private:
-  static const intptr_t kFilterBufferSize = 64 * KB;
-  uint8_t processed_buffer_[kFilterBufferSize];
+  uint8_t* current_buffer_;
+  bool owns_current_buffer_;
+  uint8_t* processed_buffer_;
   bool initialized_;
 
   DISALLOW_COPY_AND_ASSIGN(Filter);
@@ -57,12 +104,11 @@ class ZLibDeflateFilter : public Filter {
                     uint8_t* dictionary, intptr_t dictionary_length, bool raw)
       : gzip_(gzip), level_(level), window_bits_(window_bits),
         mem_level_(mem_level), strategy_(strategy), dictionary_(dictionary),
-        dictionary_length_(dictionary_length), raw_(raw), current_buffer_(NULL)
-    {}
+        dictionary_length_(dictionary_length), raw_(raw) {}
   virtual ~ZLibDeflateFilter();
 
   virtual bool Init();
-  virtual bool Process(uint8_t* data, intptr_t length);
+  virtual bool Process(uint8_t* data, intptr_t length, bool owns_data);
   virtual intptr_t Processed(uint8_t* buffer, intptr_t length, bool finish,
                              bool end);
 
@@ -75,7 +121,6 @@ class ZLibDeflateFilter : public Filter {
   uint8_t* dictionary_;
   const intptr_t dictionary_length_;
   const bool raw_;
-  uint8_t* current_buffer_;
   z_stream stream_;
 
   DISALLOW_COPY_AND_ASSIGN(ZLibDeflateFilter);
@@ -86,12 +131,11 @@ class ZLibInflateFilter : public Filter {
   ZLibInflateFilter(int32_t window_bits, uint8_t* dictionary,
                     intptr_t dictionary_length, bool raw)
       : window_bits_(window_bits), dictionary_(dictionary),
-        dictionary_length_(dictionary_length), raw_(raw), current_buffer_(NULL)
-    {}
+        dictionary_length_(dictionary_length), raw_(raw) {}
   virtual ~ZLibInflateFilter();
 
   virtual bool Init();
-  virtual bool Process(uint8_t* data, intptr_t length);
+  virtual bool Process(uint8_t* data, intptr_t length, bool owns_data);
   virtual intptr_t Processed(uint8_t* buffer, intptr_t length, bool finish,
                              bool end);
 
@@ -100,12 +144,68 @@ class ZLibInflateFilter : public Filter {
   uint8_t* dictionary_;
   const intptr_t dictionary_length_;
   const bool raw_;
-  uint8_t* current_buffer_;
   z_stream stream_;
 
   DISALLOW_COPY_AND_ASSIGN(ZLibInflateFilter);
 };
 
+class GZipBlock;
+
+// Compresses into a gzip stream by deflating independent blocks of the input
+// on a pool of worker threads. Every block is primed with the preceding 32KB
+// of input as its dictionary, which keeps the compression ratio close to
+// that of a single deflate stream, and ends on a byte boundary so that the
+// raw deflate output of the blocks can simply be concatenated. The gzip
+// header and trailer are written by the filter itself, with the CRC combined
+// from the CRCs of the blocks.
+class ParallelGZipDeflateFilter : public Filter {
+ public:
+  ParallelGZipDeflateFilter(int32_t level, int32_t window_bits,
+                            int32_t mem_level, int32_t strategy)
+      : level_(level), window_bits_(window_bits), mem_level_(mem_level),
+        strategy_(strategy), filling_(NULL), first_(NULL), last_(NULL),
+        pending_(0), crc_(0), total_length_(0), header_written_(false),
+        finished_(false), trailer_written_(false) {}
+  virtual ~ParallelGZipDeflateFilter();
+
+  virtual bool Init();
+  virtual bool Process(uint8_t* data, intptr_t length, bool owns_data);
+  virtual intptr_t Processed(uint8_t* buffer, intptr_t length, bool finish,
+                             bool end);
+
+  // Compresses block, called on a worker thread.
+  void Compress(GZipBlock* block);
+
+  static const intptr_t kBlockSize = 128 * KB;
+  static const intptr_t kDictionarySize = 32 * KB;
+
+ private:
+  // Queues the block being filled for compression.
+  void Dispatch(bool last);
+
+  const int32_t level_;
+  const int32_t window_bits_;
+  const int32_t mem_level_;
+  const int32_t strategy_;
+
+  // Block receiving the input of Process. Only touched by the isolate.
+  GZipBlock* filling_;
+
+  // Dispatched blocks in stream order, protected by monitor_.
+  Monitor monitor_;
+  GZipBlock* first_;
+  GZipBlock* last_;
+  intptr_t pending_;
+
+  uint32_t crc_;
+  uint32_t total_length_;
+  bool header_written_;
+  bool finished_;
+  bool trailer_written_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelGZipDeflateFilter);
+};
+
 }  // namespace bin
 }  // namespace dart
 
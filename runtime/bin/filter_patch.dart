@@ -30,6 +30,15 @@ class _ZLibDeflateFilter extends _FilterImpl {
       native "Filter_CreateZLibDeflate";
 }
 
+class _ParallelGZipDeflateFilter extends _FilterImpl {
+  _ParallelGZipDeflateFilter(int level, int windowBits, int memLevel,
+                             int strategy) {
+    _init(level, windowBits, memLevel, strategy);
+  }
+  void _init(int level, int windowBits, int memLevel, int strategy)
+      native "Filter_CreateParallelGZipDeflate";
+}
+
 patch class _Filter {
   /* patch */ static _Filter _newZLibDeflateFilter(bool gzip, int level,
                                                    int windowBits, int memLevel,
@@ -38,6 +47,11 @@ patch class _Filter {
                                                    bool raw) =>
       new _ZLibDeflateFilter(gzip, level, windowBits, memLevel, strategy,
                              dictionary, raw);
+  /* patch */ static _Filter _newParallelGZipDeflateFilter(int level,
+                                                           int windowBits,
+                                                           int memLevel,
+                                                           int strategy) =>
+      new _ParallelGZipDeflateFilter(level, windowBits, memLevel, strategy);
   /* patch */ static _Filter _newZLibInflateFilter(int windowBits,
                                                    List<int> dictionary,
                                                    bool raw) =>
@@ -19,6 +19,10 @@ void FUNCTION_NAME(Filter_CreateZLibInflate)(Dart_NativeArguments args) {
 void FUNCTION_NAME(Filter_CreateZLibDeflate)(Dart_NativeArguments args) {
 }
 
+void FUNCTION_NAME(Filter_CreateParallelGZipDeflate)(
+    Dart_NativeArguments args) {
+}
+
 void FUNCTION_NAME(Filter_Process)(Dart_NativeArguments args) {
 }
 
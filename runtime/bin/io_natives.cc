@@ -49,6 +49,9 @@ namespace bin {
   V(File_LastModified, 1)                                                      \
   V(File_Flush, 1)                                                             \
   V(File_Lock, 4)                                                              \
+  V(File_Map, 4)                                                               \
+  V(File_AdviseMapping, 2)                                                     \
+  V(File_SyncMapping, 1)                                                       \
   V(File_Create, 1)                                                            \
   V(File_CreateLink, 2)                                                        \
   V(File_LinkTarget, 1)                                                        \
@@ -69,6 +72,7 @@ namespace bin {
   V(FileSystemWatcher_ReadEvents, 2)                                           \
   V(FileSystemWatcher_UnwatchPath, 2)                                          \
   V(FileSystemWatcher_WatchPath, 4)                                            \
+  V(Filter_CreateParallelGZipDeflate, 5)                                       \
   V(Filter_CreateZLibDeflate, 8)                                               \
   V(Filter_CreateZLibInflate, 4)                                               \
   V(Filter_End, 1)                                                             \
@@ -116,6 +120,7 @@ namespace bin {
   V(Socket_Read, 2)                                                            \
   V(Socket_RecvFrom, 1)                                                        \
   V(Socket_WriteList, 4)                                                       \
+  V(Socket_SendFile, 4)                                                        \
   V(Socket_SendTo, 6)                                                          \
   V(Socket_GetPort, 1)                                                         \
   V(Socket_GetRemotePeer, 1)                                                   \
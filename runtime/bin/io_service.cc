@@ -7,6 +7,7 @@
 #include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/io_service.h"
+#include "bin/io_uring.h"
 #include "bin/secure_socket.h"
 #include "bin/socket.h"
 #include "bin/utils.h"
@@ -41,6 +42,13 @@ void IOServiceCallback(Dart_Port dest_port_id,
     CObjectInt32 request_id(request[2]);
     CObjectArray data(request[3]);
     reply_port_id = reply_port.Value();
+    if (IOUring::Submit(request_id.Value(),
+                        reply_port_id,
+                        message_id.Value(),
+                        data)) {
+      // The reply is posted when the operation completes.
+      return;
+    }
     switch (request_id.Value()) {
   IO_SERVICE_REQUEST_LIST(CASE_REQUEST);
       default:
@@ -53,7 +53,10 @@ namespace bin {
   V(Directory, ListNext, 36)                                                   \
   V(Directory, ListStop, 37)                                                   \
   V(Directory, Rename, 38)                                                     \
-  V(SSLFilter, ProcessFilter, 39)
+  V(SSLFilter, ProcessFilter, 39)                                              \
+  V(Directory, WalkStart, 40)                                                  \
+  V(Directory, WalkNext, 41)                                                   \
+  V(Directory, WalkStop, 42)
 
 #define DECLARE_REQUEST(type, method, id)                                      \
   k##type##method##Request = id,
@@ -0,0 +1,29 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/io_uring.h"
+
+
+namespace dart {
+namespace bin {
+
+bool IOUring::enabled_ = false;
+
+
+#if !defined(TARGET_OS_LINUX)
+void IOUring::Enable() {
+  // Only available on Linux.
+}
+
+
+bool IOUring::Submit(intptr_t request_id,
+                     Dart_Port reply_port,
+                     int32_t message_id,
+                     const CObjectArray& data) {
+  return false;
+}
+#endif  // !defined(TARGET_OS_LINUX)
+
+}  // namespace bin
+}  // namespace dart
@@ -0,0 +1,50 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef BIN_IO_URING_H_
+#define BIN_IO_URING_H_
+
+#include "bin/builtin.h"
+#include "bin/dartutils.h"
+
+
+namespace dart {
+namespace bin {
+
+// Alternative backend for the asynchronous file requests of the IOService.
+// When enabled and supported by the kernel, read, readInto and writeFrom
+// requests are submitted to an io_uring instead of being performed with a
+// blocking system call on the native port thread. Completions are posted
+// directly to the reply port of the request by a dedicated completion
+// thread.
+class IOUring {
+ public:
+  // Tries to submit the IOService request with the given id. Returns true
+  // if the request was submitted, in which case the reply is posted to
+  // reply_port once the operation completes. Returns false if the request
+  // must be handled synchronously, e.g. because io_uring is disabled or not
+  // supported by the kernel, the request is not a file read or write, or
+  // the ring is full.
+  static bool Submit(intptr_t request_id,
+                     Dart_Port reply_port,
+                     int32_t message_id,
+                     const CObjectArray& data);
+
+  // Sets up the ring if io_uring is usable on this system. Must be called
+  // before any thread that submits requests is started. Afterwards enabled()
+  // does not change, so it can be read from any thread.
+  static void Enable();
+  static bool enabled() { return enabled_; }
+
+ private:
+  static bool enabled_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IOUring);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // BIN_IO_URING_H_
@@ -0,0 +1,698 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/globals.h"
+#if defined(TARGET_OS_LINUX)
+
+#include "bin/io_uring.h"
+
+#include <errno.h>  // NOLINT
+#include <stdio.h>  // NOLINT
+#include <stdlib.h>  // NOLINT
+#include <string.h>  // NOLINT
+#include <sys/mman.h>  // NOLINT
+#include <sys/syscall.h>  // NOLINT
+#include <sys/utsname.h>  // NOLINT
+#include <unistd.h>  // NOLINT
+
+#include "bin/file.h"
+#include "bin/io_buffer.h"
+#include "bin/io_service.h"
+#include "bin/lockers.h"
+#include "bin/thread.h"
+#include "bin/utils.h"
+#include "platform/signal_blocker.h"
+#include "platform/utils.h"
+
+
+namespace dart {
+namespace bin {
+
+// The system headers we build against predate io_uring, so the small part of
+// the kernel ABI used here is declared locally. The layout is fixed by the
+// kernel and must not be changed.
+#if defined(__NR_io_uring_setup)
+static const long kIOUringSetup = __NR_io_uring_setup;  // NOLINT
+static const long kIOUringEnter = __NR_io_uring_enter;  // NOLINT
+#elif defined(__x86_64__) || defined(__i386__) || \
+      defined(__arm__) || defined(__aarch64__)
+static const long kIOUringSetup = 425;  // NOLINT
+static const long kIOUringEnter = 426;  // NOLINT
+#else
+static const long kIOUringSetup = -1;  // NOLINT
+static const long kIOUringEnter = -1;  // NOLINT
+#endif
+
+struct IOUringSqOffsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t flags;
+  uint32_t dropped;
+  uint32_t array;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+
+struct IOUringCqOffsets {
+  uint32_t head;
+  uint32_t tail;
+  uint32_t ring_mask;
+  uint32_t ring_entries;
+  uint32_t overflow;
+  uint32_t cqes;
+  uint32_t flags;
+  uint32_t resv1;
+  uint64_t resv2;
+};
+
+
+struct IOUringParams {
+  uint32_t sq_entries;
+  uint32_t cq_entries;
+  uint32_t flags;
+  uint32_t sq_thread_cpu;
+  uint32_t sq_thread_idle;
+  uint32_t features;
+  uint32_t wq_fd;
+  uint32_t resv[3];
+  IOUringSqOffsets sq_off;
+  IOUringCqOffsets cq_off;
+};
+
+
+struct IOUringSqe {
+  uint8_t opcode;
+  uint8_t flags;
+  uint16_t ioprio;
+  int32_t fd;
+  uint64_t off;
+  uint64_t addr;
+  uint32_t len;
+  uint32_t rw_flags;
+  uint64_t user_data;
+  uint16_t buf_index;
+  uint16_t personality;
+  int32_t splice_fd_in;
+  uint64_t pad[2];
+};
+
+
+struct IOUringCqe {
+  uint64_t user_data;
+  int32_t res;
+  uint32_t flags;
+};
+
+
+static const uint8_t kOpRead = 22;
+static const uint8_t kOpWrite = 23;
+static const uint32_t kEnterGetEvents = 1 << 0;
+static const uint32_t kFeatureSingleMmap = 1 << 0;
+static const uint32_t kFeatureRwCurrentPosition = 1 << 3;
+static const off_t kSqRingOffset = 0;
+static const off_t kSqesOffset = 0x10000000;
+// Offset -1 makes reads and writes use and advance the file position, just
+// like read(2) and write(2) do.
+static const uint64_t kCurrentPosition = static_cast<uint64_t>(-1);
+static const uint32_t kRingEntries = 256;
+// Reads and writes are limited to what fits in the 32-bit length of a
+// submission. Larger requests are handled synchronously.
+static const int64_t kMaxLength = kMaxInt32;
+
+
+// A submitted file request. The buffer is owned by the request until the
+// reply is posted.
+struct IOUringRequest {
+  intptr_t request_id;
+  Dart_Port reply_port;
+  int32_t message_id;
+  File* file;
+  uint8_t* buffer;
+  int64_t length;
+};
+
+
+class IOUringInstance {
+ public:
+  // Creates the process wide ring. Returns NULL if io_uring is not usable
+  // on this system.
+  static IOUringInstance* Create();
+
+  // The ring created by Create.
+  static IOUringInstance* instance() { return instance_; }
+
+  bool Enqueue(IOUringRequest* request);
+
+ private:
+  IOUringInstance()
+      : ring_fd_(-1),
+        ring_(NULL),
+        ring_size_(0),
+        sqes_(NULL),
+        sqes_size_(0),
+        sq_head_(NULL),
+        sq_tail_(NULL),
+        sq_mask_(0),
+        sq_entries_(0),
+        sq_array_(NULL),
+        cq_head_(NULL),
+        cq_tail_(NULL),
+        cq_mask_(0),
+        cq_entries_(0),
+        cqes_(NULL),
+        in_flight_(0),
+        unsubmitted_(0),
+        submitting_(false) {}
+
+  bool Initialize();
+  void Destroy();
+
+  int Enter(uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return syscall(kIOUringEnter, ring_fd_, to_submit, min_complete, flags,
+                   NULL, 0);
+  }
+
+  // Submits all queued submissions to the kernel. Only one thread flushes
+  // at a time; submissions queued while another thread is inside
+  // io_uring_enter are picked up by that thread, so concurrent requests
+  // are batched into a single system call.
+  void Flush();
+  // Takes the queued submissions back from the ring and completes them with
+  // blocking calls. Used when the kernel refuses them and no submitted
+  // request is outstanding, since then the completion thread would never
+  // wake up to flush them again.
+  void CompleteUnsubmittedSynchronously();
+  void ReapCompletions();
+  void Complete(IOUringRequest* request, int32_t result);
+
+  static void CompletionThread(uword parameter);
+  static bool KernelSupportsIOUring();
+
+  static IOUringInstance* instance_;
+
+  int ring_fd_;
+  uint8_t* ring_;
+  size_t ring_size_;
+  IOUringSqe* sqes_;
+  size_t sqes_size_;
+
+  uint32_t* sq_head_;
+  uint32_t* sq_tail_;
+  uint32_t sq_mask_;
+  uint32_t sq_entries_;
+  uint32_t* sq_array_;
+
+  uint32_t* cq_head_;
+  uint32_t* cq_tail_;
+  uint32_t cq_mask_;
+  uint32_t cq_entries_;
+  IOUringCqe* cqes_;
+
+  // Protects the submission queue and the counters below.
+  Mutex mutex_;
+  // Requests that have been queued but not completed yet. Never exceeds the
+  // size of the completion queue so completions cannot overflow.
+  uint32_t in_flight_;
+  // Requests that have been queued but not handed to the kernel yet.
+  uint32_t unsubmitted_;
+  bool submitting_;
+
+  DISALLOW_COPY_AND_ASSIGN(IOUringInstance);
+};
+
+
+IOUringInstance* IOUringInstance::instance_ = NULL;
+
+
+bool IOUringInstance::KernelSupportsIOUring() {
+  // IORING_OP_READ, IORING_OP_WRITE and reads and writes at the current file
+  // position were added in Linux 5.6. Earlier kernels may accept
+  // io_uring_setup but reject the operations we submit.
+  if (kIOUringSetup < 0) {
+    return false;
+  }
+  struct utsname info;
+  if (uname(&info) != 0) {
+    return false;
+  }
+  int major = 0;
+  int minor = 0;
+  if (sscanf(info.release, "%d.%d", &major, &minor) != 2) {
+    return false;
+  }
+  return (major > 5) || ((major == 5) && (minor >= 6));
+}
+
+
+IOUringInstance* IOUringInstance::Create() {
+  ASSERT(instance_ == NULL);
+  if (!KernelSupportsIOUring()) {
+    return NULL;
+  }
+  IOUringInstance* ring = new IOUringInstance();
+  if (!ring->Initialize()) {
+    ring->Destroy();
+    delete ring;
+    return NULL;
+  }
+  int result = Thread::Start(&CompletionThread,
+                             reinterpret_cast<uword>(ring));
+  if (result != 0) {
+    ring->Destroy();
+    delete ring;
+    return NULL;
+  }
+  instance_ = ring;
+  return instance_;
+}
+
+
+bool IOUringInstance::Initialize() {
+  IOUringParams params;
+  memset(&params, 0, sizeof(params));
+  // io_uring_setup can also fail with ENOSYS or EPERM when it is disabled or
+  // blocked by a seccomp filter, in which case we fall back silently.
+  ring_fd_ = syscall(kIOUringSetup, kRingEntries, &params);
+  if (ring_fd_ < 0) {
+    return false;
+  }
+  const uint32_t required = kFeatureSingleMmap | kFeatureRwCurrentPosition;
+  if ((params.features & required) != required) {
+    return false;
+  }
+  size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  size_t cq_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(IOUringCqe);
+  ring_size_ = (sq_size > cq_size) ? sq_size : cq_size;
+  void* ring = mmap(NULL, ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, kSqRingOffset);
+  if (ring == MAP_FAILED) {
+    ring_size_ = 0;
+    return false;
+  }
+  ring_ = reinterpret_cast<uint8_t*>(ring);
+  sqes_size_ = params.sq_entries * sizeof(IOUringSqe);
+  void* sqes = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, kSqesOffset);
+  if (sqes == MAP_FAILED) {
+    sqes_size_ = 0;
+    return false;
+  }
+  sqes_ = reinterpret_cast<IOUringSqe*>(sqes);
+
+  sq_head_ = reinterpret_cast<uint32_t*>(ring_ + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<uint32_t*>(ring_ + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<uint32_t*>(ring_ + params.sq_off.ring_mask);
+  sq_entries_ =
+      *reinterpret_cast<uint32_t*>(ring_ + params.sq_off.ring_entries);
+  sq_array_ = reinterpret_cast<uint32_t*>(ring_ + params.sq_off.array);
+  cq_head_ = reinterpret_cast<uint32_t*>(ring_ + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<uint32_t*>(ring_ + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<uint32_t*>(ring_ + params.cq_off.ring_mask);
+  cq_entries_ =
+      *reinterpret_cast<uint32_t*>(ring_ + params.cq_off.ring_entries);
+  cqes_ = reinterpret_cast<IOUringCqe*>(ring_ + params.cq_off.cqes);
+  return true;
+}
+
+
+void IOUringInstance::Destroy() {
+  if (sqes_ != NULL) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = NULL;
+  }
+  if (ring_ != NULL) {
+    munmap(ring_, ring_size_);
+    ring_ = NULL;
+  }
+  if (ring_fd_ >= 0) {
+    VOID_TEMP_FAILURE_RETRY(close(ring_fd_));
+    ring_fd_ = -1;
+  }
+}
+
+
+bool IOUringInstance::Enqueue(IOUringRequest* request) {
+  MutexLocker ml(&mutex_);
+  if (in_flight_ == cq_entries_) {
+    return false;
+  }
+  // Only this thread writes the tail, but the kernel advances the head.
+  uint32_t tail = *sq_tail_;
+  uint32_t head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (tail - head == sq_entries_) {
+    return false;
+  }
+  uint32_t index = tail & sq_mask_;
+  IOUringSqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = (request->request_id == IOService::kFileWriteFromRequest)
+      ? kOpWrite : kOpRead;
+  sqe->fd = request->file->GetFD();
+  sqe->off = kCurrentPosition;
+  sqe->addr = reinterpret_cast<uint64_t>(request->buffer);
+  sqe->len = static_cast<uint32_t>(request->length);
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  in_flight_++;
+  unsubmitted_++;
+  if (!submitting_) {
+    Flush();
+  }
+  return true;
+}
+
+
+void IOUringInstance::Flush() {
+  // Called with mutex_ held.
+  ASSERT(!submitting_);
+  submitting_ = true;
+  while (unsubmitted_ > 0) {
+    uint32_t to_submit = unsubmitted_;
+    mutex_.Unlock();
+    int result = Enter(to_submit, 0, 0);
+    int error = errno;
+    mutex_.Lock();
+    if (result > 0) {
+      ASSERT(static_cast<uint32_t>(result) <= unsubmitted_);
+      unsubmitted_ -= result;
+    } else if ((result == 0) || (error != EINTR)) {
+      // EAGAIN and EBUSY mean that the kernel is out of resources or that
+      // completions must be reaped first. If submitted requests are still
+      // outstanding, the completion thread flushes again after reaping them.
+      if (in_flight_ > unsubmitted_) {
+        break;
+      }
+      CompleteUnsubmittedSynchronously();
+    }
+  }
+  submitting_ = false;
+}
+
+
+void IOUringInstance::CompleteUnsubmittedSynchronously() {
+  // Called with mutex_ held while flushing. The kernel only reads the
+  // submission queue inside io_uring_enter, so the unsubmitted entries at the
+  // end of the queue can be taken back by moving the tail.
+  ASSERT(submitting_);
+  const uint32_t count = unsubmitted_;
+  const uint32_t tail = *sq_tail_;
+  ASSERT(tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == count);
+  IOUringRequest** requests = new IOUringRequest*[count];
+  for (uint32_t i = 0; i < count; i++) {
+    IOUringSqe* sqe = &sqes_[sq_array_[(tail - count + i) & sq_mask_]];
+    requests[i] = reinterpret_cast<IOUringRequest*>(sqe->user_data);
+  }
+  __atomic_store_n(sq_tail_, tail - count, __ATOMIC_RELEASE);
+  unsubmitted_ -= count;
+  in_flight_ -= count;
+  mutex_.Unlock();
+  for (uint32_t i = 0; i < count; i++) {
+    IOUringRequest* request = requests[i];
+    int64_t result =
+        (request->request_id == IOService::kFileWriteFromRequest)
+            ? request->file->Write(request->buffer, request->length)
+            : request->file->Read(request->buffer, request->length);
+    Complete(request, (result < 0) ? -errno : static_cast<int32_t>(result));
+  }
+  delete[] requests;
+  mutex_.Lock();
+}
+
+
+void IOUringInstance::ReapCompletions() {
+  // Only the completion thread advances the head.
+  uint32_t head = *cq_head_;
+  uint32_t tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  uint32_t count = 0;
+  while (head != tail) {
+    IOUringCqe* cqe = &cqes_[head & cq_mask_];
+    IOUringRequest* request =
+        reinterpret_cast<IOUringRequest*>(cqe->user_data);
+    int32_t result = cqe->res;
+    head++;
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    Complete(request, result);
+    count++;
+    if (head == tail) {
+      tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    }
+  }
+  if (count > 0) {
+    MutexLocker ml(&mutex_);
+    ASSERT(count <= in_flight_);
+    in_flight_ -= count;
+    if (!submitting_ && (unsubmitted_ > 0)) {
+      Flush();
+    }
+  }
+}
+
+
+// The completion thread has no API scope, so the replies are built from
+// stack allocated CObjects. Dart_PostCObject copies the message.
+static void PostOSError(Dart_Port reply_port,
+                        int32_t message_id,
+                        OSError* os_error) {
+  Dart_CObject error_values[3];
+  Dart_CObject* error_elements[3] = {
+      &error_values[0], &error_values[1], &error_values[2] };
+  error_values[0].type = Dart_CObject_kInt32;
+  error_values[0].value.as_int32 = CObject::kOSError;
+  error_values[1].type = Dart_CObject_kInt32;
+  error_values[1].value.as_int32 = os_error->code();
+  error_values[2].type = Dart_CObject_kString;
+  error_values[2].value.as_string = os_error->message();
+  Dart_CObject error;
+  error.type = Dart_CObject_kArray;
+  error.value.as_array.length = 3;
+  error.value.as_array.values = error_elements;
+
+  Dart_CObject id;
+  id.type = Dart_CObject_kInt32;
+  id.value.as_int32 = message_id;
+  Dart_CObject* elements[2] = { &id, &error };
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 2;
+  message.value.as_array.values = elements;
+  Dart_PostCObject(reply_port, &message);
+}
+
+
+static void PostReadResult(IOUringRequest* request, int64_t bytes_read) {
+  Dart_CObject success;
+  success.type = Dart_CObject_kInt32;
+  success.value.as_int32 = CObject::kSuccess;
+  Dart_CObject count;
+  count.type = Dart_CObject_kInt64;
+  count.value.as_int64 = bytes_read;
+  Dart_CObject data;
+  data.type = Dart_CObject_kExternalTypedData;
+  data.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+  data.value.as_external_typed_data.length = bytes_read;
+  data.value.as_external_typed_data.data = request->buffer;
+  data.value.as_external_typed_data.peer = request->buffer;
+  data.value.as_external_typed_data.callback = IOBuffer::Finalizer;
+
+  // A read replies with [success, data], a readInto with
+  // [success, bytes read, data].
+  Dart_CObject* result_elements[3] = { &success, &count, &data };
+  Dart_CObject result;
+  result.type = Dart_CObject_kArray;
+  if (request->request_id == IOService::kFileReadRequest) {
+    result_elements[1] = &data;
+    result.value.as_array.length = 2;
+  } else {
+    ASSERT(request->request_id == IOService::kFileReadIntoRequest);
+    result.value.as_array.length = 3;
+  }
+  result.value.as_array.values = result_elements;
+
+  Dart_CObject id;
+  id.type = Dart_CObject_kInt32;
+  id.value.as_int32 = request->message_id;
+  Dart_CObject* elements[2] = { &id, &result };
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 2;
+  message.value.as_array.values = elements;
+  Dart_PostCObject(request->reply_port, &message);
+}
+
+
+static void PostWriteResult(IOUringRequest* request) {
+  Dart_CObject id;
+  id.type = Dart_CObject_kInt32;
+  id.value.as_int32 = request->message_id;
+  Dart_CObject length;
+  length.type = Dart_CObject_kInt64;
+  length.value.as_int64 = request->length;
+  Dart_CObject* elements[2] = { &id, &length };
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 2;
+  message.value.as_array.values = elements;
+  Dart_PostCObject(request->reply_port, &message);
+}
+
+
+void IOUringInstance::Complete(IOUringRequest* request, int32_t result) {
+  bool is_write = request->request_id == IOService::kFileWriteFromRequest;
+  if (result < 0) {
+    OSError os_error;
+    os_error.SetCodeAndMessage(OSError::kSystem, -result);
+    PostOSError(request->reply_port, request->message_id, &os_error);
+    if (is_write) {
+      free(request->buffer);
+    } else {
+      IOBuffer::Free(request->buffer);
+    }
+  } else if (is_write) {
+    // A short write leaves the file position after the written bytes, so
+    // the rest can be written synchronously to get the same semantics as
+    // File::WriteFully.
+    bool success = true;
+    if (result < request->length) {
+      success = request->file->WriteFully(request->buffer + result,
+                                          request->length - result);
+    }
+    if (success) {
+      PostWriteResult(request);
+    } else {
+      OSError os_error;
+      PostOSError(request->reply_port, request->message_id, &os_error);
+    }
+    free(request->buffer);
+  } else {
+    // Ownership of the buffer is passed to the Dart heap.
+    PostReadResult(request, result);
+  }
+  delete request;
+}
+
+
+void IOUringInstance::CompletionThread(uword parameter) {
+  IOUringInstance* ring = reinterpret_cast<IOUringInstance*>(parameter);
+  // The ring lives for the rest of the process.
+  while (true) {
+    int result = ring->Enter(0, 1, kEnterGetEvents);
+    if ((result < 0) && (errno != EINTR) && (errno != EBUSY)) {
+      FATAL1("io_uring_enter failed: %d\n", errno);
+    }
+    ring->ReapCompletions();
+  }
+}
+
+
+static int64_t Int32OrInt64Value(CObject* cobject) {
+  ASSERT(cobject->IsInt32OrInt64());
+  if (cobject->IsInt32()) {
+    CObjectInt32 value(cobject);
+    return value.Value();
+  }
+  CObjectInt64 value(cobject);
+  return value.Value();
+}
+
+
+void IOUring::Enable() {
+  ASSERT(!enabled_);
+  enabled_ = (IOUringInstance::Create() != NULL);
+}
+
+
+bool IOUring::Submit(intptr_t request_id,
+                     Dart_Port reply_port,
+                     int32_t message_id,
+                     const CObjectArray& data) {
+  if (!enabled_) {
+    return false;
+  }
+  bool is_write;
+  int64_t length;
+  if ((request_id == IOService::kFileReadRequest) ||
+      (request_id == IOService::kFileReadIntoRequest)) {
+    if ((data.Length() != 2) ||
+        !data[0]->IsIntptr() ||
+        !data[1]->IsInt32OrInt64()) {
+      return false;
+    }
+    is_write = false;
+    length = Int32OrInt64Value(data[1]);
+  } else if (request_id == IOService::kFileWriteFromRequest) {
+    // Writes from a plain array need their elements converted and are left
+    // to the synchronous path.
+    if ((data.Length() != 4) ||
+        !data[0]->IsIntptr() ||
+        !data[1]->IsTypedData() ||
+        !data[2]->IsInt32OrInt64() ||
+        !data[3]->IsInt32OrInt64()) {
+      return false;
+    }
+    is_write = true;
+    length = Int32OrInt64Value(data[3]) -
+             Int32OrInt64Value(data[2]);
+  } else {
+    return false;
+  }
+  CObjectIntptr file_pointer(data[0]);
+  File* file = reinterpret_cast<File*>(file_pointer.Value());
+  ASSERT(file != NULL);
+  if (file->IsClosed() || (length <= 0) || (length > kMaxLength)) {
+    return false;
+  }
+  IOUringInstance* ring = IOUringInstance::instance();
+  ASSERT(ring != NULL);
+
+  uint8_t* buffer;
+  if (is_write) {
+    // The typed data belongs to the message and is freed when the callback
+    // returns, so the bytes are copied.
+    CObjectTypedData typed_data(data[1]);
+    int element_size = File::TypedDataElementSize(typed_data.Type());
+    int64_t start = Int32OrInt64Value(data[2]) * element_size;
+    length = length * element_size;
+    if (length > kMaxLength) {
+      return false;
+    }
+    buffer = reinterpret_cast<uint8_t*>(malloc(length));
+    if (buffer == NULL) {
+      return false;
+    }
+    memmove(buffer, typed_data.Buffer() + start, length);
+  } else {
+    buffer = IOBuffer::Allocate(static_cast<intptr_t>(length));
+    if (buffer == NULL) {
+      return false;
+    }
+  }
+
+  IOUringRequest* request = new IOUringRequest();
+  request->request_id = request_id;
+  request->reply_port = reply_port;
+  request->message_id = message_id;
+  request->file = file;
+  request->buffer = buffer;
+  request->length = length;
+  if (!ring->Enqueue(request)) {
+    if (is_write) {
+      free(buffer);
+    } else {
+      IOBuffer::Free(buffer);
+    }
+    delete request;
+    return false;
+  }
+  return true;
+}
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // defined(TARGET_OS_LINUX)
@@ -16,6 +16,7 @@
 #include "bin/eventhandler.h"
 #include "bin/extensions.h"
 #include "bin/file.h"
+#include "bin/io_uring.h"
 #include "bin/isolate_data.h"
 #include "bin/log.h"
 #include "bin/platform.h"
@@ -81,6 +82,11 @@ static bool has_precompile = false;
 static bool has_trace_loading = false;
 
 
+// Global flag that is used to indicate that asynchronous file reads and
+// writes should be submitted to an io_uring where supported.
+static bool use_io_uring = false;
+
+
 static const char* DEFAULT_VM_SERVICE_SERVER_IP = "127.0.0.1";
 static const int DEFAULT_VM_SERVICE_SERVER_PORT = 8181;
 // VM Service options.
@@ -395,6 +401,40 @@ static bool ProcessTraceLoadingOption(const char* arg,
 }
 
 
+static bool ProcessIOUringOption(const char* arg,
+                                 CommandLineOptions* vm_options) {
+  if (*arg != '\0') {
+    return false;
+  }
+  use_io_uring = true;
+  return true;
+}
+
+
+static bool ProcessVmServiceMetricsOption(const char* arg,
+                                          CommandLineOptions* vm_options) {
+  if (*arg != '\0') {
+    return false;
+  }
+  VmService::set_metrics_endpoint(true);
+  return true;
+}
+
+
+static bool ProcessTimerSlackOption(const char* arg,
+                                    CommandLineOptions* vm_options) {
+  ASSERT(arg != NULL);
+  char* end = NULL;
+  int64_t slack = strtoll(arg, &end, 10);
+  if ((*arg == '\0') || (*end != '\0') || (slack < 0)) {
+    Log::PrintErr("Use --timer-slack=<milliseconds>\n");
+    return false;
+  }
+  TimeoutQueue::set_slack(slack);
+  return true;
+}
+
+
 static struct {
   const char* option_name;
   bool (*process)(const char* option, CommandLineOptions* vm_options);
@@ -418,6 +458,9 @@ static struct {
   { "--observe", ProcessObserveOption },
   { "--trace-debug-protocol", ProcessTraceDebugProtocolOption },
   { "--trace-loading", ProcessTraceLoadingOption},
+  { "--timer-slack=", ProcessTimerSlackOption },
+  { "--io-uring", ProcessIOUringOption },
+  { "--vm-service-metrics", ProcessVmServiceMetricsOption },
   { NULL, NULL }
 };
 
@@ -807,10 +850,23 @@ static void PrintUsage() {
 "--trace-loading\n"
 "  enables tracing of library and script loading\n"
 "\n"
+"--timer-slack=<milliseconds>\n"
+"  allows timer wakeups to be delayed by up to the given number of\n"
+"  milliseconds so that nearby timers are handled in a single wakeup\n"
+"\n"
+"--io-uring\n"
+"  performs asynchronous file reads and writes through io_uring when the\n"
+"  kernel supports it (Linux 5.6 or later), falling back to blocking\n"
+"  reads and writes otherwise\n"
+"\n"
 "--enable-vm-service[:<port number>]\n"
 "  enables the VM service and listens on specified port for connections\n"
 "  (default port number is 8181)\n"
 "\n"
+"--vm-service-metrics\n"
+"  serves VM and isolate metrics in the Prometheus text format at /metrics\n"
+"  on the VM service HTTP server\n"
+"\n"
 "--noopt\n"
 "  run unoptimized code only\n"
 "\n"
@@ -1000,6 +1056,11 @@ void main(int argc, char** argv) {
 
   Thread::InitOnce();
 
+  // Set up before any thread that submits IOService requests is started.
+  if (use_io_uring) {
+    IOUring::Enable();
+  }
+
   if (!DartUtils::SetOriginalWorkingDirectory()) {
     OSError err;
     fprintf(stderr, "Error determining current directory: %s\n", err.message());
@@ -12,7 +12,11 @@
 #include <poll.h>  // NOLINT
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
+#include <signal.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/epoll.h>  // NOLINT
+#include <sys/eventfd.h>  // NOLINT
+#include <sys/syscall.h>  // NOLINT
 #include <sys/wait.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 
@@ -29,27 +33,59 @@ extern char **environ;
 namespace dart {
 namespace bin {
 
+// pidfd_open and pidfd_send_signal were added in Linux 5.3 and 5.1. The
+// system headers we build against predate them, so the system call numbers
+// are declared locally where they are the same on all architectures.
+#if defined(__NR_pidfd_open)
+static const long kPidfdOpen = __NR_pidfd_open;  // NOLINT
+static const long kPidfdSendSignal = __NR_pidfd_send_signal;  // NOLINT
+#elif defined(__x86_64__) || defined(__i386__) || \
+      defined(__arm__) || defined(__aarch64__)
+static const long kPidfdOpen = 434;  // NOLINT
+static const long kPidfdSendSignal = 424;  // NOLINT
+#else
+static const long kPidfdOpen = -1;  // NOLINT
+static const long kPidfdSendSignal = -1;  // NOLINT
+#endif
+
+
+static int PidfdOpen(pid_t pid) {
+  if (kPidfdOpen == -1) {
+    errno = ENOSYS;
+    return -1;
+  }
+  return NO_RETRY_EXPECTED(syscall(kPidfdOpen, pid, 0));
+}
+
+
 // ProcessInfo is used to map a process id to the file descriptor for
 // the pipe used to communicate the exit code of the process to Dart.
-// ProcessInfo objects are kept in the static singly-linked
-// ProcessInfoList.
+// When exits are observed through pidfds it also holds the pidfd of the
+// process, which is -1 otherwise. ProcessInfo objects are kept in the
+// static singly-linked ProcessInfoList.
 class ProcessInfo {
  public:
-  ProcessInfo(pid_t pid, intptr_t fd) : pid_(pid), fd_(fd) { }
+  ProcessInfo(pid_t pid, intptr_t fd, intptr_t pidfd)
+      : pid_(pid), fd_(fd), pidfd_(pidfd) { }
   ~ProcessInfo() {
     int closed = TEMP_FAILURE_RETRY(close(fd_));
     if (closed != 0) {
       FATAL("Failed to close process exit code pipe");
     }
+    if (pidfd_ != -1) {
+      VOID_TEMP_FAILURE_RETRY(close(pidfd_));
+    }
   }
   pid_t pid() { return pid_; }
   intptr_t fd() { return fd_; }
+  intptr_t pidfd() { return pidfd_; }
   ProcessInfo* next() { return next_; }
   void set_next(ProcessInfo* info) { next_ = info; }
 
  private:
   pid_t pid_;
   intptr_t fd_;
+  intptr_t pidfd_;
   ProcessInfo* next_;
 };
 
@@ -58,9 +94,9 @@ class ProcessInfo {
 // started from Dart.
 class ProcessInfoList {
  public:
-  static void AddProcess(pid_t pid, intptr_t fd) {
+  static void AddProcess(pid_t pid, intptr_t fd, intptr_t pidfd) {
     MutexLocker locker(mutex_);
-    ProcessInfo* info = new ProcessInfo(pid, fd);
+    ProcessInfo* info = new ProcessInfo(pid, fd, pidfd);
     info->set_next(active_processes_);
     active_processes_ = info;
   }
@@ -79,6 +115,23 @@ class ProcessInfoList {
   }
 
 
+  // Sends a signal to an active process through its pidfd, which cannot
+  // refer to another process that has reused the process id. Falls back
+  // to kill for other processes.
+  static bool Kill(pid_t pid, int signal) {
+    MutexLocker locker(mutex_);
+    ProcessInfo* current = active_processes_;
+    while (current != NULL) {
+      if ((current->pid() == pid) && (current->pidfd() != -1)) {
+        return NO_RETRY_EXPECTED(syscall(kPidfdSendSignal, current->pidfd(),
+                                         signal, NULL, 0)) != -1;
+      }
+      current = current->next();
+    }
+    return (TEMP_FAILURE_RETRY(kill(pid, signal)) != -1);
+  }
+
+
   static void RemoveProcess(pid_t pid) {
     MutexLocker locker(mutex_);
     ProcessInfo* prev = NULL;
@@ -116,10 +169,30 @@ Mutex* ProcessInfoList::mutex_ = new Mutex();
 // processes to terminate. That separate thread can then get the exit code from
 // processes that have exited and communicate it to Dart through the
 // event loop.
+//
+// On kernels with pidfd support the thread waits in epoll for the pidfds of
+// the processes started from Dart to become readable, and only reaps those
+// processes. Otherwise it reaps any child process with wait, and processes
+// must be registered before they can exit.
 class ExitCodeHandler {
  public:
-  // Notify the ExitCodeHandler that another process exists.
+  // Returns whether exits are observed through pidfds.
+  static bool UsePidfds() {
+    MonitorLocker locker(monitor_);
+    if (use_pidfds_ == -1) {
+      int pidfd = PidfdOpen(getpid());
+      use_pidfds_ = (pidfd != -1) ? 1 : 0;
+      if (pidfd != -1) {
+        VOID_TEMP_FAILURE_RETRY(close(pidfd));
+      }
+    }
+    return use_pidfds_ == 1;
+  }
+
+  // Notify the ExitCodeHandler that another process exists. Only used when
+  // exits are not observed through pidfds.
   static void ProcessStarted() {
+    ASSERT(use_pidfds_ == 0);
     // Multiple isolates could be starting processes at the same
     // time. Make sure that only one ExitCodeHandler thread exists.
     MonitorLocker locker(monitor_);
@@ -140,6 +213,32 @@ class ExitCodeHandler {
     running_ = true;
   }
 
+  // Starts watching the pidfd of a registered process for its exit.
+  static void WatchProcess(pid_t pid, int pidfd) {
+    ASSERT(use_pidfds_ == 1);
+    MonitorLocker locker(monitor_);
+    if (!running_) {
+      epoll_fd_ = NO_RETRY_EXPECTED(epoll_create1(EPOLL_CLOEXEC));
+      if (epoll_fd_ == -1) {
+        FATAL1("Failed creating exit code epoll descriptor: %d", errno);
+      }
+      wakeup_fd_ = NO_RETRY_EXPECTED(eventfd(0, EFD_CLOEXEC));
+      if (wakeup_fd_ == -1) {
+        FATAL1("Failed creating exit code wakeup descriptor: %d", errno);
+      }
+      AddToEpoll(wakeup_fd_, 0);
+      int result = Thread::Start(PidfdHandlerEntry, 0);
+      if (result != 0) {
+        FATAL1("Failed to start exit code handler worker thread %d", result);
+      }
+      running_ = true;
+    }
+    // The pid and pidfd are both kept in the event data, which leaves zero
+    // for the wakeup descriptor.
+    AddToEpoll(pidfd, (static_cast<uint64_t>(pid) << 32) |
+                      static_cast<uint32_t>(pidfd));
+  }
+
   static void TerminateExitCodeThread() {
     MonitorLocker locker(monitor_);
 
@@ -151,9 +250,14 @@ class ExitCodeHandler {
     // monitor.
     running_ = false;
 
-    // Fork to wake up waitpid.
-    if (TEMP_FAILURE_RETRY(fork()) == 0) {
-      exit(0);
+    if (use_pidfds_ == 1) {
+      uint64_t value = 1;
+      VOID_TEMP_FAILURE_RETRY(write(wakeup_fd_, &value, sizeof(value)));
+    } else {
+      // Fork to wake up waitpid.
+      if (TEMP_FAILURE_RETRY(fork()) == 0) {
+        exit(0);
+      }
     }
 
     monitor_->Notify();
@@ -164,6 +268,48 @@ class ExitCodeHandler {
   }
 
  private:
+  static void AddToEpoll(int fd, uint64_t data) {
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = data;
+    if (NO_RETRY_EXPECTED(
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event)) == -1) {
+      FATAL1("Failed adding descriptor to exit code epoll: %d", errno);
+    }
+  }
+
+  // Communicates the exit status of a process to Dart. Returns false if the
+  // process was not started from Dart.
+  static bool ReportExit(pid_t pid, int status) {
+    int exit_code = 0;
+    int negative = 0;
+    if (WIFEXITED(status)) {
+      exit_code = WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+      exit_code = WTERMSIG(status);
+      negative = 1;
+    }
+    intptr_t exit_code_fd = ProcessInfoList::LookupProcessExitFd(pid);
+    if (exit_code_fd == 0) {
+      return false;
+    }
+    int message[2] = { exit_code, negative };
+    ssize_t result =
+        FDUtils::WriteToBlocking(exit_code_fd, &message, sizeof(message));
+    // If the process has been closed, the read end of the exit
+    // pipe has been closed. It is therefore not a problem that
+    // write fails with a broken pipe error. Other errors should
+    // not happen.
+    if (result != -1 && result != sizeof(message)) {
+      FATAL("Failed to write entire process exit message");
+    } else if (result == -1 && errno != EPIPE) {
+      FATAL1("Failed to write exit code: %d", errno);
+    }
+    ProcessInfoList::RemoveProcess(pid);
+    return true;
+  }
+
   // Entry point for the separate exit code handler thread started by
   // the ExitCodeHandler.
   static void ExitCodeHandlerEntry(uword param) {
@@ -183,35 +329,56 @@ class ExitCodeHandler {
       }
 
       if ((pid = TEMP_FAILURE_RETRY(wait(&status))) > 0) {
-        int exit_code = 0;
-        int negative = 0;
-        if (WIFEXITED(status)) {
-          exit_code = WEXITSTATUS(status);
+        if (ReportExit(pid, status)) {
+          MonitorLocker locker(monitor_);
+          process_count_--;
         }
-        if (WIFSIGNALED(status)) {
-          exit_code = WTERMSIG(status);
-          negative = 1;
-        }
-        intptr_t exit_code_fd = ProcessInfoList::LookupProcessExitFd(pid);
-        if (exit_code_fd != 0) {
-          int message[2] = { exit_code, negative };
-          ssize_t result =
-              FDUtils::WriteToBlocking(exit_code_fd, &message, sizeof(message));
-          // If the process has been closed, the read end of the exit
-          // pipe has been closed. It is therefore not a problem that
-          // write fails with a broken pipe error. Other errors should
-          // not happen.
-          if (result != -1 && result != sizeof(message)) {
-            FATAL("Failed to write entire process exit message");
-          } else if (result == -1 && errno != EPIPE) {
-            FATAL1("Failed to write exit code: %d", errno);
-          }
-          ProcessInfoList::RemoveProcess(pid);
-          {
-            MonitorLocker locker(monitor_);
-            process_count_--;
+      }
+    }
+  }
+
+  // Entry point for the exit code handler thread when exits are observed
+  // through pidfds.
+  static void PidfdHandlerEntry(uword param) {
+    const intptr_t kMaxEvents = 16;
+    struct epoll_event events[kMaxEvents];
+    while (true) {
+      intptr_t count = TEMP_FAILURE_RETRY(
+          epoll_wait(epoll_fd_, events, kMaxEvents, -1));
+      if (count == -1) {
+        FATAL1("Failed waiting for process exits: %d", errno);
+      }
+      for (intptr_t i = 0; i < count; i++) {
+        uint64_t data = events[i].data.u64;
+        if (data == 0) {
+          uint64_t value;
+          VOID_TEMP_FAILURE_RETRY(read(wakeup_fd_, &value, sizeof(value)));
+          MonitorLocker locker(monitor_);
+          if (!running_) {
+            terminate_done_ = true;
+            monitor_->Notify();
+            return;
           }
+          continue;
+        }
+        pid_t pid = static_cast<pid_t>(data >> 32);
+        int pidfd = static_cast<int>(data & 0xffffffff);
+        int status = 0;
+        pid_t result = TEMP_FAILURE_RETRY(waitpid(pid, &status, WNOHANG));
+        if (result == 0) {
+          continue;
+        }
+        // A readable pidfd stays readable, so it has to leave the epoll set
+        // even when waitpid fails, e.g. with ECHILD if the process was
+        // reaped elsewhere. Its exit status is then lost and the exit is
+        // reported as a failure.
+        VOID_NO_RETRY_EXPECTED(
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, pidfd, NULL));
+        if (result != pid) {
+          status = W_EXITCODE(255, 0);
         }
+        // The pidfd is closed with the process info.
+        ReportExit(pid, status);
       }
     }
   }
@@ -219,6 +386,9 @@ class ExitCodeHandler {
   static bool terminate_done_;
   static int process_count_;
   static bool running_;
+  static int use_pidfds_;
+  static int epoll_fd_;
+  static int wakeup_fd_;
   static Monitor* monitor_;
 };
 
@@ -226,6 +396,9 @@ class ExitCodeHandler {
 bool ExitCodeHandler::running_ = false;
 int ExitCodeHandler::process_count_ = 0;
 bool ExitCodeHandler::terminate_done_ = false;
+int ExitCodeHandler::use_pidfds_ = -1;
+int ExitCodeHandler::epoll_fd_ = -1;
+int ExitCodeHandler::wakeup_fd_ = -1;
 Monitor* ExitCodeHandler::monitor_ = new Monitor();
 
 
@@ -291,6 +464,19 @@ class ProcessStarter {
     int err = CreatePipes();
     if (err != 0) return err;
 
+    bool use_pidfds = ExitCodeHandler::UsePidfds();
+    // vfork avoids copying the page tables of the parent, which dominates
+    // the cost of starting a process from a large heap. The child borrows
+    // the memory of the parent until it execs, so it cannot wait to be
+    // registered and cannot replace environ for execvp to search the new
+    // PATH. Without pidfds a process must be registered before it can
+    // exit, so vfork is only used with pidfds.
+    if (use_pidfds &&
+        (mode_ == kNormal) &&
+        ((program_environment_ == NULL) || (strchr(path_, '/') != NULL))) {
+      return StartWithVfork();
+    }
+
     // Fork to create the new process.
     pid_t pid = TEMP_FAILURE_RETRY(fork());
     if (pid < 0) {
@@ -304,12 +490,21 @@ class ProcessStarter {
     // This runs in the original process.
 
     // Be sure to listen for exit-codes, now we have a child-process.
-    ExitCodeHandler::ProcessStarted();
+    if (!use_pidfds) {
+      ExitCodeHandler::ProcessStarted();
+    }
 
     // Register the child process if not detached.
     if (mode_ == kNormal) {
       err = RegisterProcess(pid);
-      if (err != 0) return err;
+      if (err != 0) {
+        if (use_pidfds) {
+          // The child exits when it finds its pipes closed, and nobody
+          // else reaps it.
+          VOID_TEMP_FAILURE_RETRY(waitpid(pid, NULL, 0));
+        }
+        return err;
+      }
     }
 
     // Notify child process to start. This is done to delay the call to exec
@@ -328,7 +523,13 @@ class ProcessStarter {
     if (mode_ == kNormal) {
       err = ReadExecResult();
     } else {
+      pid_t intermediate = pid;
       err = ReadDetachedExecResult(&pid);
+      if (use_pidfds) {
+        // Nobody else reaps the intermediate process, which has exited
+        // once the result has been read.
+        VOID_TEMP_FAILURE_RETRY(waitpid(intermediate, NULL, 0));
+      }
     }
     VOID_TEMP_FAILURE_RETRY(close(exec_control_[0]));
     exec_control_[0] = -1;
@@ -348,6 +549,120 @@ class ProcessStarter {
       return err;
     }
 
+    ConnectPipes();
+    ASSERT(exec_control_[0] == -1);
+    ASSERT(exec_control_[1] == -1);
+
+    *id_ = pid;
+    return 0;
+  }
+
+ private:
+  int StartWithVfork() {
+    // Block all signals while the child borrows our memory, so that no
+    // handler runs in the child before it has reset its handlers.
+    sigset_t all_signals;
+    sigset_t old_mask;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, &old_mask);
+    pid_t pid = vfork();
+    if (pid == 0) {
+      // This runs in the new process.
+      ExecVforkedProcess(&old_mask);
+    }
+    int vfork_errno = errno;
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    if (pid < 0) {
+      errno = vfork_errno;
+      return CleanupAndReturnError();
+    }
+
+    // The child has either exec'ed or exited when vfork returns, so the
+    // result is already in the exec control pipe.
+    VOID_TEMP_FAILURE_RETRY(close(exec_control_[1]));
+    exec_control_[1] = -1;
+    int child_errno;
+    int bytes_read = FDUtils::ReadFromBlocking(
+        exec_control_[0], &child_errno, sizeof(child_errno));
+    VOID_TEMP_FAILURE_RETRY(close(exec_control_[0]));
+    exec_control_[0] = -1;
+    if (bytes_read != 0) {
+      if (bytes_read != sizeof(child_errno)) {
+        child_errno = (bytes_read == -1) ? errno : EPIPE;
+      }
+      VOID_TEMP_FAILURE_RETRY(waitpid(pid, NULL, 0));
+      errno = child_errno;
+      return CleanupAndReturnError();
+    }
+
+    // Exits are observed through pidfds, so the process can be registered
+    // after it has started.
+    int err = RegisterProcess(pid);
+    if (err != 0) {
+      VOID_TEMP_FAILURE_RETRY(kill(pid, SIGKILL));
+      VOID_TEMP_FAILURE_RETRY(waitpid(pid, NULL, 0));
+      return err;
+    }
+
+    ConnectPipes();
+    *id_ = pid;
+    return 0;
+  }
+
+
+  void ExecVforkedProcess(const sigset_t* mask) {
+    // Only system calls that do not touch the memory of the parent may be
+    // made here. All signals stay blocked until the exec, which rules out
+    // the signal blocking retry macros and makes them unnecessary.
+    for (int signal = 1; signal < NSIG; signal++) {
+      struct sigaction act;
+      if ((sigaction(signal, NULL, &act) == 0) &&
+          (act.sa_handler != SIG_DFL) &&
+          (act.sa_handler != SIG_IGN)) {
+        act.sa_handler = SIG_DFL;
+        act.sa_flags = 0;
+        sigaction(signal, &act, NULL);
+      }
+    }
+
+    if ((TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+            dup2(write_out_[0], STDIN_FILENO)) == -1) ||
+        (TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+            dup2(read_in_[1], STDOUT_FILENO)) == -1) ||
+        (TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+            dup2(read_err_[1], STDERR_FILENO)) == -1) ||
+        ((working_directory_ != NULL) &&
+         (TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+             chdir(working_directory_)) == -1))) {
+      ReportVforkedChildError();
+    }
+
+    pthread_sigmask(SIG_SETMASK, mask, NULL);
+    if (program_environment_ != NULL) {
+      // The path contains a slash, so no search is needed.
+      execve(path_,
+             const_cast<char* const*>(program_arguments_),
+             const_cast<char* const*>(program_environment_));
+    } else {
+      execvp(path_, const_cast<char* const*>(program_arguments_));
+    }
+    ReportVforkedChildError();
+  }
+
+
+  void ReportVforkedChildError() {
+    // The parent derives the error message from the errno.
+    int child_errno = errno;
+    sigset_t all_signals;
+    sigfillset(&all_signals);
+    pthread_sigmask(SIG_SETMASK, &all_signals, NULL);
+    VOID_TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+        write(exec_control_[1], &child_errno, sizeof(child_errno)));
+    _exit(1);
+  }
+
+
+  void ConnectPipes() {
     if (mode_ != kDetached) {
       // Connect stdio, stdout and stderr.
       FDUtils::SetNonBlocking(read_in_[0]);
@@ -368,14 +683,9 @@ class ProcessStarter {
       ASSERT(read_err_[0] == -1);
       ASSERT(read_err_[1] == -1);
     }
-    ASSERT(exec_control_[0] == -1);
-    ASSERT(exec_control_[1] == -1);
-
-    *id_ = pid;
-    return 0;
   }
 
- private:
+
   int CreatePipes() {
     int result;
     result = TEMP_FAILURE_RETRY(pipe2(exec_control_, O_CLOEXEC));
@@ -518,9 +828,23 @@ class ProcessStarter {
       return CleanupAndReturnError();
     }
 
-    ProcessInfoList::AddProcess(pid, event_fds[1]);
+    int pidfd = -1;
+    if (ExitCodeHandler::UsePidfds()) {
+      pidfd = PidfdOpen(pid);
+      if (pidfd == -1) {
+        int err = errno;
+        VOID_TEMP_FAILURE_RETRY(close(event_fds[0]));
+        VOID_TEMP_FAILURE_RETRY(close(event_fds[1]));
+        errno = err;
+        return CleanupAndReturnError();
+      }
+    }
+    ProcessInfoList::AddProcess(pid, event_fds[1], pidfd);
     *exit_event_ = event_fds[0];
     FDUtils::SetNonBlocking(event_fds[0]);
+    if (pidfd != -1) {
+      ExitCodeHandler::WatchProcess(pid, pidfd);
+    }
     return 0;
   }
 
@@ -876,7 +1200,7 @@ bool Process::Wait(intptr_t pid,
 
 
 bool Process::Kill(intptr_t id, int signal) {
-  return (TEMP_FAILURE_RETRY(kill(id, signal)) != -1);
+  return ProcessInfoList::Kill(id, signal);
 }
 
 
@@ -5,6 +5,7 @@
 #include "bin/io_buffer.h"
 #include "bin/isolate_data.h"
 #include "bin/dartutils.h"
+#include "bin/file.h"
 #include "bin/socket.h"
 #include "bin/thread.h"
 #include "bin/lockers.h"
@@ -423,6 +424,42 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_SendFile)(Dart_NativeArguments args) {
+  static bool short_socket_writes = Dart_IsVMFlagSet("short_socket_write");
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  // The file pointer has been passed into Dart as an intptr_t.
+  File* file = reinterpret_cast<File*>(
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 1)));
+  ASSERT(file != NULL);
+  int64_t offset = DartUtils::GetInt64ValueCheckRange(
+      Dart_GetNativeArgument(args, 2), 0, kMaxInt64);
+  intptr_t length =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  bool short_write = false;
+  if (short_socket_writes) {
+    if (length > 1) short_write = true;
+    length = (length + 1) / 2;
+  }
+  intptr_t bytes_written =
+      Socket::SendFile(socket, file->GetFD(), offset, length);
+  if (bytes_written == Socket::kEndOfFile) {
+    // Signal the end of the file by returning null.
+    Dart_SetReturnValue(args, Dart_Null());
+  } else if (bytes_written >= 0) {
+    if (short_write) {
+      // If the write was forced 'short', indicate by returning the negative
+      // number of bytes. A forced short write may not trigger a write event.
+      Dart_SetReturnValue(args, Dart_NewInteger(-bytes_written));
+    } else {
+      Dart_SetReturnValue(args, Dart_NewInteger(bytes_written));
+    }
+  } else {
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError());
+  }
+}
+
+
 void FUNCTION_NAME(Socket_SendTo)(Dart_NativeArguments args) {
   intptr_t socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
@@ -242,6 +242,16 @@ class Socket {
   static intptr_t Available(intptr_t fd);
   static intptr_t Read(intptr_t fd, void* buffer, intptr_t num_bytes);
   static intptr_t Write(intptr_t fd, const void* buffer, intptr_t num_bytes);
+  // Send num_bytes bytes of the file file_fd starting at offset on the
+  // socket without copying them through user space where the platform
+  // allows it. The file position is not changed. Returns the number of bytes
+  // sent, 0 if the socket is not ready for writing, kEndOfFile if offset is
+  // at or past the end of the file and -1 on error.
+  static const intptr_t kEndOfFile = -2;
+  static intptr_t SendFile(intptr_t fd,
+                           intptr_t file_fd,
+                           int64_t offset,
+                           intptr_t num_bytes);
   // Send data on a socket. The port to send to is specified in the port
   // component of the passed RawAddr structure. The RawAddr structure is only
   // used for datagram sockets.
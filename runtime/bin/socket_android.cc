@@ -9,6 +9,7 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/sendfile.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 #include <netinet/tcp.h>  // NOLINT
@@ -153,6 +154,29 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  ASSERT(fd >= 0);
+  ASSERT(file_fd >= 0);
+  off_t file_offset = offset;
+  ssize_t written_bytes = TEMP_FAILURE_RETRY(
+      sendfile(fd, file_fd, &file_offset, num_bytes));
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (written_bytes == -1 && errno == EWOULDBLOCK) {
+    // If the would block we need to retry and therefore return 0 as
+    // the number of bytes written.
+    written_bytes = 0;
+  } else if (written_bytes == 0) {
+    // sendfile only sends nothing when there is nothing left to read.
+    ASSERT(num_bytes > 0);
+    written_bytes = kEndOfFile;
+  }
+  return written_bytes;
+}
+
+
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
   ASSERT(fd >= 0);
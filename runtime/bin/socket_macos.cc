@@ -9,7 +9,9 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/socket.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
+#include <sys/uio.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 #include <net/if.h>  // NOLINT
 #include <netinet/tcp.h>  // NOLINT
@@ -155,6 +157,30 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  ASSERT(fd >= 0);
+  ASSERT(file_fd >= 0);
+  // On return length holds the number of bytes sent, also when sendfile
+  // fails with EAGAIN after a partial write.
+  off_t length = num_bytes;
+  int result = TEMP_FAILURE_RETRY(
+      sendfile(file_fd, fd, offset, &length, NULL, 0));
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (result == -1 && errno != EWOULDBLOCK) {
+    return -1;
+  }
+  if ((result == 0) && (length == 0)) {
+    // Nothing was sent although the socket did not block.
+    ASSERT(num_bytes > 0);
+    return kEndOfFile;
+  }
+  return length;
+}
+
+
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
   ASSERT(fd >= 0);
@@ -643,6 +643,32 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     return result;
   }
 
+  int sendFile(int fileId, int offset, int bytes) {
+    if (offset is! int || bytes is! int) {
+      throw new ArgumentError("Invalid arguments to sendFile on Socket");
+    }
+    if (offset < 0) throw new RangeError.value(offset);
+    if (bytes < 0) throw new RangeError.value(bytes);
+    if (isClosing || isClosed) return 0;
+    if (bytes == 0) return 0;
+    var result = nativeSendFile(fileId, offset, bytes);
+    if (result is OSError) {
+      scheduleMicrotask(() => reportError(result, "Send file failed"));
+      result = 0;
+    }
+    // A null result indicates that offset is at the end of the file.
+    if (result == null) return null;
+    // As for write, a negative result indicates a forced short write.
+    if (result >= 0 && result < bytes) {
+      writeAvailable = false;
+    }
+    if (result < 0) result = -result;
+    totalWritten += result;
+    writeCount++;
+    lastWrite = timestamp;
+    return result;
+  }
+
   int send(List<int> buffer, int offset, int bytes,
            InternetAddress address, int port) {
     if (isClosing || isClosed) return 0;
@@ -1141,6 +1167,8 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   nativeRecvFrom() native "Socket_RecvFrom";
   nativeWrite(List<int> buffer, int offset, int bytes)
       native "Socket_WriteList";
+  nativeSendFile(int fileId, int offset, int bytes)
+      native "Socket_SendFile";
   nativeSendTo(List<int> buffer, int offset, int bytes,
                List<int> address, int port)
       native "Socket_SendTo";
@@ -1410,6 +1438,18 @@ class _RawSocket extends Stream<RawSocketEvent>
   int write(List<int> buffer, [int offset, int count]) =>
       _socket.write(buffer, offset, count);
 
+  int sendFile(RandomAccessFile file, int offset, int count) {
+    if (file is! _RandomAccessFile) throw new ArgumentError(file);
+    if (file.closed) {
+      throw new FileSystemException("File closed", file.path);
+    }
+    int result = _socket.sendFile(file._id, offset, count);
+    if (result == null) {
+      throw new FileSystemException("End of file reached", file.path);
+    }
+    return result;
+  }
+
   Future close() => _socket.close().then((_) => this);
 
   void shutdown(SocketDirection direction) => _socket.shutdown(direction);
@@ -1542,11 +1582,26 @@ patch class Socket {
 }
 
 
+// A region of a file to be sent on a socket by _Socket.sendFile. It is
+// passed through the IOSink like a buffer so that it is sent in order with
+// the data added before it.
+class _FileRegion {
+  final _RandomAccessFile file;
+  int offset;
+  int remaining;
+  int sent = 0;
+  final Function onProgress;
+
+  _FileRegion(this.file, this.offset, this.remaining, this.onProgress);
+}
+
+
 class _SocketStreamConsumer extends StreamConsumer<List<int>> {
   StreamSubscription subscription;
   final _Socket socket;
   int offset;
   List<int> buffer;
+  _FileRegion region;
   bool paused = false;
   Completer streamCompleter;
 
@@ -1560,8 +1615,13 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
           (data) {
             assert(!paused);
             assert(buffer == null);
-            buffer = data;
-            offset = 0;
+            assert(region == null);
+            if (data is _FileRegion) {
+              region = data;
+            } else {
+              buffer = data;
+              offset = 0;
+            }
             try {
               write();
             } catch (e) {
@@ -1589,21 +1649,62 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
 
   void write() {
     if (subscription == null) return;
+    if (region != null) {
+      sendRegion();
+      return;
+    }
     assert(buffer != null);
     // Write as much as possible.
     offset += socket._write(buffer, offset, buffer.length - offset);
     if (offset < buffer.length) {
-      if (!paused) {
-        paused = true;
-        subscription.pause();
-      }
-      socket._enableWriteEvent();
+      waitForWrite();
     } else {
       buffer = null;
-      if (paused) {
-        paused = false;
-        subscription.resume();
+      resumeWrites();
+    }
+  }
+
+  void sendRegion() {
+    int sent;
+    try {
+      if (region.file.closed) {
+        throw new FileSystemException("File closed", region.file.path);
       }
+      // Send as much as possible. Running out of file before the region is
+      // sent throws, so a write event always makes progress.
+      sent = socket._sendFile(region.file, region.offset, region.remaining);
+    } catch (e, s) {
+      // Called from write events as well, so the error is reported here.
+      socket.destroy();
+      done(e, s);
+      return;
+    }
+    if (sent > 0) {
+      region.offset += sent;
+      region.remaining -= sent;
+      region.sent += sent;
+      if (region.onProgress != null) region.onProgress(region.sent);
+    }
+    if (region.remaining > 0) {
+      waitForWrite();
+    } else {
+      region = null;
+      resumeWrites();
+    }
+  }
+
+  void waitForWrite() {
+    if (!paused) {
+      paused = true;
+      subscription.pause();
+    }
+    socket._enableWriteEvent();
+  }
+
+  void resumeWrites() {
+    if (paused) {
+      paused = false;
+      subscription.resume();
     }
   }
 
@@ -1622,6 +1723,7 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     if (subscription == null) return;
     subscription.cancel();
     subscription = null;
+    region = null;
     paused = false;
     socket._disableWriteEvent();
   }
@@ -1695,6 +1797,35 @@ class _Socket extends Stream<List<int>> implements Socket {
     return _sink.addStream(stream);
   }
 
+  Future<int> sendFile(RandomAccessFile file,
+                       {int offset: 0, int length, void onProgress(int sent)}) {
+    if (file is! _RandomAccessFile) throw new ArgumentError(file);
+    if (offset is! int || offset < 0) throw new ArgumentError(offset);
+    if (length == null) length = file.lengthSync() - offset;
+    if (length is! int || length < 0) throw new ArgumentError(length);
+    if (_raw is! _RawSocket) {
+      // The file cannot be sent directly, e.g. because the data must be
+      // encrypted. Stream it through the normal write path instead.
+      int sent = 0;
+      var stream = new File(file.path).openRead(offset, offset + length)
+          .map((data) {
+            sent += data.length;
+            if (onProgress != null) onProgress(sent);
+            return data;
+          });
+      return _sink.addStream(stream).then((_) {
+        if (sent < length) {
+          destroy();
+          throw new FileSystemException("End of file reached", file.path);
+        }
+        return sent;
+      });
+    }
+    var region = new _FileRegion(file, offset, length, onProgress);
+    return _sink.addStream(new Stream.fromIterable([region]))
+        .then((_) => region.sent);
+  }
+
   Future<Socket> flush() => _sink.flush();
 
   Future<Socket> close() => _sink.close();
@@ -1740,6 +1871,7 @@ class _Socket extends Stream<List<int>> implements Socket {
     _sink.close();
     return _detachReady.future.then((_) {
       assert(_consumer.buffer == null);
+      assert(_consumer.region == null);
       var raw = _raw;
       _raw = null;
       return [raw, _subscription];
@@ -1822,6 +1954,9 @@ class _Socket extends Stream<List<int>> implements Socket {
   int _write(List<int> data, int offset, int length) =>
       _raw.write(data, offset, length);
 
+  int _sendFile(RandomAccessFile file, int offset, int length) =>
+      _raw.sendFile(file, offset, length);
+
   void _enableWriteEvent() {
     _raw.writeEventsEnabled = true;
   }
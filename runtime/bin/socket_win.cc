@@ -5,6 +5,8 @@
 #include "platform/globals.h"
 #if defined(TARGET_OS_WINDOWS)
 
+#include <io.h>  // NOLINT
+
 #include "bin/builtin.h"
 #include "bin/eventhandler.h"
 #include "bin/file.h"
@@ -14,6 +16,7 @@
 #include "bin/thread.h"
 #include "bin/utils.h"
 #include "bin/utils_win.h"
+#include "platform/utils.h"
 
 
 namespace dart {
@@ -92,6 +95,44 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  // Writes on Windows are issued as overlapped operations from a buffer
+  // owned by the handle, so the file is read into a buffer and written
+  // through it. The data still does not pass through the Dart heap.
+  Handle* handle = reinterpret_cast<Handle*>(fd);
+  HANDLE file = reinterpret_cast<HANDLE>(_get_osfhandle(file_fd));
+  const intptr_t kChunkSize = 64 * KB;
+  DWORD to_read =
+      static_cast<DWORD>(Utils::Minimum<intptr_t>(num_bytes, kChunkSize));
+  uint8_t* buffer = new uint8_t[to_read];
+  // A read at an explicit offset still moves the file pointer of a
+  // synchronous handle, so it is restored afterwards.
+  int64_t position = _lseeki64(file_fd, 0, SEEK_CUR);
+  OVERLAPPED overlapped;
+  ZeroMemory(&overlapped, sizeof(overlapped));
+  overlapped.Offset = Utils::Low32Bits(offset);
+  overlapped.OffsetHigh = Utils::High32Bits(offset);
+  DWORD bytes_read = 0;
+  BOOL ok = ReadFile(file, buffer, to_read, &bytes_read, &overlapped);
+  DWORD error = GetLastError();
+  _lseeki64(file_fd, position, SEEK_SET);
+  intptr_t written_bytes;
+  if (!ok && (error != ERROR_HANDLE_EOF)) {
+    SetLastError(error);
+    written_bytes = -1;
+  } else if (bytes_read == 0) {
+    written_bytes = kEndOfFile;
+  } else {
+    written_bytes = handle->Write(buffer, bytes_read);
+  }
+  delete[] buffer;
+  return written_bytes;
+}
+
+
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
   Handle* handle = reinterpret_cast<Handle*>(fd);
@@ -0,0 +1,144 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+part of vmservice_io;
+
+class _MetricFamily {
+  final String name;
+  final String help;
+  // Monotonic metrics are counters, all others are gauges.
+  final bool isCounter;
+  final List<String> samples = new List<String>();
+
+  _MetricFamily(this.name, this.help, this.isCounter);
+
+  void write(StringBuffer buffer) {
+    if (help != null) {
+      buffer.writeln('# HELP $name ${_escapeHelp(help)}');
+    }
+    buffer.writeln('# TYPE $name ${isCounter ? 'counter' : 'gauge'}');
+    samples.forEach(buffer.writeln);
+  }
+
+  static String _escapeHelp(String help) {
+    return help.replaceAll('\\', r'\\').replaceAll('\n', r'\n');
+  }
+}
+
+/// Answers a request for /metrics with the native metrics of the VM and of
+/// all running isolates in the Prometheus text exposition format.
+class MetricsClient extends Client {
+  static ContentType textContentType =
+      new ContentType("text", "plain", charset: "utf-8",
+                      parameters: {"version": "0.0.4"});
+  static const Map<String, String> _unitSuffixes = const {
+    'byte': '_bytes',
+    'microsecond': '_microseconds',
+    'bytePerSecond': '_bytes_per_second',
+    'percent': '_percent',
+  };
+  // The native metrics that count events or accumulate their duration and
+  // so only ever grow. vm.isolate.count is the current number of isolates.
+  static const List<String> _counters = const [
+    'heap.gc.marksweep.count',
+    'heap.gc.marksweep.time',
+    'heap.gc.scavenge.count',
+    'heap.gc.scavenge.time',
+    'isolate.compile.count',
+    'isolate.compile.time',
+    'isolate.deopt.count',
+  ];
+  final HttpRequest request;
+  final Map<String, _MetricFamily> _families = new Map<String, _MetricFamily>();
+
+  MetricsClient(this.request, VMService service)
+      : super(service, sendEvents:false);
+
+  Future collect() {
+    return _collect().catchError((e) {
+      request.response.statusCode = HttpStatus.INTERNAL_SERVER_ERROR;
+      post('Could not collect metrics: $e\n');
+    });
+  }
+
+  Future _collect() async {
+    var vmResponse = JSON.decode(
+        await new Message.fromUri(this, Uri.parse('_getVMMetricList'))
+            .sendToVM());
+    _addMetricList(vmResponse['result'], '');
+
+    // Snapshot of running isolates.
+    var isolates = service.runningIsolates.isolates.values.toList();
+    for (var isolate in isolates) {
+      var message = new Message.forIsolate(
+          this, Uri.parse('_getIsolateMetricList?type=Native'), isolate);
+      var response = JSON.decode(await isolate.route(message));
+      var labels = '{isolate="${_escapeLabel(isolate.name)}",'
+                   'isolate_id="${isolate.serviceId}"}';
+      _addMetricList(response['result'], labels);
+    }
+
+    var latency = _eventHandlerLatency();
+    _addSample('dart_eventhandler_timer_wakeups',
+               'Timer wakeups handled by the event handler.',
+               '', latency[0], isCounter: true);
+    _addSample('dart_eventhandler_timer_latency_milliseconds_sum',
+               'Total delay of timer wakeups in the event handler.',
+               '', latency[1], isCounter: true);
+    _addSample('dart_eventhandler_timer_latency_milliseconds_max',
+               'Longest delay of a timer wakeup in the event handler.',
+               '', latency[2]);
+
+    var buffer = new StringBuffer();
+    _families.values.forEach((family) => family.write(buffer));
+    post(buffer.toString());
+  }
+
+  void _addMetricList(Map result, String labels) {
+    if ((result == null) || (result['type'] != 'MetricList')) {
+      // The isolate went away or could not answer.
+      return;
+    }
+    for (var metric in result['metrics']) {
+      String metricName = metric['name'];
+      var name = 'dart_' + metricName.replaceAll('.', '_');
+      var suffix = _unitSuffixes[metric['unit']];
+      if (suffix != null) {
+        name += suffix;
+      }
+      _addSample(name, metric['description'], labels, metric['value'],
+                 isCounter: _counters.contains(metricName));
+    }
+  }
+
+  void _addSample(String name, String help, String labels, num value,
+                  {bool isCounter: false}) {
+    var family = _families.putIfAbsent(
+        name, () => new _MetricFamily(name, help, isCounter));
+    var text = (value == value.truncate()) ? '${value.truncate()}' : '$value';
+    family.samples.add('$name$labels $text');
+  }
+
+  static String _escapeLabel(String value) {
+    return value.replaceAll('\\', r'\\')
+                .replaceAll('"', r'\"')
+                .replaceAll('\n', r'\n');
+  }
+
+  void post(String result) {
+    request.response..headers.contentType = textContentType
+                    ..write(result)
+                    ..close();
+    close();
+  }
+
+  dynamic toJson() {
+    Map map = super.toJson();
+    map['type'] = 'MetricsClient';
+    map['request'] = '$request';
+    return map;
+  }
+}
+
+List<int> _eventHandlerLatency() native "VMServiceIO_EventHandlerLatency";
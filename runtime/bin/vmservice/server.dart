@@ -81,6 +81,7 @@ class HttpRequestClient extends Client {
 
 class Server {
   static const WEBSOCKET_PATH = '/ws';
+  static const METRICS_PATH = '/metrics';
   static const ROOT_REDIRECT_PATH = '/index.html';
 
   final VMService _service;
@@ -117,6 +118,11 @@ class Server {
       return;
     }
 
+    if (_metricsEndpoint && (path == METRICS_PATH)) {
+      new MetricsClient(request, _service).collect();
+      return;
+    }
+
     var resource = Resource.resources[path];
     if (resource != null) {
       // Serving up a static resource (e.g. .css, .html, .png).
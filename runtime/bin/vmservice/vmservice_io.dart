@@ -11,6 +11,7 @@ import 'dart:isolate';
 import 'dart:vmservice';
 
 part 'loader.dart';
+part 'metrics.dart';
 part 'resources.dart';
 part 'server.dart';
 
@@ -19,6 +20,8 @@ int _port;
 String _ip;
 // Should the HTTP server auto start?
 bool _autoStart;
+// Should the HTTP server serve metrics at /metrics?
+bool _metricsEndpoint = false;
 
 bool _isWindows = false;
 
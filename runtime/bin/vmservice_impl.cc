@@ -8,6 +8,7 @@
 
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
+#include "bin/eventhandler.h"
 #include "bin/isolate_data.h"
 #include "bin/platform.h"
 #include "bin/thread.h"
@@ -121,6 +122,17 @@ void NotifyServerState(Dart_NativeArguments args) {
   Dart_ExitScope();
 }
 
+
+void GetEventHandlerLatency(Dart_NativeArguments args) {
+  Dart_Handle result = Dart_NewList(3);
+  Dart_ListSetAt(result, 0, Dart_NewInteger(TimeoutQueue::wakeups()));
+  Dart_ListSetAt(result, 1,
+                 Dart_NewInteger(TimeoutQueue::total_wakeup_latency()));
+  Dart_ListSetAt(result, 2,
+                 Dart_NewInteger(TimeoutQueue::max_wakeup_latency()));
+  Dart_SetReturnValue(args, result);
+}
+
 struct VmServiceIONativeEntry {
   const char* name;
   int num_arguments;
@@ -131,6 +143,7 @@ struct VmServiceIONativeEntry {
 static VmServiceIONativeEntry _VmServiceIONativeEntries[] = {
   {"VMServiceIO_TriggerResourceLoad", 0, TriggerResourceLoad},
   {"VMServiceIO_NotifyServerState", 2, NotifyServerState},
+  {"VMServiceIO_EventHandlerLatency", 0, GetEventHandlerLatency},
 };
 
 
@@ -158,6 +171,7 @@ static Dart_NativeFunction VmServiceIONativeResolver(Dart_Handle name,
 const char* VmService::error_msg_ = NULL;
 char VmService::server_ip_[kServerIpStringBufferSize];
 intptr_t VmService::server_port_ = 0;
+bool VmService::metrics_endpoint_ = false;
 
 bool VmService::Setup(const char* server_ip, intptr_t server_port) {
   Dart_Isolate isolate = Dart_CurrentIsolate();
@@ -216,6 +230,10 @@ bool VmService::Setup(const char* server_ip, intptr_t server_port) {
                          DartUtils::NewString("_autoStart"),
                          Dart_NewBoolean(auto_start));
   SHUTDOWN_ON_ERROR(result);
+  result = Dart_SetField(library,
+                         DartUtils::NewString("_metricsEndpoint"),
+                         Dart_NewBoolean(metrics_endpoint_));
+  SHUTDOWN_ON_ERROR(result);
 
   // Are we running on Windows?
 #if defined(TARGET_OS_WINDOWS)
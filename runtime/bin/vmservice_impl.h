@@ -16,6 +16,12 @@ class VmService {
  public:
   static bool Setup(const char* server_ip, intptr_t server_port);
 
+  // Serve metrics in the Prometheus text format at /metrics. Must be called
+  // before Setup.
+  static void set_metrics_endpoint(bool enabled) {
+    metrics_endpoint_ = enabled;
+  }
+
   // Error message if startup failed.
   static const char* GetErrorMessage();
 
@@ -46,6 +52,7 @@ class VmService {
   static const char* error_msg_;
   static char server_ip_[kServerIpStringBufferSize];
   static intptr_t server_port_;
+  static bool metrics_endpoint_;
 
   DISALLOW_ALLOCATION();
   DISALLOW_IMPLICIT_CONSTRUCTORS(VmService);
@@ -0,0 +1,67 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/worker_pool.h"
+
+#include "bin/lockers.h"
+#include "bin/platform.h"
+
+
+namespace dart {
+namespace bin {
+
+Monitor* WorkerPool::monitor_ = new Monitor();
+WorkerJob* WorkerPool::head_ = NULL;
+WorkerJob* WorkerPool::tail_ = NULL;
+intptr_t WorkerPool::threads_ = 0;
+
+
+bool WorkerPool::Start() {
+  MonitorLocker ml(monitor_);
+  if (threads_ == 0) {
+    intptr_t count = Platform::NumberOfProcessors();
+    if (count < 1) count = 1;
+    if (count > kMaxThreads) count = kMaxThreads;
+    for (intptr_t i = 0; i < count; i++) {
+      if (Thread::Start(&Run, 0) != 0) break;
+      threads_++;
+    }
+  }
+  return threads_ > 0;
+}
+
+
+void WorkerPool::Enqueue(WorkerJob* job) {
+  ASSERT(job->next_job_ == NULL);
+  MonitorLocker ml(monitor_);
+  ASSERT(threads_ > 0);
+  if (tail_ == NULL) {
+    head_ = tail_ = job;
+  } else {
+    tail_->next_job_ = job;
+    tail_ = job;
+  }
+  ml.Notify();
+}
+
+
+void WorkerPool::Run(uword unused) {
+  while (true) {
+    WorkerJob* job;
+    {
+      MonitorLocker ml(monitor_);
+      while (head_ == NULL) {
+        ml.Wait();
+      }
+      job = head_;
+      head_ = job->next_job_;
+      if (head_ == NULL) tail_ = NULL;
+      job->next_job_ = NULL;
+    }
+    job->Run();
+  }
+}
+
+}  // namespace bin
+}  // namespace dart
@@ -0,0 +1,65 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef BIN_WORKER_POOL_H_
+#define BIN_WORKER_POOL_H_
+
+#include "bin/builtin.h"
+#include "bin/thread.h"
+
+
+namespace dart {
+namespace bin {
+
+// A unit of work for the WorkerPool.
+class WorkerJob {
+ public:
+  WorkerJob() : next_job_(NULL) {}
+  virtual ~WorkerJob() {}
+
+  // Called on a worker thread. The pool does not touch the job afterwards,
+  // so Run may delete it.
+  virtual void Run() = 0;
+
+ private:
+  friend class WorkerPool;
+
+  WorkerJob* next_job_;
+
+  DISALLOW_COPY_AND_ASSIGN(WorkerJob);
+};
+
+
+// The threads that the io natives use to work in the background, such as
+// compressing blocks for parallel gzip and reading directories for
+// Directory.walk. They are started on first use and stay around for the
+// lifetime of the process. Jobs are run in the order they are queued.
+class WorkerPool {
+ public:
+  // Starts the workers unless they are running. Returns false if no worker
+  // thread could be started, in which case the caller has to do the work
+  // some other way.
+  static bool Start();
+
+  // Queues a job. Start must have returned true.
+  static void Enqueue(WorkerJob* job);
+
+ private:
+  static const intptr_t kMaxThreads = 8;
+
+  static void Run(uword unused);
+
+  static Monitor* monitor_;
+  static WorkerJob* head_;
+  static WorkerJob* tail_;
+  static intptr_t threads_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(WorkerPool);
+};
+
+}  // namespace bin
+}  // namespace dart
+
+#endif  // BIN_WORKER_POOL_H_
@@ -0,0 +1,1107 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/bootstrap_natives.h"
+
+#include "vm/double_conversion.h"
+#include "vm/growable_array.h"
+#include "vm/native_entry.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/symbols.h"
+#include "vm/unicode.h"
+
+namespace dart {
+
+static intptr_t HashCodeUnits(const uint8_t* units, intptr_t length) {
+  return String::HashLatin1(units, length);
+}
+
+
+static intptr_t HashCodeUnits(const uint16_t* units, intptr_t length) {
+  return String::Hash(units, length);
+}
+
+
+static RawString* NewString(const uint8_t* units,
+                            intptr_t length,
+                            Heap::Space space) {
+  return OneByteString::New(units, length, space);
+}
+
+
+static RawString* NewString(const uint16_t* units,
+                            intptr_t length,
+                            Heap::Space space) {
+  return String::FromUTF16(units, length, space);
+}
+
+
+// Builds the objects for a JSON text in one pass over its code units, which
+// are UTF-8 bytes, Latin-1 characters or UTF-16 code units. Lists and maps
+// are created as _GrowableList and _InternalLinkedHashMap, the same as the
+// Dart parser creates them, and equal keys and short string values share a
+// single String instance for the whole parse.
+//
+// The builder does not report errors. It gives up on any input it does not
+// accept, and the caller leaves that input to the Dart parser, which throws
+// the FormatException (or replaces malformed UTF-8 if that was asked for).
+//
+// The code units must not move while parsing, so input in the Dart heap is
+// copied out first.
+template<typename CharType, bool kIsUtf8>
+class JsonBuilder : public ValueObject {
+ public:
+  JsonBuilder(Zone* zone,
+              const CharType* chars,
+              intptr_t length,
+              Heap::Space space)
+      : zone_(zone),
+        chars_(chars),
+        length_(length),
+        position_(0),
+        space_(space),
+        values_(GrowableObjectArray::Handle(zone,
+                                            GrowableObjectArray::New(space))),
+        strings_(GrowableObjectArray::Handle(zone,
+                                             GrowableObjectArray::New(space))),
+        string_(String::Handle(zone)),
+        value_(Object::Handle(zone)),
+        frames_(zone, 16),
+        key_ids_(zone, 16),
+        scratch_(zone, 64),
+        cache_table_(zone, 0),
+        cache_units_(zone, 256),
+        cache_hashes_(zone, 16),
+        cache_starts_(zone, 16),
+        cache_lengths_(zone, 16),
+        seen_marks_(zone, 16),
+        seen_positions_(zone, 16),
+        mark_(0) {
+    ResizeCache(kInitialCacheSize);
+  }
+
+  // Returns false if the input was not accepted.
+  bool Build(Object* result);
+
+ private:
+  struct Frame {
+    intptr_t values_start;
+    intptr_t keys_start;
+    bool is_object;
+  };
+
+  enum ValueKind {
+    kRejected,
+    kValue,
+    kOpenedContainer,
+  };
+
+  // Strings longer than this are only shared when they are keys.
+  static const intptr_t kMaxSharedValueLength = 16;
+  static const intptr_t kInitialCacheSize = 64;
+
+  intptr_t Peek() const {
+    return (position_ < length_) ? chars_[position_] : -1;
+  }
+
+  void SkipWhitespace() {
+    while (position_ < length_) {
+      const CharType c = chars_[position_];
+      if ((c != ' ') && (c != '\n') && (c != '\r') && (c != '\t')) {
+        return;
+      }
+      position_++;
+    }
+  }
+
+  bool Expect(const char* literal) {
+    for (intptr_t i = 0; literal[i] != '\0'; i++, position_++) {
+      if ((position_ == length_) || (chars_[position_] != literal[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ValueKind ParseValue();
+  bool ParseKey();
+  bool ParseString(bool is_key, intptr_t* id);
+  bool ParseNumber();
+  bool DecodeEscapedString(intptr_t start);
+  void CloseList();
+  void CloseMap();
+
+  template<typename UnitType>
+  intptr_t Share(const UnitType* units, intptr_t length);
+  void ResizeCache(intptr_t size);
+
+  Zone* zone_;
+  const CharType* chars_;
+  const intptr_t length_;
+  intptr_t position_;
+  const Heap::Space space_;
+
+  // The values of all open containers, and the keys of open maps.
+  GrowableObjectArray& values_;
+  // The shared strings, indexed by id.
+  GrowableObjectArray& strings_;
+  String& string_;
+  Object& value_;
+
+  GrowableArray<Frame> frames_;
+  // The ids of the keys of all open maps.
+  GrowableArray<intptr_t> key_ids_;
+  // Code units of a string with escapes or non-ASCII UTF-8.
+  GrowableArray<uint16_t> scratch_;
+
+  // Open addressed table from code units to 'id + 1' of a shared string.
+  GrowableArray<intptr_t> cache_table_;
+  GrowableArray<uint16_t> cache_units_;
+  GrowableArray<intptr_t> cache_hashes_;
+  GrowableArray<intptr_t> cache_starts_;
+  GrowableArray<intptr_t> cache_lengths_;
+
+  // Used to find duplicate keys when a map is closed.
+  GrowableArray<intptr_t> seen_marks_;
+  GrowableArray<intptr_t> seen_positions_;
+  intptr_t mark_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonBuilder);
+};
+
+
+template<typename CharType, bool kIsUtf8>
+bool JsonBuilder<CharType, kIsUtf8>::Build(Object* result) {
+  while (true) {
+    const ValueKind kind = ParseValue();
+    if (kind == kRejected) {
+      return false;
+    }
+    if (kind == kOpenedContainer) {
+      continue;
+    }
+    // Close containers until one expects another element.
+    while (true) {
+      SkipWhitespace();
+      if (frames_.is_empty()) {
+        if (position_ != length_) {
+          return false;
+        }
+        ASSERT(values_.Length() == 1);
+        *result = values_.At(0);
+        return true;
+      }
+      const bool is_object = frames_.Last().is_object;
+      const intptr_t c = Peek();
+      if (c == ',') {
+        position_++;
+        if (is_object && !ParseKey()) {
+          return false;
+        }
+        break;
+      }
+      if (c == (is_object ? '}' : ']')) {
+        position_++;
+        if (is_object) {
+          CloseMap();
+        } else {
+          CloseList();
+        }
+        continue;
+      }
+      return false;
+    }
+  }
+}
+
+
+template<typename CharType, bool kIsUtf8>
+typename JsonBuilder<CharType, kIsUtf8>::ValueKind
+JsonBuilder<CharType, kIsUtf8>::ParseValue() {
+  SkipWhitespace();
+  switch (Peek()) {
+    case '"': {
+      intptr_t id;
+      return ParseString(false, &id) ? kValue : kRejected;
+    }
+    case '{': {
+      position_++;
+      SkipWhitespace();
+      if (Peek() == '}') {
+        position_++;
+        value_ = LinkedHashMap::NewDefault(space_);
+        values_.Add(value_, space_);
+        return kValue;
+      }
+      Frame frame = { values_.Length(), key_ids_.length(), true };
+      frames_.Add(frame);
+      return ParseKey() ? kOpenedContainer : kRejected;
+    }
+    case '[': {
+      position_++;
+      SkipWhitespace();
+      if (Peek() == ']') {
+        position_++;
+        value_ = GrowableObjectArray::New(space_);
+        values_.Add(value_, space_);
+        return kValue;
+      }
+      Frame frame = { values_.Length(), key_ids_.length(), false };
+      frames_.Add(frame);
+      return kOpenedContainer;
+    }
+    case 't':
+      if (!Expect("true")) return kRejected;
+      values_.Add(Bool::True(), space_);
+      return kValue;
+    case 'f':
+      if (!Expect("false")) return kRejected;
+      values_.Add(Bool::False(), space_);
+      return kValue;
+    case 'n':
+      if (!Expect("null")) return kRejected;
+      values_.Add(Object::null_object(), space_);
+      return kValue;
+    default:
+      return ParseNumber() ? kValue : kRejected;
+  }
+}
+
+
+template<typename CharType, bool kIsUtf8>
+bool JsonBuilder<CharType, kIsUtf8>::ParseKey() {
+  SkipWhitespace();
+  if (Peek() != '"') {
+    return false;
+  }
+  intptr_t id;
+  if (!ParseString(true, &id)) {
+    return false;
+  }
+  key_ids_.Add(id);
+  SkipWhitespace();
+  if (Peek() != ':') {
+    return false;
+  }
+  position_++;
+  return true;
+}
+
+
+// Parses the string starting at the current quote and pushes it. Keys
+// always come from the cache, so that equal keys have equal ids.
+template<typename CharType, bool kIsUtf8>
+bool JsonBuilder<CharType, kIsUtf8>::ParseString(bool is_key, intptr_t* id) {
+  ASSERT(chars_[position_] == '"');
+  const intptr_t start = ++position_;
+  while (true) {
+    if (position_ == length_) {
+      return false;
+    }
+    const CharType c = chars_[position_];
+    if (c == '"') {
+      break;
+    }
+    if ((c == '\\') || (c < 0x20) || (c >= 0x80)) {
+      // Strings with escapes or non-ASCII characters are decoded into the
+      // scratch buffer.
+      if (!DecodeEscapedString(start)) {
+        return false;
+      }
+      const intptr_t length = scratch_.length();
+      if (is_key || (length <= kMaxSharedValueLength)) {
+        *id = Share(scratch_.data(), length);
+        value_ = strings_.At(*id);
+        values_.Add(value_, space_);
+      } else {
+        string_ = String::FromUTF16(scratch_.data(), length, space_);
+        values_.Add(string_, space_);
+      }
+      return true;
+    }
+    position_++;
+  }
+  const intptr_t length = position_ - start;
+  position_++;
+  if (is_key || (length <= kMaxSharedValueLength)) {
+    *id = Share(chars_ + start, length);
+    value_ = strings_.At(*id);
+    values_.Add(value_, space_);
+  } else {
+    string_ = OneByteString::New(chars_ + start, length, space_);
+    values_.Add(string_, space_);
+  }
+  return true;
+}
+
+
+// Decodes the string starting at 'start' into the scratch buffer and moves
+// past its closing quote.
+template<typename CharType, bool kIsUtf8>
+bool JsonBuilder<CharType, kIsUtf8>::DecodeEscapedString(intptr_t start) {
+  scratch_.Clear();
+  position_ = start;
+  while (true) {
+    if (position_ == length_) {
+      return false;
+    }
+    const CharType c = chars_[position_++];
+    if (c == '"') {
+      return true;
+    }
+    if (c < 0x20) {
+      return false;
+    }
+    if (c == '\\') {
+      if (position_ == length_) {
+        return false;
+      }
+      switch (chars_[position_++]) {
+        case '"': scratch_.Add('"'); break;
+        case '\\': scratch_.Add('\\'); break;
+        case '/': scratch_.Add('/'); break;
+        case 'b': scratch_.Add('\b'); break;
+        case 'f': scratch_.Add('\f'); break;
+        case 'n': scratch_.Add('\n'); break;
+        case 'r': scratch_.Add('\r'); break;
+        case 't': scratch_.Add('\t'); break;
+        case 'u': {
+          if (length_ - position_ < 4) {
+            return false;
+          }
+          uint16_t code_unit = 0;
+          for (intptr_t i = 0; i < 4; i++) {
+            const CharType digit = chars_[position_++];
+            code_unit <<= 4;
+            if ((digit >= '0') && (digit <= '9')) {
+              code_unit |= digit - '0';
+            } else if (((digit | 0x20) >= 'a') && ((digit | 0x20) <= 'f')) {
+              code_unit |= (digit | 0x20) - 'a' + 10;
+            } else {
+              return false;
+            }
+          }
+          scratch_.Add(code_unit);
+          break;
+        }
+        default:
+          return false;
+      }
+    } else if (kIsUtf8 && (c >= 0x80)) {
+      int32_t code_point;
+      const intptr_t consumed = Utf8::Decode(
+          reinterpret_cast<const uint8_t*>(chars_ + position_ - 1),
+          length_ - position_ + 1,
+          &code_point);
+      if (code_point < 0) {
+        return false;
+      }
+      position_ += consumed - 1;
+      if (Utf::IsSupplementary(code_point)) {
+        uint16_t pair[2];
+        Utf16::Encode(code_point, pair);
+        scratch_.Add(pair[0]);
+        scratch_.Add(pair[1]);
+      } else {
+        scratch_.Add(code_point);
+      }
+    } else {
+      scratch_.Add(c);
+    }
+  }
+}
+
+
+template<typename CharType, bool kIsUtf8>
+bool JsonBuilder<CharType, kIsUtf8>::ParseNumber() {
+  // '-'?('0'|[1-9][0-9]*)('.'[0-9]+)?([eE][+-]?[0-9]+)?
+  const intptr_t start = position_;
+  if (Peek() == '-') {
+    position_++;
+  }
+  const intptr_t digits_start = position_;
+  intptr_t c = Peek();
+  if (c == '0') {
+    position_++;
+    c = Peek();
+    if ((c >= '0') && (c <= '9')) {
+      return false;
+    }
+  } else if ((c >= '1') && (c <= '9')) {
+    do {
+      position_++;
+      c = Peek();
+    } while ((c >= '0') && (c <= '9'));
+  } else {
+    return false;
+  }
+  const intptr_t digits_end = position_;
+  bool is_double = false;
+  if (c == '.') {
+    is_double = true;
+    position_++;
+    c = Peek();
+    if ((c < '0') || (c > '9')) {
+      return false;
+    }
+    do {
+      position_++;
+      c = Peek();
+    } while ((c >= '0') && (c <= '9'));
+  }
+  if ((c | 0x20) == 'e') {
+    is_double = true;
+    position_++;
+    c = Peek();
+    if ((c == '+') || (c == '-')) {
+      position_++;
+      c = Peek();
+    }
+    if ((c < '0') || (c > '9')) {
+      return false;
+    }
+    do {
+      position_++;
+      c = Peek();
+    } while ((c >= '0') && (c <= '9'));
+  }
+
+  // Up to 18 digits always fit in an int64_t.
+  const intptr_t length = position_ - start;
+  if (!is_double && (digits_end - digits_start <= 18)) {
+    int64_t value = 0;
+    for (intptr_t i = digits_start; i < digits_end; i++) {
+      value = value * 10 + (chars_[i] - '0');
+    }
+    if (digits_start != start) {
+      value = -value;
+    }
+    value_ = Integer::New(value, space_);
+    values_.Add(value_, space_);
+    return true;
+  }
+  char buffer[64];
+  char* literal = (length < static_cast<intptr_t>(sizeof(buffer)))
+      ? buffer
+      : zone_->Alloc<char>(length + 1);
+  for (intptr_t i = 0; i < length; i++) {
+    literal[i] = static_cast<char>(chars_[start + i]);
+  }
+  literal[length] = '\0';
+  if (!is_double) {
+    string_ = String::New(literal, space_);
+    value_ = Integer::New(string_, space_);
+    values_.Add(value_, space_);
+    return true;
+  }
+  // The Dart parser computes small doubles exactly and leaves the others to
+  // the same conversion, so both produce the correctly rounded value.
+  double value;
+  if (!CStringToDouble(literal, length, &value)) {
+    return false;
+  }
+  value_ = Double::New(value, space_);
+  values_.Add(value_, space_);
+  return true;
+}
+
+
+template<typename CharType, bool kIsUtf8>
+void JsonBuilder<CharType, kIsUtf8>::CloseList() {
+  HANDLESCOPE(Thread::Current());
+  const intptr_t start = frames_.RemoveLast().values_start;
+  const intptr_t length = values_.Length() - start;
+  ASSERT(length > 0);
+  const Array& data = Array::Handle(zone_, Array::New(length, space_));
+  Object& value = Object::Handle(zone_);
+  for (intptr_t i = 0; i < length; i++) {
+    value = values_.At(start + i);
+    data.SetAt(i, value);
+  }
+  const GrowableObjectArray& list = GrowableObjectArray::Handle(zone_,
+      GrowableObjectArray::New(data, space_));
+  list.SetLength(length);
+  values_.SetLength(start);
+  values_.Add(list, space_);
+}
+
+
+// A later value for an equal key replaces the earlier one, which keeps its
+// position, as it does when the Dart parser adds the entries one at a time.
+template<typename CharType, bool kIsUtf8>
+void JsonBuilder<CharType, kIsUtf8>::CloseMap() {
+  HANDLESCOPE(Thread::Current());
+  const Frame frame = frames_.RemoveLast();
+  const intptr_t start = frame.values_start;
+  intptr_t length = key_ids_.length() - frame.keys_start;
+  ASSERT(values_.Length() - start == 2 * length);
+  Object& value = Object::Handle(zone_);
+
+  mark_++;
+  bool has_duplicates = false;
+  for (intptr_t i = 0; i < length; i++) {
+    const intptr_t id = key_ids_[frame.keys_start + i];
+    if (seen_marks_[id] == mark_) {
+      has_duplicates = true;
+      break;
+    }
+    seen_marks_[id] = mark_;
+  }
+  if (has_duplicates) {
+    mark_++;
+    intptr_t used = 0;
+    for (intptr_t i = 0; i < length; i++) {
+      const intptr_t id = key_ids_[frame.keys_start + i];
+      value = values_.At(start + 2 * i + 1);
+      if (seen_marks_[id] == mark_) {
+        values_.SetAt(start + 2 * seen_positions_[id] + 1, value);
+        continue;
+      }
+      seen_marks_[id] = mark_;
+      seen_positions_[id] = used;
+      if (used != i) {
+        values_.SetAt(start + 2 * used + 1, value);
+        value = values_.At(start + 2 * i);
+        values_.SetAt(start + 2 * used, value);
+      }
+      used++;
+    }
+    length = used;
+  }
+  key_ids_.TruncateTo(frame.keys_start);
+
+  const LinkedHashMap& map = LinkedHashMap::Handle(zone_,
+      LinkedHashMap::NewUnindexed(length, space_));
+  const Array& data = Array::Handle(zone_, map.data());
+  for (intptr_t i = 0; i < 2 * length; i++) {
+    value = values_.At(start + i);
+    data.SetAt(i, value);
+  }
+  values_.SetLength(start);
+  values_.Add(map, space_);
+}
+
+
+// Returns the id of the shared string with the given code units, creating
+// it if this is its first occurrence.
+template<typename CharType, bool kIsUtf8>
+template<typename UnitType>
+intptr_t JsonBuilder<CharType, kIsUtf8>::Share(const UnitType* units,
+                                               intptr_t length) {
+  const intptr_t hash = HashCodeUnits(units, length);
+  const intptr_t mask = cache_table_.length() - 1;
+  intptr_t slot = hash & mask;
+  while (cache_table_[slot] != 0) {
+    const intptr_t id = cache_table_[slot] - 1;
+    if ((cache_hashes_[id] == hash) && (cache_lengths_[id] == length)) {
+      const uint16_t* cached = cache_units_.data() + cache_starts_[id];
+      intptr_t i = 0;
+      while ((i < length) && (cached[i] == units[i])) {
+        i++;
+      }
+      if (i == length) {
+        return id;
+      }
+    }
+    slot = (slot + 1) & mask;
+  }
+
+  const intptr_t id = strings_.Length();
+  string_ = NewString(units, length, space_);
+  strings_.Add(string_, space_);
+  cache_hashes_.Add(hash);
+  cache_starts_.Add(cache_units_.length());
+  cache_lengths_.Add(length);
+  for (intptr_t i = 0; i < length; i++) {
+    cache_units_.Add(units[i]);
+  }
+  seen_marks_.Add(0);
+  seen_positions_.Add(0);
+  cache_table_[slot] = id + 1;
+  if (2 * strings_.Length() > cache_table_.length()) {
+    ResizeCache(2 * cache_table_.length());
+  }
+  return id;
+}
+
+
+template<typename CharType, bool kIsUtf8>
+void JsonBuilder<CharType, kIsUtf8>::ResizeCache(intptr_t size) {
+  ASSERT(Utils::IsPowerOfTwo(size));
+  cache_table_.SetLength(size);
+  for (intptr_t i = 0; i < size; i++) {
+    cache_table_[i] = 0;
+  }
+  const intptr_t mask = size - 1;
+  for (intptr_t id = 0; id < cache_hashes_.length(); id++) {
+    intptr_t slot = cache_hashes_[id] & mask;
+    while (cache_table_[slot] != 0) {
+      slot = (slot + 1) & mask;
+    }
+    cache_table_[slot] = id + 1;
+  }
+}
+
+
+template<typename CharType, bool kIsUtf8>
+static bool BuildJson(Zone* zone,
+                      const CharType* chars,
+                      intptr_t length,
+                      Object* result) {
+  Heap::Space space =
+      Isolate::Current()->heap()->SpaceForAllocation(kArrayCid);
+  JsonBuilder<CharType, kIsUtf8> builder(zone, chars, length, space);
+  return builder.Build(result);
+}
+
+
+// Parses the JSON text from 'start' to 'end' in a String or a Uint8List of
+// UTF-8. Returns 'failure' if the text is not accepted, in which case the
+// caller parses it again in Dart.
+DEFINE_NATIVE_ENTRY(JsonDecoder_parse, 4) {
+  const Instance& source = Instance::CheckedHandle(arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, end_obj, arguments->NativeArgAt(2));
+  const Instance& failure = Instance::CheckedHandle(arguments->NativeArgAt(3));
+  intptr_t start = start_obj.Value();
+  const intptr_t length = end_obj.Value() - start;
+  ASSERT((start >= 0) && (length >= 0));
+
+  Object& result = Object::Handle(zone);
+  bool accepted;
+  if (source.IsString()) {
+    const String& str = String::Cast(source);
+    ASSERT(start + length <= str.Length());
+    if (str.CharSize() == String::kOneByteChar) {
+      uint8_t* chars = zone->Alloc<uint8_t>(length);
+      String::CopyCodeUnits(str, start, length, chars);
+      accepted = BuildJson<uint8_t, false>(zone, chars, length, &result);
+    } else {
+      uint16_t* chars = zone->Alloc<uint16_t>(length);
+      String::CopyCodeUnits(str, start, length, chars);
+      accepted = BuildJson<uint16_t, false>(zone, chars, length, &result);
+    }
+  } else {
+    Instance& data = Instance::Handle(zone, source.raw());
+    if (RawObject::IsTypedDataViewClassId(source.GetClassId())) {
+      data = TypedDataView::Data(source);
+      start += Smi::Value(TypedDataView::OffsetInBytes(source));
+    }
+    const uint8_t* chars;
+    if (data.IsExternalTypedData()) {
+      // External data does not move.
+      chars = reinterpret_cast<const uint8_t*>(
+          ExternalTypedData::Cast(data).DataAddr(start));
+    } else {
+      uint8_t* copy = zone->Alloc<uint8_t>(length);
+      NoSafepointScope no_safepoint;
+      memmove(copy, TypedData::Cast(data).DataAddr(start), length);
+      chars = copy;
+    }
+    accepted = BuildJson<uint8_t, true>(zone, chars, length, &result);
+  }
+  return accepted ? result.raw() : failure.raw();
+}
+
+
+// Writes the JSON text for lists, maps, strings, numbers, booleans and null
+// as UTF-8, exactly as the Dart encoder in dart:convert writes it. Anything
+// else, including cycles, keys that are not strings, non-finite doubles and
+// nesting deeper than kMaxDepth, makes the writer give up, so that the Dart
+// encoder can write the object and call toJson() or report the error.
+//
+// No Dart code runs while writing, so the objects cannot change underneath
+// the writer. Objects are only held in handles, so the writer does not stop
+// the GC from moving them.
+class JsonUtf8Writer : public ValueObject {
+ public:
+  JsonUtf8Writer(Zone* zone,
+                 const uint8_t* indent,
+                 intptr_t indent_length)
+      : zone_(zone),
+        indent_(indent),
+        indent_length_(indent_length),
+        data_(NULL),
+        length_(0),
+        capacity_(0),
+        seen_(zone, 16),
+        latin1_(zone, 0),
+        utf16_(zone, 0) {}
+
+  ~JsonUtf8Writer() {
+    free(data_);
+  }
+
+  bool WriteValue(const Object& value) {
+    return WriteValue(value, 0);
+  }
+
+  intptr_t length() const { return length_; }
+  const uint8_t* data() const { return data_; }
+
+  // Returns the written bytes, which the caller must free.
+  uint8_t* Steal() {
+    uint8_t* data = data_;
+    data_ = NULL;
+    length_ = 0;
+    capacity_ = 0;
+    return data;
+  }
+
+ private:
+  static const intptr_t kMaxDepth = 512;
+  static const intptr_t kInitialCapacity = 1024;
+
+  bool Reserve(intptr_t count) {
+    if (length_ + count <= capacity_) {
+      return true;
+    }
+    intptr_t capacity = Utils::Maximum(kInitialCapacity, 2 * capacity_);
+    while (capacity < length_ + count) {
+      capacity *= 2;
+    }
+    uint8_t* data = reinterpret_cast<uint8_t*>(realloc(data_, capacity));
+    if (data == NULL) {
+      return false;
+    }
+    data_ = data;
+    capacity_ = capacity;
+    return true;
+  }
+
+  bool WriteBytes(const char* bytes, intptr_t count) {
+    if (!Reserve(count)) {
+      return false;
+    }
+    memmove(data_ + length_, bytes, count);
+    length_ += count;
+    return true;
+  }
+
+  bool WriteCString(const char* string) {
+    return WriteBytes(string, strlen(string));
+  }
+
+  bool WriteNewlineAndIndent(intptr_t level) {
+    if (!Reserve(1 + level * indent_length_)) {
+      return false;
+    }
+    data_[length_++] = '\n';
+    for (intptr_t i = 0; i < level; i++) {
+      memmove(data_ + length_, indent_, indent_length_);
+      length_ += indent_length_;
+    }
+    return true;
+  }
+
+  bool WriteString(const String& str);
+  template<typename CharType>
+  void WriteStringContent(const CharType* chars, intptr_t length);
+  bool WriteList(const Object& list, intptr_t level);
+  bool WriteMap(const LinkedHashMap& map, intptr_t level);
+  bool WriteValue(const Object& value, intptr_t level);
+
+  Zone* zone_;
+  const uint8_t* indent_;
+  const intptr_t indent_length_;
+  uint8_t* data_;
+  intptr_t length_;
+  intptr_t capacity_;
+  // The lists and maps being written.
+  GrowableArray<const Object*> seen_;
+  // The code units of the string being written.
+  GrowableArray<uint8_t> latin1_;
+  GrowableArray<uint16_t> utf16_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonUtf8Writer);
+};
+
+
+bool JsonUtf8Writer::WriteValue(const Object& value, intptr_t level) {
+  if (value.IsNull()) {
+    return WriteBytes("null", 4);
+  }
+  char buffer[128];
+  switch (value.GetClassId()) {
+    case kBoolCid:
+      return Bool::Cast(value).value() ? WriteBytes("true", 4)
+                                       : WriteBytes("false", 5);
+    case kSmiCid:
+      OS::SNPrint(buffer, sizeof(buffer), "%" Pd, Smi::Cast(value).Value());
+      return WriteCString(buffer);
+    case kMintCid:
+      OS::SNPrint(buffer, sizeof(buffer), "%" Pd64, Mint::Cast(value).value());
+      return WriteCString(buffer);
+    case kDoubleCid: {
+      const double d = Double::Cast(value).value();
+      if (isnan(d) || isinf(d)) {
+        return false;
+      }
+      // The same conversion as double.toString().
+      DoubleToCString(d, buffer, sizeof(buffer));
+      return WriteCString(buffer);
+    }
+    case kOneByteStringCid:
+    case kTwoByteStringCid:
+    case kExternalOneByteStringCid:
+    case kExternalTwoByteStringCid:
+      return WriteString(String::Cast(value));
+    case kArrayCid:
+    case kImmutableArrayCid:
+    case kGrowableObjectArrayCid:
+      return WriteList(value, level);
+    case kLinkedHashMapCid:
+      return WriteMap(LinkedHashMap::Cast(value), level);
+    default:
+      // Bigints and anything that needs toJson() are left to Dart.
+      return false;
+  }
+}
+
+
+bool JsonUtf8Writer::WriteString(const String& str) {
+  const intptr_t length = str.Length();
+  // A code unit takes at most six bytes, for a \u escape.
+  if (!Reserve(6 * length + 2)) {
+    return false;
+  }
+  data_[length_++] = '"';
+  if (str.CharSize() == String::kOneByteChar) {
+    latin1_.SetLength(length);
+    String::CopyCodeUnits(str, 0, length, latin1_.data());
+    WriteStringContent(latin1_.data(), length);
+  } else {
+    utf16_.SetLength(length);
+    String::CopyCodeUnits(str, 0, length, utf16_.data());
+    WriteStringContent(utf16_.data(), length);
+  }
+  data_[length_++] = '"';
+  return true;
+}
+
+
+// Escapes quotes, backslashes and control characters as the Dart encoder
+// does, and encodes unpaired surrogates in three bytes.
+template<typename CharType>
+void JsonUtf8Writer::WriteStringContent(const CharType* chars,
+                                        intptr_t length) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  uint8_t* out = data_ + length_;
+  intptr_t i = 0;
+  while (i < length) {
+    // Copy runs of characters that need no escaping or encoding.
+    intptr_t run = i;
+    while ((run < length) &&
+           (chars[run] >= 0x20) && (chars[run] < 0x80) &&
+           (chars[run] != '"') && (chars[run] != '\\')) {
+      run++;
+    }
+    if ((sizeof(CharType) == 1) && (run > i)) {
+      memmove(out, chars + i, run - i);
+      out += run - i;
+      i = run;
+    } else {
+      while (i < run) {
+        *out++ = static_cast<uint8_t>(chars[i++]);
+      }
+    }
+    if (i == length) {
+      break;
+    }
+    int32_t ch = chars[i++];
+    if (ch < 0x20) {
+      *out++ = '\\';
+      switch (ch) {
+        case '\b': *out++ = 'b'; break;
+        case '\t': *out++ = 't'; break;
+        case '\n': *out++ = 'n'; break;
+        case '\f': *out++ = 'f'; break;
+        case '\r': *out++ = 'r'; break;
+        default:
+          *out++ = 'u';
+          *out++ = '0';
+          *out++ = '0';
+          *out++ = kHexDigits[ch >> 4];
+          *out++ = kHexDigits[ch & 0xF];
+      }
+    } else if ((ch == '"') || (ch == '\\')) {
+      *out++ = '\\';
+      *out++ = ch;
+    } else {
+      if (Utf16::IsLeadSurrogate(ch) && (i < length) &&
+          Utf16::IsTrailSurrogate(chars[i])) {
+        ch = Utf16::Decode(ch, chars[i++]);
+      }
+      out += Utf8::Encode(ch, reinterpret_cast<char*>(out));
+    }
+  }
+  length_ = out - data_;
+}
+
+
+bool JsonUtf8Writer::WriteList(const Object& list, intptr_t level) {
+  HANDLESCOPE(Thread::Current());
+  Object& element = Object::Handle(zone_);
+  Array& array = Array::Handle(zone_);
+  intptr_t length;
+  if (list.IsGrowableObjectArray()) {
+    const GrowableObjectArray& growable = GrowableObjectArray::Cast(list);
+    array = growable.data();
+    length = growable.Length();
+  } else {
+    array ^= list.raw();
+    length = array.Length();
+  }
+  if (length == 0) {
+    return WriteBytes("[]", 2);
+  }
+  if (level >= kMaxDepth) {
+    return false;
+  }
+  for (intptr_t i = 0; i < seen_.length(); i++) {
+    if (seen_[i]->raw() == list.raw()) {
+      return false;
+    }
+  }
+  seen_.Add(&list);
+  if (!WriteBytes("[", 1)) {
+    return false;
+  }
+  for (intptr_t i = 0; i < length; i++) {
+    if ((i > 0) && !WriteBytes(",", 1)) {
+      return false;
+    }
+    if ((indent_ != NULL) && !WriteNewlineAndIndent(level + 1)) {
+      return false;
+    }
+    element = array.At(i);
+    if (!WriteValue(element, level + 1)) {
+      return false;
+    }
+  }
+  if ((indent_ != NULL) && !WriteNewlineAndIndent(level)) {
+    return false;
+  }
+  seen_.RemoveLast();
+  return WriteBytes("]", 1);
+}
+
+
+bool JsonUtf8Writer::WriteMap(const LinkedHashMap& map, intptr_t level) {
+  HANDLESCOPE(Thread::Current());
+  const Array& data = Array::Handle(zone_, map.data());
+  const intptr_t used_data = Smi::Value(map.used_data());
+  Object& key = Object::Handle(zone_);
+  Object& value = Object::Handle(zone_);
+  // Like the Dart encoder, check the keys before writing anything. Deleted
+  // entries have the data array itself as their key.
+  intptr_t length = 0;
+  for (intptr_t i = 0; i < used_data; i += 2) {
+    key = data.At(i);
+    if (key.raw() == data.raw()) {
+      continue;
+    }
+    if (!key.IsString()) {
+      return false;
+    }
+    length++;
+  }
+  if (length == 0) {
+    return WriteBytes("{}", 2);
+  }
+  if (level >= kMaxDepth) {
+    return false;
+  }
+  for (intptr_t i = 0; i < seen_.length(); i++) {
+    if (seen_[i]->raw() == map.raw()) {
+      return false;
+    }
+  }
+  seen_.Add(&map);
+  if (!WriteBytes("{", 1)) {
+    return false;
+  }
+  bool first = true;
+  for (intptr_t i = 0; i < used_data; i += 2) {
+    key = data.At(i);
+    if (key.raw() == data.raw()) {
+      continue;
+    }
+    if (!first && !WriteBytes(",", 1)) {
+      return false;
+    }
+    first = false;
+    if ((indent_ != NULL) && !WriteNewlineAndIndent(level + 1)) {
+      return false;
+    }
+    if (!WriteString(String::Cast(key))) {
+      return false;
+    }
+    if (!((indent_ != NULL) ? WriteBytes(": ", 2) : WriteBytes(":", 1))) {
+      return false;
+    }
+    value = data.At(i + 1);
+    if (!WriteValue(value, level + 1)) {
+      return false;
+    }
+  }
+  if ((indent_ != NULL) && !WriteNewlineAndIndent(level)) {
+    return false;
+  }
+  seen_.RemoveLast();
+  return WriteBytes("}", 1);
+}
+
+
+static void JsonBufferFinalizer(void* isolate_callback_data,
+                                Dart_WeakPersistentHandle handle,
+                                void* peer) {
+  free(peer);
+}
+
+
+// Encodes 'object' as UTF-8 JSON into the Uint8List 'buffer' from 'index'.
+// 'indent' is null or the Uint8List written once per nesting level before
+// each line. Returns the index after the encoding, or a new Uint8List with
+// the encoding if it does not fit in 'buffer'. Returns null if 'object' is
+// left to the Dart encoder.
+DEFINE_NATIVE_ENTRY(JsonUtf8Encoder_encode, 4) {
+  const Instance& object = Instance::CheckedHandle(arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(TypedData, buffer, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, index_obj, arguments->NativeArgAt(2));
+  GET_NATIVE_ARGUMENT(TypedData, indent, arguments->NativeArgAt(3));
+  const intptr_t index = index_obj.Value();
+  ASSERT((index >= 0) && (index <= buffer.LengthInBytes()));
+
+  // The indentation is copied, as it must not move while writing.
+  const uint8_t* indent_bytes = NULL;
+  intptr_t indent_length = 0;
+  if (!indent.IsNull()) {
+    indent_length = indent.LengthInBytes();
+    uint8_t* copy = zone->Alloc<uint8_t>(indent_length);
+    NoSafepointScope no_safepoint;
+    memmove(copy, indent.DataAddr(0), indent_length);
+    indent_bytes = copy;
+  }
+  JsonUtf8Writer writer(zone, indent_bytes, indent_length);
+  if (!writer.WriteValue(object)) {
+    return Object::null();
+  }
+
+  const intptr_t length = writer.length();
+  if (length <= buffer.LengthInBytes() - index) {
+    NoSafepointScope no_safepoint;
+    memmove(buffer.DataAddr(index), writer.data(), length);
+    return Smi::New(index + length);
+  }
+  // Encodings that do not fit are handed over without copying them again.
+  uint8_t* data = writer.Steal();
+  const ExternalTypedData& result = ExternalTypedData::Handle(
+      ExternalTypedData::New(kExternalTypedDataUint8ArrayCid, data, length));
+  result.AddFinalizer(data, JsonBufferFinalizer);
+  return result.raw();
+}
+
+}  // namespace dart
@@ -7,6 +7,11 @@ import "dart:_internal" show POWERS_OF_TEN;
 // JSON conversion.
 
 patch _parseJson(String json, reviver(var key, var value)) {
+  if (reviver == null) {
+    var result =
+        _parseJsonNatively(json, 0, json.length, _NATIVE_PARSE_FAILED);
+    if (!identical(result, _NATIVE_PARSE_FAILED)) return result;
+  }
   _BuildJsonListener listener;
   if (reviver == null) {
     listener = new _BuildJsonListener();
@@ -35,8 +40,52 @@ patch class Utf8Decoder {
   /* patch */
   static String _convertIntercepted(
       bool allowMalformed, List<int> codeUnits, int start, int end) {
-    return null;  // This call was not intercepted.
+    if (codeUnits is! Uint8List) {
+      return null;  // This call was not intercepted.
+    }
+    end = RangeError.checkValidRange(start, end, codeUnits.length);
+    String result = _Utf8Decoder._decodeIntercepted(codeUnits, start, end);
+    if (result != null &&
+        result.isNotEmpty &&
+        result.codeUnitAt(0) == UNICODE_BOM_CHARACTER_RUNE) {
+      result = result.substring(1);
+    }
+    return result;
+  }
+}
+
+patch class _Utf8Decoder {
+  // Typed data is validated and decoded natively. Malformed input is left
+  // to the Dart decoder, which reports or replaces it.
+  /* patch */
+  static String _decodeIntercepted(List<int> codeUnits, int start, int end) {
+    if (codeUnits is! Uint8List) {
+      return null;  // This call was not intercepted.
+    }
+    RangeError.checkValidRange(start, end, codeUnits.length);
+    return _decode(codeUnits, start, end);
+  }
+
+  static String _decode(Uint8List codeUnits, int start, int end)
+      native "Utf8Decoder_decode";
+}
+
+patch class Utf8Encoder {
+  /* patch */
+  static List<int> _convertIntercepted(String string, int start, int end) {
+    RangeError.checkValidRange(start, end, string.length);
+    return _encode(string, start, end);
   }
+
+  static Uint8List _encode(String string, int start, int end)
+      native "Utf8Encoder_encode";
+}
+
+patch class _JsonUtf8Stringifier {
+  /* patch */
+  static _encodeIntercepted(object, Uint8List buffer, int index,
+                            Uint8List indent)
+      native "JsonUtf8Encoder_encode";
 }
 
 class _JsonUtf8Decoder extends Converter<List<int>, Object> {
@@ -46,6 +95,11 @@ class _JsonUtf8Decoder extends Converter<List<int>, Object> {
   _JsonUtf8Decoder(this._reviver, this._allowMalformed);
 
   dynamic convert(List<int> input) {
+    if (_reviver == null && input is Uint8List) {
+      var result =
+          _parseJsonNatively(input, 0, input.length, _NATIVE_PARSE_FAILED);
+      if (!identical(result, _NATIVE_PARSE_FAILED)) return result;
+    }
     var parser = _JsonUtf8DecoderSink._createParser(_reviver, _allowMalformed);
     parser.chunk = input;
     parser.chunkEnd = input.length;
@@ -58,6 +112,16 @@ class _JsonUtf8Decoder extends Converter<List<int>, Object> {
   }
 }
 
+// Returned by the native parser for input it does not accept. Such input is
+// parsed again in Dart, which reports the error or applies the options the
+// native parser does not support.
+final Object _NATIVE_PARSE_FAILED = new Object();
+
+// Parses JSON text from [start] to [end] of a String or of a Uint8List of
+// UTF-8 in one go, without calling back into Dart.
+_parseJsonNatively(source, int start, int end, Object failure)
+    native "JsonDecoder_parse";
+
 //// Implementation ///////////////////////////////////////////////////////////
 
 // Simple API for JSON parsing.
@@ -613,4 +613,40 @@ DEFINE_NATIVE_ENTRY(StringBuffer_createStringFromUint16Array, 3) {
   return result.raw();
 }
 
+
+
+// Decodes the UTF-8 in a Uint8List straight into a one or two byte string.
+// Returns null for malformed input and for encoded surrogates, which are
+// left to the Dart decoder to report or replace.
+DEFINE_NATIVE_ENTRY(Utf8Decoder_decode, 3) {
+  const Instance& list = Instance::CheckedHandle(arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, end_obj, arguments->NativeArgAt(2));
+  intptr_t offset = start_obj.Value();
+  intptr_t length = end_obj.Value() - offset;
+  ASSERT((offset >= 0) && (length >= 0));
+  Instance& data = Instance::Handle(list.raw());
+  if (RawObject::IsTypedDataViewClassId(list.GetClassId())) {
+    data = TypedDataView::Data(list);
+    offset += Smi::Value(TypedDataView::OffsetInBytes(list));
+  }
+  Heap::Space space = isolate->heap()->SpaceForAllocation(kOneByteStringCid);
+  return String::FromUTF8(data, offset, length, space);
+}
+
+
+// Encodes the code units from 'start' to 'end' of a string into a new
+// Uint8List.
+DEFINE_NATIVE_ENTRY(Utf8Encoder_encode, 3) {
+  GET_NON_NULL_NATIVE_ARGUMENT(String, str, arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, end_obj, arguments->NativeArgAt(2));
+  intptr_t start = start_obj.Value();
+  intptr_t length = end_obj.Value() - start;
+  ASSERT((start >= 0) && (length >= 0) && (start + length <= str.Length()));
+  Heap::Space space =
+      isolate->heap()->SpaceForAllocation(kTypedDataUint8ArrayCid);
+  return String::ToUTF8(str, start, length, space);
+}
+
 }  // namespace dart
@@ -0,0 +1,66 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--error_on_bad_type --error_on_bad_override --allocation_sample_interval=1
+
+import 'package:observatory/service_io.dart';
+import 'package:unittest/unittest.dart';
+
+import 'test_helper.dart';
+
+class _Sampled {
+  _Sampled(this.payload);
+  var payload;
+}
+
+var retained;
+
+void script() {
+  retained = [];
+  for (int i = 0; i < 100000; i++) {
+    var sampled = new _Sampled(new List(8));
+    if (i % 2 == 0) {
+      retained.add(sampled);
+    }
+  }
+}
+
+var tests = [
+  (Isolate isolate) async {
+    var params = {
+      'gc' : 'full',
+    };
+    var result = await isolate.invokeRpcNoUpgrade('_getAllocationSites',
+                                                  params);
+    expect(result['type'], equals('AllocationSites'));
+    expect(result['samplingInterval'], equals(1024));
+    expect(result['samples'], isPositive);
+    var sites = result['sites'].where(
+        (site) => site['class']['name'] == '_Sampled').toList();
+    expect(sites.length, isPositive);
+    var site = sites[0];
+    expect(site['type'], equals('AllocationSite'));
+    expect(site['samples'], isPositive);
+    expect(site['liveSamples'], lessThanOrEqualTo(site['samples']));
+    expect(site['stack'].length, isPositive);
+  },
+
+  (Isolate isolate) async {
+    var params = {
+      'gc' : 'banana',
+    };
+    bool caughtException;
+    try {
+      await isolate.invokeRpcNoUpgrade('_getAllocationSites', params);
+      expect(false, isTrue, reason:'Unreachable');
+    } on ServerRpcException catch (e) {
+      caughtException = true;
+      expect(e.code, equals(ServerRpcException.kInvalidParams));
+      expect(e.data['details'],
+             "_getAllocationSites: invalid \'gc\' parameter: banana");
+    }
+    expect(caughtException, isTrue);
+  },
+];
+
+main(args) async => runIsolateTests(args, tests, testeeBefore: script);
@@ -0,0 +1,80 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--error_on_bad_type --error_on_bad_override
+
+import 'package:observatory/service_io.dart';
+import 'package:unittest/unittest.dart';
+
+import 'test_helper.dart';
+
+var retained;
+
+void script() {
+  retained = [];
+  for (int i = 0; i < 100000; i++) {
+    var garbage = new List(8);
+    if (i % 100 == 0) {
+      retained.add(garbage);
+    }
+  }
+}
+
+var tests = [
+  (Isolate isolate) async {
+    // Force a scavenge and a mark-sweep.
+    await isolate.invokeRpcNoUpgrade('_getAllocationProfile',
+                                     { 'gc': 'full' });
+    var result = await isolate.invokeRpcNoUpgrade('_getGCHistograms', {});
+    expect(result['type'], equals('GCHistograms'));
+    expect(result['collections'], isPositive);
+    var histograms = {};
+    for (var histogram in result['histograms']) {
+      expect(histogram['type'], equals('Histogram'));
+      histograms[histogram['name']] = histogram;
+    }
+    var scavenges = histograms['heap.gc.scavenge.pause'];
+    expect(scavenges['unit'], equals('microsecond'));
+    expect(scavenges['count'], isPositive);
+    expect(scavenges['p50'], lessThanOrEqualTo(scavenges['p99']));
+    expect(scavenges['p99'], lessThanOrEqualTo(scavenges['max']));
+    expect(scavenges['buckets'].length, isPositive);
+    var markSweeps = histograms['heap.gc.marksweep.pause'];
+    expect(markSweeps['count'], isPositive);
+    expect(histograms['heap.old.fragmentation']['unit'], equals('percent'));
+  },
+
+  (Isolate isolate) async {
+    var result = await isolate.invokeRpcNoUpgrade('_getGCHistograms',
+                                                  { 'reset': 'true' });
+    expect(result['type'], equals('GCHistograms'));
+    result = await isolate.invokeRpcNoUpgrade('_getGCHistograms', {});
+    for (var histogram in result['histograms']) {
+      expect(histogram['count'], equals(0));
+    }
+  },
+
+  (Isolate isolate) async {
+    Map metrics = await isolate.refreshNativeMetrics();
+    var found = metrics.values.any(
+        (m) => m.name == 'heap.gc.scavenge.pause.p99');
+    expect(found, isTrue);
+  },
+
+  (Isolate isolate) async {
+    bool caughtException;
+    try {
+      await isolate.invokeRpcNoUpgrade('_getGCHistograms',
+                                       { 'reset': 'banana' });
+      expect(false, isTrue, reason:'Unreachable');
+    } on ServerRpcException catch (e) {
+      caughtException = true;
+      expect(e.code, equals(ServerRpcException.kInvalidParams));
+      expect(e.data['details'],
+             "_getGCHistograms: invalid \'reset\' parameter: banana");
+    }
+    expect(caughtException, isTrue);
+  },
+];
+
+main(args) async => runIsolateTests(args, tests, testeeBefore: script);
@@ -0,0 +1,64 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--error_on_bad_type --error_on_bad_override --ic_stats
+
+import 'package:observatory/service_io.dart';
+import 'package:unittest/unittest.dart';
+
+import 'test_helper.dart';
+
+class A { polymorphic() => 1; }
+class B { polymorphic() => 2; }
+class C { polymorphic() => 3; }
+
+var sum = 0;
+
+void script() {
+  var receivers = [new A(), new B(), new C()];
+  for (int i = 0; i < 300; i++) {
+    sum += receivers[i % 3].polymorphic();
+  }
+}
+
+var tests = [
+  (Isolate isolate) async {
+    var params = {
+      'limit' : '1000',
+    };
+    var result = await isolate.invokeRpcNoUpgrade('_getICStats', params);
+    expect(result['type'], equals('ICStats'));
+    expect(result['enabled'], isTrue);
+    expect(result['misses'], isPositive);
+    var sites = result['sites'].where(
+        (site) => site['selector'] == 'polymorphic').toList();
+    expect(sites.length, isPositive);
+    var site = sites[0];
+    expect(site['type'], equals('ICSite'));
+    expect(site['misses'], greaterThanOrEqualTo(3));
+    expect(site['checks'], equals(3));
+    var selectors = result['selectors'].where(
+        (selector) => selector['selector'] == 'polymorphic').toList();
+    expect(selectors.length, equals(1));
+    expect(selectors[0]['misses'], greaterThanOrEqualTo(3));
+  },
+
+  (Isolate isolate) async {
+    var params = {
+      'reset' : 'banana',
+    };
+    bool caughtException;
+    try {
+      await isolate.invokeRpcNoUpgrade('_getICStats', params);
+      expect(false, isTrue, reason:'Unreachable');
+    } on ServerRpcException catch (e) {
+      caughtException = true;
+      expect(e.code, equals(ServerRpcException.kInvalidParams));
+      expect(e.data['details'],
+             "_getICStats: invalid \'reset\' parameter: banana");
+    }
+    expect(caughtException, isTrue);
+  },
+];
+
+main(args) async => runIsolateTests(args, tests, testeeBefore: script);
@@ -0,0 +1,44 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--error_on_bad_type --error_on_bad_override
+
+import 'package:observatory/service_io.dart';
+import 'package:unittest/unittest.dart';
+
+import 'test_helper.dart';
+
+var tests = [
+  (VM vm) async {
+    var result = await vm.invokeRpcNoUpgrade('_getVMMetricList', {});
+    expect(result['type'], equals('MetricList'));
+    var names = result['metrics'].map((m) => m['name']).toList();
+    expect(names, contains('vm.isolate.count'));
+    expect(names, contains('vm.threadpool.running'));
+    var isolates = result['metrics'].firstWhere(
+        (m) => m['name'] == 'vm.isolate.count');
+    expect(isolates['value'], isPositive);
+  },
+
+  (VM vm) async {
+    var result = await vm.invokeRpcNoUpgrade(
+        '_getVMMetric', { 'metricId': 'vm/metrics/vm.isolate.count' });
+    expect(result['type'], equals('Counter'));
+    expect(result['name'], equals('vm.isolate.count'));
+  },
+
+  (VM vm) async {
+    bool caughtException;
+    try {
+      await vm.invokeRpcNoUpgrade(
+          '_getVMMetric', { 'metricId': 'vm/metrics/doesnotexist' });
+      expect(false, isTrue, reason:'Unreachable');
+    } on ServerRpcException catch (e) {
+      caughtException = true;
+      expect(e.code, equals(ServerRpcException.kInvalidParams));
+    }
+    expect(caughtException, isTrue);
+  },
+];
+
+main(args) async => runVMTests(args, tests);
@@ -0,0 +1,74 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--error_on_bad_type --error_on_bad_override --vm-service-metrics
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+import 'package:observatory/service_io.dart';
+import 'package:unittest/unittest.dart';
+
+import 'test_helper.dart';
+
+Future<HttpClientResponse> getMetrics() async {
+  HttpClient client = new HttpClient();
+  var request = await client.getUrl(Uri.parse('$serviceHttpAddress/metrics'));
+  return request.close();
+}
+
+var tests = [
+  (VM vm) async {
+    var response = await getMetrics();
+    expect(response.statusCode, equals(HttpStatus.OK));
+    expect(response.headers.contentType.mimeType, equals('text/plain'));
+    expect(response.headers.contentType.parameters['version'],
+           equals('0.0.4'));
+    var lines = await response.transform(UTF8.decoder)
+                              .transform(new LineSplitter())
+                              .toList();
+
+    // Every family has a type, and every sample a name, optional labels
+    // and a number.
+    var types = {};
+    var samples = {};
+    var typeExp = new RegExp(r'^# TYPE ([a-z_]+) (counter|gauge)$');
+    var sampleExp = new RegExp(r'^([a-z_]+)(\{[^}]*\})? (-?[0-9.e+-]+)$');
+    for (var line in lines) {
+      if (line.startsWith('# HELP ')) {
+        continue;
+      }
+      var match = typeExp.firstMatch(line);
+      if (match != null) {
+        types[match.group(1)] = match.group(2);
+        continue;
+      }
+      match = sampleExp.firstMatch(line);
+      expect(match, isNotNull, reason: line);
+      expect(types, contains(match.group(1)));
+      samples.putIfAbsent(match.group(1), () => []).add(line);
+    }
+
+    // VM wide metrics have no labels.
+    expect(types['dart_vm_isolate_count'], equals('gauge'));
+    expect(samples['dart_vm_isolate_count'].single,
+           matches(r'^dart_vm_isolate_count [1-9][0-9]*$'));
+    expect(types['dart_heap_gc_scavenge_count'], equals('counter'));
+    expect(types['dart_heap_gc_scavenge_time_microseconds'],
+           equals('counter'));
+    expect(types['dart_eventhandler_timer_wakeups'], equals('counter'));
+    expect(types['dart_eventhandler_timer_latency_milliseconds_max'],
+           equals('gauge'));
+
+    // Isolate metrics are labelled with the isolate.
+    expect(types['dart_isolate_compile_count'], equals('counter'));
+    expect(types['dart_isolate_messages_queued'], equals('gauge'));
+    expect(types['dart_heap_new_used_bytes'], equals('gauge'));
+    var label = 'isolate_id="${vm.isolates.first.id}"}';
+    var compileCount = samples['dart_isolate_compile_count'].singleWhere(
+        (sample) => sample.contains(label));
+    expect(int.parse(compileCount.split(' ').last), isPositive);
+  },
+];
+
+main(args) async => runVMTests(args, tests);
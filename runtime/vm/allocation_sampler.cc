@@ -0,0 +1,256 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/allocation_sampler.h"
+
+#include <math.h>  // NOLINT
+
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/json_stream.h"
+#include "vm/object.h"
+#include "vm/scavenger.h"
+#include "vm/stack_frame.h"
+#include "vm/weak_table.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, profile_depth);
+
+DEFINE_FLAG(int, allocation_sample_interval, 0,
+            "Mean number of KB allocated between allocation samples, "
+            "0 disables allocation sampling.");
+
+
+static intptr_t SampleIntervalInBytes() {
+  return FLAG_allocation_sample_interval * KB;
+}
+
+
+AllocationSampler::AllocationSampler(Heap* heap)
+    : heap_(heap),
+      old_bytes_until_sample_(0),
+      num_samples_(0) {
+  const intptr_t kInitialTableSize = 256;
+  site_table_.SetLength(kInitialTableSize);
+  for (intptr_t i = 0; i < kInitialTableSize; i++) {
+    site_table_[i] = -1;
+  }
+}
+
+
+AllocationSampler::~AllocationSampler() {
+}
+
+
+intptr_t AllocationSampler::NextInterval() {
+  // The gaps between the samples of a Poisson process are exponentially
+  // distributed.
+  const double uniform = (random_.NextUInt32() + 1.0) / 4294967296.0;
+  const double interval = -log(uniform) * SampleIntervalInBytes();
+  if (interval < kObjectAlignment) {
+    return kObjectAlignment;
+  }
+  if (interval > kMaxInt32) {
+    return kMaxInt32;
+  }
+  return static_cast<intptr_t>(interval);
+}
+
+
+double AllocationSampler::Weight(intptr_t size) const {
+  // An object is sampled when a sample point falls inside it, so large
+  // objects are sampled more often than small ones.
+  const intptr_t interval = SampleIntervalInBytes();
+  if (interval <= 0) {
+    return size;
+  }
+  const double probability =
+      1.0 - exp(-static_cast<double>(size) / interval);
+  return size / probability;
+}
+
+
+void AllocationSampler::Allocated(RawObject* raw_obj,
+                                  intptr_t cid,
+                                  intptr_t size) {
+  Scavenger* new_space = heap_->new_space();
+  bool sample = false;
+  if (raw_obj->IsNewObject()) {
+    sample = new_space->AllocationLimitReached();
+  } else {
+    if (old_bytes_until_sample_ == 0) {
+      old_bytes_until_sample_ = NextInterval();
+    }
+    old_bytes_until_sample_ -= size;
+    if (old_bytes_until_sample_ <= 0) {
+      sample = true;
+      old_bytes_until_sample_ = NextInterval();
+    }
+  }
+  if (sample) {
+    Sample(raw_obj, cid, size);
+  }
+  if (!new_space->HasAllocationLimit() ||
+      new_space->AllocationLimitReached()) {
+    // A scavenge removes the limit. As the process is memoryless a fresh
+    // interval can be drawn instead of carrying over what was left of it.
+    new_space->SetAllocationLimit(NextInterval());
+  }
+}
+
+
+void AllocationSampler::Sample(RawObject* raw_obj,
+                               intptr_t cid,
+                               intptr_t size) {
+  Isolate* isolate = heap_->isolate();
+  const intptr_t offset = site_pcs_.length();
+  if (isolate->MutatorThreadIsCurrentThread()) {
+    DartFrameIterator iterator(isolate);
+    StackFrame* frame = iterator.NextFrame();
+    while ((frame != NULL) &&
+           (site_pcs_.length() - offset < FLAG_profile_depth)) {
+      site_pcs_.Add(frame->pc());
+      frame = iterator.NextFrame();
+    }
+  }
+  const intptr_t index =
+      InternSite(cid, offset, site_pcs_.length() - offset);
+  Site& site = sites_[index];
+  site.samples++;
+  site.bytes += Weight(size);
+  num_samples_++;
+  // Zero means no entry, so the site is stored off by one.
+  heap_->SetWeakEntry(raw_obj, Heap::kAllocationSites, index + 1);
+}
+
+
+bool AllocationSampler::SiteEquals(const Site& site,
+                                   intptr_t cid,
+                                   intptr_t offset,
+                                   intptr_t length) const {
+  if ((site.cid != cid) || (site.length != length)) {
+    return false;
+  }
+  for (intptr_t i = 0; i < length; i++) {
+    if (site_pcs_[site.offset + i] != site_pcs_[offset + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+intptr_t AllocationSampler::InternSite(intptr_t cid,
+                                       intptr_t offset,
+                                       intptr_t length) {
+  uword hash = cid;
+  for (intptr_t i = 0; i < length; i++) {
+    hash = (hash * 31) + site_pcs_[offset + i];
+    hash ^= hash >> 16;
+  }
+  const intptr_t mask = site_table_.length() - 1;
+  intptr_t index = hash & mask;
+  while (site_table_[index] != -1) {
+    const intptr_t existing = site_table_[index];
+    if ((sites_[existing].hash == hash) &&
+        SiteEquals(sites_[existing], cid, offset, length)) {
+      // Known site, drop the copy of its stack trace.
+      site_pcs_.TruncateTo(offset);
+      return existing;
+    }
+    index = (index + 1) & mask;
+  }
+  Site site;
+  site.cid = cid;
+  site.hash = hash;
+  site.offset = offset;
+  site.length = length;
+  site.samples = 0;
+  site.bytes = 0.0;
+  const intptr_t result = sites_.length();
+  sites_.Add(site);
+  site_table_[index] = result;
+  if (2 * sites_.length() >= site_table_.length()) {
+    GrowSiteTable();
+  }
+  return result;
+}
+
+
+void AllocationSampler::GrowSiteTable() {
+  const intptr_t size = 2 * site_table_.length();
+  const intptr_t mask = size - 1;
+  site_table_.SetLength(size);
+  for (intptr_t i = 0; i < size; i++) {
+    site_table_[i] = -1;
+  }
+  for (intptr_t i = 0; i < sites_.length(); i++) {
+    intptr_t index = sites_[i].hash & mask;
+    while (site_table_[index] != -1) {
+      index = (index + 1) & mask;
+    }
+    site_table_[index] = i;
+  }
+}
+
+
+void AllocationSampler::PrintJSON(JSONStream* stream) {
+  Isolate* isolate = heap_->isolate();
+  const intptr_t num_sites = sites_.length();
+  MallocGrowableArray<int64_t> live_samples(num_sites);
+  MallocGrowableArray<double> live_bytes(num_sites);
+  for (intptr_t i = 0; i < num_sites; i++) {
+    live_samples.Add(0);
+    live_bytes.Add(0.0);
+  }
+  {
+    // Sampled objects that have died are no longer in the weak tables.
+    NoSafepointScope no_safepoint;
+    const Heap::Space spaces[] = { Heap::kNew, Heap::kOld };
+    for (intptr_t i = 0; i < 2; i++) {
+      WeakTable* table =
+          heap_->GetWeakTable(spaces[i], Heap::kAllocationSites);
+      for (intptr_t j = 0; j < table->size(); j++) {
+        if (!table->IsValidEntryAt(j)) {
+          continue;
+        }
+        const intptr_t index = table->ValueAt(j) - 1;
+        live_samples[index]++;
+        live_bytes[index] += Weight(table->ObjectAt(j)->Size());
+      }
+    }
+  }
+
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "AllocationSites");
+  jsobj.AddProperty("samplingInterval", SampleIntervalInBytes());
+  jsobj.AddProperty64("samples", num_samples_);
+  JSONArray sites(&jsobj, "sites");
+  Class& cls = Class::Handle();
+  Code& code = Code::Handle();
+  for (intptr_t i = 0; i < num_sites; i++) {
+    const Site& site = sites_[i];
+    JSONObject jssite(&sites);
+    jssite.AddProperty("type", "AllocationSite");
+    cls = isolate->class_table()->At(site.cid);
+    jssite.AddProperty("class", cls);
+    jssite.AddProperty64("samples", site.samples);
+    jssite.AddProperty("bytes", site.bytes);
+    jssite.AddProperty64("liveSamples", live_samples[i]);
+    jssite.AddProperty("liveBytes", live_bytes[i]);
+    JSONArray stack(&jssite, "stack");
+    for (intptr_t j = 0; j < site.length; j++) {
+      code = Code::LookupCode(site_pcs_[site.offset + j]);
+      if (code.IsNull()) {
+        // The code has been collected since.
+        stack.AddValue("[Collected]");
+      } else {
+        stack.AddValue(code);
+      }
+    }
+  }
+}
+
+}  // namespace dart
@@ -0,0 +1,87 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_ALLOCATION_SAMPLER_H_
+#define VM_ALLOCATION_SAMPLER_H_
+
+#include "vm/allocation.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+#include "vm/growable_array.h"
+#include "vm/random.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, allocation_sample_interval);
+
+class Heap;
+class JSONStream;
+class RawObject;
+
+// Samples the allocations of a heap as a Poisson process over the allocated
+// bytes, taking a sample every --allocation_sample_interval KB on average.
+//
+// New space allocations are sampled by limiting how far generated code may
+// bump allocate, which sends the allocation that crosses the limit through
+// the runtime. Each sampled object is recorded in a weak table of the heap
+// with its allocation site, a class and stack trace, so the objects that are
+// still alive make up a live heap profile by site.
+class AllocationSampler {
+ public:
+  explicit AllocationSampler(Heap* heap);
+  ~AllocationSampler();
+
+  static bool IsEnabled() {
+    return FLAG_allocation_sample_interval > 0;
+  }
+
+  // Called by the runtime for each object it allocates.
+  void Allocated(RawObject* raw_obj, intptr_t cid, intptr_t size);
+
+  void PrintJSON(JSONStream* stream);
+
+  intptr_t num_samples() const {
+    return num_samples_;
+  }
+
+  intptr_t num_sites() const {
+    return sites_.length();
+  }
+
+ private:
+  struct Site {
+    intptr_t cid;
+    uword hash;
+    intptr_t offset;
+    intptr_t length;
+    int64_t samples;
+    double bytes;
+  };
+
+  intptr_t NextInterval();
+  double Weight(intptr_t size) const;
+  void Sample(RawObject* raw_obj, intptr_t cid, intptr_t size);
+  intptr_t InternSite(intptr_t cid, intptr_t offset, intptr_t length);
+  bool SiteEquals(const Site& site,
+                  intptr_t cid,
+                  intptr_t offset,
+                  intptr_t length) const;
+  void GrowSiteTable();
+
+  Heap* heap_;
+  Random random_;
+  intptr_t old_bytes_until_sample_;
+  int64_t num_samples_;
+  MallocGrowableArray<Site> sites_;
+  // The stack traces of the sites, leaf first.
+  MallocGrowableArray<uword> site_pcs_;
+  // Open addressed table of site indices, -1 marks an empty entry.
+  MallocGrowableArray<intptr_t> site_table_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace dart
+
+#endif  // VM_ALLOCATION_SAMPLER_H_
@@ -22,6 +22,12 @@ class AtomicOperations : public AllStatic {
   static uintptr_t FetchAndIncrement(uintptr_t* p);
 
   static uword CompareAndSwapWord(uword* ptr, uword old_value, uword new_value);
+
+  // Loads the value at ptr with acquire semantics and stores value at ptr
+  // with release semantics, so that writes made before a release store are
+  // visible to a thread that observes the stored value with an acquire load.
+  static uword LoadAcquire(uword* ptr);
+  static void StoreRelease(uword* ptr, uword value);
 };
 
 
@@ -28,6 +28,17 @@ inline uintptr_t AtomicOperations::FetchAndIncrement(uintptr_t* p) {
 }
 
 
+// Volatile accesses have acquire and release semantics on x86.
+inline uword AtomicOperations::LoadAcquire(uword* ptr) {
+  return *static_cast<volatile uword*>(ptr);
+}
+
+
+inline void AtomicOperations::StoreRelease(uword* ptr, uword value) {
+  *static_cast<volatile uword*>(ptr) = value;
+}
+
+
 #if !defined(USING_SIMULATOR)
 inline uword AtomicOperations::CompareAndSwapWord(uword* ptr,
                                                   uword old_value,
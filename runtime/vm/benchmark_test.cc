@@ -5,7 +5,9 @@
 #include "vm/benchmark_test.h"
 
 #include "bin/builtin.h"
+#include "bin/eventhandler.h"
 #include "bin/file.h"
+#include "bin/process.h"
 
 #include "platform/assert.h"
 #include "platform/globals.h"
@@ -583,6 +585,76 @@ BENCHMARK(EnterExitIsolate) {
 }
 
 
+//
+// Measure updates of the event handler timeout queue when many ports keep
+// rescheduling their timers.
+//
+BENCHMARK(TimeoutQueueChurn) {
+  const intptr_t kNumPorts = 10000;
+  const intptr_t kNumUpdates = 1000000;
+  bin::TimeoutQueue queue;
+  Random random;
+  for (intptr_t i = 0; i < kNumPorts; i++) {
+    queue.UpdateTimeout(i + 1, random.NextUInt32() % 60000);
+  }
+  Timer timer(true, "Timeout queue churn");
+  timer.Start();
+  int64_t now = 0;
+  for (intptr_t i = 0; i < kNumUpdates; i++) {
+    const Dart_Port port = (random.NextUInt32() % kNumPorts) + 1;
+    queue.UpdateTimeout(port, now + (random.NextUInt32() % 60000));
+    if ((i % 16) == 0) {
+      // Expire the earliest timer and reschedule it, like the event handler
+      // does when a port's timer fires.
+      const Dart_Port current = queue.CurrentPort();
+      now = queue.CurrentTimeout();
+      queue.RemoveCurrent();
+      queue.UpdateTimeout(current, now + (random.NextUInt32() % 60000));
+    }
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+
+#if !defined(TARGET_OS_WINDOWS)
+//
+// Measure the throughput of starting short lived processes and waiting for
+// their exit codes, like Process.runSync does.
+//
+BENCHMARK(ProcessSpawn) {
+  const intptr_t kNumProcesses = 200;
+  Timer timer(true, "Process spawn");
+  timer.Start();
+  for (intptr_t i = 0; i < kNumProcesses; i++) {
+    intptr_t process_stdin;
+    intptr_t process_stdout;
+    intptr_t process_stderr;
+    intptr_t pid;
+    intptr_t exit_event;
+    char* os_error_message = NULL;
+    int error = bin::Process::Start("true", NULL, 0, NULL, NULL, 0,
+                                    bin::kNormal, &process_stdout,
+                                    &process_stdin, &process_stderr, &pid,
+                                    &exit_event, &os_error_message);
+    EXPECT_EQ(0, error);
+    if (error != 0) {
+      free(os_error_message);
+      return;
+    }
+    bin::ProcessResult result;
+    EXPECT(bin::Process::Wait(pid, process_stdin, process_stdout,
+                              process_stderr, exit_event, &result));
+    EXPECT_EQ(0, result.exit_code());
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+#endif  // !defined(TARGET_OS_WINDOWS)
+
+
 static uint8_t message_buffer[64];
 static uint8_t* message_allocator(
     uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
@@ -118,6 +118,10 @@ namespace dart {
   V(OneByteString_allocateFromOneByteList, 3)                                  \
   V(OneByteString_setAt, 3)                                                    \
   V(TwoByteString_allocateFromTwoByteList, 3)                                  \
+  V(Utf8Decoder_decode, 3)                                                     \
+  V(Utf8Encoder_encode, 3)                                                     \
+  V(JsonDecoder_parse, 4)                                                      \
+  V(JsonUtf8Encoder_encode, 4)                                                 \
   V(ExternalOneByteString_getCid, 0)                                           \
   V(String_getHashCode, 1)                                                     \
   V(String_getLength, 1)                                                       \
@@ -13,6 +13,7 @@
 #include "vm/debugger.h"
 #include "vm/deopt_instructions.h"
 #include "vm/exceptions.h"
+#include "vm/ic_stats.h"
 #include "vm/intermediate_language.h"
 #include "vm/object_store.h"
 #include "vm/message.h"
@@ -56,7 +57,6 @@ DEFINE_FLAG(bool, trace_patching, false, "Trace patching of code.");
 DEFINE_FLAG(bool, trace_runtime_calls, false, "Trace runtime calls");
 DEFINE_FLAG(bool, trace_type_checks, false, "Trace runtime type checks.");
 
-DECLARE_FLAG(int, deoptimization_counter_threshold);
 DECLARE_FLAG(bool, warn_on_javascript_compatibility);
 
 DEFINE_FLAG(bool, use_osr, true, "Use on-stack replacement.");
@@ -801,6 +801,9 @@ RawFunction* InlineCacheMissHelper(
 static RawFunction* InlineCacheMissHandler(
     const GrowableArray<const Instance*>& args,
     const ICData& ic_data) {
+  if (ICStats::IsEnabled()) {
+    ICStats::RecordMiss(Isolate::Current(), ic_data);
+  }
   const Instance& receiver = *args[0];
   ArgumentsDescriptor
       arguments_descriptor(Array::Handle(ic_data.arguments_descriptor()));
@@ -1003,6 +1006,9 @@ DEFINE_RUNTIME_ENTRY(MegamorphicCacheMissHandler, 3) {
   const ICData& ic_data = ICData::CheckedHandle(arguments.ArgAt(1));
   const Array& descriptor = Array::CheckedHandle(arguments.ArgAt(2));
   const String& name = String::Handle(ic_data.target_name());
+  if (ICStats::IsEnabled()) {
+    ICStats::RecordMegamorphicMiss(isolate, ic_data);
+  }
   const MegamorphicCache& cache = MegamorphicCache::Handle(
       isolate->megamorphic_cache_table()->Lookup(name, descriptor));
   Class& cls = Class::Handle(receiver.clazz());
@@ -1209,8 +1215,7 @@ static bool CanOptimizeFunction(const Function& function, Isolate* isolate) {
     function.set_usage_counter(0);
     return false;
   }
-  if (function.deoptimization_counter() >=
-      FLAG_deoptimization_counter_threshold) {
+  if (Compiler::HasExcessiveDeoptimization(function)) {
     if (FLAG_trace_failed_optimization_attempts ||
         FLAG_stop_on_excessive_deoptimization) {
       OS::PrintErr("Too Many Deoptimizations: %s\n",
@@ -1355,6 +1360,8 @@ DEFINE_RUNTIME_ENTRY(StackOverflow, 0) {
     }
   }
   if ((interrupt_bits & Isolate::kMessageInterrupt) != 0) {
+    // Dart code has run since the last interrupt.
+    isolate->IncrementMutatorEpoch();
     bool ok = isolate->message_handler()->HandleOOBMessages();
     if (!ok) {
       // False result from HandleOOBMessages signals that the isolate should
@@ -1454,7 +1461,8 @@ DEFINE_RUNTIME_ENTRY(TraceICCall, 2) {
 
 
 // This is called from function that needs to be optimized.
-// The requesting function can be already optimized (reoptimization).
+// The requesting function can be already optimized (reoptimization) or
+// baseline optimized (tier-up).
 // Returns the Code object where to continue execution.
 DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
   const Function& function = Function::CheckedHandle(zone,
@@ -1466,8 +1474,14 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
     // Reset usage counter for reoptimization before calling optimizer to
     // prevent recursive triggering of function optimization.
     function.set_usage_counter(0);
-    const Error& error = Error::Handle(
-        isolate, Compiler::CompileOptimizedFunction(thread, function));
+    // Warm unoptimized code is first compiled by the baseline tier; baseline
+    // and optimized code that get hot are fully (re)optimized.
+    const bool baseline =
+        !Code::Handle(zone, function.CurrentCode()).is_optimized() &&
+        Compiler::UseBaselineTier(function);
+    const Error& error = Error::Handle(isolate, baseline ?
+        Compiler::CompileBaselineOptimizedFunction(thread, function) :
+        Compiler::CompileOptimizedFunction(thread, function));
     if (!error.IsNull()) {
       Exceptions::PropagateError(error);
     }
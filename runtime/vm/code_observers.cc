@@ -40,6 +40,27 @@ void CodeObservers::NotifyAll(const char* name,
 }
 
 
+void CodeObservers::NotifyAllSourcePositions(
+    uword base,
+    const CodeSourcePosition* positions,
+    intptr_t length) {
+  for (intptr_t i = 0; i < observers_length_; i++) {
+    if (observers_[i]->IsActive() && observers_[i]->WantsSourcePositions()) {
+      observers_[i]->NotifySourcePositions(base, positions, length);
+    }
+  }
+}
+
+
+void CodeObservers::NotifyAllUnload(uword base, uword size) {
+  for (intptr_t i = 0; i < observers_length_; i++) {
+    if (observers_[i]->IsActive()) {
+      observers_[i]->NotifyUnload(base, size);
+    }
+  }
+}
+
+
 bool CodeObservers::AreActive() {
   for (intptr_t i = 0; i < observers_length_; i++) {
     if (observers_[i]->IsActive()) return true;
@@ -48,6 +69,16 @@ bool CodeObservers::AreActive() {
 }
 
 
+bool CodeObservers::WantSourcePositions() {
+  for (intptr_t i = 0; i < observers_length_; i++) {
+    if (observers_[i]->IsActive() && observers_[i]->WantsSourcePositions()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
 void CodeObservers::DeleteAll() {
   for (intptr_t i = 0; i < observers_length_; i++) {
     delete observers_[i];
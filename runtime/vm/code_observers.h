@@ -12,6 +12,15 @@ namespace dart {
 
 class Mutex;
 
+// Source position of the instructions starting at |pc|. For inlined code
+// this is the position in the innermost inlined function.
+struct CodeSourcePosition {
+  uword pc;
+  intptr_t line;
+  intptr_t column;
+  const char* file;
+};
+
 // Object observing code creation events. Used by external profilers and
 // debuggers to map address ranges to function names.
 class CodeObserver {
@@ -32,6 +41,20 @@ class CodeObserver {
                       uword size,
                       bool optimized) = 0;
 
+  // Returns true if this observer should also be notified about the source
+  // positions of newly created code.
+  virtual bool WantsSourcePositions() const { return false; }
+
+  // Notify code observer about the source positions of the code object
+  // starting at |base|, sorted by pc. Called after |Notify| for the code.
+  virtual void NotifySourcePositions(uword base,
+                                     const CodeSourcePosition* positions,
+                                     intptr_t length) { }
+
+  // Notify code observer that the code object in [base, base + size) has
+  // been freed. Called during GC, must not allocate in the Dart heap.
+  virtual void NotifyUnload(uword base, uword size) { }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(CodeObserver);
 };
@@ -50,9 +73,22 @@ class CodeObservers : public AllStatic {
                         uword size,
                         bool optimized);
 
+  // Notify all interested code observers about the source positions of a
+  // newly created code object.
+  static void NotifyAllSourcePositions(uword base,
+                                       const CodeSourcePosition* positions,
+                                       intptr_t length);
+
+  // Notify all active code observers about a freed code object.
+  static void NotifyAllUnload(uword base, uword size);
+
   // Returns true if there is at least one active code observer.
   static bool AreActive();
 
+  // Returns true if there is at least one active code observer that wants
+  // source positions.
+  static bool WantSourcePositions();
+
   static void DeleteAll();
 
   static Mutex* mutex() {
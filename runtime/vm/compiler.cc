@@ -10,6 +10,7 @@
 #include "vm/block_scheduler.h"
 #include "vm/cha.h"
 #include "vm/code_generator.h"
+#include "vm/code_observers.h"
 #include "vm/code_patcher.h"
 #include "vm/constant_propagator.h"
 #include "vm/dart_entry.h"
@@ -41,12 +42,20 @@ namespace dart {
 
 DEFINE_FLAG(bool, allocation_sinking, true,
     "Attempt to sink temporary allocations to side exits");
+DEFINE_FLAG(int, baseline_optimization_counter_threshold, -1,
+    "Function's usage-counter value before it is compiled by the baseline "
+    "optimizing tier, -1 means never. Baseline code does not update type "
+    "feedback or edge counters.");
 DEFINE_FLAG(bool, common_subexpression_elimination, true,
     "Do common subexpression elimination.");
 DEFINE_FLAG(bool, constant_propagation, true,
     "Do conditional constant propagation/unreachable code elimination.");
 DEFINE_FLAG(int, deoptimization_counter_threshold, 16,
-    "How many times we allow deoptimization before we disallow optimization.");
+    "How many times we allow deoptimization before we disallow speculative "
+    "optimization.");
+DEFINE_FLAG(int, deoptimization_storm_retries, 4,
+    "How many more deoptimizations we allow once speculative optimization is "
+    "disallowed before we disallow optimization.");
 DEFINE_FLAG(bool, disassemble, false, "Disassemble dart code.");
 DEFINE_FLAG(bool, disassemble_optimized, false, "Disassemble optimized code.");
 DEFINE_FLAG(bool, loop_invariant_code_motion, true,
@@ -65,6 +74,7 @@ DEFINE_FLAG(bool, verify_compiler, false,
     "Enable compiler verification assertions");
 
 DECLARE_FLAG(bool, load_deferred_eagerly);
+DECLARE_FLAG(int, optimization_counter_threshold);
 DECLARE_FLAG(bool, trace_failed_optimization_attempts);
 DECLARE_FLAG(bool, trace_inlining_intervals);
 DECLARE_FLAG(bool, trace_irregexp);
@@ -381,12 +391,73 @@ RawError* Compiler::CompileClass(const Class& cls) {
 }
 
 
+static int CompareSourcePositions(const CodeSourcePosition* a,
+                                  const CodeSourcePosition* b) {
+  if (a->pc < b->pc) {
+    return -1;
+  } else if (a->pc > b->pc) {
+    return 1;
+  }
+  return 0;
+}
+
+
+// Maps the pc descriptors of |code| to source lines for the code observers.
+// Positions inside inlined code belong to the innermost inlined function.
+static void NotifySourcePositions(const Function& function, const Code& code) {
+  Zone* zone = Thread::Current()->zone();
+  const PcDescriptors& descriptors =
+      PcDescriptors::Handle(zone, code.pc_descriptors());
+  GrowableArray<CodeSourcePosition> positions;
+  GrowableArray<Function*> inlined_functions;
+  Script& script = Script::Handle(zone);
+  RawScript* last_script = Script::null();
+  const char* file = NULL;
+  PcDescriptors::Iterator iter(descriptors, RawPcDescriptors::kAnyKind);
+  while (iter.MoveNext()) {
+    const intptr_t token_pos = iter.TokenPos();
+    if (token_pos <= Scanner::kNoSourcePos) {
+      continue;
+    }
+    code.GetInlinedFunctionsAt(iter.PcOffset(), &inlined_functions);
+    const Function& owner = inlined_functions.is_empty() ?
+        function : *inlined_functions[0];
+    script = owner.script();
+    if (script.IsNull()) {
+      continue;
+    }
+    if (script.raw() != last_script) {
+      last_script = script.raw();
+      file = String::Handle(zone, script.url()).ToCString();
+    }
+    CodeSourcePosition position;
+    position.pc = code.EntryPoint() + iter.PcOffset();
+    script.GetTokenLocation(token_pos, &position.line, &position.column);
+    position.file = file;
+    positions.Add(position);
+  }
+  if (positions.is_empty()) {
+    return;
+  }
+  positions.Sort(CompareSourcePositions);
+  CodeObservers::NotifyAllSourcePositions(code.EntryPoint(),
+                                          positions.data(),
+                                          positions.length());
+}
+
+
 // Return false if bailed out.
+// A baseline compilation is an optimized compilation that only applies type
+// feedback and allocates registers; it skips inlining and the expensive
+// optimization passes.
 static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
                                         ParsedFunction* parsed_function,
                                         bool optimized,
+                                        bool baseline,
                                         intptr_t osr_id) {
   const Function& function = parsed_function->function();
+  ASSERT(optimized || !baseline);
+  ASSERT(!baseline || (osr_id == Isolate::kNoDeoptId));
   if (optimized && !function.IsOptimizable()) {
     return false;
   }
@@ -396,6 +467,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
   Isolate* const isolate = thread->isolate();
   CSTAT_TIMER_SCOPE(isolate, codegen_timer);
   HANDLESCOPE(isolate);
+  const int64_t start_micros = OS::GetCurrentTimeMicros();
 
   // We may reattempt compilation if the function needs to be assembled using
   // far branches on ARM and MIPS. In the else branch of the setjmp call,
@@ -426,8 +498,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         if (optimized) {
           // Extract type feedback before the graph is built, as the graph
           // builder uses it to attach it to nodes.
-          ASSERT(function.deoptimization_counter() <
-                 FLAG_deoptimization_counter_threshold);
+          ASSERT(!Compiler::HasExcessiveDeoptimization(function));
           function.RestoreICDataMap(ic_data_array);
           if (FLAG_print_ic_data_map) {
             for (intptr_t i = 0; i < ic_data_array->length(); i++) {
@@ -504,7 +575,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         FlowGraphInliner::SetInliningId(flow_graph, 0);
 
         // Inlining (mutates the flow graph)
-        if (FLAG_use_inlining) {
+        if (FLAG_use_inlining && !baseline) {
           CSTAT_TIMER_SCOPE(isolate, graphinliner_timer);
           // Propagate types to create more inlining opportunities.
           FlowGraphTypePropagator::Propagate(flow_graph);
@@ -549,7 +620,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         IfConverter::Simplify(flow_graph);
         DEBUG_ASSERT(flow_graph->VerifyUseLists());
 
-        if (FLAG_constant_propagation) {
+        if (FLAG_constant_propagation && !baseline) {
           ConstantPropagator::Optimize(flow_graph);
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
           // A canonicalization pass to remove e.g. smi checks on smi constants.
@@ -563,7 +634,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
 
         // Optimistically convert loop phis that have a single non-smi input
         // coming from the loop pre-header into smi-phis.
-        if (FLAG_loop_invariant_code_motion) {
+        if (FLAG_loop_invariant_code_motion && !baseline) {
           LICM licm(flow_graph);
           licm.OptimisticallySpecializeSmiPhis();
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
@@ -585,12 +656,13 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         optimizer.SelectRepresentations();
         DEBUG_ASSERT(flow_graph->VerifyUseLists());
 
-        if (FLAG_common_subexpression_elimination ||
-            FLAG_loop_invariant_code_motion) {
+        if (!baseline &&
+            (FLAG_common_subexpression_elimination ||
+             FLAG_loop_invariant_code_motion)) {
           flow_graph->ComputeBlockEffects();
         }
 
-        if (FLAG_common_subexpression_elimination) {
+        if (FLAG_common_subexpression_elimination && !baseline) {
           if (DominatorBasedCSE::Optimize(flow_graph)) {
             DEBUG_ASSERT(flow_graph->VerifyUseLists());
             // Do another round of CSE to take secondary effects into account:
@@ -603,7 +675,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
 
         // Run loop-invariant code motion right after load elimination since it
         // depends on the numbering of loads from the previous load-elimination.
-        if (FLAG_loop_invariant_code_motion) {
+        if (FLAG_loop_invariant_code_motion && !baseline) {
           LICM licm(flow_graph);
           licm.Optimize();
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
@@ -616,9 +688,11 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         optimizer.TryOptimizePatterns();
         DEBUG_ASSERT(flow_graph->VerifyUseLists());
 
-        DeadStoreElimination::Optimize(flow_graph);
+        if (!baseline) {
+          DeadStoreElimination::Optimize(flow_graph);
+        }
 
-        if (FLAG_range_analysis) {
+        if (FLAG_range_analysis && !baseline) {
           // Propagate types after store-load-forwarding. Some phis may have
           // become smi phis that can be processed by range analysis.
           FlowGraphTypePropagator::Propagate(flow_graph);
@@ -631,7 +705,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
         }
 
-        if (FLAG_constant_propagation) {
+        if (FLAG_constant_propagation && !baseline) {
           // Constant propagation can use information from range analysis to
           // find unreachable branch targets and eliminate branches that have
           // the same true- and false-target.
@@ -663,6 +737,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         // the deoptimization path.
         AllocationSinking* sinking = NULL;
         if (FLAG_allocation_sinking &&
+            !baseline &&
             (flow_graph->graph_entry()->SuccessorCount()  == 1)) {
           // TODO(fschneider): Support allocation sinking with try-catch.
           sinking = new AllocationSinking(flow_graph);
@@ -715,7 +790,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
       ASSERT(inline_id_to_function.length() == caller_inline_id.length());
       Assembler assembler(use_far_branches);
       FlowGraphCompiler graph_compiler(&assembler, flow_graph,
-                                       *parsed_function, optimized,
+                                       *parsed_function, optimized, baseline,
                                        inline_id_to_function,
                                        caller_inline_id);
       {
@@ -759,6 +834,9 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
         graph_compiler.FinalizeVarDescriptors(code);
         graph_compiler.FinalizeExceptionHandlers(code);
         graph_compiler.FinalizeStaticCallTargetsTable(code);
+        if (CodeObservers::WantSourcePositions()) {
+          NotifySourcePositions(function, code);
+        }
 
         if (optimized) {
           // We may not have previous code if 'always_optimize' is set.
@@ -843,6 +921,7 @@ static bool CompileParsedFunctionHelper(CompilationPipeline* pipeline,
     // Reset global isolate state.
     isolate->set_deopt_id(prev_deopt_id);
   }
+  isolate->RecordCompilation(OS::GetCurrentTimeMicros() - start_micros);
   return is_compiled;
 }
 
@@ -1003,6 +1082,7 @@ static void CheckInliningIntervals(const Function& function) {
 static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
                                        const Function& function,
                                        bool optimized,
+                                       bool baseline,
                                        intptr_t osr_id) {
   // Check that we optimize if 'Compiler::always_optimize()' is set to true,
   // except if the function is marked as not optimizable.
@@ -1035,7 +1115,8 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
     if (FLAG_trace_compiler) {
       ISL_Print("Compiling %s%sfunction: '%s' @ token %" Pd ", size %" Pd "\n",
                 (osr_id == Isolate::kNoDeoptId ? "" : "osr "),
-                (optimized ? "optimized " : ""),
+                (optimized ? (baseline ? "baseline optimized " : "optimized ")
+                           : ""),
                 function.ToFullyQualifiedCString(),
                 function.token_pos(),
                 (function.end_token_pos() - function.token_pos()));
@@ -1048,6 +1129,7 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
     const bool success = CompileParsedFunctionHelper(pipeline,
                                                      parsed_function,
                                                      optimized,
+                                                     baseline,
                                                      osr_id);
     if (!success) {
       if (optimized) {
@@ -1126,7 +1208,7 @@ RawError* Compiler::CompileFunction(Thread* thread,
   const bool optimized =
       Compiler::always_optimize() && function.IsOptimizable();
 
-  return CompileFunctionHelper(pipeline, function, optimized,
+  return CompileFunctionHelper(pipeline, function, optimized, false,
       Isolate::kNoDeoptId);
 }
 
@@ -1143,7 +1225,8 @@ RawError* Compiler::EnsureUnoptimizedCode(Thread* thread,
   CompilationPipeline* pipeline =
       CompilationPipeline::New(thread->zone(), function);
   const Error& error = Error::Handle(
-      CompileFunctionHelper(pipeline, function, false, Isolate::kNoDeoptId));
+      CompileFunctionHelper(pipeline, function, false, false,
+                            Isolate::kNoDeoptId));
   if (!error.IsNull()) {
     return error.raw();
   }
@@ -1171,7 +1254,57 @@ RawError* Compiler::CompileOptimizedFunction(Thread* thread,
 
   CompilationPipeline* pipeline =
       CompilationPipeline::New(thread->zone(), function);
-  return CompileFunctionHelper(pipeline, function, true, osr_id);
+  return CompileFunctionHelper(pipeline, function, true, false, osr_id);
+}
+
+
+RawError* Compiler::CompileBaselineOptimizedFunction(Thread* thread,
+                                                     const Function& function) {
+  Isolate* isolate = thread->isolate();
+  VMTagScope tagScope(thread, VMTag::kCompileOptimizedTagId);
+  TIMELINE_FUNCTION_COMPILATION_DURATION(isolate,
+                                         "BaselineOptimizedFunction", function);
+
+  CompilationPipeline* pipeline =
+      CompilationPipeline::New(thread->zone(), function);
+  return CompileFunctionHelper(pipeline, function, true, true,
+                               Isolate::kNoDeoptId);
+}
+
+
+bool Compiler::IsInDeoptimizationStorm(const Function& function) {
+  return function.deoptimization_counter() >=
+      FLAG_deoptimization_counter_threshold;
+}
+
+
+bool Compiler::HasExcessiveDeoptimization(const Function& function) {
+  return function.deoptimization_counter() >=
+      (FLAG_deoptimization_counter_threshold +
+       FLAG_deoptimization_storm_retries);
+}
+
+
+bool Compiler::UseBaselineTier() {
+  // The tier only pays off if it triggers before full optimization would.
+  return !always_optimize() &&
+      (FLAG_baseline_optimization_counter_threshold >= 0) &&
+      (FLAG_baseline_optimization_counter_threshold <
+       FLAG_optimization_counter_threshold);
+}
+
+
+bool Compiler::UseBaselineTier(const Function& function) {
+  if (!UseBaselineTier() ||
+      function.IsIrregexpFunction() ||
+      (function.unoptimized_code() == Code::null())) {
+    return false;
+  }
+  const Code& unoptimized_code = Code::Handle(function.unoptimized_code());
+  const PcDescriptors& descriptors =
+      PcDescriptors::Handle(unoptimized_code.pc_descriptors());
+  PcDescriptors::Iterator iter(descriptors, RawPcDescriptors::kOsrEntry);
+  return !iter.MoveNext();
 }
 
 
@@ -1185,6 +1318,7 @@ RawError* Compiler::CompileParsedFunction(
     CompileParsedFunctionHelper(&pipeline,
                                 parsed_function,
                                 false,
+                                false,
                                 Isolate::kNoDeoptId);
     if (FLAG_disassemble) {
       DisassembleCode(parsed_function->function(), false);
@@ -1300,6 +1434,7 @@ void Compiler::CompileStaticInitializer(const Field& field) {
   CompileParsedFunctionHelper(&pipeline,
                               parsed_function,
                               false,  // optimized
+                              false,  // baseline
                               Isolate::kNoDeoptId);
 
   const Function& initializer = parsed_function->function();
@@ -1332,6 +1467,7 @@ RawObject* Compiler::EvaluateStaticInitializer(const Field& field) {
       CompileParsedFunctionHelper(&pipeline,
                                   parsed_function,
                                   false,  // optimized
+                                  false,  // baseline
                                   Isolate::kNoDeoptId);
       // Eagerly create local var descriptors.
       CreateLocalVarDescriptors(*parsed_function);
@@ -1403,6 +1539,7 @@ RawObject* Compiler::ExecuteOnce(SequenceNode* fragment) {
     CompileParsedFunctionHelper(&pipeline,
                                 parsed_function,
                                 false,
+                                false,
                                 Isolate::kNoDeoptId);
 
     // Eagerly create local var descriptors.
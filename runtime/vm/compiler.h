@@ -53,6 +53,39 @@ class Compiler : public AllStatic {
       const Function& function,
       intptr_t osr_id = Isolate::kNoDeoptId);
 
+  // Generates baseline optimized code for function: type feedback is applied
+  // and registers are allocated, but inlining and the expensive optimization
+  // passes are skipped. The resulting code counts its invocations and tiers
+  // up to fully optimized code once it gets hot.
+  //
+  // Baseline code has no edge counters, and calls it specializes with type
+  // feedback no longer update their ICData, so full optimization mostly sees
+  // the feedback collected before the baseline compilation. A receiver class
+  // that baseline code has not seen deoptimizes it, and the unoptimized code
+  // then records it. The tier is therefore off unless
+  // --baseline_optimization_counter_threshold is set.
+  //
+  // Returns Error::null() if there is no compilation error.
+  static RawError* CompileBaselineOptimizedFunction(Thread* thread,
+                                                    const Function& function);
+
+  // Returns true if the function deoptimized so often that it is only
+  // optimized with speculative checks disabled.
+  static bool IsInDeoptimizationStorm(const Function& function);
+
+  // Returns true if the function kept deoptimizing even with speculative
+  // checks disabled and must not be optimized again.
+  static bool HasExcessiveDeoptimization(const Function& function);
+
+  // Returns true if warm unoptimized code should be compiled by the baseline
+  // optimizing tier before it is fully optimized.
+  static bool UseBaselineTier();
+
+  // Returns true if the baseline tier applies to function. Baseline code
+  // cannot be left by OSR, so functions whose unoptimized code has OSR entries
+  // skip the tier; otherwise a hot loop could run in baseline code forever.
+  static bool UseBaselineTier(const Function& function);
+
   // Generates code for given parsed function (without parsing it again) and
   // sets its code field.
   //
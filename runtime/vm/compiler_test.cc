@@ -4,15 +4,22 @@
 
 #include "platform/assert.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_generator.h"
 #include "vm/code_patcher.h"
 #include "vm/compiler.h"
 #include "vm/dart_api_impl.h"
+#include "vm/deopt_instructions.h"
+#include "vm/flow_graph_compiler.h"
 #include "vm/object.h"
 #include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(int, baseline_optimization_counter_threshold);
+DECLARE_FLAG(int, deoptimization_counter_threshold);
+DECLARE_FLAG(int, deoptimization_storm_retries);
+
 TEST_CASE(CompileScript) {
   const char* kScriptChars =
       "class A {\n"
@@ -69,6 +76,217 @@ TEST_CASE(CompileFunction) {
 }
 
 
+TEST_CASE(CompileBaselineOptimizedFunction) {
+  const char* kScriptChars =
+            "class A {\n"
+            "  static foo(a, b) { return a + b; }\n"
+            "}\n";
+  String& url =
+      String::Handle(String::New("dart-test:CompileBaselineOptimizedFunction"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url,
+                                              source,
+                                              RawScript::kScriptTag));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::ProcessPendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(Symbols::New("A"))));
+  EXPECT(!cls.IsNull());
+  String& function_foo_name = String::Handle(String::New("foo"));
+  Function& function_foo =
+      Function::Handle(cls.LookupStaticFunction(function_foo_name));
+  EXPECT(!function_foo.IsNull());
+  EXPECT(CompilerTest::TestCompileFunction(function_foo));
+  EXPECT(function_foo.HasCode());
+  EXPECT(!Code::Handle(function_foo.CurrentCode()).is_optimized());
+
+  const Error& error = Error::Handle(
+      Compiler::CompileBaselineOptimizedFunction(Thread::Current(),
+                                                 function_foo));
+  EXPECT(error.IsNull());
+  EXPECT(Code::Handle(function_foo.CurrentCode()).is_optimized());
+  EXPECT(function_foo.unoptimized_code() != Object::null());
+}
+
+
+static RawFunction* GetFunction(const Library& lib, const char* name) {
+  const Function& function = Function::Handle(
+      lib.LookupLocalFunction(String::Handle(Symbols::New(name))));
+  EXPECT(!function.IsNull());
+  return function.raw();
+}
+
+
+static RawICData* GetICData(const Function& function, const char* name) {
+  const Array& ic_data_array = Array::Handle(function.ic_data_array());
+  EXPECT(!ic_data_array.IsNull());
+  const String& target_name = String::Handle(Symbols::New(name));
+  ICData& ic_data = ICData::Handle();
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (ic_data.target_name() == target_name.raw()) {
+      return ic_data.raw();
+    }
+  }
+  EXPECT(false);
+  return ICData::null();
+}
+
+
+// Baseline code does not count the calls it specializes, so the type
+// feedback is frozen until a new receiver class deoptimizes it.
+TEST_CASE(BaselineOptimizedCodeTypeFeedback) {
+  const char* kScriptChars =
+      "class A { bar() => 1; }\n"
+      "class B { bar() => 2; }\n"
+      "makeA() => new A();\n"
+      "makeB() => new B();\n"
+      "foo(x) => x.bar();\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle a = Dart_Invoke(lib, NewString("makeA"), 0, NULL);
+  EXPECT_VALID(a);
+  Dart_Handle b = Dart_Invoke(lib, NewString("makeB"), 0, NULL);
+  EXPECT_VALID(b);
+  for (intptr_t i = 0; i < 3; i++) {
+    EXPECT_VALID(Dart_Invoke(lib, NewString("foo"), 1, &a));
+  }
+
+  Library& lib_handle = Library::Handle();
+  lib_handle ^= Api::UnwrapHandle(lib);
+  const Function& foo = Function::Handle(GetFunction(lib_handle, "foo"));
+  EXPECT(!Code::Handle(foo.CurrentCode()).is_optimized());
+  const ICData& ic_data = ICData::Handle(GetICData(foo, "bar"));
+  EXPECT_EQ(1, ic_data.NumberOfChecks());
+  const intptr_t count = ic_data.AggregateCount();
+  EXPECT(count > 0);
+
+  // The tier is off by default.
+  EXPECT(!Compiler::UseBaselineTier(foo));
+  const intptr_t saved_threshold = FLAG_baseline_optimization_counter_threshold;
+  FLAG_baseline_optimization_counter_threshold = 2000;
+  EXPECT(Compiler::UseBaselineTier(foo));
+  FLAG_baseline_optimization_counter_threshold = saved_threshold;
+  const Error& error = Error::Handle(
+      Compiler::CompileBaselineOptimizedFunction(Thread::Current(), foo));
+  EXPECT(error.IsNull());
+  EXPECT(Code::Handle(foo.CurrentCode()).is_optimized());
+
+  // Calls with the known receiver class stay in baseline code and are not
+  // counted.
+  for (intptr_t i = 0; i < 3; i++) {
+    EXPECT_VALID(Dart_Invoke(lib, NewString("foo"), 1, &a));
+  }
+  EXPECT(Code::Handle(foo.CurrentCode()).is_optimized());
+  EXPECT_EQ(count, ic_data.AggregateCount());
+
+  // A new receiver class deoptimizes and is recorded by unoptimized code.
+  Dart_Handle result = Dart_Invoke(lib, NewString("foo"), 1, &b);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(2, value);
+  EXPECT(!Code::Handle(foo.CurrentCode()).is_optimized());
+  EXPECT_EQ(2, ic_data.NumberOfChecks());
+}
+
+
+// Baseline code has no OSR entries, so functions with loops skip the tier.
+TEST_CASE(BaselineTierSkipsLoops) {
+  const char* kScriptChars =
+      "straight(n) => n + 1;\n"
+      "loop(n) {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < n; i++) sum += i;\n"
+      "  return sum;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle arg = Dart_NewInteger(10);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("straight"), 1, &arg));
+  EXPECT_VALID(Dart_Invoke(lib, NewString("loop"), 1, &arg));
+
+  Library& lib_handle = Library::Handle();
+  lib_handle ^= Api::UnwrapHandle(lib);
+  const Function& straight =
+      Function::Handle(GetFunction(lib_handle, "straight"));
+  const Function& loop = Function::Handle(GetFunction(lib_handle, "loop"));
+  const intptr_t saved_threshold = FLAG_baseline_optimization_counter_threshold;
+  FLAG_baseline_optimization_counter_threshold = 2000;
+  EXPECT(Compiler::UseBaselineTier(straight));
+  EXPECT(!Compiler::UseBaselineTier(loop));
+  FLAG_baseline_optimization_counter_threshold = saved_threshold;
+}
+
+
+static void DeoptimizeFunctionsOnStackNative(Dart_NativeArguments args) {
+  DeoptimizeFunctionsOnStack();
+}
+
+
+static Dart_NativeFunction DeoptimizeNativeResolver(Dart_Handle name,
+                                                    int argument_count,
+                                                    bool* auto_setup_scope) {
+  ASSERT(auto_setup_scope != NULL);
+  *auto_setup_scope = false;
+  return reinterpret_cast<Dart_NativeFunction>(
+      &DeoptimizeFunctionsOnStackNative);
+}
+
+
+// A function that keeps deoptimizing is first reoptimized without
+// speculative checks and is only given up on after the storm retries.
+TEST_CASE(DeoptimizationStorm) {
+  const char* kScriptChars =
+      "class A { bar() => 42; }\n"
+      "deopt() native 'DeoptimizeFunctionsOnStack';\n"
+      "foo(x) {\n"
+      "  deopt();\n"
+      "  return x.bar();\n"
+      "}\n"
+      "main() => foo(new A());\n";
+  Dart_Handle lib =
+      TestCase::LoadTestScript(kScriptChars, DeoptimizeNativeResolver);
+  EXPECT_VALID(lib);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+
+  Library& lib_handle = Library::Handle();
+  lib_handle ^= Api::UnwrapHandle(lib);
+  const Function& foo = Function::Handle(GetFunction(lib_handle, "foo"));
+  const ICData& ic_data = ICData::Handle(GetICData(foo, "bar"));
+  DeoptStats* stats = Isolate::Current()->deopt_stats();
+  const int64_t storms = stats->storm_count();
+  const int64_t give_ups = stats->give_up_count();
+
+  const intptr_t saved_threshold = FLAG_deoptimization_counter_threshold;
+  const intptr_t saved_retries = FLAG_deoptimization_storm_retries;
+  FLAG_deoptimization_counter_threshold = 2;
+  FLAG_deoptimization_storm_retries = 2;
+  for (intptr_t i = 1; i <= 4; i++) {
+    EXPECT(!Compiler::HasExcessiveDeoptimization(foo));
+    const Error& error = Error::Handle(
+        Compiler::CompileOptimizedFunction(Thread::Current(), foo));
+    EXPECT(error.IsNull());
+    EXPECT(Code::Handle(foo.CurrentCode()).is_optimized());
+    EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+    EXPECT(!Code::Handle(foo.CurrentCode()).is_optimized());
+    EXPECT_EQ(i, foo.deoptimization_counter());
+    const bool in_storm = (i >= 2);
+    EXPECT_EQ(in_storm, Compiler::IsInDeoptimizationStorm(foo));
+    EXPECT_EQ(!in_storm, foo.allows_hoisting_check_class());
+    EXPECT_EQ(!in_storm, foo.allows_bounds_check_generalization());
+    EXPECT_EQ(!in_storm,
+              FlowGraphCompiler::MayDeoptimizeOnReceiverMiss(foo, ic_data));
+  }
+  EXPECT(Compiler::HasExcessiveDeoptimization(foo));
+  EXPECT_EQ(storms + 1, stats->storm_count());
+  EXPECT_EQ(give_ups + 1, stats->give_up_count());
+  FLAG_deoptimization_counter_threshold = saved_threshold;
+  FLAG_deoptimization_storm_retries = saved_retries;
+}
+
+
 TEST_CASE(RegenerateAllocStubs) {
   const char* kScriptChars =
             "class A {\n"
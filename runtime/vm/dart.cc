@@ -33,6 +33,7 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, compact_timeline);
 DECLARE_FLAG(bool, complete_timeline);
 DECLARE_FLAG(bool, print_class_table);
 DECLARE_FLAG(bool, trace_isolates);
@@ -311,6 +312,8 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer, void* data) {
 
   if (FLAG_complete_timeline) {
     isolate->SetTimelineEventRecorder(new TimelineEventEndlessRecorder());
+  } else if (FLAG_compact_timeline) {
+    isolate->SetTimelineEventRecorder(new TimelineEventCompactRecorder());
   } else {
     isolate->SetTimelineEventRecorder(new TimelineEventRingRecorder());
   }
@@ -99,6 +99,7 @@ RawObject* DartEntry::InvokeFunction(const Function& function,
   ASSERT(Isolate::Current()->no_callback_scope_depth() == 0);
   ScopedIsolateStackLimits stack_limit(isolate);
   SuspendLongJumpScope suspend_long_jump_scope(isolate);
+  isolate->IncrementMutatorEpoch();
 #if defined(USING_SIMULATOR)
 #if defined(ARCH_IS_64_BIT)
   // TODO(zra): Change to intptr_t so we have only one case.
@@ -2315,6 +2315,7 @@ void Debugger::Pause(DebuggerEvent* event) {
 
   pause_event_ = event;
   obj_cache_ = new RemoteObjectCache(64);
+  isolate_->IncrementMutatorEpoch();
 
   InvokeEventHandler(event);
 
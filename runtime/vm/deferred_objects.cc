@@ -186,12 +186,28 @@ void DeferredPcMarker::Materialize(DeoptContext* deopt_context) {
 
   // Increment the deoptimization counter. This effectively increments each
   // function occurring in the optimized frame.
+  const bool was_in_storm = Compiler::IsInDeoptimizationStorm(function);
+  const bool was_excessive = Compiler::HasExcessiveDeoptimization(function);
   function.set_deoptimization_counter(function.deoptimization_counter() + 1);
   if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
     OS::PrintErr("Deoptimizing %s (count %d)\n",
         function.ToFullyQualifiedCString(),
         function.deoptimization_counter());
   }
+  DeoptStats* stats = thread->isolate()->deopt_stats();
+  if (!was_in_storm && Compiler::IsInDeoptimizationStorm(function)) {
+    // Rather than giving up on the function, reoptimize it without the
+    // speculative checks that may have caused the deoptimizations.
+    function.set_allows_hoisting_check_class(false);
+    function.set_allows_bounds_check_generalization(false);
+    stats->AddStorm();
+    if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
+      OS::PrintErr("Deoptimization storm in %s, disabling speculation\n",
+          function.ToFullyQualifiedCString());
+    }
+  } else if (!was_excessive && Compiler::HasExcessiveDeoptimization(function)) {
+    stats->AddGiveUp();
+  }
   // Clear invocation counter so that hopefully the function gets reoptimized
   // only after more feedback has been collected.
   function.set_usage_counter(0);
@@ -8,6 +8,7 @@
 #include "vm/code_patcher.h"
 #include "vm/compiler.h"
 #include "vm/intermediate_language.h"
+#include "vm/json_stream.h"
 #include "vm/locations.h"
 #include "vm/parser.h"
 #include "vm/stack_frame.h"
@@ -98,6 +99,7 @@ DeoptContext::DeoptContext(const StackFrame* frame,
     // kDestIsAllocated is used by the debugger to generate a stack trace
     // and does not signal a real deopt.
     Isolate* isolate = Isolate::Current();
+    isolate->deopt_stats()->AddDeoptimization(deopt_reason_);
     TimelineStream* compiler_stream = isolate->GetCompilerStream();
     ASSERT(compiler_stream != NULL);
     timeline_event_ = compiler_stream->StartEvent();
@@ -1300,4 +1302,40 @@ void DeoptTable::GetEntry(const Array& table,
   *reason ^= table.At(i + 2);
 }
 
+
+DeoptStats::DeoptStats()
+    : total_count_(0),
+      storm_count_(0),
+      give_up_count_(0) {
+  for (intptr_t i = 0; i < ICData::kDeoptNumReasons; i++) {
+    reason_counts_[i] = 0;
+  }
+}
+
+
+void DeoptStats::AddDeoptimization(ICData::DeoptReasonId reason) {
+  ASSERT((0 <= reason) && (reason < ICData::kDeoptNumReasons));
+  reason_counts_[reason]++;
+  total_count_++;
+}
+
+
+void DeoptStats::PrintJSON(JSONStream* stream) const {
+  JSONObject obj(stream);
+  obj.AddProperty("type", "_DeoptimizationStats");
+  obj.AddProperty64("deoptimizations", total_count_);
+  obj.AddProperty64("storms", storm_count_);
+  obj.AddProperty64("disabledFunctions", give_up_count_);
+  JSONArray reasons(&obj, "reasons");
+  for (intptr_t i = 0; i < ICData::kDeoptNumReasons; i++) {
+    if (reason_counts_[i] == 0) {
+      continue;
+    }
+    JSONObject reason(&reasons);
+    reason.AddProperty("reason",
+        DeoptReasonToCString(static_cast<ICData::DeoptReasonId>(i)));
+    reason.AddProperty64("count", reason_counts_[i]);
+  }
+}
+
 }  // namespace dart
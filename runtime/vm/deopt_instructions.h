@@ -16,6 +16,7 @@
 
 namespace dart {
 
+class JSONStream;
 class Location;
 class Value;
 class MaterializeObjectInstr;
@@ -539,6 +540,43 @@ class DeoptTable : public AllStatic {
   static const intptr_t kEntrySize = 3;
 };
 
+
+// Per-isolate deoptimization statistics, reported by the
+// _getDeoptimizationStats service RPC.
+class DeoptStats {
+ public:
+  DeoptStats();
+
+  void AddDeoptimization(ICData::DeoptReasonId reason);
+
+  // A function deoptimized often enough that it is now reoptimized with
+  // speculative checks disabled.
+  void AddStorm() { storm_count_++; }
+
+  // A function exhausted its conservative reoptimization attempts and will
+  // not be optimized again.
+  void AddGiveUp() { give_up_count_++; }
+
+  int64_t total_count() const { return total_count_; }
+  int64_t storm_count() const { return storm_count_; }
+  int64_t give_up_count() const { return give_up_count_; }
+
+  int64_t CountOf(ICData::DeoptReasonId reason) const {
+    ASSERT((0 <= reason) && (reason < ICData::kDeoptNumReasons));
+    return reason_counts_[reason];
+  }
+
+  void PrintJSON(JSONStream* stream) const;
+
+ private:
+  int64_t reason_counts_[ICData::kDeoptNumReasons];
+  int64_t total_count_;
+  int64_t storm_count_;
+  int64_t give_up_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptStats);
+};
+
 }  // namespace dart
 
 #endif  // VM_DEOPT_INSTRUCTIONS_H_
@@ -0,0 +1,594 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/dominator_tree.h"
+
+#include "vm/atomic.h"
+#include "vm/dart.h"
+#include "vm/growable_array.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/lockers.h"
+#include "vm/object.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/scavenger.h"
+#include "vm/thread_pool.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, heap_snapshot_tasks);
+
+template<typename T>
+static T* AllocateArray(intptr_t length) {
+  return reinterpret_cast<T*>(malloc(length * sizeof(T)));
+}
+
+
+// Returns the node of 'raw_obj' among the nodes sorted by address, or -1.
+static intptr_t FindNode(const uword* addresses,
+                         intptr_t num_nodes,
+                         RawObject* raw_obj) {
+  const uword addr = RawObject::ToAddr(raw_obj);
+  // Node 0 is the root.
+  intptr_t lo = 1;
+  intptr_t hi = num_nodes - 1;
+  while (lo <= hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (addresses[mid] < addr) {
+      lo = mid + 1;
+    } else if (addresses[mid] > addr) {
+      hi = mid - 1;
+    } else {
+      return mid;
+    }
+  }
+  return -1;
+}
+
+
+// Copies the old space into a compact graph: node 0 is the root, whose
+// edges are the roots of the isolate, and every object in the heap is a
+// node numbered in address order. The pages are walked by several threads,
+// first to number the nodes, then to write them with their number of edges,
+// and last to write the edges.
+class HeapGraphBuilder : public ValueObject {
+ public:
+  enum Phase {
+    kCountNodes,
+    kWriteNodes,
+    kWriteEdges,
+  };
+
+  explicit HeapGraphBuilder(Isolate* isolate)
+      : isolate_(isolate),
+        next_page_(0),
+        pending_tasks_(0),
+        num_nodes_(0),
+        addresses_(NULL),
+        sizes_(NULL),
+        first_succ_(NULL),
+        succs_(NULL) { }
+
+  ~HeapGraphBuilder() {
+    free(addresses_);
+    free(sizes_);
+    free(first_succ_);
+    free(succs_);
+  }
+
+  // Must be called with a collected heap and no safepoints.
+  void Build();
+
+  // Walks the pages handed out to this thread.
+  void WorkOnPages(Phase phase);
+
+  void TaskDone() {
+    MonitorLocker ml(&monitor_);
+    pending_tasks_--;
+    ml.Notify();
+  }
+
+  intptr_t num_nodes() const { return num_nodes_; }
+  const intptr_t* sizes() const { return sizes_; }
+  const intptr_t* first_succ() const { return first_succ_; }
+  const intptr_t* succs() const { return succs_; }
+
+  uword* TakeAddresses() {
+    uword* result = addresses_;
+    addresses_ = NULL;
+    return result;
+  }
+
+ private:
+  // Counts or writes the edges of one node.
+  class EdgeVisitor : public ObjectPointerVisitor {
+   public:
+    EdgeVisitor(Isolate* isolate, const HeapGraphBuilder* builder)
+        : ObjectPointerVisitor(isolate),
+          builder_(builder),
+          succs_(NULL),
+          count_(0) { }
+
+    void Reset(intptr_t* succs) {
+      succs_ = succs;
+      count_ = 0;
+    }
+
+    intptr_t count() const { return count_; }
+
+    virtual void VisitPointers(RawObject** first, RawObject** last) {
+      for (RawObject** current = first; current <= last; current++) {
+        RawObject* raw_obj = *current;
+        // Smis, null and other objects in the VM isolate are not nodes.
+        if (!raw_obj->IsHeapObject() || raw_obj->IsVMHeapObject()) {
+          continue;
+        }
+        ASSERT(raw_obj->IsOldObject());
+        if (succs_ != NULL) {
+          succs_[count_] = builder_->NodeOf(raw_obj);
+        }
+        count_++;
+      }
+    }
+
+   private:
+    const HeapGraphBuilder* builder_;
+    intptr_t* succs_;
+    intptr_t count_;
+  };
+
+  static int ComparePages(HeapPage* const* a, HeapPage* const* b) {
+    if ((*a)->object_start() < (*b)->object_start()) {
+      return -1;
+    } else if ((*a)->object_start() > (*b)->object_start()) {
+      return 1;
+    }
+    return 0;
+  }
+
+  intptr_t NodeOf(RawObject* raw_obj) const {
+    const intptr_t node = FindNode(addresses_, num_nodes_, raw_obj);
+    ASSERT(node != -1);
+    return node;
+  }
+
+  void VisitPage(Phase phase, intptr_t page_index, EdgeVisitor* visitor);
+  void RunPhase(Phase phase);
+
+  Isolate* isolate_;
+  MallocGrowableArray<HeapPage*> pages_;
+  // The first node of each page.
+  MallocGrowableArray<intptr_t> page_first_node_;
+  uintptr_t next_page_;
+  Monitor monitor_;
+  intptr_t pending_tasks_;
+
+  intptr_t num_nodes_;
+  uword* addresses_;
+  intptr_t* sizes_;
+  intptr_t* first_succ_;
+  intptr_t* succs_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapGraphBuilder);
+};
+
+
+class RootCollector : public ObjectPointerVisitor {
+ public:
+  RootCollector(Isolate* isolate, MallocGrowableArray<RawObject*>* roots)
+      : ObjectPointerVisitor(isolate), roots_(roots) { }
+
+  virtual void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      if ((*current)->IsHeapObject() && !(*current)->IsVMHeapObject()) {
+        roots_->Add(*current);
+      }
+    }
+  }
+
+ private:
+  MallocGrowableArray<RawObject*>* roots_;
+
+  DISALLOW_COPY_AND_ASSIGN(RootCollector);
+};
+
+
+class HeapGraphTask : public ThreadPool::Task {
+ public:
+  HeapGraphTask(Isolate* isolate,
+                HeapGraphBuilder* builder,
+                HeapGraphBuilder::Phase phase)
+      : task_isolate_(isolate), builder_(builder), phase_(phase) { }
+
+  virtual void Run() {
+    Thread::EnterIsolateAsHelper(task_isolate_);
+    builder_->WorkOnPages(phase_);
+    Thread::ExitIsolateAsHelper();
+    builder_->TaskDone();
+  }
+
+ private:
+  Isolate* task_isolate_;
+  HeapGraphBuilder* builder_;
+  const HeapGraphBuilder::Phase phase_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapGraphTask);
+};
+
+
+void HeapGraphBuilder::VisitPage(Phase phase,
+                                 intptr_t page_index,
+                                 EdgeVisitor* visitor) {
+  HeapPage* page = pages_[page_index];
+  intptr_t node = page_first_node_[page_index];
+  uword addr = page->object_start();
+  while (addr < page->object_end()) {
+    RawObject* raw_obj = RawObject::FromAddr(addr);
+    const intptr_t size = raw_obj->Size();
+    addr += size;
+    if (raw_obj->IsFreeListElement()) {
+      continue;
+    }
+    switch (phase) {
+      case kCountNodes:
+        break;
+      case kWriteNodes:
+        addresses_[node] = RawObject::ToAddr(raw_obj);
+        sizes_[node] = size;
+        visitor->Reset(NULL);
+        raw_obj->VisitPointers(visitor);
+        // Turned into offsets once all nodes are written.
+        first_succ_[node + 1] = visitor->count();
+        break;
+      case kWriteEdges:
+        visitor->Reset(&succs_[first_succ_[node]]);
+        raw_obj->VisitPointers(visitor);
+        ASSERT(visitor->count() == first_succ_[node + 1] - first_succ_[node]);
+        break;
+    }
+    node++;
+  }
+  if (phase == kCountNodes) {
+    page_first_node_[page_index] = node;
+  }
+}
+
+
+void HeapGraphBuilder::WorkOnPages(Phase phase) {
+  EdgeVisitor visitor(isolate_, this);
+  while (true) {
+    const intptr_t index = AtomicOperations::FetchAndIncrement(&next_page_);
+    if (index >= pages_.length()) {
+      break;
+    }
+    VisitPage(phase, index, &visitor);
+  }
+}
+
+
+void HeapGraphBuilder::RunPhase(Phase phase) {
+  next_page_ = 0;
+  // The mutator thread walks pages too.
+  const intptr_t num_tasks = Utils::Maximum<intptr_t>(
+      Utils::Minimum<intptr_t>(FLAG_heap_snapshot_tasks, pages_.length()) - 1,
+      0);
+  pending_tasks_ = num_tasks;
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    Dart::thread_pool()->Run(new HeapGraphTask(isolate_, this, phase));
+  }
+  WorkOnPages(phase);
+  MonitorLocker ml(&monitor_);
+  while (pending_tasks_ > 0) {
+    ml.Wait();
+  }
+}
+
+
+void HeapGraphBuilder::Build() {
+  // The roots are collected first, the isolate has its own iteration scope
+  // for them.
+  MallocGrowableArray<RawObject*> roots;
+  {
+    RootCollector collector(isolate_, &roots);
+    isolate_->IterateObjectPointers(&collector, false, false);
+  }
+
+  // Keeps the concurrent sweeper away from the pages.
+  HeapIterationScope iteration;
+  isolate_->heap()->old_space()->AddPagesTo(&pages_);
+  pages_.Sort(ComparePages);
+  for (intptr_t i = 0; i < pages_.length(); i++) {
+    page_first_node_.Add(0);
+  }
+
+  // Number the nodes. Counting leaves the number of nodes of each page in
+  // page_first_node_, which is then turned into the first node of the page.
+  RunPhase(kCountNodes);
+  intptr_t node = 1;
+  for (intptr_t i = 0; i < pages_.length(); i++) {
+    const intptr_t count = page_first_node_[i];
+    page_first_node_[i] = node;
+    node += count;
+  }
+  num_nodes_ = node;
+
+  addresses_ = AllocateArray<uword>(num_nodes_);
+  sizes_ = AllocateArray<intptr_t>(num_nodes_);
+  first_succ_ = AllocateArray<intptr_t>(num_nodes_ + 1);
+  addresses_[0] = 0;
+  sizes_[0] = 0;
+  first_succ_[0] = 0;
+  first_succ_[1] = roots.length();
+  RunPhase(kWriteNodes);
+  for (intptr_t i = 1; i <= num_nodes_; i++) {
+    first_succ_[i] += first_succ_[i - 1];
+  }
+
+  succs_ = AllocateArray<intptr_t>(first_succ_[num_nodes_]);
+  for (intptr_t i = 0; i < roots.length(); i++) {
+    succs_[i] = NodeOf(roots[i]);
+  }
+  RunPhase(kWriteEdges);
+}
+
+
+void HeapDominatorTree::ComputeDominators(intptr_t num_nodes,
+                                          const intptr_t* first_succ,
+                                          const intptr_t* succs,
+                                          intptr_t* idom) {
+  ASSERT(num_nodes > 0);
+  // Number the reachable nodes in depth first preorder. From here on nodes
+  // are named by their preorder number.
+  intptr_t* preorder = AllocateArray<intptr_t>(num_nodes);
+  intptr_t* vertex = AllocateArray<intptr_t>(num_nodes);
+  intptr_t* parent = AllocateArray<intptr_t>(num_nodes);
+  for (intptr_t v = 0; v < num_nodes; v++) {
+    preorder[v] = -1;
+  }
+  intptr_t count = 0;
+  {
+    // Pairs of node and next edge to follow.
+    MallocGrowableArray<intptr_t> stack;
+    preorder[0] = count;
+    vertex[count] = 0;
+    parent[count] = 0;
+    count++;
+    stack.Add(0);
+    stack.Add(first_succ[0]);
+    while (!stack.is_empty()) {
+      const intptr_t v = stack[stack.length() - 2];
+      const intptr_t edge = stack.Last();
+      if (edge == first_succ[v + 1]) {
+        stack.RemoveLast();
+        stack.RemoveLast();
+        continue;
+      }
+      stack.Last() = edge + 1;
+      const intptr_t w = succs[edge];
+      if (preorder[w] == -1) {
+        preorder[w] = count;
+        vertex[count] = w;
+        parent[count] = preorder[v];
+        count++;
+        stack.Add(w);
+        stack.Add(first_succ[w]);
+      }
+    }
+  }
+
+  // The predecessors of each reachable node.
+  intptr_t* first_pred = AllocateArray<intptr_t>(count + 1);
+  for (intptr_t i = 0; i <= count; i++) {
+    first_pred[i] = 0;
+  }
+  for (intptr_t i = 0; i < count; i++) {
+    const intptr_t v = vertex[i];
+    for (intptr_t edge = first_succ[v]; edge < first_succ[v + 1]; edge++) {
+      first_pred[preorder[succs[edge]] + 1]++;
+    }
+  }
+  for (intptr_t i = 1; i <= count; i++) {
+    first_pred[i] += first_pred[i - 1];
+  }
+  intptr_t* preds = AllocateArray<intptr_t>(first_pred[count]);
+  intptr_t* next_pred = AllocateArray<intptr_t>(count);
+  for (intptr_t i = 0; i < count; i++) {
+    next_pred[i] = first_pred[i];
+  }
+  for (intptr_t i = 0; i < count; i++) {
+    const intptr_t v = vertex[i];
+    for (intptr_t edge = first_succ[v]; edge < first_succ[v + 1]; edge++) {
+      preds[next_pred[preorder[succs[edge]]]++] = i;
+    }
+  }
+  free(next_pred);
+
+  // Semidominators, as in Lengauer-Tarjan with simple path compression.
+  intptr_t* semi = AllocateArray<intptr_t>(count);
+  intptr_t* label = AllocateArray<intptr_t>(count);
+  intptr_t* ancestor = AllocateArray<intptr_t>(count);
+  for (intptr_t i = 0; i < count; i++) {
+    semi[i] = i;
+    label[i] = i;
+    ancestor[i] = -1;
+  }
+  MallocGrowableArray<intptr_t> path;
+  for (intptr_t w = count - 1; w > 0; w--) {
+    for (intptr_t p = first_pred[w]; p < first_pred[w + 1]; p++) {
+      intptr_t u = preds[p];
+      if (ancestor[u] != -1) {
+        // Compress the path from u to the root of its tree in the forest,
+        // starting next to that root.
+        path.Clear();
+        for (intptr_t x = u; ancestor[ancestor[x]] != -1; x = ancestor[x]) {
+          path.Add(x);
+        }
+        for (intptr_t j = path.length() - 1; j >= 0; j--) {
+          const intptr_t x = path[j];
+          const intptr_t a = ancestor[x];
+          if (semi[label[a]] < semi[label[x]]) {
+            label[x] = label[a];
+          }
+          ancestor[x] = ancestor[a];
+        }
+        u = label[u];
+      }
+      if (semi[u] < semi[w]) {
+        semi[w] = semi[u];
+      }
+    }
+    ancestor[w] = parent[w];
+  }
+  free(label);
+  free(ancestor);
+  free(preds);
+  free(first_pred);
+
+  // The immediate dominator is the nearest common ancestor of the parent and
+  // the semidominator in the dominator tree (semi-NCA).
+  intptr_t* dom = parent;
+  for (intptr_t w = 1; w < count; w++) {
+    intptr_t d = parent[w];
+    while (d > semi[w]) {
+      d = dom[d];
+    }
+    dom[w] = d;
+  }
+  free(semi);
+
+  for (intptr_t v = 0; v < num_nodes; v++) {
+    idom[v] = (preorder[v] == -1) ? -1 : vertex[dom[preorder[v]]];
+  }
+  free(preorder);
+  free(vertex);
+  free(dom);
+}
+
+
+HeapDominatorTree::HeapDominatorTree(intptr_t num_nodes)
+    : num_nodes_(num_nodes),
+      addresses_(NULL),
+      retained_sizes_(NULL) {
+}
+
+
+HeapDominatorTree::~HeapDominatorTree() {
+  free(addresses_);
+  free(retained_sizes_);
+}
+
+
+HeapDominatorTree* HeapDominatorTree::ForIsolate(Isolate* isolate) {
+  Heap* heap = isolate->heap();
+  // The heap drops its tree when it may have changed.
+  HeapDominatorTree* tree = heap->dominator_tree();
+  if (tree != NULL) {
+    return tree;
+  }
+  return Recompute(isolate);
+}
+
+
+HeapDominatorTree* HeapDominatorTree::Recompute(Isolate* isolate) {
+  Heap* heap = isolate->heap();
+  // Promote everything to old space and collect it, so that only reachable
+  // objects are left in the pages.
+  heap->new_space()->Evacuate();
+  heap->CollectGarbage(Heap::kOld);
+  ASSERT(heap->new_space()->UsedInWords() == 0);
+
+  NoSafepointScope no_safepoint;
+  HeapGraphBuilder builder(isolate);
+  builder.Build();
+  const intptr_t num_nodes = builder.num_nodes();
+  const intptr_t* sizes = builder.sizes();
+  intptr_t* idom = AllocateArray<intptr_t>(num_nodes);
+  ComputeDominators(num_nodes, builder.first_succ(), builder.succs(), idom);
+
+  // The children of each node in the dominator tree.
+  intptr_t* first_child = AllocateArray<intptr_t>(num_nodes + 1);
+  for (intptr_t v = 0; v <= num_nodes; v++) {
+    first_child[v] = 0;
+  }
+  for (intptr_t v = 1; v < num_nodes; v++) {
+    if (idom[v] != -1) {
+      first_child[idom[v] + 1]++;
+    }
+  }
+  for (intptr_t v = 1; v <= num_nodes; v++) {
+    first_child[v] += first_child[v - 1];
+  }
+  intptr_t* children = AllocateArray<intptr_t>(first_child[num_nodes]);
+  intptr_t* next_child = AllocateArray<intptr_t>(num_nodes);
+  for (intptr_t v = 0; v < num_nodes; v++) {
+    next_child[v] = first_child[v];
+  }
+  for (intptr_t v = 1; v < num_nodes; v++) {
+    if (idom[v] != -1) {
+      children[next_child[idom[v]]++] = v;
+    }
+  }
+
+  // Walk the dominator tree depth first.
+  MallocGrowableArray<intptr_t> order(num_nodes);
+  {
+    for (intptr_t v = 0; v < num_nodes; v++) {
+      next_child[v] = first_child[v];
+    }
+    MallocGrowableArray<intptr_t> stack;
+    stack.Add(0);
+    order.Add(0);
+    while (!stack.is_empty()) {
+      const intptr_t v = stack.Last();
+      if (next_child[v] == first_child[v + 1]) {
+        stack.RemoveLast();
+        continue;
+      }
+      const intptr_t w = children[next_child[v]++];
+      order.Add(w);
+      stack.Add(w);
+    }
+  }
+  free(next_child);
+  free(children);
+  free(first_child);
+
+  HeapDominatorTree* tree = new HeapDominatorTree(num_nodes);
+  tree->addresses_ = builder.TakeAddresses();
+  intptr_t* retained = AllocateArray<intptr_t>(num_nodes);
+  for (intptr_t v = 0; v < num_nodes; v++) {
+    retained[v] = sizes[v];
+  }
+  // Children come after their dominator in the order.
+  for (intptr_t i = order.length() - 1; i > 0; i--) {
+    const intptr_t v = order[i];
+    retained[idom[v]] += retained[v];
+  }
+  tree->retained_sizes_ = retained;
+  free(idom);
+
+  heap->set_dominator_tree(tree);
+  return tree;
+}
+
+
+intptr_t HeapDominatorTree::NodeOf(RawObject* raw_obj) const {
+  if (!raw_obj->IsHeapObject()) {
+    return -1;
+  }
+  return FindNode(addresses_, num_nodes_, raw_obj);
+}
+
+
+intptr_t HeapDominatorTree::SizeRetainedByObject(RawObject* raw_obj) const {
+  const intptr_t node = NodeOf(raw_obj);
+  if (node == -1) {
+    return -1;
+  }
+  return retained_sizes_[node];
+}
+
+}  // namespace dart
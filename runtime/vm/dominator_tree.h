@@ -0,0 +1,67 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_DOMINATOR_TREE_H_
+#define VM_DOMINATOR_TREE_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class Isolate;
+class RawObject;
+
+// The dominator tree of the object graph of an isolate, reduced to the
+// retained size of every object.
+//
+// Computing the tree costs about as much as a heap snapshot: the heap is
+// collected, its pages are copied into a compact graph by several threads,
+// and the dominators are found with the semi-NCA algorithm. Afterwards
+// retained sizes are answered by a binary search for as long as the heap
+// cannot have changed, i.e. until it is collected or the isolate may have
+// run Dart code (see Isolate::mutator_epoch).
+class HeapDominatorTree {
+ public:
+  ~HeapDominatorTree();
+
+  // Returns the tree of the isolate's heap, computing it if there is none
+  // or the heap may have changed since.
+  static HeapDominatorTree* ForIsolate(Isolate* isolate);
+
+  // Computes a new tree of the isolate's heap.
+  static HeapDominatorTree* Recompute(Isolate* isolate);
+
+  // The number of objects in the tree, not counting the root.
+  intptr_t num_objects() const { return num_nodes_ - 1; }
+
+  // The number of bytes retained by 'raw_obj' alone, or -1 if the object
+  // was not in the heap when the tree was computed.
+  intptr_t SizeRetainedByObject(RawObject* raw_obj) const;
+
+  // Computes the immediate dominator of every node of a graph, given as the
+  // successors succs[first_succ[v]] ... succs[first_succ[v + 1] - 1] of each
+  // node v. Node 0 is the root, whose dominator is itself. Nodes not
+  // reachable from the root get -1.
+  static void ComputeDominators(intptr_t num_nodes,
+                                const intptr_t* first_succ,
+                                const intptr_t* succs,
+                                intptr_t* idom);
+
+ private:
+  explicit HeapDominatorTree(intptr_t num_nodes);
+
+  intptr_t NodeOf(RawObject* raw_obj) const;
+
+  const intptr_t num_nodes_;
+  // Node 0 is the root, all other nodes are sorted by address.
+  uword* addresses_;
+  intptr_t* retained_sizes_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapDominatorTree);
+};
+
+}  // namespace dart
+
+#endif  // VM_DOMINATOR_TREE_H_
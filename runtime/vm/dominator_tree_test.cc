@@ -0,0 +1,97 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dominator_tree.h"
+#include "vm/heap.h"
+#include "vm/object.h"
+#include "vm/object_graph.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+UNIT_TEST_CASE(ComputeDominators) {
+  // The example graph of Lengauer and Tarjan, with R, A, B, ... L as
+  // nodes 0 to 12, and an unreachable node 13 pointing into it.
+  const intptr_t kNumNodes = 14;
+  const intptr_t first_succ[kNumNodes + 1] = {
+    0, 3, 4, 7, 9, 10, 11, 12, 14, 16, 17, 18, 20, 21, 22
+  };
+  const intptr_t succs[] = {
+    1, 2, 3,  // R -> A, B, C
+    4,  // A -> D
+    1, 4, 5,  // B -> A, D, E
+    6, 7,  // C -> F, G
+    12,  // D -> L
+    8,  // E -> H
+    9,  // F -> I
+    9, 10,  // G -> I, J
+    5, 11,  // H -> E, K
+    11,  // I -> K
+    9,  // J -> I
+    0, 9,  // K -> R, I
+    8,  // L -> H
+    2,  // 13 -> B
+  };
+  intptr_t idom[kNumNodes];
+  HeapDominatorTree::ComputeDominators(kNumNodes, first_succ, succs, idom);
+  const intptr_t expected[kNumNodes] = {
+    0, 0, 0, 0, 0, 0, 3, 3, 0, 0, 7, 0, 4, -1
+  };
+  for (intptr_t i = 0; i < kNumNodes; i++) {
+    EXPECT_EQ(expected[i], idom[i]);
+  }
+}
+
+
+TEST_CASE(HeapDominatorTree) {
+  Isolate* isolate = Isolate::Current();
+  // a+->b+->c
+  // +   +
+  // |   v
+  // +-->d
+  Array& a = Array::Handle(Array::New(12, Heap::kNew));
+  Array& b = Array::Handle(Array::New(2, Heap::kOld));
+  Array& c = Array::Handle(Array::New(0, Heap::kOld));
+  Array& d = Array::Handle(Array::New(0, Heap::kOld));
+  a.SetAt(10, b);
+  b.SetAt(0, c);
+  b.SetAt(1, d);
+  a.SetAt(11, d);
+  HeapDominatorTree* tree = HeapDominatorTree::ForIsolate(isolate);
+  EXPECT(tree == HeapDominatorTree::ForIsolate(isolate));
+  const intptr_t a_size = a.raw()->Size();
+  const intptr_t b_size = b.raw()->Size();
+  const intptr_t c_size = c.raw()->Size();
+  const intptr_t d_size = d.raw()->Size();
+  EXPECT_EQ(a_size + b_size + c_size + d_size,
+            tree->SizeRetainedByObject(a.raw()));
+  // d is also reachable from a directly.
+  EXPECT_EQ(b_size + c_size, tree->SizeRetainedByObject(b.raw()));
+  EXPECT_EQ(d_size, tree->SizeRetainedByObject(d.raw()));
+  {
+    ObjectGraph graph(isolate);
+    EXPECT_EQ(graph.SizeRetainedByInstance(b),
+              tree->SizeRetainedByObject(b.raw()));
+  }
+  EXPECT_EQ(-1, tree->SizeRetainedByObject(Object::null()));
+  const Array& e = Array::Handle(Array::New(0, Heap::kNew));
+  EXPECT_EQ(-1, tree->SizeRetainedByObject(e.raw()));
+
+  // A collection makes the tree stale.
+  isolate->heap()->CollectAllGarbage();
+  EXPECT(isolate->heap()->dominator_tree() == NULL);
+  tree = HeapDominatorTree::ForIsolate(isolate);
+  EXPECT_EQ(e.raw()->Size(), tree->SizeRetainedByObject(e.raw()));
+
+  // So does running Dart code, which may have changed the heap.
+  a.SetAt(11, Object::null_object());
+  EXPECT(tree == HeapDominatorTree::ForIsolate(isolate));
+  isolate->IncrementMutatorEpoch();
+  EXPECT(isolate->heap()->dominator_tree() == NULL);
+  tree = HeapDominatorTree::ForIsolate(isolate);
+  EXPECT_EQ(b_size + c_size + d_size, tree->SizeRetainedByObject(b.raw()));
+}
+
+}  // namespace dart
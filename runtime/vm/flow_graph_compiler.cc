@@ -32,6 +32,9 @@ DEFINE_FLAG(bool, always_megamorphic_calls, false,
     "Instance call always as megamorphic.");
 DEFINE_FLAG(bool, enable_simd_inline, true,
     "Enable inlining of SIMD related method calls.");
+DEFINE_FLAG(int, max_sorted_polymorphic_checks, 12,
+    "Dispatch inline on up to this many receiver classes, sorted by class id, "
+    "before falling back to the megamorphic cache.");
 DEFINE_FLAG(int, min_optimization_counter_threshold, 5000,
     "The minimum invocation count for a function.");
 DEFINE_FLAG(int, optimization_counter_scale, 2000,
@@ -44,6 +47,7 @@ DEFINE_FLAG(bool, trace_inlining_intervals, false,
     "Inlining interval diagnostics");
 DEFINE_FLAG(bool, use_megamorphic_stub, true, "Out of line megamorphic lookup");
 
+DECLARE_FLAG(int, baseline_optimization_counter_threshold);
 DECLARE_FLAG(bool, code_comments);
 DECLARE_FLAG(bool, deoptimize_alot);
 DECLARE_FLAG(int, deoptimize_every);
@@ -160,6 +164,7 @@ FlowGraphCompiler::FlowGraphCompiler(
     FlowGraph* flow_graph,
     const ParsedFunction& parsed_function,
     bool is_optimizing,
+    bool is_baseline,
     const GrowableArray<const Function*>& inline_id_to_function,
     const GrowableArray<intptr_t>& caller_inline_id)
       : isolate_(Isolate::Current()),
@@ -177,6 +182,7 @@ FlowGraphCompiler::FlowGraphCompiler(
         static_calls_target_table_(GrowableObjectArray::ZoneHandle(
             GrowableObjectArray::New())),
         is_optimizing_(is_optimizing),
+        is_baseline_(is_baseline),
         may_reoptimize_(false),
         intrinsic_mode_(false),
         double_class_(Class::ZoneHandle(
@@ -254,6 +260,14 @@ void FlowGraphCompiler::InitCompiler() {
         if ((ic_data != NULL) && (ic_data->NumberOfUsedChecks() == 0)) {
           may_reoptimize_ = true;
         }
+        // Sorted polymorphic dispatch counts its misses, see
+        // EmitSortedPolymorphicInstanceCall.
+        if ((ic_data != NULL) &&
+            (ic_data->NumArgsTested() == 1) &&
+            (ic_data->NumberOfChecks() <=
+                FLAG_max_sorted_polymorphic_checks)) {
+          may_reoptimize_ = true;
+        }
         if (is_leaf &&
             !current->IsCheckStackOverflow() &&
             !current->IsParallelMove()) {
@@ -267,6 +281,12 @@ void FlowGraphCompiler::InitCompiler() {
       }
     }
   }
+  // Baseline code counts its invocations at entry in order to tier up. It
+  // has no edge counters and its specialized calls do not update ICData, see
+  // Compiler::CompileBaselineOptimizedFunction.
+  if (is_baseline()) {
+    may_reoptimize_ = true;
+  }
   if (is_leaf) {
     // Remove the stack overflow check at function entry.
     Instruction* first = flow_graph_.graph_entry()->normal_entry()->next();
@@ -1064,6 +1084,7 @@ void FlowGraphCompiler::GenerateInstanceCall(
     intptr_t deopt_id,
     intptr_t token_pos,
     intptr_t argument_count,
+    const Array& argument_names,
     LocationSummary* locs,
     const ICData& ic_data) {
   if (FLAG_always_megamorphic_calls) {
@@ -1101,6 +1122,13 @@ void FlowGraphCompiler::GenerateInstanceCall(
       // warning has already been issued or not.
       (!FLAG_warn_on_javascript_compatibility ||
        !ic_data.MayCheckForJSWarning())) {
+    if ((ic_data.NumArgsTested() == 1) &&
+        (ic_data.NumberOfChecks() <= FLAG_max_sorted_polymorphic_checks)) {
+      EmitSortedPolymorphicInstanceCall(ic_data, argument_count,
+                                        argument_names, deopt_id,
+                                        token_pos, locs);
+      return;
+    }
     EmitMegamorphicInstanceCall(ic_data, argument_count,
                                 deopt_id, token_pos, locs);
     return;
@@ -1577,6 +1605,15 @@ ParallelMoveResolver::ScratchRegisterScope::~ScratchRegisterScope() {
 }
 
 
+bool FlowGraphCompiler::MayDeoptimizeOnReceiverMiss(const Function& function,
+                                                    const ICData& ic_data) {
+  return FLAG_polymorphic_with_deopt &&
+      !ic_data.HasDeoptReason(ICData::kDeoptPolymorphicInstanceCallTestFail) &&
+      !ic_data.HasDeoptReason(ICData::kDeoptCheckClass) &&
+      !Compiler::IsInDeoptimizationStorm(function);
+}
+
+
 static int HighestCountFirst(const CidTarget* a, const CidTarget* b) {
   // Negative if 'a' should sort before 'b'.
   return b->count - a->count;
@@ -1603,6 +1640,42 @@ void FlowGraphCompiler::SortICDataByCount(const ICData& ic_data,
 }
 
 
+static int LowestCidFirst(const CidTarget* a, const CidTarget* b) {
+  // Negative if 'a' should sort before 'b'.
+  return a->cid - b->cid;
+}
+
+
+void FlowGraphCompiler::SortICDataRanges(const ICData& ic_data,
+                                         GrowableArray<CidRangeTarget>* ranges,
+                                         bool sort_by_cid) {
+  GrowableArray<CidTarget> sorted(ic_data.NumberOfChecks());
+  SortICDataByCount(ic_data, &sorted, /* drop_smi = */ true);
+  ranges->Clear();
+  if (!sort_by_cid) {
+    for (intptr_t i = 0; i < sorted.length(); i++) {
+      ranges->Add(CidRangeTarget(sorted[i].cid, sorted[i].cid,
+                                 sorted[i].target, sorted[i].count));
+    }
+    return;
+  }
+  sorted.Sort(LowestCidFirst);
+  for (intptr_t i = 0; i < sorted.length(); i++) {
+    if (!ranges->is_empty()) {
+      CidRangeTarget& last = (*ranges)[ranges->length() - 1];
+      if ((last.cid_end + 1 == sorted[i].cid) &&
+          (last.target->raw() == sorted[i].target->raw())) {
+        last.cid_end = sorted[i].cid;
+        last.count += sorted[i].count;
+        continue;
+      }
+    }
+    ranges->Add(CidRangeTarget(sorted[i].cid, sorted[i].cid,
+                               sorted[i].target, sorted[i].count));
+  }
+}
+
+
 const ICData* FlowGraphCompiler::GetOrAddInstanceCallICData(
     intptr_t deopt_id,
     const String& target_name,
@@ -1650,9 +1723,31 @@ const ICData* FlowGraphCompiler::GetOrAddStaticCallICData(
 }
 
 
+// Unoptimized code records an OSR entry at every loop stack check. Such
+// functions skip the baseline tier, see Compiler::UseBaselineTier.
+static bool HasOsrEntries(const FlowGraph& flow_graph) {
+  if (!FLAG_use_osr) {
+    return false;
+  }
+  for (BlockIterator block_it = flow_graph.reverse_postorder_iterator();
+       !block_it.Done();
+       block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current());
+         !it.Done();
+         it.Advance()) {
+      CheckStackOverflowInstr* check = it.Current()->AsCheckStackOverflow();
+      if ((check != NULL) && check->in_loop()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+
 intptr_t FlowGraphCompiler::GetOptimizationThreshold() const {
   intptr_t threshold;
-  if (is_optimizing()) {
+  if (is_optimizing() && !is_baseline()) {
     threshold = FLAG_reoptimization_counter_threshold;
   } else if (parsed_function_.function().IsIrregexpFunction()) {
     threshold = FLAG_regexp_optimization_counter_threshold;
@@ -1664,6 +1759,13 @@ intptr_t FlowGraphCompiler::GetOptimizationThreshold() const {
     if (threshold > FLAG_optimization_counter_threshold) {
       threshold = FLAG_optimization_counter_threshold;
     }
+    // Warm unoptimized code tiers up to baseline code first.
+    if (!is_optimizing() &&
+        Compiler::UseBaselineTier() &&
+        (threshold > FLAG_baseline_optimization_counter_threshold) &&
+        !HasOsrEntries(flow_graph())) {
+      threshold = FLAG_baseline_optimization_counter_threshold;
+    }
   }
   return threshold;
 }
@@ -1723,14 +1825,15 @@ void FlowGraphCompiler::EmitPolymorphicInstanceCall(
     intptr_t deopt_id,
     intptr_t token_pos,
     LocationSummary* locs) {
-  if (FLAG_polymorphic_with_deopt) {
+  if (MayDeoptimizeOnReceiverMiss(parsed_function().function(), ic_data)) {
     Label* deopt = AddDeoptStub(deopt_id,
                                 ICData::kDeoptPolymorphicInstanceCallTestFail);
     Label ok;
     EmitTestAndCall(ic_data, argument_count, argument_names,
                     deopt,  // No cid match.
                     &ok,    // Found cid.
-                    deopt_id, token_pos, locs);
+                    deopt_id, token_pos, locs,
+                    /* sort_by_cid = */ false);
     assembler()->Bind(&ok);
   } else {
     // Instead of deoptimizing, do a megamorphic call when no matching
@@ -1739,7 +1842,8 @@ void FlowGraphCompiler::EmitPolymorphicInstanceCall(
     EmitTestAndCall(ic_data, argument_count, argument_names,
                     &megamorphic,  // No cid match.
                     &ok,           // Found cid.
-                    deopt_id, token_pos, locs);
+                    deopt_id, token_pos, locs,
+                    /* sort_by_cid = */ false);
     // Fall through if last test is match.
     assembler()->Jump(&ok);
     assembler()->Bind(&megamorphic);
@@ -1750,6 +1854,35 @@ void FlowGraphCompiler::EmitPolymorphicInstanceCall(
 }
 
 
+void FlowGraphCompiler::EmitSortedPolymorphicInstanceCall(
+    const ICData& ic_data,
+    intptr_t argument_count,
+    const Array& argument_names,
+    intptr_t deopt_id,
+    intptr_t token_pos,
+    LocationSummary* locs) {
+  ASSERT(ic_data.NumArgsTested() == 1);
+  ASSERT(may_reoptimize() || flow_graph().IsCompiledForOsr());
+  Label miss, ok;
+  EmitTestAndCall(ic_data, argument_count, argument_names,
+                  &miss,  // No cid match.
+                  &ok,    // Found cid.
+                  deopt_id, token_pos, locs,
+                  /* sort_by_cid = */ true);
+  // Fall through if last test is match.
+  assembler()->Jump(&ok);
+  assembler()->Bind(&miss);
+  // New receiver classes are added to 'ic_data' by the IC stub, which also
+  // counts towards reoptimization. The reoptimized function regenerates the
+  // dispatch from the grown 'ic_data', or calls megamorphic once it has more
+  // than FLAG_max_sorted_polymorphic_checks classes.
+  EmitOptimizedInstanceCall(
+      *StubCode::OneArgOptimizedCheckInlineCache_entry(), ic_data,
+      argument_count, deopt_id, token_pos, locs);
+  assembler()->Bind(&ok);
+}
+
+
 #if defined(DEBUG)
 void FlowGraphCompiler::FrameStateUpdateWith(Instruction* instr) {
   ASSERT(!is_optimizing());
@@ -225,6 +225,24 @@ struct CidTarget {
 };
 
 
+// Receiver class ids cid_start..cid_end (inclusive) all dispatching to
+// the same target.
+struct CidRangeTarget {
+  intptr_t cid_start;
+  intptr_t cid_end;
+  Function* target;
+  intptr_t count;
+  CidRangeTarget(intptr_t cid_start_arg,
+                 intptr_t cid_end_arg,
+                 Function* target_arg,
+                 intptr_t count_arg)
+      : cid_start(cid_start_arg),
+        cid_end(cid_end_arg),
+        target(target_arg),
+        count(count_arg) {}
+};
+
+
 class FlowGraphCompiler : public ValueObject {
  private:
   class BlockInfo : public ZoneAllocated {
@@ -270,6 +288,7 @@ class FlowGraphCompiler : public ValueObject {
       FlowGraph* flow_graph,
       const ParsedFunction& parsed_function,
       bool is_optimizing,
+      bool is_baseline,
       const GrowableArray<const Function*>& inline_id_to_function,
       const GrowableArray<intptr_t>& caller_inline_id);
 
@@ -301,6 +320,9 @@ class FlowGraphCompiler : public ValueObject {
   bool CanOptimizeFunction() const;
   bool CanOSRFunction() const;
   bool is_optimizing() const { return is_optimizing_; }
+  // Baseline code is optimized code compiled without inlining and the
+  // expensive passes; it keeps counting invocations to tier up.
+  bool is_baseline() const { return is_baseline_; }
 
   void EnterIntrinsicMode();
   void ExitIntrinsicMode();
@@ -362,6 +384,7 @@ class FlowGraphCompiler : public ValueObject {
   void GenerateInstanceCall(intptr_t deopt_id,
                             intptr_t token_pos,
                             intptr_t argument_count,
+                            const Array& argument_names,
                             LocationSummary* locs,
                             const ICData& ic_data);
 
@@ -414,6 +437,17 @@ class FlowGraphCompiler : public ValueObject {
                                    intptr_t token_pos,
                                    LocationSummary* locs);
 
+  // Dispatches inline over the receiver cids of 'ic_data' sorted by cid and
+  // falls back to an IC call for other cids. The IC call records them in
+  // 'ic_data' and counts towards reoptimization, which regenerates the
+  // dispatch.
+  void EmitSortedPolymorphicInstanceCall(const ICData& ic_data,
+                                         intptr_t argument_count,
+                                         const Array& argument_names,
+                                         intptr_t deopt_id,
+                                         intptr_t token_pos,
+                                         LocationSummary* locs);
+
   void EmitMegamorphicInstanceCall(const ICData& ic_data,
                                    intptr_t argument_count,
                                    intptr_t deopt_id,
@@ -427,7 +461,8 @@ class FlowGraphCompiler : public ValueObject {
                        Label* match_found,
                        intptr_t deopt_id,
                        intptr_t token_index,
-                       LocationSummary* locs);
+                       LocationSummary* locs,
+                       bool sort_by_cid);
 
   Condition EmitEqualityRegConstCompare(Register reg,
                                         const Object& obj,
@@ -513,6 +548,21 @@ class FlowGraphCompiler : public ValueObject {
                                 GrowableArray<CidTarget>* sorted,
                                 bool drop_smi);
 
+  // Returns 'ranges' of receiver cids to test against, Smi dropped. If
+  // 'sort_by_cid' is false these are single cids in decreasing count order.
+  // Otherwise adjacent cids with the same target are merged and the ranges
+  // are in increasing cid order.
+  static void SortICDataRanges(const ICData& ic_data,
+                               GrowableArray<CidRangeTarget>* ranges,
+                               bool sort_by_cid);
+
+  // Returns true if a polymorphic call in optimized 'function' may
+  // deoptimize when the receiver class is not in 'ic_data'. Call sites that
+  // already deoptimized on a class check, and functions in a deoptimization
+  // storm, fall back to a megamorphic call instead.
+  static bool MayDeoptimizeOnReceiverMiss(const Function& function,
+                                          const ICData& ic_data);
+
   // Use in unoptimized compilation to preserve/reuse ICData.
   const ICData* GetOrAddInstanceCallICData(intptr_t deopt_id,
                                            const String& target_name,
@@ -689,6 +739,7 @@ class FlowGraphCompiler : public ValueObject {
   // separate table?
   const GrowableObjectArray& static_calls_target_table_;
   const bool is_optimizing_;
+  const bool is_baseline_;
   // Set to true if optimized code has IC calls.
   bool may_reoptimize_;
   // True while emitting intrinsic code.
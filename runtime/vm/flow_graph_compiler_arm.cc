@@ -1006,8 +1006,9 @@ void FlowGraphCompiler::EmitFrameEntry() {
     __ ldr(R7, FieldAddress(function_reg,
                             Function::usage_counter_offset()));
     // Reoptimization of an optimized function is triggered by counting in
-    // IC stubs, but not at the entry of the function.
-    if (!is_optimizing()) {
+    // IC stubs, but not at the entry of the function. Baseline code counts
+    // at entry to tier up to fully optimized code.
+    if (!is_optimizing() || is_baseline()) {
       __ add(R7, R7, Operand(1));
       __ str(R7, FieldAddress(function_reg,
                               Function::usage_counter_offset()));
@@ -1523,7 +1524,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
                                         Label* match_found,
                                         intptr_t deopt_id,
                                         intptr_t token_index,
-                                        LocationSummary* locs) {
+                                        LocationSummary* locs,
+                                        bool sort_by_cid) {
   ASSERT(is_optimizing());
   __ Comment("EmitTestAndCall");
   const Array& arguments_descriptor =
@@ -1569,8 +1571,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ Bind(&after_smi_test);
 
   ASSERT(!ic_data.IsNull() && (kNumChecks > 0));
-  GrowableArray<CidTarget> sorted(kNumChecks);
-  SortICDataByCount(ic_data, &sorted, /* drop_smi = */ true);
+  GrowableArray<CidRangeTarget> sorted(kNumChecks);
+  SortICDataRanges(ic_data, &sorted, sort_by_cid);
 
   // Value is not Smi,
   const intptr_t kSortedLen = sorted.length();
@@ -1581,13 +1583,24 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ LoadClassId(R2, R0);
   for (intptr_t i = 0; i < kSortedLen; i++) {
     const bool kIsLastCheck = (i == (kSortedLen - 1));
-    ASSERT(sorted[i].cid != kSmiCid);
+    ASSERT(sorted[i].cid_start != kSmiCid);
     Label next_test;
-    __ CompareImmediate(R2, sorted[i].cid);
-    if (kIsLastCheck) {
-      __ b(failed, NE);
+    if (sort_by_cid) {
+      // Ranges are in increasing cid order: a cid below this range cannot
+      // match any of the following ones either.
+      __ CompareImmediate(R2, sorted[i].cid_start);
+      __ b(failed, LT);
+      if (sorted[i].cid_end != sorted[i].cid_start) {
+        __ CompareImmediate(R2, sorted[i].cid_end);
+      }
+      __ b(kIsLastCheck ? failed : &next_test, GT);
     } else {
-      __ b(&next_test, NE);
+      __ CompareImmediate(R2, sorted[i].cid_start);
+      if (kIsLastCheck) {
+        __ b(failed, NE);
+      } else {
+        __ b(&next_test, NE);
+      }
     }
     // Do not use the code from the function, but let the code be patched so
     // that we can record the outgoing edges to other code.
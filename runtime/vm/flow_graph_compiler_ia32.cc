@@ -1012,8 +1012,9 @@ void FlowGraphCompiler::EmitFrameEntry() {
     entry_patch_pc_offset_ = assembler()->CodeSize();
 
     // Reoptimization of an optimized function is triggered by counting in
-    // IC stubs, but not at the entry of the function.
-    if (!is_optimizing()) {
+    // IC stubs, but not at the entry of the function. Baseline code counts
+    // at entry to tier up to fully optimized code.
+    if (!is_optimizing() || is_baseline()) {
       __ incl(FieldAddress(function_reg, Function::usage_counter_offset()));
     }
     __ cmpl(FieldAddress(function_reg, Function::usage_counter_offset()),
@@ -1509,7 +1510,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
                                         Label* match_found,
                                         intptr_t deopt_id,
                                         intptr_t token_index,
-                                        LocationSummary* locs) {
+                                        LocationSummary* locs,
+                                        bool sort_by_cid) {
   ASSERT(is_optimizing());
   __ Comment("EmitTestAndCall");
   const Array& arguments_descriptor =
@@ -1554,8 +1556,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ Bind(&after_smi_test);
 
   ASSERT(!ic_data.IsNull() && (kNumChecks > 0));
-  GrowableArray<CidTarget> sorted(kNumChecks);
-  SortICDataByCount(ic_data, &sorted, /* drop_smi = */ true);
+  GrowableArray<CidRangeTarget> sorted(kNumChecks);
+  SortICDataRanges(ic_data, &sorted, sort_by_cid);
 
   // Value is not Smi,
   // LoadValueCid(this, EDI, EAX, failed);
@@ -1567,13 +1569,24 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ LoadClassId(EDI, EAX);
   for (intptr_t i = 0; i < kSortedLen; i++) {
     const bool kIsLastCheck = (i == (kSortedLen - 1));
-    ASSERT(sorted[i].cid != kSmiCid);
+    ASSERT(sorted[i].cid_start != kSmiCid);
     Label next_test;
-    __ cmpl(EDI, Immediate(sorted[i].cid));
-    if (kIsLastCheck) {
-      __ j(NOT_EQUAL, failed);
+    if (sort_by_cid) {
+      // Ranges are in increasing cid order: a cid below this range cannot
+      // match any of the following ones either.
+      __ cmpl(EDI, Immediate(sorted[i].cid_start));
+      __ j(LESS, failed);
+      if (sorted[i].cid_end != sorted[i].cid_start) {
+        __ cmpl(EDI, Immediate(sorted[i].cid_end));
+      }
+      __ j(GREATER, kIsLastCheck ? failed : &next_test);
     } else {
-      __ j(NOT_EQUAL, &next_test);
+      __ cmpl(EDI, Immediate(sorted[i].cid_start));
+      if (kIsLastCheck) {
+        __ j(NOT_EQUAL, failed);
+      } else {
+        __ j(NOT_EQUAL, &next_test);
+      }
     }
     // Do not use the code from the function, but let the code be patched so
     // that we can record the outgoing edges to other code.
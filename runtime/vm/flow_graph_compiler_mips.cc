@@ -1021,8 +1021,9 @@ void FlowGraphCompiler::EmitFrameEntry() {
 
     __ lw(T1, FieldAddress(function_reg, Function::usage_counter_offset()));
     // Reoptimization of an optimized function is triggered by counting in
-    // IC stubs, but not at the entry of the function.
-    if (!is_optimizing()) {
+    // IC stubs, but not at the entry of the function. Baseline code counts
+    // at entry to tier up to fully optimized code.
+    if (!is_optimizing() || is_baseline()) {
       __ addiu(T1, T1, Immediate(1));
       __ sw(T1, FieldAddress(function_reg, Function::usage_counter_offset()));
     }
@@ -1544,7 +1545,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
                                         Label* match_found,
                                         intptr_t deopt_id,
                                         intptr_t token_index,
-                                        LocationSummary* locs) {
+                                        LocationSummary* locs,
+                                        bool sort_by_cid) {
   ASSERT(is_optimizing());
   __ Comment("EmitTestAndCall");
   const Array& arguments_descriptor =
@@ -1590,8 +1592,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
 
   __ Bind(&after_smi_test);
 
-  GrowableArray<CidTarget> sorted(kNumChecks);
-  SortICDataByCount(ic_data, &sorted, /* drop_smi = */ true);
+  GrowableArray<CidRangeTarget> sorted(kNumChecks);
+  SortICDataRanges(ic_data, &sorted, sort_by_cid);
 
   // Value is not Smi,
   const intptr_t kSortedLen = sorted.length();
@@ -1602,12 +1604,18 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ LoadClassId(T2, T0);
   for (intptr_t i = 0; i < kSortedLen; i++) {
     const bool kIsLastCheck = (i == (kSortedLen - 1));
-    ASSERT(sorted[i].cid != kSmiCid);
+    ASSERT(sorted[i].cid_start != kSmiCid);
     Label next_test;
-    if (kIsLastCheck) {
-      __ BranchNotEqual(T2, Immediate(sorted[i].cid), failed);
+    if (sort_by_cid) {
+      // Ranges are in increasing cid order: a cid below this range cannot
+      // match any of the following ones either.
+      __ BranchSignedLess(T2, Immediate(sorted[i].cid_start), failed);
+      __ BranchSignedGreater(T2, Immediate(sorted[i].cid_end),
+                             kIsLastCheck ? failed : &next_test);
+    } else if (kIsLastCheck) {
+      __ BranchNotEqual(T2, Immediate(sorted[i].cid_start), failed);
     } else {
-      __ BranchNotEqual(T2, Immediate(sorted[i].cid), &next_test);
+      __ BranchNotEqual(T2, Immediate(sorted[i].cid_start), &next_test);
     }
     // Do not use the code from the function, but let the code be patched so
     // that we can record the outgoing edges to other code.
@@ -0,0 +1,137 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler.h"
+#include "vm/dart_api_impl.h"
+#include "vm/dart_entry.h"
+#include "vm/flow_graph_compiler.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static RawFunction* GetFunction(const Library& lib, const char* name) {
+  const Function& function = Function::Handle(
+      lib.LookupLocalFunction(String::Handle(Symbols::New(name))));
+  EXPECT(!function.IsNull());
+  return function.raw();
+}
+
+
+TEST_CASE(SortedPolymorphicDispatchOrder) {
+  const char* kScriptChars =
+      "f() => 1;\n"
+      "g() => 2;\n";
+  Dart_Handle lib_h = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib_h);
+  Library& lib = Library::Handle();
+  lib ^= Api::UnwrapHandle(lib_h);
+  const Function& f = Function::Handle(GetFunction(lib, "f"));
+  const Function& g = Function::Handle(GetFunction(lib, "g"));
+
+  const Array& args_descriptor =
+      Array::Handle(ArgumentsDescriptor::New(1, Object::null_array()));
+  const ICData& ic_data = ICData::Handle(
+      ICData::New(f, String::Handle(Symbols::New("foo")),
+                  args_descriptor, 1, 1));
+  const intptr_t base = kNumPredefinedCids;
+  ic_data.AddReceiverCheck(base + 3, g, 5);
+  ic_data.AddReceiverCheck(base, f, 1);
+  ic_data.AddReceiverCheck(kSmiCid, f, 7);
+  ic_data.AddReceiverCheck(base + 1, f, 10);
+  ic_data.AddReceiverCheck(base + 5, f, 2);
+
+  // Sorted by cid, adjacent cids with the same target merged, Smi dropped.
+  GrowableArray<CidRangeTarget> ranges;
+  FlowGraphCompiler::SortICDataRanges(ic_data, &ranges, true);
+  EXPECT_EQ(3, ranges.length());
+  EXPECT_EQ(base, ranges[0].cid_start);
+  EXPECT_EQ(base + 1, ranges[0].cid_end);
+  EXPECT_EQ(f.raw(), ranges[0].target->raw());
+  EXPECT_EQ(11, ranges[0].count);
+  EXPECT_EQ(base + 3, ranges[1].cid_start);
+  EXPECT_EQ(base + 3, ranges[1].cid_end);
+  EXPECT_EQ(g.raw(), ranges[1].target->raw());
+  EXPECT_EQ(base + 5, ranges[2].cid_start);
+  EXPECT_EQ(base + 5, ranges[2].cid_end);
+
+  // Otherwise single cids, most frequent first.
+  FlowGraphCompiler::SortICDataRanges(ic_data, &ranges, false);
+  EXPECT_EQ(4, ranges.length());
+  const intptr_t kExpected[] = { base + 1, base + 3, base + 5, base };
+  for (intptr_t i = 0; i < ranges.length(); i++) {
+    EXPECT_EQ(kExpected[i], ranges[i].cid_start);
+    EXPECT_EQ(kExpected[i], ranges[i].cid_end);
+  }
+}
+
+
+// Receiver classes missed by a sorted dispatch are added to the ICData and
+// count towards reoptimization, which regenerates the dispatch.
+TEST_CASE(SortedPolymorphicDispatchRecordsMisses) {
+  const char* kScriptChars =
+      "class C0 { foo() => 0; }\n"
+      "class C1 { foo() => 1; }\n"
+      "class C2 { foo() => 2; }\n"
+      "class C3 { foo() => 3; }\n"
+      "class C4 { foo() => 4; }\n"
+      "class C5 { foo() => 5; }\n"
+      "dispatch(x) => x.foo();\n"
+      "objects() => [new C0(), new C1(), new C2(),\n"
+      "              new C3(), new C4(), new C5()];\n"
+      "callFirst(list, n) {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < n; i++) sum += dispatch(list[i]);\n"
+      "  return sum;\n"
+      "}\n";
+  Dart_Handle lib_h = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib_h);
+  Dart_Handle args[2];
+  args[0] = Dart_Invoke(lib_h, NewString("objects"), 0, NULL);
+  EXPECT_VALID(args[0]);
+  args[1] = Dart_NewInteger(5);
+  EXPECT_VALID(Dart_Invoke(lib_h, NewString("callFirst"), 2, args));
+
+  Library& lib = Library::Handle();
+  lib ^= Api::UnwrapHandle(lib_h);
+  const Function& dispatch = Function::Handle(GetFunction(lib, "dispatch"));
+  const Array& ic_data_array = Array::Handle(dispatch.ic_data_array());
+  EXPECT(!ic_data_array.IsNull());
+  ICData& ic_data = ICData::Handle();
+  const String& foo = String::Handle(Symbols::New("foo"));
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (ic_data.target_name() == foo.raw()) {
+      break;
+    }
+  }
+  EXPECT_EQ(foo.raw(), ic_data.target_name());
+  EXPECT_EQ(5, ic_data.NumberOfChecks());
+
+  const Error& error = Error::Handle(
+      Compiler::CompileOptimizedFunction(Thread::Current(), dispatch));
+  EXPECT(error.IsNull());
+  EXPECT(Code::Handle(dispatch.CurrentCode()).is_optimized());
+  dispatch.set_usage_counter(0);
+
+  // Known receiver classes are dispatched inline.
+  Dart_Handle result = Dart_Invoke(lib_h, NewString("callFirst"), 2, args);
+  EXPECT_VALID(result);
+  EXPECT_EQ(0, dispatch.usage_counter());
+  EXPECT_EQ(5, ic_data.NumberOfChecks());
+
+  // A new receiver class is recorded and counted.
+  args[1] = Dart_NewInteger(6);
+  result = Dart_Invoke(lib_h, NewString("callFirst"), 2, args);
+  EXPECT_VALID(result);
+  int64_t sum = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &sum));
+  EXPECT_EQ(15, sum);
+  EXPECT(Code::Handle(dispatch.CurrentCode()).is_optimized());
+  EXPECT_EQ(6, ic_data.NumberOfChecks());
+  EXPECT(dispatch.usage_counter() > 0);
+}
+
+}  // namespace dart
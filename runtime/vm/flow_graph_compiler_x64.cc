@@ -1028,8 +1028,9 @@ void FlowGraphCompiler::EmitFrameEntry() {
       entry_patch_pc_offset_ = assembler()->CodeSize();
 
       // Reoptimization of an optimized function is triggered by counting in
-      // IC stubs, but not at the entry of the function.
-      if (!is_optimizing()) {
+      // IC stubs, but not at the entry of the function. Baseline code counts
+      // at entry to tier up to fully optimized code.
+      if (!is_optimizing() || is_baseline()) {
         __ incl(FieldAddress(function_reg, Function::usage_counter_offset()));
       }
       __ cmpl(
@@ -1480,7 +1481,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
                                         Label* match_found,
                                         intptr_t deopt_id,
                                         intptr_t token_index,
-                                        LocationSummary* locs) {
+                                        LocationSummary* locs,
+                                        bool sort_by_cid) {
   ASSERT(is_optimizing());
 
   __ Comment("EmitTestAndCall");
@@ -1527,8 +1529,8 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ Bind(&after_smi_test);
 
   ASSERT(!ic_data.IsNull() && (kNumChecks > 0));
-  GrowableArray<CidTarget> sorted(kNumChecks);
-  SortICDataByCount(ic_data, &sorted, /* drop_smi = */ true);
+  GrowableArray<CidRangeTarget> sorted(kNumChecks);
+  SortICDataRanges(ic_data, &sorted, sort_by_cid);
 
   const intptr_t kSortedLen = sorted.length();
   // If kSortedLen is 0 then only a Smi check was needed; the Smi check above
@@ -1539,13 +1541,24 @@ void FlowGraphCompiler::EmitTestAndCall(const ICData& ic_data,
   __ LoadClassId(RDI, RAX);
   for (intptr_t i = 0; i < kSortedLen; i++) {
     const bool kIsLastCheck = (i == (kSortedLen - 1));
-    ASSERT(sorted[i].cid != kSmiCid);
+    ASSERT(sorted[i].cid_start != kSmiCid);
     Label next_test;
-    __ cmpl(RDI, Immediate(sorted[i].cid));
-    if (kIsLastCheck) {
-      __ j(NOT_EQUAL, failed);
+    if (sort_by_cid) {
+      // Ranges are in increasing cid order: a cid below this range cannot
+      // match any of the following ones either.
+      __ cmpl(RDI, Immediate(sorted[i].cid_start));
+      __ j(LESS, failed);
+      if (sorted[i].cid_end != sorted[i].cid_start) {
+        __ cmpl(RDI, Immediate(sorted[i].cid_end));
+      }
+      __ j(GREATER, kIsLastCheck ? failed : &next_test);
     } else {
-      __ j(NOT_EQUAL, &next_test);
+      __ cmpl(RDI, Immediate(sorted[i].cid_start));
+      if (kIsLastCheck) {
+        __ j(NOT_EQUAL, failed);
+      } else {
+        __ j(NOT_EQUAL, &next_test);
+      }
     }
     // Do not use the code from the function, but let the code be patched so
     // that we can record the outgoing edges to other code.
@@ -49,6 +49,12 @@ DEFINE_FLAG(int, inlining_constant_arguments_min_size_threshold, 60,
 DEFINE_FLAG(int, inlining_hotness, 10,
     "Inline only hotter calls, in percents (0 .. 100); "
     "default 10%: calls above-equal 10% of max-count are inlined.");
+DEFINE_FLAG(int, inlining_hot_call_site_ratio, 50,
+    "Call sites above-equal this percentage (0 .. 100) of max-count are hot "
+    "and get their size thresholds scaled by "
+    "inlining_hot_call_site_size_factor.");
+DEFINE_FLAG(int, inlining_hot_call_site_size_factor, 2,
+    "Scale the callee size thresholds of hot call sites by this factor.");
 DEFINE_FLAG(int, inlining_recursion_depth_threshold, 1,
     "Inline recursive function calls up to threshold recursion depth.");
 DEFINE_FLAG(int, max_inlined_per_depth, 500,
@@ -60,6 +66,7 @@ DEFINE_FLAG(bool, enable_inlining_annotations, false,
 DECLARE_FLAG(bool, compiler_stats);
 DECLARE_FLAG(int, deoptimization_counter_threshold);
 DECLARE_FLAG(bool, polymorphic_with_deopt);
+DECLARE_FLAG(bool, precompile_receiver_classes);
 DECLARE_FLAG(bool, print_flow_graph);
 DECLARE_FLAG(bool, print_flow_graph_optimized);
 DECLARE_FLAG(bool, verify_compiler);
@@ -214,9 +221,11 @@ class CallSites : public ValueObject {
 
   struct ClosureCallInfo {
     ClosureCallInstr* call;
+    double ratio;
     FlowGraph* caller_graph;
     ClosureCallInfo(ClosureCallInstr* value, FlowGraph* flow_graph)
         : call(value),
+          ratio(0.0),
           caller_graph(flow_graph) {}
     const Function& caller() const { return caller_graph->function(); }
   };
@@ -251,12 +260,38 @@ class CallSites : public ValueObject {
     instance_calls_.Clear();
   }
 
+  // Estimate how often 'call' was executed from the edge counters attached
+  // to the graph by the BlockScheduler. Used for calls without ICData.
+  static intptr_t EstimateCallCount(Instruction* call, FlowGraph* graph) {
+    const intptr_t entry_count = graph->graph_entry()->entry_count();
+    if (entry_count == 0) {
+      return 0;
+    }
+    BlockEntryInstr* block = call->GetBlock();
+    double weight = 0.0;
+    if (block == graph->graph_entry()->normal_entry()) {
+      weight = 1.0;
+    } else if (block->IsTargetEntry()) {
+      weight = block->AsTargetEntry()->edge_weight();
+    } else if (block->IsJoinEntry()) {
+      for (intptr_t i = 0; i < block->PredecessorCount(); ++i) {
+        GotoInstr* jump =
+            block->PredecessorAt(i)->last_instruction()->AsGoto();
+        if (jump != NULL) weight += jump->edge_weight();
+      }
+    }
+    return static_cast<intptr_t>(weight * entry_count);
+  }
+
   void ComputeCallSiteRatio(intptr_t static_call_start_ix,
-                            intptr_t instance_call_start_ix) {
+                            intptr_t instance_call_start_ix,
+                            intptr_t closure_call_start_ix) {
     const intptr_t num_static_calls =
         static_calls_.length() - static_call_start_ix;
     const intptr_t num_instance_calls =
         instance_calls_.length() - instance_call_start_ix;
+    const intptr_t num_closure_calls =
+        closure_calls_.length() - closure_call_start_ix;
 
     intptr_t max_count = 0;
     GrowableArray<intptr_t> instance_call_counts(num_instance_calls);
@@ -272,7 +307,9 @@ class CallSites : public ValueObject {
     for (intptr_t i = 0; i < num_static_calls; ++i) {
       intptr_t aggregate_count = 0;
       if (static_calls_[i + static_call_start_ix].call->ic_data() == NULL) {
-        aggregate_count = 0;
+        aggregate_count = EstimateCallCount(
+            static_calls_[i + static_call_start_ix].call,
+            static_calls_[i + static_call_start_ix].caller_graph);
       } else {
         aggregate_count =
             static_calls_[i + static_call_start_ix].
@@ -282,6 +319,15 @@ class CallSites : public ValueObject {
       if (aggregate_count > max_count) max_count = aggregate_count;
     }
 
+    GrowableArray<intptr_t> closure_call_counts(num_closure_calls);
+    for (intptr_t i = 0; i < num_closure_calls; ++i) {
+      const intptr_t aggregate_count = EstimateCallCount(
+          closure_calls_[i + closure_call_start_ix].call,
+          closure_calls_[i + closure_call_start_ix].caller_graph);
+      closure_call_counts.Add(aggregate_count);
+      if (aggregate_count > max_count) max_count = aggregate_count;
+    }
+
     // max_count can be 0 if none of the calls was executed.
     for (intptr_t i = 0; i < num_instance_calls; ++i) {
       const double ratio = (max_count == 0) ?
@@ -293,6 +339,11 @@ class CallSites : public ValueObject {
           0.0 : static_cast<double>(static_call_counts[i]) / max_count;
       static_calls_[i + static_call_start_ix].ratio = ratio;
     }
+    for (intptr_t i = 0; i < num_closure_calls; ++i) {
+      const double ratio = (max_count == 0) ?
+          0.0 : static_cast<double>(closure_call_counts[i]) / max_count;
+      closure_calls_[i + closure_call_start_ix].ratio = ratio;
+    }
   }
 
   static void RecordAllNotInlinedFunction(
@@ -348,6 +399,7 @@ class CallSites : public ValueObject {
 
     const intptr_t instance_call_start_ix = instance_calls_.length();
     const intptr_t static_call_start_ix = static_calls_.length();
+    const intptr_t closure_call_start_ix = closure_calls_.length();
     for (BlockIterator block_it = graph->postorder_iterator();
          !block_it.Done();
          block_it.Advance()) {
@@ -397,7 +449,9 @@ class CallSites : public ValueObject {
         }
       }
     }
-    ComputeCallSiteRatio(static_call_start_ix, instance_call_start_ix);
+    ComputeCallSiteRatio(static_call_start_ix,
+                         instance_call_start_ix,
+                         closure_call_start_ix);
   }
 
  private:
@@ -413,9 +467,11 @@ struct InlinedCallData {
   InlinedCallData(Definition* call,
                   GrowableArray<Value*>* arguments,
                   const Function& caller,
-                  intptr_t caller_inlining_id)
+                  intptr_t caller_inlining_id,
+                  double ratio)
       : call(call),
         arguments(arguments),
+        ratio(ratio),
         callee_graph(NULL),
         parameter_stubs(NULL),
         exit_collector(NULL),
@@ -424,6 +480,8 @@ struct InlinedCallData {
 
   Definition* call;
   GrowableArray<Value*>* arguments;
+  // Call count relative to the hottest call site at the same depth.
+  const double ratio;
   FlowGraph* callee_graph;
   ZoneGrowableArray<Definition*>* parameter_stubs;
   InlineExitCollector* exit_collector;
@@ -439,7 +497,8 @@ class PolymorphicInliner : public ValueObject {
   PolymorphicInliner(CallSiteInliner* owner,
                      PolymorphicInstanceCallInstr* call,
                      const Function& caller_function,
-                     intptr_t caller_inlining_id);
+                     intptr_t caller_inlining_id,
+                     double ratio);
 
   void Inline();
 
@@ -447,6 +506,7 @@ class PolymorphicInliner : public ValueObject {
   bool CheckInlinedDuplicate(const Function& target);
   bool CheckNonInlinedDuplicate(const Function& target);
 
+  double VariantRatio(intptr_t receiver_cid) const;
   bool TryInliningPoly(intptr_t receiver_cid, const Function& target);
   bool TryInlineRecognizedMethod(intptr_t receiver_cid, const Function& target);
 
@@ -467,6 +527,7 @@ class PolymorphicInliner : public ValueObject {
 
   const Function& caller_function_;
   const intptr_t caller_inlining_id_;
+  const double ratio_;
 };
 
 
@@ -489,6 +550,12 @@ static bool HasAnnotation(const Function& function, const char* annotation) {
 }
 
 
+static intptr_t HotCallSiteSizeFactor(double ratio) {
+  return ((ratio * 100) >= FLAG_inlining_hot_call_site_ratio) ?
+      FLAG_inlining_hot_call_site_size_factor : 1;
+}
+
+
 class CallSiteInliner : public ValueObject {
  public:
   explicit CallSiteInliner(FlowGraphInliner* inliner)
@@ -513,11 +580,13 @@ class CallSiteInliner : public ValueObject {
 
   bool trace_inlining() const { return inliner_->trace_inlining(); }
 
-  // Inlining heuristics based on Cooper et al. 2008.
+  // Inlining heuristics based on Cooper et al. 2008. The size thresholds
+  // are scaled up for call sites that are hot relative to their siblings.
   bool ShouldWeInline(const Function& callee,
                       intptr_t instr_count,
                       intptr_t call_site_count,
-                      intptr_t const_arg_count) {
+                      intptr_t const_arg_count,
+                      double ratio) {
     if (inliner_->AlwaysInline(callee)) {
       return true;
     }
@@ -525,25 +594,10 @@ class CallSiteInliner : public ValueObject {
       // Prevent methods becoming humongous and thus slow to compile.
       return false;
     }
-    if (const_arg_count > 0) {
-      if (instr_count > FLAG_inlining_constant_arguments_max_size_threshold) {
-        return false;
-      }
-    } else if (instr_count > FLAG_inlining_callee_size_threshold) {
-      return false;
-    }
-    // 'instr_count' can be 0 if it was not computed yet.
-    if ((instr_count != 0) && (instr_count <= FLAG_inlining_size_threshold)) {
-      return true;
-    }
-    if (call_site_count <= FLAG_inlining_callee_call_sites_threshold) {
-      return true;
-    }
-    if ((const_arg_count >= FLAG_inlining_constant_arguments_count) &&
-        (instr_count <= FLAG_inlining_constant_arguments_min_size_threshold)) {
-      return true;
-    }
-    return false;
+    return FlowGraphInliner::IsWithinSizeBudget(instr_count,
+                                                call_site_count,
+                                                const_arg_count,
+                                                ratio);
   }
 
   void InlineCalls() {
@@ -652,7 +706,8 @@ class CallSiteInliner : public ValueObject {
     if (!ShouldWeInline(function,
                         function.optimized_instruction_count(),
                         function.optimized_call_site_count(),
-                        constant_arguments)) {
+                        constant_arguments,
+                        call_data->ratio)) {
       TRACE_INLINING(ISL_Print("     Bailout: early heuristics with "
                                "code size:  %" Pd ", "
                                "call sites: %" Pd ", "
@@ -813,12 +868,18 @@ class CallSiteInliner : public ValueObject {
       function.set_optimized_call_site_count(call_site_count);
 
       // Use heuristics do decide if this call should be inlined.
-      if (!ShouldWeInline(function, size, call_site_count, constants_count)) {
+      if (!ShouldWeInline(function, size, call_site_count, constants_count,
+                          call_data->ratio)) {
         // If size is larger than all thresholds, don't consider it again.
-        if ((size > FLAG_inlining_size_threshold) &&
+        // Compare against the thresholds of hot call sites so that a cold
+        // call site does not prevent inlining at a hot one.
+        const intptr_t factor = HotCallSiteSizeFactor(1.0);
+        if ((size > factor * FLAG_inlining_size_threshold) &&
             (call_site_count > FLAG_inlining_callee_call_sites_threshold) &&
-            (size > FLAG_inlining_constant_arguments_min_size_threshold) &&
-            (size > FLAG_inlining_constant_arguments_max_size_threshold)) {
+            (size >
+                factor * FLAG_inlining_constant_arguments_min_size_threshold) &&
+            (size >
+                factor * FLAG_inlining_constant_arguments_max_size_threshold)) {
           function.set_is_inlinable(false);
         }
         isolate()->set_deopt_id(prev_deopt_id);
@@ -1061,7 +1122,7 @@ class CallSiteInliner : public ValueObject {
       }
       const Function& target = call->function();
       if (!inliner_->AlwaysInline(target) &&
-          (call_info[call_idx].ratio * 100) < FLAG_inlining_hotness) {
+          FlowGraphInliner::IsColdCallSite(call_info[call_idx].ratio)) {
         TRACE_INLINING(ISL_Print(
             "  => %s (deopt count %d)\n     Bailout: cold %f\n",
             target.ToCString(),
@@ -1077,7 +1138,8 @@ class CallSiteInliner : public ValueObject {
       }
       InlinedCallData call_data(
           call, &arguments, call_info[call_idx].caller(),
-          call_info[call_idx].caller_graph->inlining_id());
+          call_info[call_idx].caller_graph->inlining_id(),
+          call_info[call_idx].ratio);
       if (TryInlining(call->function(), call->argument_names(), &call_data)) {
         InlineCall(&call_data);
       }
@@ -1118,7 +1180,8 @@ class CallSiteInliner : public ValueObject {
       }
       InlinedCallData call_data(
           call, &arguments, call_info[call_idx].caller(),
-          call_info[call_idx].caller_graph->inlining_id());
+          call_info[call_idx].caller_graph->inlining_id(),
+          call_info[call_idx].ratio);
       if (TryInlining(target,
                       call->argument_names(),
                       &call_data)) {
@@ -1135,12 +1198,21 @@ class CallSiteInliner : public ValueObject {
     for (intptr_t call_idx = 0; call_idx < call_info.length(); ++call_idx) {
       PolymorphicInstanceCallInstr* call = call_info[call_idx].call;
       if (call->with_checks()) {
-        // PolymorphicInliner introduces deoptimization paths.
-        if (!FLAG_polymorphic_with_deopt) return;
+        // PolymorphicInliner introduces deoptimization paths. Where
+        // polymorphic calls must not deoptimize, it only runs with
+        // --precompile_receiver_classes, which creates these calls from the
+        // receiver class table, and falls back to a polymorphic call instead.
+        if (!FLAG_polymorphic_with_deopt) {
+          if (!FLAG_precompile_receiver_classes) return;
+        } else if (!FlowGraphCompiler::MayDeoptimizeOnReceiverMiss(
+                       caller_graph()->function(), call->ic_data())) {
+          continue;
+        }
         const Function& cl = call_info[call_idx].caller();
         intptr_t caller_inlining_id =
             call_info[call_idx].caller_graph->inlining_id();
-        PolymorphicInliner inliner(this, call, cl, caller_inlining_id);
+        PolymorphicInliner inliner(this, call, cl, caller_inlining_id,
+                                   call_info[call_idx].ratio);
         inliner.Inline();
         continue;
       }
@@ -1148,7 +1220,7 @@ class CallSiteInliner : public ValueObject {
       const ICData& ic_data = call->ic_data();
       const Function& target = Function::ZoneHandle(ic_data.GetTargetAt(0));
       if (!inliner_->AlwaysInline(target) &&
-          (call_info[call_idx].ratio * 100) < FLAG_inlining_hotness) {
+          FlowGraphInliner::IsColdCallSite(call_info[call_idx].ratio)) {
         TRACE_INLINING(ISL_Print(
             "  => %s (deopt count %d)\n     Bailout: cold %f\n",
             target.ToCString(),
@@ -1164,7 +1236,8 @@ class CallSiteInliner : public ValueObject {
       }
       InlinedCallData call_data(
           call, &arguments, call_info[call_idx].caller(),
-          call_info[call_idx].caller_graph->inlining_id());
+          call_info[call_idx].caller_graph->inlining_id(),
+          call_info[call_idx].ratio);
       if (TryInlining(target,
                       call->instance_call()->argument_names(),
                       &call_data)) {
@@ -1285,7 +1358,8 @@ class CallSiteInliner : public ValueObject {
 PolymorphicInliner::PolymorphicInliner(CallSiteInliner* owner,
                                        PolymorphicInstanceCallInstr* call,
                                        const Function& caller_function,
-                                       intptr_t caller_inlining_id)
+                                       intptr_t caller_inlining_id,
+                                       double ratio)
     : owner_(owner),
       call_(call),
       num_variants_(call->ic_data().NumberOfChecks()),
@@ -1296,7 +1370,8 @@ PolymorphicInliner::PolymorphicInliner(CallSiteInliner* owner,
       exit_collector_(new(Z)
           InlineExitCollector(owner->caller_graph(), call)),
       caller_function_(caller_function),
-      caller_inlining_id_(caller_inlining_id) {
+      caller_inlining_id_(caller_inlining_id),
+      ratio_(ratio) {
 }
 
 
@@ -1383,6 +1458,21 @@ bool PolymorphicInliner::CheckNonInlinedDuplicate(const Function& target) {
 }
 
 
+// The share of the call site's ratio that goes to the given receiver class.
+double PolymorphicInliner::VariantRatio(intptr_t receiver_cid) const {
+  const intptr_t total = call_->ic_data().AggregateCount();
+  if (total == 0) {
+    return 0.0;
+  }
+  for (intptr_t i = 0; i < variants_.length(); ++i) {
+    if (variants_[i].cid == receiver_cid) {
+      return ratio_ * static_cast<double>(variants_[i].count) / total;
+    }
+  }
+  return 0.0;
+}
+
+
 bool PolymorphicInliner::TryInliningPoly(intptr_t receiver_cid,
                                         const Function& target) {
   if (TryInlineRecognizedMethod(receiver_cid, target)) {
@@ -1396,7 +1486,8 @@ bool PolymorphicInliner::TryInliningPoly(intptr_t receiver_cid,
   }
   InlinedCallData call_data(call_, &arguments,
                             caller_function_,
-                            caller_inlining_id_);
+                            caller_inlining_id_,
+                            VariantRatio(receiver_cid));
   if (!owner_->TryInlining(target,
                            call_->instance_call()->argument_names(),
                            &call_data)) {
@@ -1469,6 +1560,10 @@ static Instruction* AppendInstruction(Instruction* first,
 
 bool PolymorphicInliner::TryInlineRecognizedMethod(intptr_t receiver_cid,
                                                    const Function& target) {
+  if (!FLAG_polymorphic_with_deopt) {
+    // The inlined recognized methods contain checks that can deoptimize.
+    return false;
+  }
   FlowGraphOptimizer optimizer(owner_->caller_graph());
   TargetEntryInstr* entry;
   Definition* last;
@@ -1521,8 +1616,9 @@ bool PolymorphicInliner::TryInlineRecognizedMethod(intptr_t receiver_cid,
 // id of the receiver and make explicit comparisons for each inlined body,
 // in frequency order.  If all variants are inlined, the entry to the last
 // inlined body is guarded by a CheckClassId instruction which can deopt.
-// If not all variants are inlined, we add a PolymorphicInstanceCall
-// instruction to handle the non-inlined variants.
+// If not all variants are inlined, or polymorphic calls must not deopt, we
+// add a PolymorphicInstanceCall instruction to handle the remaining
+// receivers.
 TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
   // Start with a fresh target entry.
   TargetEntryInstr* entry =
@@ -1547,7 +1643,8 @@ TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
   for (intptr_t i = 0; i < inlined_variants_.length(); ++i) {
     // 1. Guard the body with a class id check.
     if ((i == (inlined_variants_.length() - 1)) &&
-        non_inlined_variants_.is_empty()) {
+        non_inlined_variants_.is_empty() &&
+        FLAG_polymorphic_with_deopt) {
       // If it is the last variant use a check class id instruction which can
       // deoptimize, followed unconditionally by the body.
       RedefinitionInstr* cid_redefinition =
@@ -1668,8 +1765,9 @@ TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
     }
   }
 
-  // Handle any non-inlined variants.
-  if (!non_inlined_variants_.is_empty()) {
+  // Handle any non-inlined variants. Without deoptimization other receivers
+  // get here as well.
+  if (!non_inlined_variants_.is_empty() || !FLAG_polymorphic_with_deopt) {
     // Move push arguments of the call.
     for (intptr_t i = 0; i < call_->ArgumentCount(); ++i) {
       PushArgumentInstr* push = call_->PushArgumentAt(i);
@@ -1685,11 +1783,18 @@ TargetEntryInstr* PolymorphicInliner::BuildDecisionGraph() {
                     Array::Handle(old_checks.arguments_descriptor()),
                     old_checks.deopt_id(),
                     1));  // Number of args tested.
+    new_checks.SetDeoptReasons(old_checks.DeoptReasons());
     for (intptr_t i = 0; i < non_inlined_variants_.length(); ++i) {
       new_checks.AddReceiverCheck(non_inlined_variants_[i].cid,
                                   *non_inlined_variants_[i].target,
                                   non_inlined_variants_[i].count);
     }
+    if (new_checks.NumberOfChecks() == 0) {
+      // The call needs at least one check before its megamorphic fallback.
+      // The last inlined variant never gets here, so it is never taken.
+      const CidTarget& last = inlined_variants_.Last();
+      new_checks.AddReceiverCheck(last.cid, *last.target, last.count);
+    }
     PolymorphicInstanceCallInstr* fallback_call =
         new PolymorphicInstanceCallInstr(call_->instance_call(),
                                          new_checks,
@@ -1828,6 +1933,41 @@ static bool IsInlineableOperator(const Function& function) {
 }
 
 
+bool FlowGraphInliner::IsColdCallSite(double ratio) {
+  return (ratio * 100) < FLAG_inlining_hotness;
+}
+
+
+bool FlowGraphInliner::IsWithinSizeBudget(intptr_t instr_count,
+                                          intptr_t call_site_count,
+                                          intptr_t const_arg_count,
+                                          double ratio) {
+  const intptr_t factor = HotCallSiteSizeFactor(ratio);
+  if (const_arg_count > 0) {
+    if (instr_count >
+        factor * FLAG_inlining_constant_arguments_max_size_threshold) {
+      return false;
+    }
+  } else if (instr_count > factor * FLAG_inlining_callee_size_threshold) {
+    return false;
+  }
+  // 'instr_count' can be 0 if it was not computed yet.
+  if ((instr_count != 0) &&
+      (instr_count <= factor * FLAG_inlining_size_threshold)) {
+    return true;
+  }
+  if (call_site_count <= FLAG_inlining_callee_call_sites_threshold) {
+    return true;
+  }
+  if ((const_arg_count >= FLAG_inlining_constant_arguments_count) &&
+      (instr_count <=
+          factor * FLAG_inlining_constant_arguments_min_size_threshold)) {
+    return true;
+  }
+  return false;
+}
+
+
 bool FlowGraphInliner::AlwaysInline(const Function& function) {
   const char* kAlwaysInlineAnnotation = "AlwaysInline";
   if (FLAG_enable_inlining_annotations &&
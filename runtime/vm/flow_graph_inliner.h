@@ -29,6 +29,19 @@ class FlowGraphInliner : ValueObject {
 
   bool AlwaysInline(const Function& function);
 
+  // Returns true if a call site executed 'ratio' times as often as the
+  // hottest call site at the same depth is too cold to inline.
+  static bool IsColdCallSite(double ratio);
+
+  // Returns true if a callee with 'instr_count' instructions and
+  // 'call_site_count' calls fits the size thresholds of a call site with
+  // 'const_arg_count' constant arguments. Hot call sites, see 'ratio' above,
+  // get larger thresholds.
+  static bool IsWithinSizeBudget(intptr_t instr_count,
+                                 intptr_t call_site_count,
+                                 intptr_t const_arg_count,
+                                 double ratio);
+
   FlowGraph* flow_graph() const { return flow_graph_; }
   intptr_t NextInlineId(const Function& function, intptr_t caller_id);
 
@@ -0,0 +1,43 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/flags.h"
+#include "vm/flow_graph_inliner.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, inlining_callee_call_sites_threshold);
+DECLARE_FLAG(int, inlining_callee_size_threshold);
+DECLARE_FLAG(int, inlining_hot_call_site_size_factor);
+DECLARE_FLAG(int, inlining_size_threshold);
+
+
+// The ratios below assume the default --inlining_hotness (10%) and
+// --inlining_hot_call_site_ratio (50%).
+TEST_CASE(InliningBudgetScalesWithCallSiteFrequency) {
+  // A callee just above the size threshold of ordinary call sites that makes
+  // too many calls to be inlined for that reason alone.
+  const intptr_t size = FLAG_inlining_size_threshold + 1;
+  const intptr_t call_sites = FLAG_inlining_callee_call_sites_threshold + 1;
+  EXPECT(FlowGraphInliner::IsWithinSizeBudget(size, call_sites, 0, 1.0));
+  EXPECT(FlowGraphInliner::IsWithinSizeBudget(size, call_sites, 0, 0.5));
+  EXPECT(!FlowGraphInliner::IsWithinSizeBudget(size, call_sites, 0, 0.2));
+
+  // Small callees fit the budget of every call site.
+  EXPECT(FlowGraphInliner::IsWithinSizeBudget(1, call_sites, 0, 0.2));
+
+  // Callees above the scaled callee size threshold never fit.
+  const intptr_t huge = FLAG_inlining_hot_call_site_size_factor *
+      FLAG_inlining_callee_size_threshold + 1;
+  EXPECT(!FlowGraphInliner::IsWithinSizeBudget(huge, call_sites, 0, 1.0));
+
+  // Cold call sites are not inlined at all.
+  EXPECT(FlowGraphInliner::IsColdCallSite(0.0));
+  EXPECT(FlowGraphInliner::IsColdCallSite(0.05));
+  EXPECT(!FlowGraphInliner::IsColdCallSite(0.2));
+  EXPECT(!FlowGraphInliner::IsColdCallSite(1.0));
+}
+
+}  // namespace dart
@@ -18,6 +18,7 @@
 #include "vm/intermediate_language.h"
 #include "vm/object_store.h"
 #include "vm/parser.h"
+#include "vm/precompiler.h"
 #include "vm/resolver.h"
 #include "vm/scopes.h"
 #include "vm/stack_frame.h"
@@ -274,7 +275,29 @@ bool FlowGraphOptimizer::TryCreateICData(InstanceCallInstr* call) {
     }
   }
 
-  return false;
+  return TryCreateICDataForReceiverClasses(call);
+}
+
+
+// In precompiled mode, once all allocated classes are known, a dynamic call
+// can only reach the targets of the allocated classes responding to its
+// selector. If there are few of them, check for them directly; other
+// receivers (e.g., ones hitting noSuchMethod) take the megamorphic path.
+// The resulting polymorphic call does not deoptimize, so the inliner can
+// inline its targets.
+bool FlowGraphOptimizer::TryCreateICDataForReceiverClasses(
+    InstanceCallInstr* call) {
+  ReceiverClassTable* table = Precompiler::receiver_class_table();
+  if (!Compiler::always_optimize() || (table == NULL)) {
+    return false;
+  }
+  const ICData* ic_data =
+      table->CreateICData(*call->ic_data(), FLAG_max_polymorphic_checks);
+  if (ic_data == NULL) {
+    return false;
+  }
+  call->set_ic_data(ic_data);
+  return true;
 }
 
 
@@ -4408,7 +4431,9 @@ void FlowGraphOptimizer::VisitInstanceCall(InstanceCallInstr* instr) {
 
   if (unary_checks.NumberOfChecks() <= FLAG_max_polymorphic_checks) {
     bool call_with_checks;
-    if (has_one_target && FLAG_polymorphic_with_deopt) {
+    if (has_one_target &&
+        FlowGraphCompiler::MayDeoptimizeOnReceiverMiss(function(),
+                                                       unary_checks)) {
       // Type propagation has not run yet, we cannot eliminate the check.
       AddReceiverCheck(instr);
       // Call can still deoptimize, do not detach environment from instr.
@@ -81,6 +81,7 @@ class FlowGraphOptimizer : public FlowGraphVisitor {
  private:
   // Attempt to build ICData for call using propagated class-ids.
   bool TryCreateICData(InstanceCallInstr* call);
+  bool TryCreateICDataForReceiverClasses(InstanceCallInstr* call);
   const ICData& TrySpecializeICData(const ICData& ic_data, intptr_t cid);
 
   void SpecializePolymorphicInstanceCall(PolymorphicInstanceCallInstr* call);
@@ -4,20 +4,35 @@
 
 #include "vm/gc_sweeper.h"
 
+#include "vm/code_observers.h"
 #include "vm/freelist.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
 #include "vm/lockers.h"
+#include "vm/object.h"
 #include "vm/pages.h"
 #include "vm/thread_pool.h"
 
 namespace dart {
 
+// Tells the code observers that the instructions in a dead object are gone,
+// so that they can forget about the code before its memory is reused.
+static void NotifyUnloadedCode(RawObject* raw_obj) {
+  if (!raw_obj->IsInstructions()) {
+    return;
+  }
+  const uword base = RawObject::ToAddr(raw_obj) + Instructions::HeaderSize();
+  const intptr_t size = raw_obj->Size() - Instructions::HeaderSize();
+  CodeObservers::NotifyAllUnload(base, size);
+}
+
+
 bool GCSweeper::SweepPage(HeapPage* page, FreeList* freelist, bool locked) {
   // Keep track whether this page is still in use.
   bool in_use = false;
 
   bool is_executable = (page->type() == HeapPage::kExecutable);
+  bool notify_unload = is_executable && CodeObservers::AreActive();
   uword start = page->object_start();
   uword end = page->object_end();
   uword current = start;
@@ -31,6 +46,9 @@ bool GCSweeper::SweepPage(HeapPage* page, FreeList* freelist, bool locked) {
       obj_size = raw_obj->Size();
       in_use = true;
     } else {
+      if (notify_unload) {
+        NotifyUnloadedCode(raw_obj);
+      }
       uword free_end = current + raw_obj->Size();
       while (free_end < end) {
         RawObject* next_obj = RawObject::FromAddr(free_end);
@@ -38,6 +56,9 @@ bool GCSweeper::SweepPage(HeapPage* page, FreeList* freelist, bool locked) {
           // Reached the end of the free block.
           break;
         }
+        if (notify_unload) {
+          NotifyUnloadedCode(next_obj);
+        }
         // Expand the free block by the size of this object.
         free_end += next_obj->Size();
       }
@@ -72,6 +93,9 @@ intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
   if (raw_obj->IsMarked()) {
     raw_obj->ClearMarkBit();
     words_to_end = (raw_obj->Size() >> kWordSizeLog2);
+  } else if ((page->type() == HeapPage::kExecutable) &&
+             CodeObservers::AreActive()) {
+    NotifyUnloadedCode(raw_obj);
   }
 #ifdef DEBUG
   // String::MakeExternal and Array::MakeArray create trailing filler objects,
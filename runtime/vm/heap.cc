@@ -6,8 +6,11 @@
 
 #include "platform/assert.h"
 #include "platform/utils.h"
+#include "vm/allocation_sampler.h"
+#include "vm/dominator_tree.h"
 #include "vm/flags.h"
 #include "vm/isolate.h"
+#include "vm/json_stream.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
 #include "vm/object_set.h"
@@ -59,7 +62,11 @@ Heap::Heap(Isolate* isolate,
     new_weak_tables_[sel] = new WeakTable();
     old_weak_tables_[sel] = new WeakTable();
   }
+  allocation_sampler_ = new AllocationSampler(this);
+  dominator_tree_ = NULL;
   stats_.num_ = 0;
+  // Rates for the first collection are measured from the heap's creation.
+  stats_.after_.micros_ = OS::GetCurrentTimeMicros();
 }
 
 
@@ -70,6 +77,16 @@ Heap::~Heap() {
     delete new_weak_tables_[sel];
     delete old_weak_tables_[sel];
   }
+  delete allocation_sampler_;
+  delete dominator_tree_;
+}
+
+
+void Heap::set_dominator_tree(HeapDominatorTree* tree) {
+  if (tree != dominator_tree_) {
+    delete dominator_tree_;
+    dominator_tree_ = tree;
+  }
 }
 
 
@@ -694,6 +711,11 @@ void Heap::RecordBeforeGC(Space space, GCReason reason) {
 
 
 void Heap::RecordAfterGC() {
+  const int64_t previous_micros = stats_.after_.micros_;
+  const intptr_t previous_new_used_in_words =
+      stats_.after_.new_.used_in_words;
+  const intptr_t previous_old_used_in_words =
+      stats_.after_.old_.used_in_words;
   stats_.after_.micros_ = OS::GetCurrentTimeMicros();
   int64_t delta = stats_.after_.micros_ - stats_.before_.micros_;
   if (stats_.space_ == kNew) {
@@ -703,8 +725,13 @@ void Heap::RecordAfterGC() {
     old_space_.AddGCTime(delta);
     old_space_.IncrementCollections();
   }
+  // The collection has moved or freed objects of the dominator tree.
+  set_dominator_tree(NULL);
   stats_.after_.new_ = new_space_.GetCurrentUsage();
   stats_.after_.old_ = old_space_.GetCurrentUsage();
+  UpdateGCHistograms(previous_micros,
+                     previous_new_used_in_words,
+                     previous_old_used_in_words);
   EndGC();
   if (Service::gc_stream.enabled()) {
     ServiceEvent event(Isolate::Current(), ServiceEvent::kGC);
@@ -714,6 +741,79 @@ void Heap::RecordAfterGC() {
 }
 
 
+void Heap::UpdateGCHistograms(int64_t previous_micros,
+                              intptr_t previous_new_used_in_words,
+                              intptr_t previous_old_used_in_words) {
+  const int64_t pause = stats_.after_.micros_ - stats_.before_.micros_;
+  const SpaceUsage& old_after = stats_.after_.old_;
+  if (stats_.space_ == kNew) {
+    gc_histograms_[kScavengePause].Add(pause);
+    // Only scavenges measure the rates, otherwise the old space collection
+    // that immediately follows the scavenge of a full GC would record a
+    // meaningless rate over an interval of a few microseconds.
+    const int64_t interval = stats_.before_.micros_ - previous_micros;
+    if (interval > 0) {
+      intptr_t allocated_in_words =
+          stats_.before_.new_.used_in_words - previous_new_used_in_words;
+      // Old space usage also drops when the concurrent sweeper frees memory.
+      const intptr_t old_allocated_in_words =
+          stats_.before_.old_.used_in_words - previous_old_used_in_words;
+      if (old_allocated_in_words > 0) {
+        allocated_in_words += old_allocated_in_words;
+      }
+      const intptr_t promoted_in_words =
+          old_after.used_in_words - stats_.before_.old_.used_in_words;
+      gc_histograms_[kAllocationRate].Add(
+          static_cast<int64_t>(allocated_in_words) * kWordSize *
+          kMicrosecondsPerSecond / interval);
+      gc_histograms_[kPromotionRate].Add(
+          static_cast<int64_t>(promoted_in_words) * kWordSize *
+          kMicrosecondsPerSecond / interval);
+    }
+  } else {
+    gc_histograms_[kMarkSweepPause].Add(pause);
+    if (old_after.capacity_in_words > 0) {
+      const intptr_t free_in_words =
+          old_after.capacity_in_words - old_after.used_in_words;
+      gc_histograms_[kOldFragmentation].Add(
+          (100 * free_in_words) / old_after.capacity_in_words);
+    }
+  }
+}
+
+
+void Heap::ResetGCHistograms() {
+  for (intptr_t i = 0; i < kNumGCHistograms; i++) {
+    gc_histograms_[i].Reset();
+  }
+}
+
+
+void Heap::PrintGCHistogramsJSON(JSONStream* stream) const {
+  static const struct {
+    const char* name;
+    const char* unit;
+  } kHistograms[kNumGCHistograms] = {
+    { "heap.gc.scavenge.pause", "microsecond" },
+    { "heap.gc.marksweep.pause", "microsecond" },
+    { "heap.allocation.rate", "bytePerSecond" },
+    { "heap.promotion.rate", "bytePerSecond" },
+    { "heap.old.fragmentation", "percent" },
+  };
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "GCHistograms");
+  jsobj.AddProperty64("collections", stats_.num_);
+  JSONArray histograms(&jsobj, "histograms");
+  for (intptr_t i = 0; i < kNumGCHistograms; i++) {
+    JSONObject histogram(&histograms);
+    histogram.AddProperty("type", "Histogram");
+    histogram.AddProperty("name", kHistograms[i].name);
+    histogram.AddProperty("unit", kHistograms[i].unit);
+    gc_histograms_[i].PrintToJSONObject(&histogram);
+  }
+}
+
+
 void Heap::PrintStats() {
   if (!FLAG_verbose_gc) return;
 
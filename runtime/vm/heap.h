@@ -9,6 +9,7 @@
 #include "vm/allocation.h"
 #include "vm/flags.h"
 #include "vm/globals.h"
+#include "vm/histogram.h"
 #include "vm/pages.h"
 #include "vm/scavenger.h"
 #include "vm/spaces.h"
@@ -18,7 +19,10 @@
 namespace dart {
 
 // Forward declarations.
+class AllocationSampler;
+class HeapDominatorTree;
 class Isolate;
+class JSONStream;
 class ObjectPointerVisitor;
 class ObjectSet;
 class ServiceEvent;
@@ -42,6 +46,10 @@ class Heap {
   enum WeakSelector {
     kPeers = 0,
     kHashes,
+    kAllocationSites,
+    kICMisses,
+    kMegamorphicMisses,
+    kSelectorMisses,
     kNumWeakSelectors
   };
 
@@ -59,6 +67,16 @@ class Heap {
     kGCTestCase,
   };
 
+  // Distributions recorded over all collections of the heap.
+  enum GCHistogramKind {
+    kScavengePause = 0,  // Microseconds.
+    kMarkSweepPause,  // Microseconds.
+    kAllocationRate,  // Bytes per second between scavenges.
+    kPromotionRate,  // Bytes promoted per second between scavenges.
+    kOldFragmentation,  // Percent of old space capacity free after GC.
+    kNumGCHistograms
+  };
+
 #if defined(DEBUG)
   // Pattern for unused new space and swept old space.
   static const uint64_t kZap64Bits = 0xf3f3f3f3f3f3f3f3;
@@ -70,6 +88,15 @@ class Heap {
 
   Scavenger* new_space() { return &new_space_; }
   PageSpace* old_space() { return &old_space_; }
+  AllocationSampler* allocation_sampler() const {
+    return allocation_sampler_;
+  }
+
+  // The last dominator tree computed for this heap, or NULL if the heap may
+  // have changed since, i.e. it has been collected or the isolate's mutator
+  // epoch has moved.
+  HeapDominatorTree* dominator_tree() const { return dominator_tree_; }
+  void set_dominator_tree(HeapDominatorTree* tree);
 
   uword Allocate(intptr_t size, Space space) {
     ASSERT(!read_only_);
@@ -232,6 +259,13 @@ class Heap {
     return old_space_.PrintHeapMapToJSONStream(isolate, stream);
   }
 
+  const Histogram& gc_histogram(GCHistogramKind kind) const {
+    ASSERT((kind >= 0) && (kind < kNumGCHistograms));
+    return gc_histograms_[kind];
+  }
+  void ResetGCHistograms();
+  void PrintGCHistogramsJSON(JSONStream* stream) const;
+
   Isolate* isolate() const { return isolate_; }
 
   bool ShouldPretenure(intptr_t class_id) const;
@@ -294,6 +328,9 @@ class Heap {
   void RecordBeforeGC(Space space, GCReason reason);
   void RecordAfterGC();
   void PrintStats();
+  void UpdateGCHistograms(int64_t previous_micros,
+                          intptr_t previous_new_used_in_words,
+                          intptr_t previous_old_used_in_words);
   void UpdateClassHeapStatsBeforeGC(Heap::Space space);
   void UpdatePretenurePolicy();
 
@@ -315,8 +352,12 @@ class Heap {
   WeakTable* new_weak_tables_[kNumWeakSelectors];
   WeakTable* old_weak_tables_[kNumWeakSelectors];
 
+  AllocationSampler* allocation_sampler_;
+  HeapDominatorTree* dominator_tree_;
+
   // GC stats collection.
   GCStats stats_;
+  Histogram gc_histograms_[kNumGCHistograms];
 
   // This heap is in read-only mode: No allocation is allowed.
   bool read_only_;
@@ -0,0 +1,111 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/histogram.h"
+
+#include <math.h>  // NOLINT
+
+#include "platform/utils.h"
+#include "vm/json_stream.h"
+
+namespace dart {
+
+Histogram::Histogram() {
+  Reset();
+}
+
+
+void Histogram::Reset() {
+  count_ = 0;
+  sum_ = 0;
+  min_ = 0;
+  max_ = 0;
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    buckets_[i] = 0;
+  }
+}
+
+
+intptr_t Histogram::BucketIndex(int64_t value) {
+  if (value < kSubBucketCount) {
+    return value;
+  }
+  // Values in [2^n, 2^(n+1)) share kSubBucketCount buckets.
+  const intptr_t shift = Utils::HighestBit(value) - kSubBucketBits;
+  const intptr_t sub_bucket = (value >> shift) - kSubBucketCount;
+  return kSubBucketCount + (shift * kSubBucketCount) + sub_bucket;
+}
+
+
+int64_t Histogram::BucketUpperBound(intptr_t index) {
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const intptr_t shift = (index - kSubBucketCount) / kSubBucketCount;
+  const intptr_t sub_bucket = (index - kSubBucketCount) % kSubBucketCount;
+  return ((kSubBucketCount + sub_bucket + 1LL) << shift) - 1;
+}
+
+
+void Histogram::Add(int64_t value) {
+  const int64_t kMaxValue = (1LL << kMaxValueBits) - 1;
+  if (value < 0) {
+    value = 0;
+  } else if (value > kMaxValue) {
+    value = kMaxValue;
+  }
+  if ((count_ == 0) || (value < min_)) {
+    min_ = value;
+  }
+  if ((count_ == 0) || (value > max_)) {
+    max_ = value;
+  }
+  count_++;
+  sum_ += value;
+  buckets_[BucketIndex(value)]++;
+}
+
+
+int64_t Histogram::ValueAtPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  int64_t target = static_cast<int64_t>(ceil(percentile * count_ / 100.0));
+  if (target < 1) {
+    target = 1;
+  }
+  int64_t seen = 0;
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    seen += buckets_[i];
+    if (seen >= target) {
+      const int64_t bound = BucketUpperBound(i);
+      return (bound < max_) ? bound : max_;
+    }
+  }
+  return max_;
+}
+
+
+void Histogram::PrintToJSONObject(JSONObject* jsobj) const {
+  jsobj->AddProperty64("count", count_);
+  jsobj->AddProperty64("min", min_);
+  jsobj->AddProperty64("max", max_);
+  jsobj->AddProperty("mean", mean());
+  jsobj->AddProperty64("p50", ValueAtPercentile(50.0));
+  jsobj->AddProperty64("p90", ValueAtPercentile(90.0));
+  jsobj->AddProperty64("p99", ValueAtPercentile(99.0));
+  jsobj->AddProperty64("p999", ValueAtPercentile(99.9));
+  // The non-empty buckets as pairs of inclusive upper bound and count.
+  JSONArray buckets(jsobj, "buckets");
+  for (intptr_t i = 0; i < kNumBuckets; i++) {
+    if (buckets_[i] == 0) {
+      continue;
+    }
+    JSONArray bucket(&buckets);
+    bucket.AddValue64(BucketUpperBound(i));
+    bucket.AddValue64(buckets_[i]);
+  }
+}
+
+}  // namespace dart
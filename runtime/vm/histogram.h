@@ -0,0 +1,61 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_HISTOGRAM_H_
+#define VM_HISTOGRAM_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class JSONObject;
+
+// A histogram of non-negative values with a fixed relative precision, in the
+// style of HdrHistogram. Values are counted in buckets whose width is a
+// sixteenth of their magnitude, so any percentile is reported with an error
+// below 6.25% while adding a value is a constant time array increment.
+// Values beyond 2^48 are counted as 2^48 - 1.
+class Histogram : public ValueObject {
+ public:
+  Histogram();
+
+  void Add(int64_t value);
+  void Reset();
+
+  int64_t count() const { return count_; }
+  int64_t min() const { return min_; }
+  int64_t max() const { return max_; }
+  double mean() const {
+    return (count_ == 0) ? 0.0 : static_cast<double>(sum_) / count_;
+  }
+
+  // Returns the smallest value such that |percentile| percent of the values
+  // are less than or equal to it, rounded up to the end of its bucket.
+  int64_t ValueAtPercentile(double percentile) const;
+
+  void PrintToJSONObject(JSONObject* jsobj) const;
+
+ private:
+  static const intptr_t kSubBucketBits = 4;
+  static const intptr_t kSubBucketCount = 1 << kSubBucketBits;
+  static const intptr_t kMaxValueBits = 48;
+  static const intptr_t kNumBuckets =
+      kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketCount;
+
+  static intptr_t BucketIndex(int64_t value);
+  static int64_t BucketUpperBound(intptr_t index);
+
+  int64_t count_;
+  int64_t sum_;
+  int64_t min_;
+  int64_t max_;
+  int64_t buckets_[kNumBuckets];
+
+  DISALLOW_COPY_AND_ASSIGN(Histogram);
+};
+
+}  // namespace dart
+
+#endif  // VM_HISTOGRAM_H_
@@ -0,0 +1,58 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+
+#include "vm/globals.h"
+#include "vm/histogram.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+UNIT_TEST_CASE(Histogram_Empty) {
+  Histogram histogram;
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.ValueAtPercentile(50.0));
+  EXPECT_EQ(0, histogram.ValueAtPercentile(99.0));
+}
+
+
+UNIT_TEST_CASE(Histogram_Percentiles) {
+  Histogram histogram;
+  for (intptr_t i = 1; i <= 1000; i++) {
+    histogram.Add(i);
+  }
+  EXPECT_EQ(1000, histogram.count());
+  EXPECT_EQ(1, histogram.min());
+  EXPECT_EQ(1000, histogram.max());
+  EXPECT_FLOAT_EQ(500.5, histogram.mean(), 0.001);
+  // Small values are exact.
+  EXPECT_EQ(10, histogram.ValueAtPercentile(1.0));
+  // Larger values are within a sixteenth of the true value.
+  const int64_t p50 = histogram.ValueAtPercentile(50.0);
+  EXPECT_LE(500, p50);
+  EXPECT_LE(p50, 500 + 500 / 16);
+  const int64_t p99 = histogram.ValueAtPercentile(99.0);
+  EXPECT_LE(990, p99);
+  EXPECT_LE(p99, 1000);
+  EXPECT_EQ(1000, histogram.ValueAtPercentile(100.0));
+
+  histogram.Reset();
+  EXPECT_EQ(0, histogram.count());
+  EXPECT_EQ(0, histogram.ValueAtPercentile(99.0));
+}
+
+
+UNIT_TEST_CASE(Histogram_Clamping) {
+  Histogram histogram;
+  histogram.Add(-5);
+  histogram.Add(kMaxInt64);
+  EXPECT_EQ(2, histogram.count());
+  EXPECT_EQ(0, histogram.min());
+  EXPECT_EQ(0, histogram.ValueAtPercentile(50.0));
+  EXPECT_EQ(histogram.max(), histogram.ValueAtPercentile(100.0));
+  EXPECT_LT(0, histogram.max());
+}
+
+}  // namespace dart
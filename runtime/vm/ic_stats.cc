@@ -0,0 +1,188 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/ic_stats.h"
+
+#include "vm/growable_array.h"
+#include "vm/isolate.h"
+#include "vm/json_stream.h"
+#include "vm/object.h"
+#include "vm/weak_table.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, ic_stats, false,
+            "Count inline cache and megamorphic cache misses per call site "
+            "and selector, see the _getICStats service RPC.");
+
+
+struct ICStatsEntry {
+  RawObject* key;
+  intptr_t misses;
+  intptr_t megamorphic_misses;
+};
+
+
+static int CompareEntries(const ICStatsEntry* a, const ICStatsEntry* b) {
+  // Most misses first.
+  const intptr_t a_total = a->misses + a->megamorphic_misses;
+  const intptr_t b_total = b->misses + b->megamorphic_misses;
+  if (a_total > b_total) {
+    return -1;
+  } else if (a_total < b_total) {
+    return 1;
+  }
+  return 0;
+}
+
+
+void ICStats::Increment(Heap* heap,
+                        RawObject* raw_obj,
+                        Heap::WeakSelector sel) {
+  heap->SetWeakEntry(raw_obj, sel, heap->GetWeakEntry(raw_obj, sel) + 1);
+}
+
+
+void ICStats::RecordMiss(Isolate* isolate, const ICData& ic_data) {
+  Heap* heap = isolate->heap();
+  Increment(heap, ic_data.raw(), Heap::kICMisses);
+  Increment(heap, ic_data.target_name(), Heap::kSelectorMisses);
+}
+
+
+void ICStats::RecordMegamorphicMiss(Isolate* isolate, const ICData& ic_data) {
+  Heap* heap = isolate->heap();
+  Increment(heap, ic_data.raw(), Heap::kMegamorphicMisses);
+  Increment(heap, ic_data.target_name(), Heap::kSelectorMisses);
+}
+
+
+// Adds an entry for each object in the weak tables of |sel|, skipping
+// objects that already have one.
+static void CollectEntries(Heap* heap,
+                           Heap::WeakSelector sel,
+                           Heap::WeakSelector skip_sel,
+                           MallocGrowableArray<ICStatsEntry>* entries) {
+  const Heap::Space spaces[] = { Heap::kNew, Heap::kOld };
+  for (intptr_t i = 0; i < 2; i++) {
+    WeakTable* table = heap->GetWeakTable(spaces[i], sel);
+    for (intptr_t j = 0; j < table->size(); j++) {
+      if (!table->IsValidEntryAt(j)) {
+        continue;
+      }
+      RawObject* key = table->ObjectAt(j);
+      if ((skip_sel != sel) && (heap->GetWeakEntry(key, skip_sel) != 0)) {
+        continue;
+      }
+      ICStatsEntry entry;
+      entry.key = key;
+      entry.misses = heap->GetWeakEntry(key, Heap::kICMisses);
+      entry.megamorphic_misses =
+          heap->GetWeakEntry(key, Heap::kMegamorphicMisses);
+      entries->Add(entry);
+    }
+  }
+}
+
+
+void ICStats::PrintJSON(Isolate* isolate, JSONStream* stream, intptr_t limit) {
+  Heap* heap = isolate->heap();
+  GrowableArray<const ICData*> sites;
+  GrowableArray<intptr_t> site_misses;
+  GrowableArray<intptr_t> site_megamorphic_misses;
+  GrowableArray<const String*> selectors;
+  GrowableArray<intptr_t> selector_misses;
+  intptr_t total_misses = 0;
+  intptr_t total_megamorphic_misses = 0;
+  {
+    // Handles for the top entries are created before anything can allocate.
+    NoSafepointScope no_safepoint;
+    MallocGrowableArray<ICStatsEntry> entries;
+    CollectEntries(heap, Heap::kICMisses, Heap::kICMisses, &entries);
+    CollectEntries(heap, Heap::kMegamorphicMisses, Heap::kICMisses, &entries);
+    for (intptr_t i = 0; i < entries.length(); i++) {
+      total_misses += entries[i].misses;
+      total_megamorphic_misses += entries[i].megamorphic_misses;
+    }
+    entries.Sort(CompareEntries);
+    for (intptr_t i = 0; (i < entries.length()) && (i < limit); i++) {
+      sites.Add(&ICData::ZoneHandle(
+          reinterpret_cast<RawICData*>(entries[i].key)));
+      site_misses.Add(entries[i].misses);
+      site_megamorphic_misses.Add(entries[i].megamorphic_misses);
+    }
+
+    entries.Clear();
+    const Heap::Space spaces[] = { Heap::kNew, Heap::kOld };
+    for (intptr_t i = 0; i < 2; i++) {
+      WeakTable* table = heap->GetWeakTable(spaces[i], Heap::kSelectorMisses);
+      for (intptr_t j = 0; j < table->size(); j++) {
+        if (!table->IsValidEntryAt(j)) {
+          continue;
+        }
+        ICStatsEntry entry;
+        entry.key = table->ObjectAt(j);
+        entry.misses = table->ValueAt(j);
+        entry.megamorphic_misses = 0;
+        entries.Add(entry);
+      }
+    }
+    entries.Sort(CompareEntries);
+    for (intptr_t i = 0; (i < entries.length()) && (i < limit); i++) {
+      selectors.Add(&String::ZoneHandle(
+          reinterpret_cast<RawString*>(entries[i].key)));
+      selector_misses.Add(entries[i].misses);
+    }
+  }
+
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "ICStats");
+  jsobj.AddProperty("enabled", IsEnabled());
+  jsobj.AddProperty("misses", total_misses);
+  jsobj.AddProperty("megamorphicMisses", total_megamorphic_misses);
+  {
+    JSONArray jssites(&jsobj, "sites");
+    Function& owner = Function::Handle();
+    String& selector = String::Handle();
+    for (intptr_t i = 0; i < sites.length(); i++) {
+      const ICData& ic_data = *sites[i];
+      JSONObject jssite(&jssites);
+      jssite.AddProperty("type", "ICSite");
+      jssite.AddProperty("icData", ic_data);
+      owner = ic_data.owner();
+      jssite.AddProperty("function", owner);
+      selector = ic_data.target_name();
+      jssite.AddProperty("selector", selector.ToCString());
+      jssite.AddProperty("checks", ic_data.NumberOfChecks());
+      jssite.AddProperty("misses", site_misses[i]);
+      jssite.AddProperty("megamorphicMisses", site_megamorphic_misses[i]);
+    }
+  }
+  {
+    JSONArray jsselectors(&jsobj, "selectors");
+    for (intptr_t i = 0; i < selectors.length(); i++) {
+      JSONObject jsselector(&jsselectors);
+      jsselector.AddProperty("type", "ICSelector");
+      jsselector.AddProperty("selector", selectors[i]->ToCString());
+      jsselector.AddProperty("misses", selector_misses[i]);
+    }
+  }
+}
+
+
+void ICStats::Reset(Isolate* isolate) {
+  Heap* heap = isolate->heap();
+  const Heap::WeakSelector selectors[] = {
+    Heap::kICMisses, Heap::kMegamorphicMisses, Heap::kSelectorMisses
+  };
+  const Heap::Space spaces[] = { Heap::kNew, Heap::kOld };
+  for (intptr_t i = 0; i < 3; i++) {
+    for (intptr_t j = 0; j < 2; j++) {
+      delete heap->GetWeakTable(spaces[j], selectors[i]);
+      heap->SetWeakTable(spaces[j], selectors[i], new WeakTable());
+    }
+  }
+}
+
+}  // namespace dart
@@ -0,0 +1,51 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_IC_STATS_H_
+#define VM_IC_STATS_H_
+
+#include "vm/allocation.h"
+#include "vm/flags.h"
+#include "vm/heap.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, ic_stats);
+
+class ICData;
+class Isolate;
+class JSONStream;
+
+// Counts the inline cache and megamorphic cache misses of instance calls per
+// call site and per selector when --ic_stats is given.
+//
+// The counts are kept in weak tables of the heap keyed by the ICData of the
+// call site and by the selector symbol, so counting costs a hash table update
+// on the already slow miss path and the counts of collected code disappear
+// with it.
+class ICStats : public AllStatic {
+ public:
+  static bool IsEnabled() {
+    return FLAG_ic_stats;
+  }
+
+  // Called by the runtime when an instance call misses its inline cache.
+  static void RecordMiss(Isolate* isolate, const ICData& ic_data);
+
+  // Called by the runtime when a megamorphic call misses its cache.
+  static void RecordMegamorphicMiss(Isolate* isolate, const ICData& ic_data);
+
+  // Prints the totals and the |limit| call sites and selectors with the
+  // most misses.
+  static void PrintJSON(Isolate* isolate, JSONStream* stream, intptr_t limit);
+
+  static void Reset(Isolate* isolate);
+
+ private:
+  static void Increment(Heap* heap, RawObject* raw_obj, Heap::WeakSelector sel);
+};
+
+}  // namespace dart
+
+#endif  // VM_IC_STATS_H_
@@ -2975,18 +2975,22 @@ void InstanceCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   if (compiler->is_optimizing() && HasICData()) {
     ASSERT(HasICData());
     if (ic_data()->NumberOfUsedChecks() > 0) {
-      const ICData& unary_ic_data =
-          ICData::ZoneHandle(zone, ic_data()->AsUnaryClassChecks());
+      // Pass the original ICData: a sorted polymorphic dispatch records new
+      // receiver classes in it.
+      const ICData& original_ic_data =
+          ICData::ZoneHandle(zone, ic_data()->raw());
       compiler->GenerateInstanceCall(deopt_id(),
                                      token_pos(),
                                      ArgumentCount(),
+                                     argument_names(),
                                      locs(),
-                                     unary_ic_data);
+                                     original_ic_data);
     } else {
       // Call was not visited yet, use original ICData in order to populate it.
       compiler->GenerateInstanceCall(deopt_id(),
                                      token_pos(),
                                      ArgumentCount(),
+                                     argument_names(),
                                      locs(),
                                      *call_ic_data);
     }
@@ -3041,6 +3045,7 @@ void InstanceCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       compiler->GenerateInstanceCall(deopt_id(),
                                      token_pos(),
                                      ArgumentCount(),
+                                     argument_names(),
                                      locs(),
                                      *call_ic_data);
     }
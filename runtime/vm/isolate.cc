@@ -685,6 +685,10 @@ Isolate::Isolate(const Dart_IsolateFlags& api_flags)
       trace_buffer_(NULL),
       timeline_event_recorder_(NULL),
       profiler_data_(NULL),
+      deopt_stats_(new DeoptStats()),
+      compilations_(0),
+      compilation_micros_(0),
+      mutator_epoch_(0),
       tag_table_(GrowableObjectArray::null()),
       current_tag_(UserTag::null()),
       default_tag_(UserTag::null()),
@@ -733,6 +737,8 @@ Isolate::~Isolate() {
     delete compiler_stats_;
     compiler_stats_ = NULL;
   }
+  delete deopt_stats_;
+  deopt_stats_ = NULL;
   RemoveTimelineEventRecorder();
   delete thread_registry_;
 }
@@ -956,6 +962,12 @@ bool Isolate::GetProfilerStackBounds(uword* lower, uword* upper) const {
 }
 
 
+void Isolate::IncrementMutatorEpoch() {
+  mutator_epoch_++;
+  heap()->set_dominator_tree(NULL);
+}
+
+
 void Isolate::ScheduleInterrupts(uword interrupt_bits) {
   MutexLocker ml(mutex_);
   ASSERT((interrupt_bits & ~kInterruptsMask) == 0);  // Must fit in mask.
@@ -35,6 +35,7 @@ class CodeIndexTable;
 class CompilerStats;
 class Debugger;
 class DeoptContext;
+class DeoptStats;
 class Error;
 class ExceptionHandlers;
 class Field;
@@ -640,6 +641,24 @@ class Isolate : public BaseIsolate {
     return compiler_stats_;
   }
 
+  DeoptStats* deopt_stats() const { return deopt_stats_; }
+
+  // Called by the compiler on the mutator thread for each function it
+  // compiles.
+  void RecordCompilation(intptr_t micros) {
+    compilations_++;
+    compilation_micros_ += micros;
+  }
+  intptr_t compilations() const { return compilations_; }
+  intptr_t compilation_micros() const { return compilation_micros_; }
+
+  // Advanced whenever the isolate may run Dart code: on entry into Dart, on
+  // interrupts of running Dart code and on debugger pauses. The heap can
+  // only have been changed by Dart code if the epoch has moved, so moving it
+  // drops the dominator tree of the heap.
+  void IncrementMutatorEpoch();
+  intptr_t mutator_epoch() const { return mutator_epoch_; }
+
   // Returns the number of sampled threads.
   intptr_t ProfileInterrupt();
 
@@ -854,6 +873,13 @@ class Isolate : public BaseIsolate {
   IsolateProfilerData* profiler_data_;
   Mutex profiler_data_mutex_;
 
+  DeoptStats* deopt_stats_;
+
+  intptr_t compilations_;
+  intptr_t compilation_micros_;
+
+  intptr_t mutator_epoch_;
+
   VMTagCounters vm_tag_counters_;
   uword user_tag_;
   RawGrowableObjectArray* tag_table_;
@@ -225,6 +225,12 @@ bool MessageHandler::HandleOOBMessages() {
 }
 
 
+intptr_t MessageHandler::QueueLength() {
+  MonitorLocker ml(&monitor_);
+  return queue_->Length() + oob_queue_->Length();
+}
+
+
 bool MessageHandler::HasOOBMessages() {
   MonitorLocker ml(&monitor_);
   return !oob_queue_->IsEmpty();
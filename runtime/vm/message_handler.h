@@ -58,6 +58,10 @@ class MessageHandler {
   // handler.
   bool HasOOBMessages();
 
+  // Returns the number of messages waiting to be handled, OOB messages
+  // included.
+  intptr_t QueueLength();
+
   // A message handler tracks how many live ports it has.
   bool HasLivePorts() const { return live_ports_ > 0; }
 
@@ -4,11 +4,15 @@
 
 #include "vm/metrics.h"
 
+#include "vm/dart.h"
+#include "vm/deopt_instructions.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
+#include "vm/message_handler.h"
 #include "vm/native_entry.h"
 #include "vm/runtime_entry.h"
 #include "vm/object.h"
+#include "vm/thread_pool.h"
 
 namespace dart {
 
@@ -67,6 +71,9 @@ static const char* UnitString(intptr_t unit) {
   switch (unit) {
     case Metric::kCounter: return "counter";
     case Metric::kByte: return "byte";
+    case Metric::kMicrosecond: return "microsecond";
+    case Metric::kBytePerSecond: return "bytePerSecond";
+    case Metric::kPercent: return "percent";
     default:
       UNREACHABLE();
   }
@@ -230,10 +237,111 @@ int64_t MetricHeapNewExternal::Value() const {
 }
 
 
+static int64_t GCHistogramPercentile(Isolate* isolate,
+                                     Heap::GCHistogramKind kind,
+                                     double percentile) {
+  ASSERT(isolate == Isolate::Current());
+  return isolate->heap()->gc_histogram(kind).ValueAtPercentile(percentile);
+}
+
+
+int64_t MetricGCScavengePauseP50::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kScavengePause, 50.0);
+}
+
+
+int64_t MetricGCScavengePauseP99::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kScavengePause, 99.0);
+}
+
+
+int64_t MetricGCMarkSweepPauseP50::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kMarkSweepPause, 50.0);
+}
+
+
+int64_t MetricGCMarkSweepPauseP99::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kMarkSweepPause, 99.0);
+}
+
+
+int64_t MetricHeapAllocationRate::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kAllocationRate, 50.0);
+}
+
+
+int64_t MetricHeapPromotionRate::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kPromotionRate, 50.0);
+}
+
+
+int64_t MetricHeapOldFragmentation::Value() const {
+  return GCHistogramPercentile(isolate(), Heap::kOldFragmentation, 50.0);
+}
+
+
+int64_t MetricGCScavengeCount::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->new_space()->collections();
+}
+
+
+int64_t MetricGCScavengeTime::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->new_space()->gc_time_micros();
+}
+
+
+int64_t MetricGCMarkSweepCount::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->old_space()->collections();
+}
+
+
+int64_t MetricGCMarkSweepTime::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->heap()->old_space()->gc_time_micros();
+}
+
+
+int64_t MetricIsolateMessageQueueLength::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->message_handler()->QueueLength();
+}
+
+
+int64_t MetricIsolateCompileCount::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->compilations();
+}
+
+
+int64_t MetricIsolateCompileTime::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->compilation_micros();
+}
+
+
+int64_t MetricIsolateDeoptCount::Value() const {
+  ASSERT(isolate() == Isolate::Current());
+  return isolate()->deopt_stats()->total_count();
+}
+
+
 int64_t MetricIsolateCount::Value() const {
   return Isolate::IsolateListLength();
 }
 
+
+int64_t MetricThreadPoolRunning::Value() const {
+  return Dart::thread_pool()->workers_running();
+}
+
+
+int64_t MetricThreadPoolIdle::Value() const {
+  return Dart::thread_pool()->workers_idle();
+}
+
 #define VM_METRIC_VARIABLE(type, variable, name, unit)                         \
   static type vm_metric_##variable##_;
   VM_METRIC_LIST(VM_METRIC_VARIABLE);
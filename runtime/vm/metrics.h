@@ -20,15 +20,51 @@ class JSONStream;
   V(MetricHeapNewUsed, HeapNewUsed, "heap.new.used", kByte)                    \
   V(MetricHeapNewCapacity, HeapNewCapacity, "heap.new.capacity", kByte)        \
   V(MetricHeapNewExternal, HeapNewExternal, "heap.new.external", kByte)        \
+  V(MetricGCScavengePauseP50, GCScavengePauseP50,                              \
+    "heap.gc.scavenge.pause.p50", kMicrosecond)                                \
+  V(MetricGCScavengePauseP99, GCScavengePauseP99,                              \
+    "heap.gc.scavenge.pause.p99", kMicrosecond)                                \
+  V(MetricGCMarkSweepPauseP50, GCMarkSweepPauseP50,                            \
+    "heap.gc.marksweep.pause.p50", kMicrosecond)                               \
+  V(MetricGCMarkSweepPauseP99, GCMarkSweepPauseP99,                            \
+    "heap.gc.marksweep.pause.p99", kMicrosecond)                               \
+  V(MetricHeapAllocationRate, HeapAllocationRate,                              \
+    "heap.allocation.rate.p50", kBytePerSecond)                                \
+  V(MetricHeapPromotionRate, HeapPromotionRate,                                \
+    "heap.promotion.rate.p50", kBytePerSecond)                                 \
+  V(MetricHeapOldFragmentation, HeapOldFragmentation,                          \
+    "heap.old.fragmentation.p50", kPercent)                                    \
+  V(MetricGCScavengeCount, GCScavengeCount, "heap.gc.scavenge.count",          \
+    kCounter)                                                                  \
+  V(MetricGCScavengeTime, GCScavengeTime, "heap.gc.scavenge.time",             \
+    kMicrosecond)                                                              \
+  V(MetricGCMarkSweepCount, GCMarkSweepCount, "heap.gc.marksweep.count",       \
+    kCounter)                                                                  \
+  V(MetricGCMarkSweepTime, GCMarkSweepTime, "heap.gc.marksweep.time",          \
+    kMicrosecond)                                                              \
+  V(MetricIsolateMessageQueueLength, IsolateMessageQueueLength,                \
+    "isolate.messages.queued", kCounter)                                       \
+  V(MetricIsolateCompileCount, IsolateCompileCount, "isolate.compile.count",   \
+    kCounter)                                                                  \
+  V(MetricIsolateCompileTime, IsolateCompileTime, "isolate.compile.time",      \
+    kMicrosecond)                                                              \
+  V(MetricIsolateDeoptCount, IsolateDeoptCount, "isolate.deopt.count",         \
+    kCounter)                                                                  \
 
 #define VM_METRIC_LIST(V)                                                      \
   V(MetricIsolateCount, IsolateCount, "vm.isolate.count", kCounter)            \
+  V(MetricThreadPoolRunning, ThreadPoolRunning, "vm.threadpool.running",       \
+    kCounter)                                                                  \
+  V(MetricThreadPoolIdle, ThreadPoolIdle, "vm.threadpool.idle", kCounter)      \
 
 class Metric {
  public:
   enum Unit {
     kCounter,
     kByte,
+    kMicrosecond,
+    kBytePerSecond,
+    kPercent,
   };
 
   Metric();
@@ -130,12 +166,115 @@ class MetricHeapNewExternal : public Metric {
 };
 
 
+// Percentiles of the GC histograms of the isolate's heap.
+class MetricGCScavengePauseP50 : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCScavengePauseP99 : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCMarkSweepPauseP50 : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCMarkSweepPauseP99 : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricHeapAllocationRate : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricHeapPromotionRate : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricHeapOldFragmentation : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCScavengeCount : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCScavengeTime : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCMarkSweepCount : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricGCMarkSweepTime : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricIsolateMessageQueueLength : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricIsolateCompileCount : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricIsolateCompileTime : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricIsolateDeoptCount : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
 class MetricIsolateCount : public Metric {
  protected:
   virtual int64_t Value() const;
 };
 
 
+class MetricThreadPoolRunning : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
+class MetricThreadPoolIdle : public Metric {
+ protected:
+  virtual int64_t Value() const;
+};
+
+
 }  // namespace dart
 
 #endif  // VM_METRICS_H_
@@ -6,6 +6,7 @@
 
 #include "include/dart_api.h"
 #include "platform/assert.h"
+#include "vm/allocation_sampler.h"
 #include "vm/assembler.h"
 #include "vm/cpu.h"
 #include "vm/bit_vector.h"
@@ -1759,6 +1760,9 @@ RawObject* Object::Allocate(intptr_t cls_id,
   InitializeObject(address, cls_id, size, (isolate == Dart::vm_isolate()));
   RawObject* raw_obj = reinterpret_cast<RawObject*>(address + kHeapObjectTag);
   ASSERT(cls_id == RawObject::ClassIdTag::decode(raw_obj->ptr()->tags_));
+  if (AllocationSampler::IsEnabled() && (isolate != Dart::vm_isolate())) {
+    heap->allocation_sampler()->Allocated(raw_obj, cls_id, size);
+  }
   return raw_obj;
 }
 
@@ -18328,6 +18332,55 @@ RawString* String::FromUTF8(const uint8_t* utf8_array,
 }
 
 
+// Returns the address of the byte at 'offset' in a TypedData or an
+// ExternalTypedData. The address of a TypedData is only valid until the next
+// safepoint.
+static const uint8_t* Uint8DataAddr(const Instance& data, intptr_t offset) {
+  if (data.IsTypedData()) {
+    return reinterpret_cast<const uint8_t*>(
+        TypedData::Cast(data).DataAddr(offset));
+  }
+  ASSERT(data.IsExternalTypedData());
+  return reinterpret_cast<const uint8_t*>(
+      ExternalTypedData::Cast(data).DataAddr(offset));
+}
+
+
+RawString* String::FromUTF8(const Instance& utf8_data,
+                            intptr_t offset,
+                            intptr_t array_len,
+                            Heap::Space space) {
+  if (array_len == 0) {
+    return Symbols::Empty().raw();
+  }
+  Utf8::Type type;
+  intptr_t len;
+  {
+    NoSafepointScope no_safepoint;
+    const uint8_t* utf8_array = Uint8DataAddr(utf8_data, offset);
+    if (!Utf8::IsValid(utf8_array, array_len)) {
+      return String::null();
+    }
+    len = Utf8::CodeUnitCount(utf8_array, array_len, &type);
+  }
+  // Allocating the string may move the input, so its address is looked up
+  // again afterwards.
+  if (type == Utf8::kLatin1) {
+    const String& strobj = String::Handle(OneByteString::New(len, space));
+    NoSafepointScope no_safepoint;
+    Utf8::DecodeToLatin1(Uint8DataAddr(utf8_data, offset), array_len,
+                         OneByteString::CharAddr(strobj, 0), len);
+    return strobj.raw();
+  }
+  ASSERT((type == Utf8::kBMP) || (type == Utf8::kSupplementary));
+  const String& strobj = String::Handle(TwoByteString::New(len, space));
+  NoSafepointScope no_safepoint;
+  Utf8::DecodeToUTF16(Uint8DataAddr(utf8_data, offset), array_len,
+                      TwoByteString::CharAddr(strobj, 0), len);
+  return strobj.raw();
+}
+
+
 RawString* String::FromLatin1(const uint8_t* latin1_array,
                               intptr_t array_len,
                               Heap::Space space) {
@@ -18851,6 +18904,108 @@ void String::ToUTF8(uint8_t* utf8_array, intptr_t array_len) const {
 }
 
 
+RawTypedData* String::ToUTF8(const String& str,
+                             intptr_t start,
+                             intptr_t length,
+                             Heap::Space space) {
+  ASSERT((start >= 0) && (start + length <= str.Length()));
+  const intptr_t cid = str.GetClassId();
+  intptr_t utf8_len;
+  {
+    NoSafepointScope no_safepoint;
+    switch (cid) {
+      case kOneByteStringCid:
+        utf8_len = Utf8::EncodedLength(
+            OneByteString::CharAddr(str, start), length);
+        break;
+      case kExternalOneByteStringCid:
+        utf8_len = Utf8::EncodedLength(
+            ExternalOneByteString::CharAddr(str, start), length);
+        break;
+      case kTwoByteStringCid:
+        utf8_len = Utf8::EncodedLength(
+            TwoByteString::CharAddr(str, start), length);
+        break;
+      default:
+        ASSERT(cid == kExternalTwoByteStringCid);
+        utf8_len = Utf8::EncodedLength(
+            ExternalTwoByteString::CharAddr(str, start), length);
+    }
+  }
+  // Allocating the result may move the string, so the address of its
+  // characters is looked up again afterwards.
+  const TypedData& result = TypedData::Handle(
+      TypedData::New(kTypedDataUint8ArrayCid, utf8_len, space));
+  NoSafepointScope no_safepoint;
+  uint8_t* dst = reinterpret_cast<uint8_t*>(result.DataAddr(0));
+  intptr_t written;
+  switch (cid) {
+    case kOneByteStringCid:
+      written = Utf8::EncodeLatin1(
+          OneByteString::CharAddr(str, start), length, dst);
+      break;
+    case kExternalOneByteStringCid:
+      written = Utf8::EncodeLatin1(
+          ExternalOneByteString::CharAddr(str, start), length, dst);
+      break;
+    case kTwoByteStringCid:
+      written = Utf8::EncodeUTF16(
+          TwoByteString::CharAddr(str, start), length, dst);
+      break;
+    default:
+      written = Utf8::EncodeUTF16(
+          ExternalTwoByteString::CharAddr(str, start), length, dst);
+  }
+  ASSERT(written == utf8_len);
+  return result.raw();
+}
+
+
+void String::CopyCodeUnits(const String& str,
+                           intptr_t start,
+                           intptr_t length,
+                           uint8_t* dst) {
+  ASSERT((start >= 0) && (length >= 0) && (start + length <= str.Length()));
+  NoSafepointScope no_safepoint;
+  if (str.IsOneByteString()) {
+    memmove(dst, OneByteString::CharAddr(str, start), length);
+  } else {
+    ASSERT(str.IsExternalOneByteString());
+    memmove(dst, ExternalOneByteString::CharAddr(str, start), length);
+  }
+}
+
+
+void String::CopyCodeUnits(const String& str,
+                           intptr_t start,
+                           intptr_t length,
+                           uint16_t* dst) {
+  ASSERT((start >= 0) && (length >= 0) && (start + length <= str.Length()));
+  NoSafepointScope no_safepoint;
+  const uint8_t* latin1 = NULL;
+  switch (str.GetClassId()) {
+    case kOneByteStringCid:
+      latin1 = OneByteString::CharAddr(str, start);
+      break;
+    case kExternalOneByteStringCid:
+      latin1 = ExternalOneByteString::CharAddr(str, start);
+      break;
+    case kTwoByteStringCid:
+      memmove(dst, TwoByteString::CharAddr(str, start),
+              length * sizeof(uint16_t));
+      return;
+    default:
+      ASSERT(str.IsExternalTwoByteString());
+      memmove(dst, ExternalTwoByteString::CharAddr(str, start),
+              length * sizeof(uint16_t));
+      return;
+  }
+  for (intptr_t i = 0; i < length; i++) {
+    dst[i] = latin1[i];
+  }
+}
+
+
 static FinalizablePersistentHandle* AddFinalizer(
     const Object& referent,
     void* peer,
@@ -20177,6 +20332,19 @@ RawLinkedHashMap* LinkedHashMap::New(const Array& data,
 }
 
 
+RawLinkedHashMap* LinkedHashMap::NewUnindexed(intptr_t length,
+                                              Heap::Space space) {
+  const intptr_t used_data = length << 1;
+  const intptr_t data_size = Utils::Maximum(
+      Utils::RoundUpToPowerOfTwo(used_data),
+      static_cast<uintptr_t>(kInitialIndexSize));
+  const Array& data = Array::Handle(Array::New(data_size, space));
+  // The hash mask must be 0 while the index is null.
+  return LinkedHashMap::New(data, TypedData::Handle(), 0, used_data, 0,
+                            space);
+}
+
+
 RawLinkedHashMap* LinkedHashMap::NewUninitialized(Heap::Space space) {
   ASSERT(Isolate::Current()->object_store()->linked_hash_map_class()
          != Class::null());
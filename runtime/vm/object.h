@@ -1763,9 +1763,9 @@ class ICData : public Object {
     return raw_ptr()->deopt_id_;
   }
 
-  // Note: only deopts with reasons before Unknown in this list are recorded in
-  // the ICData. All other reasons are used purely for informational messages
-  // printed during deoptimization itself.
+  // Note: only deopts with reasons up to and including CheckClass in this
+  // list are recorded in the ICData. All other reasons are used purely for
+  // informational messages printed during deoptimization itself.
   #define DEOPT_REASONS(V)                                                     \
     V(BinarySmiOp)                                                             \
     V(BinaryMintOp)                                                            \
@@ -1791,7 +1791,7 @@ class ICData : public Object {
   #undef DEFINE_ENUM_LIST
   };
 
-  static const intptr_t kLastRecordedDeoptReason = kDeoptUnknown - 1;
+  static const intptr_t kLastRecordedDeoptReason = kDeoptCheckClass;
 
   enum DeoptFlags {
     // Deoptimization is caused by an optimistically hoisted instruction.
@@ -6033,6 +6033,32 @@ class String : public Instance {
                              intptr_t array_len,
                              Heap::Space space = Heap::kNew);
 
+  // Creates a new String object from 'array_len' bytes of UTF-8 at 'offset'
+  // in 'utf8_data', which is a TypedData or an ExternalTypedData. Returns
+  // null if the bytes are not valid UTF-8.
+  static RawString* FromUTF8(const Instance& utf8_data,
+                             intptr_t offset,
+                             intptr_t array_len,
+                             Heap::Space space = Heap::kNew);
+
+  // Encodes the 'length' characters at 'start' in 'str' into a new
+  // Uint8List. Unpaired surrogates are encoded in three bytes.
+  static RawTypedData* ToUTF8(const String& str,
+                              intptr_t start,
+                              intptr_t length,
+                              Heap::Space space = Heap::kNew);
+
+  // Copies the 'length' code units at 'start' in 'str' into 'dst'. Copying
+  // into a Latin-1 array requires a one-byte string.
+  static void CopyCodeUnits(const String& str,
+                            intptr_t start,
+                            intptr_t length,
+                            uint8_t* dst);
+  static void CopyCodeUnits(const String& str,
+                            intptr_t start,
+                            intptr_t length,
+                            uint16_t* dst);
+
   // Creates a new String object from an array of Latin-1 encoded characters.
   static RawString* FromLatin1(const uint8_t* latin1_array,
                                intptr_t array_len,
@@ -7351,6 +7377,11 @@ class LinkedHashMap : public Instance {
                                intptr_t used_data,
                                intptr_t deleted_keys,
                                Heap::Space space = Heap::kNew);
+  // Allocates a map with room for 'length' entries and no index. The caller
+  // stores distinct keys and their values at even and odd positions of the
+  // data array, and the map builds its index when it is first used.
+  static RawLinkedHashMap* NewUnindexed(intptr_t length,
+                                        Heap::Space space = Heap::kNew);
 
   virtual RawTypeArguments* GetTypeArguments() const {
     return raw_ptr()->type_arguments_;
@@ -4,16 +4,24 @@
 
 #include "vm/object_graph.h"
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/growable_array.h"
 #include "vm/isolate.h"
+#include "vm/lockers.h"
 #include "vm/object.h"
+#include "vm/pages.h"
 #include "vm/raw_object.h"
 #include "vm/reusable_handles.h"
+#include "vm/scavenger.h"
+#include "vm/thread_pool.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, heap_snapshot_tasks, 4,
+            "Number of threads writing the heap pages of a heap snapshot.");
+
 // The state of a pre-order, depth-first traversal of an object graph.
 // When a node is visited, *all* its children are pushed to the stack at once.
 // We insert a sentinel between the node and its children on the stack, to
@@ -479,4 +487,181 @@ intptr_t ObjectGraph::Serialize(WriteStream* stream) {
   return visitor.count() + 1;  // + root
 }
 
+
+static uint8_t* allocator(uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
+  void* new_ptr = realloc(reinterpret_cast<void*>(ptr), new_size);
+  return reinterpret_cast<uint8_t*>(new_ptr);
+}
+
+
+SerializedGraph::~SerializedGraph() {
+  for (intptr_t i = 0; i < buffers_.length(); i++) {
+    free(buffers_[i]);
+  }
+}
+
+
+void SerializedGraph::AddBuffer(uint8_t* buffer,
+                                intptr_t length,
+                                intptr_t node_count) {
+  buffers_.Add(buffer);
+  lengths_.Add(length);
+  size_ += length;
+  node_count_ += node_count;
+}
+
+
+void SerializedGraph::CopyTo(uint8_t* dst,
+                             intptr_t offset,
+                             intptr_t length) const {
+  ASSERT((offset >= 0) && (length >= 0) && (offset + length <= size_));
+  for (intptr_t i = 0; (i < buffers_.length()) && (length > 0); i++) {
+    if (offset >= lengths_[i]) {
+      offset -= lengths_[i];
+      continue;
+    }
+    const intptr_t count = Utils::Minimum(length, lengths_[i] - offset);
+    memmove(dst, buffers_[i] + offset, count);
+    dst += count;
+    length -= count;
+    offset = 0;
+  }
+  ASSERT(length == 0);
+}
+
+
+class WritePageVisitor : public ObjectVisitor {
+ public:
+  WritePageVisitor(Isolate* isolate, WriteStream* stream)
+      : ObjectVisitor(isolate),
+        stream_(stream),
+        ptr_writer_(isolate, stream),
+        count_(0) { }
+
+  virtual void VisitObject(RawObject* raw_obj) {
+    if (raw_obj->IsFreeListElement()) {
+      return;
+    }
+    // Same node format as WriteGraphVisitor.
+    WriteHeader(raw_obj, raw_obj->Size(), raw_obj->GetClassId(), stream_);
+    raw_obj->VisitPointers(&ptr_writer_);
+    stream_->WriteUnsigned(0);
+    ++count_;
+  }
+
+  intptr_t count() const { return count_; }
+
+ private:
+  WriteStream* stream_;
+  WritePointerVisitor ptr_writer_;
+  intptr_t count_;
+};
+
+
+// Writes the heap pages handed out by 'next_page' until there are none left.
+// Helper tasks and the mutator thread run it concurrently, each adding its
+// own buffer to the graph.
+class SerializePagesTask : public ThreadPool::Task {
+ public:
+  SerializePagesTask(Isolate* isolate,
+                     const MallocGrowableArray<HeapPage*>* pages,
+                     uintptr_t* next_page,
+                     SerializedGraph* graph,
+                     Monitor* monitor,
+                     intptr_t* pending_tasks)
+      : task_isolate_(isolate),
+        pages_(pages),
+        next_page_(next_page),
+        graph_(graph),
+        monitor_(monitor),
+        pending_tasks_(pending_tasks) { }
+
+  virtual void Run() {
+    Thread::EnterIsolateAsHelper(task_isolate_);
+    SerializePages(task_isolate_, pages_, next_page_, graph_, monitor_);
+    Thread::ExitIsolateAsHelper();
+    MonitorLocker ml(monitor_);
+    (*pending_tasks_)--;
+    ml.Notify();
+  }
+
+  static void SerializePages(Isolate* isolate,
+                             const MallocGrowableArray<HeapPage*>* pages,
+                             uintptr_t* next_page,
+                             SerializedGraph* graph,
+                             Monitor* monitor) {
+    uint8_t* buffer = NULL;
+    WriteStream stream(&buffer, &allocator, 1 * MB);
+    WritePageVisitor visitor(isolate, &stream);
+    while (true) {
+      const intptr_t index = AtomicOperations::FetchAndIncrement(next_page);
+      if (index >= pages->length()) {
+        break;
+      }
+      pages->At(index)->VisitObjects(&visitor);
+    }
+    MonitorLocker ml(monitor);
+    graph->AddBuffer(buffer, stream.bytes_written(), visitor.count());
+  }
+
+ private:
+  Isolate* task_isolate_;
+  const MallocGrowableArray<HeapPage*>* pages_;
+  uintptr_t* next_page_;
+  SerializedGraph* graph_;
+  Monitor* monitor_;
+  intptr_t* pending_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(SerializePagesTask);
+};
+
+
+SerializedGraph* ObjectGraph::SerializeParallel() {
+  Heap* heap = isolate()->heap();
+  // Promote everything to old space and collect it, so that only reachable
+  // objects are left in the pages.
+  heap->new_space()->Evacuate();
+  heap->CollectGarbage(Heap::kOld);
+  ASSERT(heap->new_space()->UsedInWords() == 0);
+
+  SerializedGraph* graph = new SerializedGraph();
+  {
+    // The root comes first, its edges are the roots of the isolate.
+    uint8_t* buffer = NULL;
+    WriteStream stream(&buffer, &allocator, 4 * KB);
+    stream.WriteUnsigned(kObjectAlignment);
+    stream.WriteUnsigned(0);
+    stream.WriteUnsigned(0);
+    stream.WriteUnsigned(0);
+    WritePointerVisitor ptr_writer(isolate(), &stream);
+    isolate()->IterateObjectPointers(&ptr_writer, false, false);
+    stream.WriteUnsigned(0);
+    graph->AddBuffer(buffer, stream.bytes_written(), 1);
+  }
+
+  // Keeps the concurrent sweeper away from the pages.
+  HeapIterationScope iteration;
+  NoSafepointScope no_safepoint;
+  MallocGrowableArray<HeapPage*> pages;
+  heap->old_space()->AddPagesTo(&pages);
+  uintptr_t next_page = 0;
+  Monitor monitor;
+  // The mutator thread writes pages too.
+  const intptr_t num_tasks = Utils::Maximum<intptr_t>(
+      Utils::Minimum<intptr_t>(FLAG_heap_snapshot_tasks, pages.length()) - 1,
+      0);
+  intptr_t pending_tasks = num_tasks;
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    Dart::thread_pool()->Run(new SerializePagesTask(
+        isolate(), &pages, &next_page, graph, &monitor, &pending_tasks));
+  }
+  SerializePagesTask::SerializePages(
+      isolate(), &pages, &next_page, graph, &monitor);
+  MonitorLocker ml(&monitor);
+  while (pending_tasks > 0) {
+    ml.Wait();
+  }
+  return graph;
+}
+
 }  // namespace dart
@@ -6,11 +6,13 @@
 #define VM_OBJECT_GRAPH_H_
 
 #include "vm/allocation.h"
+#include "vm/growable_array.h"
 #include "vm/object.h"
 
 namespace dart {
 
 class Isolate;
+class SerializedGraph;
 
 // Utility to traverse the object graph in an ordered fashion.
 // Example uses:
@@ -94,10 +96,49 @@ class ObjectGraph : public StackResource {
   // TODO(koda): Document format; support streaming/chunking.
   intptr_t Serialize(WriteStream* stream);
 
+  // Like 'Serialize', but the heap is first collected so that every object
+  // left in it is reachable, and the pages of the heap are then written by
+  // several threads at once. The nodes come in no particular order. The
+  // caller owns the result, which does not refer to the Dart heap and can be
+  // sent by any thread once the isolate has resumed.
+  SerializedGraph* SerializeParallel();
+
  private:
   DISALLOW_IMPLICIT_CONSTRUCTORS(ObjectGraph);
 };
 
+
+// An object graph in the format written by ObjectGraph::Serialize, held in
+// malloc'ed buffers, one per thread that wrote it.
+class SerializedGraph {
+ public:
+  SerializedGraph() : node_count_(0), size_(0) { }
+  ~SerializedGraph();
+
+  // The number of nodes, including the root.
+  intptr_t node_count() const { return node_count_; }
+
+  // The number of bytes of the serialized graph.
+  intptr_t size() const { return size_; }
+
+  // Copies 'length' bytes of the serialized graph, starting at 'offset',
+  // to 'dst'.
+  void CopyTo(uint8_t* dst, intptr_t offset, intptr_t length) const;
+
+ private:
+  // Takes ownership of 'buffer'.
+  void AddBuffer(uint8_t* buffer, intptr_t length, intptr_t node_count);
+
+  MallocGrowableArray<uint8_t*> buffers_;
+  MallocGrowableArray<intptr_t> lengths_;
+  intptr_t node_count_;
+  intptr_t size_;
+
+  friend class ObjectGraph;
+  friend class SerializePagesTask;
+  DISALLOW_COPY_AND_ASSIGN(SerializedGraph);
+};
+
 }  // namespace dart
 
 #endif  // VM_OBJECT_GRAPH_H_
@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "vm/datastream.h"
 #include "vm/object_graph.h"
 #include "vm/unit_test.h"
 
@@ -138,4 +139,47 @@ TEST_CASE(ObjectGraph) {
   }
 }
 
+
+
+static uint8_t* malloc_allocator(
+    uint8_t* ptr, intptr_t old_size, intptr_t new_size) {
+  return reinterpret_cast<uint8_t*>(realloc(ptr, new_size));
+}
+
+
+TEST_CASE(ObjectGraphSerializeParallel) {
+  Isolate* isolate = Isolate::Current();
+  Array& a = Array::Handle(Array::New(1000, Heap::kNew));
+  for (intptr_t i = 0; i < a.Length(); i++) {
+    a.SetAt(i, Array::Handle(Array::New(i % 7, Heap::kNew)));
+  }
+  ObjectGraph graph(isolate);
+  SerializedGraph* parallel = graph.SerializeParallel();
+  // The heap has just been collected, so the depth first traversal finds
+  // the same nodes, only in another order.
+  uint8_t* buffer = NULL;
+  WriteStream stream(&buffer, &malloc_allocator, 1 * KB);
+  intptr_t node_count = graph.Serialize(&stream);
+  EXPECT_EQ(node_count, parallel->node_count());
+  EXPECT_EQ(stream.bytes_written(), parallel->size());
+  // Both start with the root.
+  const intptr_t kHeaderSize = 4;
+  uint8_t header[kHeaderSize];
+  parallel->CopyTo(header, 0, kHeaderSize);
+  EXPECT_EQ(0, memcmp(header, buffer, kHeaderSize));
+  // Copying across the buffers of the writer threads.
+  uint8_t* copy = reinterpret_cast<uint8_t*>(malloc(parallel->size()));
+  parallel->CopyTo(copy, 0, parallel->size() / 2);
+  parallel->CopyTo(copy + parallel->size() / 2,
+                   parallel->size() / 2,
+                   parallel->size() - parallel->size() / 2);
+  uint8_t* expected = reinterpret_cast<uint8_t*>(malloc(parallel->size()));
+  parallel->CopyTo(expected, 0, parallel->size());
+  EXPECT_EQ(0, memcmp(copy, expected, parallel->size()));
+  free(expected);
+  free(copy);
+  free(buffer);
+  delete parallel;
+}
+
 }  // namespace dart
@@ -15,6 +15,7 @@
 #include <sys/time.h>  // NOLINT
 #include <sys/types.h>  // NOLINT
 #include <sys/syscall.h>  // NOLINT
+#include <sys/mman.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
 #include <fcntl.h>  // NOLINT
 #include <unistd.h>  // NOLINT
@@ -23,6 +24,7 @@
 #include "vm/code_observers.h"
 #include "vm/dart.h"
 #include "vm/debuginfo.h"
+#include "vm/growable_array.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
 #include "vm/os_thread.h"
@@ -141,52 +143,69 @@ class JitdumpCodeObserver : public CodeObserver {
  public:
   JitdumpCodeObserver() {
     ASSERT(FLAG_generate_perf_jitdump);
-    out_file_ = NULL;
+    out_fd_ = -1;
+    marker_ = NULL;
     clock_fd_ = -1;
     clock_id_ = kInvalidClockId;
     code_sequence_ = 0;
-    Dart_FileOpenCallback file_open = Isolate::file_open_callback();
-    Dart_FileWriteCallback file_write = Isolate::file_write_callback();
-    Dart_FileCloseCallback file_close = Isolate::file_close_callback();
-    if ((file_open == NULL) || (file_write == NULL) || (file_close == NULL)) {
-      return;
-    }
-    // The Jitdump code observer writes all jitted code into the file
-    // 'perf.jitdump' in the current working directory. We open the file once
-    // on initialization and close it when the VM is going down.
-    {
-      // Open the file.
-      const char* filename = "perf.jitdump";
-      out_file_ = (*file_open)(filename, true);
-      ASSERT(out_file_ != NULL);
-      // Write the jit dump header.
-      WriteHeader();
-    }
     // perf uses an internal clock and because our output is merged with data
     // collected by perf our timestamps must be consistent. Using
     // the posix-clock-module (/dev/trace_clock) as our time source ensures
-    // we are consistent with the perf timestamps.
-    clock_id_ = kInvalidClockId;
+    // we are consistent with the perf timestamps. Without it we use the
+    // monotonic clock, which matches 'perf record -k mono'.
     clock_fd_ = open("/dev/trace_clock", O_RDONLY);
     if (clock_fd_ >= 0) {
       clock_id_ = FD_TO_CLOCKID(clock_fd_);
+    } else {
+      clock_id_ = CLOCK_MONOTONIC;
+    }
+    // The Jitdump code observer writes all jitted code into the file
+    // 'jit-<pid>.dump' in the current working directory, the name
+    // 'perf inject --jit' looks for. We open the file once on initialization
+    // and close it when the VM is going down.
+    char filename[64];
+    OS::SNPrint(filename, sizeof(filename), "jit-%d.dump", getpid());
+    out_fd_ = open(filename, O_CREAT | O_TRUNC | O_RDWR, 0666);
+    if (out_fd_ < 0) {
+      return;
+    }
+    // perf finds the dump through an executable mapping of it recorded in
+    // perf.data.
+    const intptr_t page_size = getpagesize();
+    void* marker = mmap(NULL, page_size, PROT_READ | PROT_EXEC, MAP_PRIVATE,
+                        out_fd_, 0);
+    if (marker != MAP_FAILED) {
+      marker_ = marker;
     }
+    WriteHeader();
   }
 
   ~JitdumpCodeObserver() {
-    Dart_FileCloseCallback file_close = Isolate::file_close_callback();
-    if (file_close == NULL) {
-      return;
+    if (out_fd_ >= 0) {
+      MutexLocker ml(CodeObservers::mutex());
+      for (intptr_t i = 0; i < pending_loads_.length(); i++) {
+        WriteLocked(pending_loads_[i].record, pending_loads_[i].size);
+        free(pending_loads_[i].record);
+      }
+      pending_loads_.Clear();
+    }
+    if (marker_ != NULL) {
+      munmap(marker_, getpagesize());
+    }
+    if (out_fd_ >= 0) {
+      close(out_fd_);
     }
-    ASSERT(out_file_ != NULL);
-    (*file_close)(out_file_);
     if (clock_fd_ >= 0) {
       close(clock_fd_);
     }
   }
 
   virtual bool IsActive() const {
-    return FLAG_generate_perf_jitdump && (out_file_ != NULL);
+    return FLAG_generate_perf_jitdump && (out_fd_ >= 0);
+  }
+
+  virtual bool WantsSourcePositions() const {
+    return true;
   }
 
   virtual void Notify(const char* name,
@@ -197,6 +216,12 @@ class JitdumpCodeObserver : public CodeObserver {
     WriteCodeLoad(name, base, prologue_offset, size, optimized);
   }
 
+  virtual void NotifySourcePositions(uword base,
+                                     const CodeSourcePosition* positions,
+                                     intptr_t length) {
+    WriteDebugInfo(base, positions, length);
+  }
+
  private:
   static const uint32_t kJitHeaderMagic = 0x4A695444;
   static const uint32_t kJitHeaderMagicSw = 0x4454694A;
@@ -217,6 +242,7 @@ class JitdumpCodeObserver : public CodeObserver {
     uint32_t pad1;    /* reserved */
     uint32_t pid;   /* JIT process id */
     uint64_t timestamp; /* timestamp */
+    uint64_t flags; /* flags */
   };
 
   /* record prefix (mandatory in each record) */
@@ -229,7 +255,7 @@ class JitdumpCodeObserver : public CodeObserver {
   enum jit_record_type {
     JIT_CODE_LOAD = 0,
     /* JIT_CODE_MOVE = 1, */
-    /* JIT_CODE_DEBUG_INFO = 2, */
+    JIT_CODE_DEBUG_INFO = 2,
     /* JIT_CODE_CLOSE = 3, */
     JIT_CODE_MAX = 4,
   };
@@ -244,6 +270,30 @@ class JitdumpCodeObserver : public CodeObserver {
     uint64_t code_index;
   };
 
+  struct jr_code_debug_info {
+    struct jr_prefix prefix;
+    uint64_t code_addr;
+    uint64_t nr_entry;
+  };
+
+  struct debug_entry {
+    uint64_t addr;
+    int32_t lineno;
+    int32_t discrim;
+    // Followed by the null terminated file name.
+  };
+
+  // perf only uses the line table of a code object that is written before
+  // its load record, but the code is announced before its pc descriptors
+  // exist. The load record is therefore held back until the line table of
+  // the code arrives or the same thread announces the next code object.
+  struct PendingLoad {
+    pid_t tid;
+    uword base;
+    uint8_t* record;
+    intptr_t size;
+  };
+
   const char* GenerateCodeName(const char* name, bool optimized) {
     const char* format = "%s%s";
     const char* marker = optimized ? "*" : "";
@@ -276,23 +326,41 @@ class JitdumpCodeObserver : public CodeObserver {
   }
 
   uint64_t GetKernelTimeNanos() {
-    if (clock_id_ != kInvalidClockId) {
-      struct timespec ts;
-      int r = clock_gettime(clock_id_, &ts);
-      ASSERT(r == 0);
-      uint64_t nanos = static_cast<uint64_t>(ts.tv_sec) *
-                       static_cast<uint64_t>(kNanosecondsPerSecond);
-      nanos += static_cast<uint64_t>(ts.tv_nsec);
-      return nanos;
-    } else {
-      return OS::GetCurrentTimeMicros() * kNanosecondsPerMicrosecond;
+    struct timespec ts;
+    int r = clock_gettime(clock_id_, &ts);
+    ASSERT(r == 0);
+    uint64_t nanos = static_cast<uint64_t>(ts.tv_sec) *
+                     static_cast<uint64_t>(kNanosecondsPerSecond);
+    nanos += static_cast<uint64_t>(ts.tv_nsec);
+    return nanos;
+  }
+
+  // Must be called with CodeObservers::mutex() held.
+  void WriteLocked(const void* data, intptr_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    while (size > 0) {
+      ssize_t written = write(out_fd_, bytes, size);
+      if ((written < 0) && (errno == EINTR)) {
+        continue;
+      }
+      if (written <= 0) {
+        return;
+      }
+      bytes += written;
+      size -= written;
     }
   }
 
+  // Must be called with CodeObservers::mutex() held.
+  void FlushPendingLoadLocked(intptr_t index) {
+    PendingLoad pending = pending_loads_[index];
+    pending_loads_[index] = pending_loads_.Last();
+    pending_loads_.RemoveLast();
+    WriteLocked(pending.record, pending.size);
+    free(pending.record);
+  }
+
   void WriteHeader() {
-    Dart_FileWriteCallback file_write = Isolate::file_write_callback();
-    ASSERT(file_write != NULL);
-    ASSERT(out_file_ != NULL);
     jitheader header;
     header.magic = kJitHeaderMagic;
     header.version = kJitHeaderVersion;
@@ -301,17 +369,16 @@ class JitdumpCodeObserver : public CodeObserver {
     header.elf_mach = GetElfMach();
     header.pid = getpid();
     header.timestamp = GetKernelTimeNanos();
+    header.flags = 0;
     {
       MutexLocker ml(CodeObservers::mutex());
-      (*file_write)(&header, sizeof(header), out_file_);
+      WriteLocked(&header, sizeof(header));
     }
   }
 
   void WriteCodeLoad(const char* name, uword base, uword prologue_offset,
                      uword code_size, bool optimized) {
-    Dart_FileWriteCallback file_write = Isolate::file_write_callback();
-    ASSERT(file_write != NULL);
-    ASSERT(out_file_ != NULL);
+    ASSERT(out_fd_ >= 0);
 
     const char* code_name = GenerateCodeName(name, optimized);
     const intptr_t code_name_size = strlen(code_name) + 1;
@@ -330,19 +397,81 @@ class JitdumpCodeObserver : public CodeObserver {
 
     {
       MutexLocker ml(CodeObservers::mutex());
+      for (intptr_t i = 0; i < pending_loads_.length(); i++) {
+        if (pending_loads_[i].tid == static_cast<pid_t>(code_load.tid)) {
+          FlushPendingLoadLocked(i);
+          break;
+        }
+      }
       // Set this field under the index.
       code_load.code_index = code_sequence_++;
-      // Write structures.
-      (*file_write)(&code_load, sizeof(code_load), out_file_);
-      (*file_write)(code_name, code_name_size, out_file_);
-      (*file_write)(code_pointer, code_size, out_file_);
+      PendingLoad pending;
+      pending.tid = code_load.tid;
+      pending.base = base;
+      pending.size = code_load.prefix.total_size;
+      pending.record = reinterpret_cast<uint8_t*>(malloc(pending.size));
+      if (pending.record == NULL) {
+        return;
+      }
+      uint8_t* cursor = pending.record;
+      memmove(cursor, &code_load, sizeof(code_load));
+      cursor += sizeof(code_load);
+      memmove(cursor, code_name, code_name_size);
+      cursor += code_name_size;
+      memmove(cursor, code_pointer, code_size);
+      pending_loads_.Add(pending);
     }
   }
 
-  void* out_file_;
+  void WriteDebugInfo(uword base,
+                      const CodeSourcePosition* positions,
+                      intptr_t length) {
+    ASSERT(out_fd_ >= 0);
+
+    jr_code_debug_info debug_info;
+    debug_info.prefix.id = JIT_CODE_DEBUG_INFO;
+    debug_info.prefix.timestamp = GetKernelTimeNanos();
+    debug_info.code_addr = base;
+    debug_info.nr_entry = 0;
+    uword total_size = sizeof(debug_info);
+    for (intptr_t i = 0; i < length; i++) {
+      if ((i > 0) && (positions[i].pc == positions[i - 1].pc)) {
+        continue;
+      }
+      debug_info.nr_entry++;
+      total_size += sizeof(debug_entry) + strlen(positions[i].file) + 1;
+    }
+    debug_info.prefix.total_size = total_size;
+
+    {
+      MutexLocker ml(CodeObservers::mutex());
+      WriteLocked(&debug_info, sizeof(debug_info));
+      for (intptr_t i = 0; i < length; i++) {
+        if ((i > 0) && (positions[i].pc == positions[i - 1].pc)) {
+          continue;
+        }
+        debug_entry entry;
+        entry.addr = positions[i].pc;
+        entry.lineno = positions[i].line;
+        entry.discrim = 0;
+        WriteLocked(&entry, sizeof(entry));
+        WriteLocked(positions[i].file, strlen(positions[i].file) + 1);
+      }
+      for (intptr_t i = 0; i < pending_loads_.length(); i++) {
+        if (pending_loads_[i].base == base) {
+          FlushPendingLoadLocked(i);
+          break;
+        }
+      }
+    }
+  }
+
+  int out_fd_;
+  void* marker_;
   int clock_fd_;
   int clock_id_;
   uint64_t code_sequence_;
+  MallocGrowableArray<PendingLoad> pending_loads_;
   DISALLOW_COPY_AND_ASSIGN(JitdumpCodeObserver);
 };
 
@@ -590,6 +590,13 @@ void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
 }
 
 
+void PageSpace::AddPagesTo(MallocGrowableArray<HeapPage*>* pages) const {
+  for (ExclusivePageIterator it(this); !it.Done(); it.Advance()) {
+    pages->Add(it.page());
+  }
+}
+
+
 RawObject* PageSpace::FindObject(FindObjectVisitor* visitor,
                                  HeapPage::PageType type) const {
   if (type == HeapPage::kExecutable) {
@@ -7,6 +7,7 @@
 
 #include "vm/freelist.h"
 #include "vm/globals.h"
+#include "vm/growable_array.h"
 #include "vm/lockers.h"
 #include "vm/ring_buffer.h"
 #include "vm/spaces.h"
@@ -248,6 +249,11 @@ class PageSpace {
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
 
+  // Appends all pages of this space to 'pages', so that they can be walked
+  // by several threads. The pages stay valid only while the space neither
+  // grows nor is swept, e.g. inside a HeapIterationScope.
+  void AddPagesTo(MallocGrowableArray<HeapPage*>* pages) const;
+
   RawObject* FindObject(FindObjectVisitor* visitor,
                         HeapPage::PageType type) const;
 
@@ -5,6 +5,7 @@
 #include "vm/precompiler.h"
 
 #include "vm/compiler.h"
+#include "vm/dart_entry.h"
 #include "vm/isolate.h"
 #include "vm/log.h"
 #include "vm/longjump.h"
@@ -20,9 +21,72 @@ namespace dart {
 #define Z (zone())
 
 
+DEFINE_FLAG(bool, precompile_receiver_classes, false,
+    "Recompile once all allocated classes are known, specializing dynamic "
+    "calls to the receiver classes that can reach them.");
 DEFINE_FLAG(bool, trace_precompiler, false, "Trace precompiler.");
 
 
+ReceiverClassTable* Precompiler::receiver_class_table_ = NULL;
+
+
+const ZoneGrowableArray<ReceiverTarget>& ReceiverClassTable::TargetsOf(
+    const String& selector) {
+  ASSERT(selector.IsSymbol());
+  ZoneGrowableArray<ReceiverTarget>* targets = map_.Lookup(&selector);
+  if (targets != NULL) {
+    return *targets;
+  }
+
+  targets = new(zone_) ZoneGrowableArray<ReceiverTarget>();
+  ClassTable* class_table = Isolate::Current()->class_table();
+  Class& cls = Class::Handle(zone_);
+  Function& function = Function::Handle(zone_);
+  for (intptr_t cid = kInstanceCid; cid < class_table->NumCids(); cid++) {
+    if (!class_table->HasValidClassAt(cid)) continue;
+    cls = class_table->At(cid);
+    if (!cls.is_allocated() || cls.is_abstract()) continue;
+    function = Resolver::ResolveDynamicAnyArgs(cls, selector);
+    if (function.IsNull()) continue;
+    ReceiverTarget entry(cid, &Function::ZoneHandle(zone_, function.raw()));
+    if (cid == kSmiCid) {
+      // Smi must be the first check, see FlowGraphCompiler::EmitTestAndCall.
+      targets->InsertAt(0, entry);
+    } else {
+      targets->Add(entry);
+    }
+  }
+  map_.Insert(ReceiverTargetsPair(
+      &String::ZoneHandle(zone_, selector.raw()), targets));
+  return *targets;
+}
+
+
+const ICData* ReceiverClassTable::CreateICData(const ICData& ic_data,
+                                               intptr_t max_checks) {
+  const ZoneGrowableArray<ReceiverTarget>& targets =
+      TargetsOf(String::Handle(zone_, ic_data.target_name()));
+  if (targets.is_empty() || (targets.length() > max_checks)) {
+    return NULL;
+  }
+  ArgumentsDescriptor args_desc(
+      Array::Handle(zone_, ic_data.arguments_descriptor()));
+  const ICData& result =
+      ICData::ZoneHandle(zone_, ICData::NewFrom(ic_data, 1));
+  for (intptr_t i = 0; i < targets.length(); i++) {
+    const Function& target = *targets[i].target;
+    if (!target.AreValidArguments(args_desc, NULL)) {
+      continue;
+    }
+    result.AddReceiverCheck(targets[i].cid, target);
+  }
+  if (result.NumberOfChecks() == 0) {
+    return NULL;
+  }
+  return &result;
+}
+
+
 static void Jump(const Error& error) {
   Isolate::Current()->long_jump_base()->Jump(1, error);
 }
@@ -35,6 +99,7 @@ RawError* Precompiler::CompileAll() {
     precompiler.DoCompileAll();
     return Error::null();
   } else {
+    receiver_class_table_ = NULL;
     Isolate* isolate = Isolate::Current();
     const Error& error = Error::Handle(isolate->object_store()->sticky_error());
     isolate->object_store()->clear_sticky_error();
@@ -78,6 +143,10 @@ void Precompiler::DoCompileAll() {
   // point.
   Iterate();
 
+  if (FLAG_precompile_receiver_classes) {
+    CompileWithReceiverClasses();
+  }
+
   CleanUp();
 
   if (FLAG_trace_precompiler) {
@@ -93,6 +162,29 @@ void Precompiler::DoCompileAll() {
 }
 
 
+// All allocated classes are known now, so every dynamic call can only
+// dispatch to the targets of the allocated classes responding to its
+// selector. Recompile everything with that information available to the
+// optimizer. Should recompilation discover further allocated classes, the
+// table is stale and we start over.
+void Precompiler::CompileWithReceiverClasses() {
+  intptr_t class_count;
+  do {
+    class_count = class_count_;
+    if (FLAG_trace_precompiler) {
+      ISL_Print("Recompiling with %" Pd " allocated classes\n", class_count);
+    }
+    ReceiverClassTable table(Z);
+    receiver_class_table_ = &table;
+    ClearAllCode();
+    AddRoots();
+    changed_ = true;
+    Iterate();
+    receiver_class_table_ = NULL;
+  } while (class_count != class_count_);
+}
+
+
 void Precompiler::ClearAllCode() {
   Library& lib = Library::Handle(Z);
   Class& cls = Class::Handle(Z);
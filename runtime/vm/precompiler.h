@@ -6,6 +6,7 @@
 #define VM_PRECOMPILER_H_
 
 #include "vm/allocation.h"
+#include "vm/growable_array.h"
 #include "vm/hash_map.h"
 #include "vm/object.h"
 
@@ -76,14 +77,81 @@ class SymbolSet : public ValueObject {
 };
 
 
+struct ReceiverTarget {
+  intptr_t cid;
+  const Function* target;
+  ReceiverTarget() : cid(kIllegalCid), target(NULL) {}
+  ReceiverTarget(intptr_t cid_arg, const Function* target_arg)
+      : cid(cid_arg), target(target_arg) {}
+};
+
+
+class ReceiverTargetsPair {
+ public:
+  // Typedefs needed for the DirectChainedHashMap template.
+  typedef const String* Key;
+  typedef ZoneGrowableArray<ReceiverTarget>* Value;
+  typedef ReceiverTargetsPair Pair;
+
+  ReceiverTargetsPair() : key_(NULL), value_(NULL) {}
+  ReceiverTargetsPair(Key key, Value value) : key_(key), value_(value) {
+    ASSERT(key->IsNotTemporaryScopedHandle());
+  }
+
+  static Key KeyOf(Pair kv) { return kv.key_; }
+
+  static Value ValueOf(Pair kv) { return kv.value_; }
+
+  static inline intptr_t Hashcode(Key key) {
+    return key->Hash();
+  }
+
+  static inline bool IsKeyEqual(Pair pair, Key key) {
+    return pair.key_->raw() == key->raw();
+  }
+
+ private:
+  Key key_;
+  Value value_;
+};
+
+
+// Whole-program receiver class information: for a selector, the allocated
+// classes that respond to it and the functions they dispatch to. Only valid
+// once the precompiler has reached a fixed point and no further classes can
+// become allocated. Entries are computed lazily and cached.
+class ReceiverClassTable : public ValueObject {
+ public:
+  explicit ReceiverClassTable(Zone* zone) : zone_(zone), map_() {}
+
+  const ZoneGrowableArray<ReceiverTarget>& TargetsOf(const String& selector);
+
+  // Returns a copy of 'ic_data' checking for each allocated class whose
+  // target accepts the call's arguments, or NULL if there is no such class
+  // or more than 'max_checks'.
+  const ICData* CreateICData(const ICData& ic_data, intptr_t max_checks);
+
+ private:
+  Zone* zone_;
+  DirectChainedHashMap<ReceiverTargetsPair> map_;
+};
+
+
 class Precompiler : public ValueObject {
  public:
   static RawError* CompileAll();
 
+  // The receiver classes of the running precompilation, or NULL outside of
+  // the final compilation pass.
+  static ReceiverClassTable* receiver_class_table() {
+    return receiver_class_table_;
+  }
+
  private:
   explicit Precompiler(Thread* thread);
 
   void DoCompileAll();
+  void CompileWithReceiverClasses();
   void ClearAllCode();
   void AddRoots();
   void Iterate();
@@ -120,6 +188,8 @@ class Precompiler : public ValueObject {
   const GrowableObjectArray& collected_closures_;
   SymbolSet sent_selectors_;
   Error& error_;
+
+  static ReceiverClassTable* receiver_class_table_;
 };
 
 }  // namespace dart
@@ -0,0 +1,91 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dart_api_impl.h"
+#include "vm/dart_entry.h"
+#include "vm/object.h"
+#include "vm/precompiler.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static RawClass* GetClass(const Library& lib, const char* name) {
+  const Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(Symbols::New(name))));
+  EXPECT(!cls.IsNull());
+  return cls.raw();
+}
+
+
+TEST_CASE(ReceiverClassTableCreateICData) {
+  const char* kScript =
+      "class A { foo(x) => 1; }\n"
+      "class B extends A { }\n"
+      "class C { foo(x, [y]) => 2; }\n"
+      "class D { foo() => 3; }\n"
+      "abstract class E { foo(x); }\n"
+      "class F { bar(x) => 4; }\n"
+      "class G { foo(x) => 5; }\n";
+  Dart_Handle lib_h = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib_h);
+  Library& lib = Library::Handle();
+  lib ^= Api::UnwrapHandle(lib_h);
+  EXPECT(!lib.IsNull());
+
+  // G is never allocated.
+  const char* kAllocated[] = { "A", "B", "C", "D", "E", "F" };
+  Class& cls = Class::Handle();
+  for (intptr_t i = 0; i < ARRAY_SIZE(kAllocated); i++) {
+    cls = GetClass(lib, kAllocated[i]);
+    EXPECT(cls.EnsureIsFinalized(Isolate::Current()) == Error::null());
+    cls.set_is_allocated();
+  }
+  cls = GetClass(lib, "A");
+  const Function& a_foo = Function::Handle(
+      cls.LookupDynamicFunction(String::Handle(Symbols::New("foo"))));
+  EXPECT(!a_foo.IsNull());
+  cls = GetClass(lib, "C");
+  const Function& c_foo = Function::Handle(
+      cls.LookupDynamicFunction(String::Handle(Symbols::New("foo"))));
+  EXPECT(!c_foo.IsNull());
+
+  // A call of foo with one argument. D.foo does not accept it, F does not
+  // respond to foo, E is abstract and G is not allocated.
+  const Array& args_descriptor =
+      Array::Handle(ArgumentsDescriptor::New(2, Object::null_array()));
+  const ICData& ic_data = ICData::Handle(
+      ICData::New(a_foo, String::Handle(Symbols::New("foo")),
+                  args_descriptor, 1, 1));
+  ReceiverClassTable table(Thread::Current()->zone());
+  const ICData* result = table.CreateICData(ic_data, 4);
+  EXPECT(result != NULL);
+  EXPECT_EQ(3, result->NumberOfChecks());
+  EXPECT_EQ(1, result->NumArgsTested());
+  EXPECT_EQ(ic_data.deopt_id(), result->deopt_id());
+  EXPECT_EQ(GetClass(lib, "A"),
+            Isolate::Current()->class_table()->At(
+                result->GetReceiverClassIdAt(0)));
+  EXPECT_EQ(a_foo.raw(), result->GetTargetAt(0));
+  EXPECT_EQ(GetClass(lib, "B"),
+            Isolate::Current()->class_table()->At(
+                result->GetReceiverClassIdAt(1)));
+  EXPECT_EQ(a_foo.raw(), result->GetTargetAt(1));
+  EXPECT_EQ(GetClass(lib, "C"),
+            Isolate::Current()->class_table()->At(
+                result->GetReceiverClassIdAt(2)));
+  EXPECT_EQ(c_foo.raw(), result->GetTargetAt(2));
+
+  // Four allocated classes respond to foo.
+  EXPECT(table.CreateICData(ic_data, 3) == NULL);
+
+  // No allocated class responds to baz.
+  const ICData& baz_ic_data = ICData::Handle(
+      ICData::New(a_foo, String::Handle(Symbols::New("baz")),
+                  args_descriptor, 2, 1));
+  EXPECT(table.CreateICData(baz_ic_data, 4) == NULL);
+}
+
+}  // namespace dart
@@ -17,6 +17,7 @@
 #include "vm/object.h"
 #include "vm/os.h"
 #include "vm/profiler.h"
+#include "vm/profiler_export.h"
 #include "vm/reusable_handles.h"
 #include "vm/signal_handler.h"
 #include "vm/simulator.h"
@@ -38,7 +39,7 @@ DEFINE_FLAG(bool, trace_profiled_isolates, false, "Trace profiled isolates.");
   DEFINE_FLAG(int, profile_period, 1000,
               "Time between profiler samples in microseconds. Minimum 50.");
 #endif
-DEFINE_FLAG(int, profile_depth, 8,
+DEFINE_FLAG(int, profile_depth, 64,
             "Maximum number stack frames walked. Minimum 1. Maximum 255.");
 #if defined(USING_SIMULATOR)
 DEFINE_FLAG(bool, profile_vm, true,
@@ -73,6 +74,7 @@ void Profiler::InitOnce() {
   ThreadInterrupter::SetInterruptPeriod(FLAG_profile_period);
   ThreadInterrupter::Startup();
   initialized_ = true;
+  ProfileExporter::InitOnce();
 }
 
 
@@ -81,6 +83,8 @@ void Profiler::Shutdown() {
     return;
   }
   ASSERT(initialized_);
+  // Writes the last profile.
+  ProfileExporter::Shutdown();
   ThreadInterrupter::Shutdown();
   NativeSymbolResolver::ShutdownOnce();
 }
@@ -226,8 +230,7 @@ intptr_t Sample::instance_size_ = 0;
 
 
 void Sample::InitOnce() {
-  ASSERT(FLAG_profile_depth >= 2);
-  pcs_length_ = FLAG_profile_depth;
+  pcs_length_ = kPCArraySizeInWords;
   instance_size_ =
       sizeof(Sample) + (sizeof(uword) * pcs_length_);  // NOLINT.
 }
@@ -263,12 +266,30 @@ Sample* SampleBuffer::At(intptr_t idx) const {
 }
 
 
-Sample* SampleBuffer::ReserveSample() {
+intptr_t SampleBuffer::ReserveSampleSlot() {
   ASSERT(samples_ != NULL);
   uintptr_t cursor = AtomicOperations::FetchAndIncrement(&cursor_);
   // Map back into sample buffer range.
   cursor = cursor % capacity_;
-  return At(cursor);
+  return cursor;
+}
+
+
+Sample* SampleBuffer::ReserveSample() {
+  return At(ReserveSampleSlot());
+}
+
+
+Sample* SampleBuffer::ReserveSampleAndLink(Sample* previous) {
+  ASSERT(previous != NULL);
+  intptr_t next_index = ReserveSampleSlot();
+  Sample* next = At(next_index);
+  next->Init(previous->isolate(), previous->timestamp(), previous->tid());
+  next->set_vm_tag(previous->vm_tag());
+  next->set_user_tag(previous->user_tag());
+  next->set_is_continuation_sample(true);
+  previous->SetContinuationIndex(next_index);
+  return next;
 }
 
 // Attempts to find the true return address when a Dart frame is being setup
@@ -405,25 +426,66 @@ void ClearProfileVisitor::VisitSample(Sample* sample) {
 }
 
 
+// Appends the frames of a stack trace to a sample, chaining continuation
+// samples when a sample is full, until FLAG_profile_depth frames have been
+// collected.
+class ProfilerStackWalker : public ValueObject {
+ public:
+  ProfilerStackWalker(SampleBuffer* sample_buffer, Sample* sample)
+      : sample_buffer_(sample_buffer),
+        sample_(sample),
+        current_(sample),
+        frame_index_(0),
+        total_frames_(0) {
+    ASSERT(sample_buffer_ != NULL);
+    ASSERT(sample_ != NULL);
+  }
+
+  // Returns false, and marks the trace as truncated, if the stack trace is
+  // already at the maximum depth.
+  bool Append(uword pc) {
+    if (total_frames_ >= NumberOfFramesToCollect()) {
+      sample_->set_truncated_trace(true);
+      return false;
+    }
+    if (frame_index_ == Sample::pcs_length()) {
+      current_ = sample_buffer_->ReserveSampleAndLink(current_);
+      frame_index_ = 0;
+    }
+    current_->SetAt(frame_index_, pc);
+    frame_index_++;
+    total_frames_++;
+    return true;
+  }
+
+ protected:
+  SampleBuffer* sample_buffer_;
+  // First sample of the stack trace.
+  Sample* sample_;
+
+ private:
+  Sample* current_;
+  intptr_t frame_index_;
+  intptr_t total_frames_;
+};
+
+
 // Given an exit frame, walk the Dart stack.
-class ProfilerDartExitStackWalker : public ValueObject {
+class ProfilerDartExitStackWalker : public ProfilerStackWalker {
  public:
-  ProfilerDartExitStackWalker(Isolate* isolate, Sample* sample)
-      : sample_(sample),
+  ProfilerDartExitStackWalker(Isolate* isolate,
+                              SampleBuffer* sample_buffer,
+                              Sample* sample)
+      : ProfilerStackWalker(sample_buffer, sample),
         frame_iterator_(isolate) {
-    ASSERT(sample_ != NULL);
   }
 
   void walk() {
     // Mark that this sample was collected from an exit frame.
     sample_->set_exit_frame_sample(true);
-    intptr_t frame_index = 0;
     StackFrame* frame = frame_iterator_.NextFrame();
     while (frame != NULL) {
-      sample_->SetAt(frame_index, frame->pc());
-      frame_index++;
-      if (frame_index >= NumberOfFramesToCollect()) {
-        sample_->set_truncated_trace(true);
+      if (!Append(frame->pc())) {
         break;
       }
       frame = frame_iterator_.NextFrame();
@@ -431,24 +493,25 @@ class ProfilerDartExitStackWalker : public ValueObject {
   }
 
  private:
-  Sample* sample_;
   DartFrameIterator frame_iterator_;
 };
 
 
 // Executing Dart code, walk the stack.
-class ProfilerDartStackWalker : public ValueObject {
+class ProfilerDartStackWalker : public ProfilerStackWalker {
  public:
-  ProfilerDartStackWalker(Sample* sample,
+  ProfilerDartStackWalker(SampleBuffer* sample_buffer,
+                          Sample* sample,
                           uword stack_lower,
                           uword stack_upper,
                           uword pc,
                           uword fp,
                           uword sp)
-      : sample_(sample),
+      : ProfilerStackWalker(sample_buffer, sample),
         stack_upper_(stack_upper),
-        stack_lower_(stack_lower) {
-    ASSERT(sample_ != NULL);
+        stack_lower_(stack_lower),
+        invocation_stub_start_(0),
+        invocation_stub_end_(0) {
     pc_ = reinterpret_cast<uword*>(pc);
     fp_ = reinterpret_cast<uword*>(fp);
     sp_ = reinterpret_cast<uword*>(sp);
@@ -461,8 +524,12 @@ class ProfilerDartStackWalker : public ValueObject {
       return;
     }
     ASSERT(ValidFramePointer());
+    // Looked up once, as every frame is checked against it.
+    invocation_stub_start_ = StubCode::InvokeDartCode_entry()->EntryPoint();
+    invocation_stub_end_ =
+        invocation_stub_start_ + StubCode::InvokeDartCodeSize();
     uword return_pc = InitialReturnAddress();
-    if (StubCode::InInvocationStub(return_pc)) {
+    if (InInvocationStub(return_pc)) {
       // Edge case- we have called out from the Invocation Stub but have not
       // created the stack frame of the callee. Attempt to locate the exit
       // frame before walking the stack.
@@ -472,28 +539,30 @@ class ProfilerDartStackWalker : public ValueObject {
         return;
       }
     }
-    for (int i = 0; i < NumberOfFramesToCollect(); i++) {
-      sample_->SetAt(i, reinterpret_cast<uword>(pc_));
+    while (Append(reinterpret_cast<uword>(pc_))) {
       if (!Next()) {
         return;
       }
     }
-    sample_->set_truncated_trace(true);
   }
 
  private:
+  bool InInvocationStub(uword pc) const {
+    return (pc >= invocation_stub_start_) && (pc < invocation_stub_end_);
+  }
+
   bool Next() {
     if (!ValidFramePointer()) {
       return false;
     }
-    if (StubCode::InInvocationStub(reinterpret_cast<uword>(pc_))) {
+    if (InInvocationStub(reinterpret_cast<uword>(pc_))) {
       // In invocation stub.
       return NextExit();
     }
     // In regular Dart frame.
     uword* new_pc = CallerPC();
     // Check if we've moved into the invocation stub.
-    if (StubCode::InInvocationStub(reinterpret_cast<uword>(new_pc))) {
+    if (InInvocationStub(reinterpret_cast<uword>(new_pc))) {
       // New PC is inside invocation stub, skip.
       return NextExit();
     }
@@ -581,9 +650,10 @@ class ProfilerDartStackWalker : public ValueObject {
   uword* pc_;
   uword* fp_;
   uword* sp_;
-  Sample* sample_;
   const uword stack_upper_;
   uword stack_lower_;
+  uword invocation_stub_start_;
+  uword invocation_stub_end_;
 };
 
 
@@ -591,28 +661,26 @@ class ProfilerDartStackWalker : public ValueObject {
 // recent GCC versions with optimizing enabled) the stack walking code may
 // fail.
 //
-class ProfilerNativeStackWalker : public ValueObject {
+class ProfilerNativeStackWalker : public ProfilerStackWalker {
  public:
-  ProfilerNativeStackWalker(Sample* sample,
+  ProfilerNativeStackWalker(SampleBuffer* sample_buffer,
+                            Sample* sample,
                             uword stack_lower,
                             uword stack_upper,
                             uword pc,
                             uword fp,
                             uword sp)
-      : sample_(sample),
+      : ProfilerStackWalker(sample_buffer, sample),
         stack_upper_(stack_upper),
         original_pc_(pc),
         original_fp_(fp),
         original_sp_(sp),
         lower_bound_(stack_lower) {
-    ASSERT(sample_ != NULL);
   }
 
   void walk() {
     const uword kMaxStep = VirtualMemory::PageSize();
 
-    sample_->SetAt(0, original_pc_);
-
     uword* pc = reinterpret_cast<uword*>(original_pc_);
     uword* fp = reinterpret_cast<uword*>(original_fp_);
     uword* previous_fp = fp;
@@ -621,16 +689,16 @@ class ProfilerNativeStackWalker : public ValueObject {
     if (gap >= kMaxStep) {
       // Gap between frame pointer and stack pointer is
       // too large.
+      Append(original_pc_);
       return;
     }
 
     if (!ValidFramePointer(fp)) {
+      Append(original_pc_);
       return;
     }
 
-    for (int i = 0; i < NumberOfFramesToCollect(); i++) {
-      sample_->SetAt(i, reinterpret_cast<uword>(pc));
-
+    while (Append(reinterpret_cast<uword>(pc))) {
       pc = CallerPC(fp);
       previous_fp = fp;
       fp = CallerFP(fp);
@@ -658,8 +726,6 @@ class ProfilerNativeStackWalker : public ValueObject {
       // Move the lower bound up.
       lower_bound_ = reinterpret_cast<uword>(fp);
     }
-
-    sample_->set_truncated_trace(true);
   }
 
  private:
@@ -691,7 +757,6 @@ class ProfilerNativeStackWalker : public ValueObject {
     return r;
   }
 
-  Sample* sample_;
   const uword stack_upper_;
   const uword original_pc_;
   const uword original_fp_;
@@ -1003,7 +1068,8 @@ void Profiler::RecordAllocation(Isolate* isolate, intptr_t cid) {
                                  sample_buffer,
                                  OSThread::GetCurrentThreadId());
     sample->SetAllocationCid(cid);
-    ProfilerNativeStackWalker native_stack_walker(sample,
+    ProfilerNativeStackWalker native_stack_walker(sample_buffer,
+                                                  sample,
                                                   stack_lower,
                                                   stack_upper,
                                                   pc,
@@ -1016,7 +1082,9 @@ void Profiler::RecordAllocation(Isolate* isolate, intptr_t cid) {
                                  sample_buffer,
                                  OSThread::GetCurrentThreadId());
     sample->SetAllocationCid(cid);
-    ProfilerDartExitStackWalker dart_exit_stack_walker(isolate, sample);
+    ProfilerDartExitStackWalker dart_exit_stack_walker(isolate,
+                                                       sample_buffer,
+                                                       sample);
     dart_exit_stack_walker.walk();
   }
 }
@@ -1097,16 +1165,20 @@ void Profiler::RecordSampleInterruptCallback(
   ASSERT(counters != NULL);
   counters->Increment(sample->vm_tag());
 
-  ProfilerNativeStackWalker native_stack_walker(sample,
+  ProfilerNativeStackWalker native_stack_walker(sample_buffer,
+                                                sample,
                                                 stack_lower,
                                                 stack_upper,
                                                 pc,
                                                 fp,
                                                 sp);
 
-  ProfilerDartExitStackWalker dart_exit_stack_walker(isolate, sample);
+  ProfilerDartExitStackWalker dart_exit_stack_walker(isolate,
+                                                     sample_buffer,
+                                                     sample);
 
-  ProfilerDartStackWalker dart_stack_walker(sample,
+  ProfilerDartStackWalker dart_stack_walker(sample_buffer,
+                                            sample,
                                             stack_lower,
                                             stack_upper,
                                             pc,
@@ -1150,6 +1222,10 @@ ProcessedSampleBuffer* SampleBuffer::BuildProcessedSampleBuffer(
       // Empty.
       continue;
     }
+    if (sample->is_continuation_sample()) {
+      // Processed as part of its first sample.
+      continue;
+    }
     if (sample->At(0) == 0) {
       // No frames.
       continue;
@@ -1183,7 +1259,7 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(Sample* sample) {
   bool truncated = false;
   Sample* current = sample;
   while (current != NULL) {
-    for (intptr_t i = 0; i < FLAG_profile_depth; i++) {
+    for (intptr_t i = 0; i < Sample::pcs_length(); i++) {
       if (current->At(i) == 0) {
         break;
       }
@@ -1191,7 +1267,7 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(Sample* sample) {
     }
 
     truncated = truncated || current->truncated_trace();
-    current = Next(sample);
+    current = Next(current);
   }
 
   if (!sample->exit_frame_sample()) {
@@ -1209,8 +1285,17 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(Sample* sample) {
 
 
 Sample* SampleBuffer::Next(Sample* sample) {
-  // TODO(johnmccutchan): Support chaining samples for complete stack traces.
-  return NULL;
+  if (!sample->has_continuation_sample()) {
+    return NULL;
+  }
+  Sample* next_sample = At(sample->continuation_index());
+  // Sanity check that the continuation has not been overwritten since.
+  if (!next_sample->is_continuation_sample() ||
+      (next_sample->timestamp() != sample->timestamp()) ||
+      (next_sample->tid() != sample->tid())) {
+    return NULL;
+  }
+  return next_sample;
 }
 
 
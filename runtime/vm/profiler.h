@@ -166,6 +166,7 @@ class Sample {
     lr_ = 0;
     metadata_ = 0;
     state_ = 0;
+    continuation_index_ = -1;
     uword* pcs = GetPCArray();
     for (intptr_t i = 0; i < pcs_length_; i++) {
       pcs[i] = 0;
@@ -177,6 +178,11 @@ class Sample {
     return timestamp_;
   }
 
+  // Thread sample was taken on.
+  ThreadId tid() const {
+    return tid_;
+  }
+
   // Top most pc.
   uword pc() const {
     return At(0);
@@ -315,15 +321,48 @@ class Sample {
     set_metadata(cid);
   }
 
+  // A continuation sample holds the frames of a stack trace that did not fit
+  // into the sample before it.
+  bool is_continuation_sample() const {
+    return ContinuationSampleBit::decode(state_);
+  }
+
+  void set_is_continuation_sample(bool continuation_sample) {
+    state_ = ContinuationSampleBit::update(continuation_sample, state_);
+  }
+
+  bool has_continuation_sample() const {
+    return HasContinuationSampleBit::decode(state_);
+  }
+
+  // Index of the continuation sample in the sample buffer.
+  intptr_t continuation_index() const {
+    ASSERT(has_continuation_sample());
+    return continuation_index_;
+  }
+
+  void SetContinuationIndex(intptr_t index) {
+    ASSERT(!has_continuation_sample());
+    state_ = HasContinuationSampleBit::update(true, state_);
+    continuation_index_ = index;
+  }
+
   static void InitOnce();
 
   static intptr_t instance_size() {
     return instance_size_;
   }
 
+  // Number of pcs held by each sample.
+  static intptr_t pcs_length() {
+    return pcs_length_;
+  }
+
   uword* GetPCArray() const;
 
   static const int kStackBufferSizeInWords = 2;
+  // Deeper stack traces are split across continuation samples.
+  static const intptr_t kPCArraySizeInWords = 8;
   uword* GetStackBuffer() {
     return &stack_buffer_[0];
   }
@@ -339,6 +378,8 @@ class Sample {
     kMissingFrameInsertedBit = 4,
     kTruncatedTrace = 5,
     kClassAllocationSample = 6,
+    kContinuationSample = 7,
+    kHasContinuationSample = 8,
   };
   class ProcessedBit : public BitField<bool, kProcessedBit, 1> {};
   class LeafFrameIsDart : public BitField<bool, kLeafFrameIsDartBit, 1> {};
@@ -349,6 +390,10 @@ class Sample {
   class TruncatedTraceBit : public BitField<bool, kTruncatedTrace, 1> {};
   class ClassAllocationSampleBit
       : public BitField<bool, kClassAllocationSample, 1> {};
+  class ContinuationSampleBit
+      : public BitField<bool, kContinuationSample, 1> {};
+  class HasContinuationSampleBit
+      : public BitField<bool, kHasContinuationSample, 1> {};
 
   int64_t timestamp_;
   ThreadId tid_;
@@ -360,6 +405,7 @@ class Sample {
   uword metadata_;
   uword lr_;
   uword state_;
+  intptr_t continuation_index_;
 
   /* There are a variable number of words that follow, the words hold the
    * sampled pc values. Access via GetPCArray() */
@@ -386,9 +432,19 @@ class SampleBuffer {
 
   intptr_t capacity() const { return capacity_; }
 
+  // Number of samples reserved so far, before wrapping around.
+  uintptr_t cursor() const { return cursor_; }
+
   Sample* At(intptr_t idx) const;
   Sample* ReserveSample();
 
+  // Reserves a continuation sample for |previous| and links it.
+  Sample* ReserveSampleAndLink(Sample* previous);
+
+  // Returns the continuation of |sample|, or NULL if there is none or it has
+  // already been overwritten.
+  Sample* Next(Sample* sample);
+
   void VisitSamples(SampleVisitor* visitor) {
     ASSERT(visitor != NULL);
     const intptr_t length = capacity();
@@ -398,6 +454,10 @@ class SampleBuffer {
         // Bad sample.
         continue;
       }
+      if (sample->is_continuation_sample()) {
+        // Visited as part of its first sample.
+        continue;
+      }
       if (sample->isolate() != visitor->isolate()) {
         // Another isolate.
         continue;
@@ -418,8 +478,8 @@ class SampleBuffer {
   ProcessedSampleBuffer* BuildProcessedSampleBuffer(SampleFilter* filter);
 
  private:
+  intptr_t ReserveSampleSlot();
   ProcessedSample* BuildProcessedSample(Sample* sample);
-  Sample* Next(Sample* sample);
 
   Sample* samples_;
   intptr_t capacity_;
@@ -0,0 +1,767 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/profiler_export.h"
+
+#include "platform/utils.h"
+
+#include "vm/code_observers.h"
+#include "vm/flags.h"
+#include "vm/isolate.h"
+#include "vm/lockers.h"
+#include "vm/native_symbol.h"
+#include "vm/os.h"
+#include "vm/os_thread.h"
+#include "vm/profiler.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, profile_depth);
+DECLARE_FLAG(int, profile_period);
+
+DEFINE_FLAG(charp, profile_export_dir, NULL,
+            "Periodically write the samples collected by the profiler to "
+            "this directory as pprof profiles.");
+DEFINE_FLAG(int, profile_export_period, 60,
+            "Number of seconds of samples in each exported profile.");
+DEFINE_FLAG(int, profile_export_count, 10,
+            "Number of exported profiles kept before the oldest one is "
+            "overwritten.");
+
+// Time between drains of the sample buffer.
+static const int64_t kDrainPeriodMicros = 1000000;
+
+// Samples that were reserved most recently may still be being filled in by
+// the interrupted threads. They are left for the next drain.
+static const uintptr_t kSamplesInFlight = 64;
+
+
+static uword HashName(const char* name) {
+  // FNV-1a.
+  uword hash = 2166136261U;
+  for (const uint8_t* p = reinterpret_cast<const uint8_t*>(name);
+       *p != '\0';
+       p++) {
+    hash = (hash ^ *p) * 16777619U;
+  }
+  return hash;
+}
+
+
+static uword HashWord(uword value) {
+  // Fold the bits that differ between nearby addresses into the low bits.
+  value ^= value >> 16;
+  value *= 0x45d9f3b;
+  value ^= value >> 16;
+  return value;
+}
+
+
+class ProfilerExportCodeObserver : public CodeObserver {
+ public:
+  explicit ProfilerExportCodeObserver(ProfilerCodeMap* code_map)
+      : code_map_(code_map) { }
+
+  virtual bool IsActive() const {
+    return FLAG_profile_export_dir != NULL;
+  }
+
+  virtual void Notify(const char* name,
+                      uword base,
+                      uword prologue_offset,
+                      uword size,
+                      bool optimized) {
+    code_map_->Add(name, base, size);
+  }
+
+  virtual void NotifyUnload(uword base, uword size) {
+    code_map_->Remove(base, size);
+  }
+
+ private:
+  ProfilerCodeMap* code_map_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerExportCodeObserver);
+};
+
+
+ProfilerCodeMap::ProfilerCodeMap()
+    : mutex_(new Mutex()),
+      name_table_(NULL),
+      name_table_size_(0) {
+  GrowNameTable();
+}
+
+
+ProfilerCodeMap::~ProfilerCodeMap() {
+  for (intptr_t i = 0; i < pending_.length(); i++) {
+    if (pending_[i].name != NULL) {
+      free(pending_[i].name);
+    }
+  }
+  for (intptr_t i = 0; i < names_.length(); i++) {
+    free(names_[i]);
+  }
+  free(name_table_);
+  delete mutex_;
+}
+
+
+void ProfilerCodeMap::Add(const char* name, uword start, uword size) {
+  PendingEntry entry;
+  entry.start = start;
+  entry.end = start + size;
+  entry.name = strdup(name);
+  MutexLocker ml(mutex_);
+  pending_.Add(entry);
+}
+
+
+void ProfilerCodeMap::Remove(uword start, uword size) {
+  PendingEntry entry;
+  entry.start = start;
+  entry.end = start + size;
+  entry.name = NULL;
+  MutexLocker ml(mutex_);
+  pending_.Add(entry);
+}
+
+
+int ProfilerCodeMap::CompareEntries(const Entry* a, const Entry* b) {
+  if (a->start < b->start) {
+    return -1;
+  } else if (a->start > b->start) {
+    return 1;
+  }
+  return 0;
+}
+
+
+bool ProfilerCodeMap::Update() {
+  MallocGrowableArray<Entry> added;
+  MallocGrowableArray<uword> removed;
+  {
+    MutexLocker ml(mutex_);
+    for (intptr_t i = 0; i < pending_.length(); i++) {
+      if (pending_[i].name == NULL) {
+        // Code added since the last update may already be gone again.
+        for (intptr_t k = 0; k < added.length(); k++) {
+          if (added[k].start == pending_[i].start) {
+            added[k] = added.Last();
+            added.RemoveLast();
+            break;
+          }
+        }
+        removed.Add(pending_[i].start);
+        continue;
+      }
+      Entry entry;
+      entry.start = pending_[i].start;
+      entry.end = pending_[i].end;
+      entry.name_id = InternName(pending_[i].name);
+      free(pending_[i].name);
+      added.Add(entry);
+    }
+    pending_.Clear();
+  }
+  if (added.is_empty() && removed.is_empty()) {
+    return false;
+  }
+  added.Sort(CompareEntries);
+
+  // Merge the sorted lists, dropping old code that has been collected or
+  // that overlaps new code. The memory of old code is only reused once the
+  // code has been collected.
+  bool replaced = false;
+  MallocGrowableArray<Entry> merged(entries_.length() + added.length());
+  intptr_t j = 0;
+  for (intptr_t i = 0; i < entries_.length(); i++) {
+    const Entry& entry = entries_[i];
+    if (IsRemoved(removed, entry.start)) {
+      replaced = true;
+      continue;
+    }
+    while ((j < added.length()) && (added[j].start <= entry.start)) {
+      merged.Add(added[j++]);
+    }
+    if (((j > 0) && (added[j - 1].end > entry.start)) ||
+        ((j < added.length()) && (entry.end > added[j].start))) {
+      replaced = true;
+      continue;
+    }
+    merged.Add(entry);
+  }
+  while (j < added.length()) {
+    merged.Add(added[j++]);
+  }
+  entries_.Clear();
+  for (intptr_t i = 0; i < merged.length(); i++) {
+    entries_.Add(merged[i]);
+  }
+  return replaced;
+}
+
+
+bool ProfilerCodeMap::IsRemoved(const MallocGrowableArray<uword>& removed,
+                                uword start) {
+  for (intptr_t i = 0; i < removed.length(); i++) {
+    if (removed[i] == start) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+intptr_t ProfilerCodeMap::Lookup(uword pc) const {
+  // Find the last entry starting at or before |pc|.
+  intptr_t low = 0;
+  intptr_t high = entries_.length() - 1;
+  intptr_t found = -1;
+  while (low <= high) {
+    intptr_t mid = low + (high - low) / 2;
+    if (entries_[mid].start <= pc) {
+      found = mid;
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  if ((found < 0) || (pc >= entries_[found].end)) {
+    return -1;
+  }
+  return entries_[found].name_id;
+}
+
+
+intptr_t ProfilerCodeMap::InternName(const char* name) {
+  const intptr_t mask = name_table_size_ - 1;
+  intptr_t index = HashName(name) & mask;
+  while (name_table_[index] != -1) {
+    if (strcmp(names_[name_table_[index]], name) == 0) {
+      return name_table_[index];
+    }
+    index = (index + 1) & mask;
+  }
+  const intptr_t id = names_.length();
+  names_.Add(strdup(name));
+  name_table_[index] = id;
+  if (2 * names_.length() >= name_table_size_) {
+    GrowNameTable();
+  }
+  return id;
+}
+
+
+void ProfilerCodeMap::GrowNameTable() {
+  const intptr_t size =
+      (name_table_size_ == 0) ? 1024 : (2 * name_table_size_);
+  const intptr_t mask = size - 1;
+  free(name_table_);
+  name_table_ = reinterpret_cast<intptr_t*>(
+      malloc(size * sizeof(*name_table_)));
+  name_table_size_ = size;
+  for (intptr_t i = 0; i < size; i++) {
+    name_table_[i] = -1;
+  }
+  for (intptr_t id = 0; id < names_.length(); id++) {
+    intptr_t index = HashName(names_[id]) & mask;
+    while (name_table_[index] != -1) {
+      index = (index + 1) & mask;
+    }
+    name_table_[index] = id;
+  }
+}
+
+
+// Writes the protocol buffer wire format.
+class ProtobufWriter : public ValueObject {
+ public:
+  enum WireType {
+    kVarint = 0,
+    kLengthDelimited = 2,
+  };
+
+  explicit ProtobufWriter(MallocGrowableArray<uint8_t>* bytes)
+      : bytes_(bytes) { }
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      bytes_->Add(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    bytes_->Add(static_cast<uint8_t>(value));
+  }
+
+  void WriteInt(intptr_t field, uint64_t value) {
+    WriteVarint((field << 3) | kVarint);
+    WriteVarint(value);
+  }
+
+  void WriteBytes(intptr_t field, const uint8_t* data, intptr_t length) {
+    WriteVarint((field << 3) | kLengthDelimited);
+    WriteVarint(length);
+    for (intptr_t i = 0; i < length; i++) {
+      bytes_->Add(data[i]);
+    }
+  }
+
+  void WriteString(intptr_t field, const char* string) {
+    WriteBytes(field, reinterpret_cast<const uint8_t*>(string), strlen(string));
+  }
+
+  // Writes |message| as a nested message and clears it.
+  void WriteMessage(intptr_t field, MallocGrowableArray<uint8_t>* message) {
+    WriteBytes(field, message->data(), message->length());
+    message->Clear();
+  }
+
+ private:
+  MallocGrowableArray<uint8_t>* bytes_;
+};
+
+
+// Field numbers and fixed string table entries of profile.proto.
+enum {
+  kProfileSampleType = 1,
+  kProfileSample = 2,
+  kProfileLocation = 4,
+  kProfileFunction = 5,
+  kProfileStringTable = 6,
+  kProfileTimeNanos = 9,
+  kProfileDurationNanos = 10,
+  kProfilePeriodType = 11,
+  kProfilePeriod = 12,
+
+  kValueTypeType = 1,
+  kValueTypeUnit = 2,
+
+  kSampleLocationId = 1,
+  kSampleValue = 2,
+
+  kLocationId = 1,
+  kLocationAddress = 3,
+  kLocationLine = 4,
+
+  kLineFunctionId = 1,
+
+  kFunctionId = 1,
+  kFunctionName = 2,
+  kFunctionSystemName = 3,
+};
+
+static const char* kFixedStrings[] = {
+  "", "samples", "count", "cpu", "nanoseconds",
+};
+static const intptr_t kSamplesString = 1;
+static const intptr_t kCountString = 2;
+static const intptr_t kCpuString = 3;
+static const intptr_t kNanosecondsString = 4;
+static const intptr_t kNumFixedStrings = ARRAY_SIZE(kFixedStrings);
+
+
+PprofBuilder::PprofBuilder(ProfilerCodeMap* code_map)
+    : code_map_(code_map),
+      num_samples_(0),
+      num_pcs_(0) {
+  Reset();
+}
+
+
+PprofBuilder::~PprofBuilder() {
+}
+
+
+void PprofBuilder::AddSample(const uword* pcs, intptr_t length) {
+  const intptr_t offset = stack_data_.length();
+  uword hash = length;
+  for (intptr_t i = 0; i < length; i++) {
+    const intptr_t location = LocationFor(pcs[i]);
+    stack_data_.Add(location);
+    hash = HashWord(hash + location);
+  }
+  num_samples_++;
+
+  const intptr_t mask = stack_table_.length() - 1;
+  intptr_t index = hash & mask;
+  while (stack_table_[index] != -1) {
+    Stack& stack = stacks_[stack_table_[index]];
+    if ((stack.hash == hash) && StackEquals(stack, offset, length)) {
+      // Seen before, drop the copy.
+      stack.count++;
+      stack_data_.TruncateTo(offset);
+      return;
+    }
+    index = (index + 1) & mask;
+  }
+  Stack stack;
+  stack.hash = hash;
+  stack.offset = offset;
+  stack.length = length;
+  stack.count = 1;
+  stack_table_[index] = stacks_.length();
+  stacks_.Add(stack);
+  if (2 * stacks_.length() >= stack_table_.length()) {
+    GrowStackTable();
+  }
+}
+
+
+bool PprofBuilder::StackEquals(const Stack& stack,
+                               intptr_t offset,
+                               intptr_t length) const {
+  if (stack.length != length) {
+    return false;
+  }
+  for (intptr_t i = 0; i < length; i++) {
+    if (stack_data_[stack.offset + i] != stack_data_[offset + i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void PprofBuilder::GrowStackTable() {
+  const intptr_t size = 2 * stack_table_.length();
+  const intptr_t mask = size - 1;
+  stack_table_.SetLength(size);
+  for (intptr_t i = 0; i < size; i++) {
+    stack_table_[i] = -1;
+  }
+  for (intptr_t i = 0; i < stacks_.length(); i++) {
+    intptr_t index = stacks_[i].hash & mask;
+    while (stack_table_[index] != -1) {
+      index = (index + 1) & mask;
+    }
+    stack_table_[index] = i;
+  }
+}
+
+
+intptr_t PprofBuilder::LocationFor(uword pc) {
+  // Look for the symbolized address. Zero marks an empty entry, as sampled
+  // pcs are never zero.
+  intptr_t mask = pc_keys_.length() - 1;
+  intptr_t index = HashWord(pc) & mask;
+  while (pc_keys_[index] != 0) {
+    if (pc_keys_[index] == pc) {
+      return pc_values_[index];
+    }
+    index = (index + 1) & mask;
+  }
+
+  intptr_t name_id = code_map_->Lookup(pc);
+  if (name_id < 0) {
+    uintptr_t start = 0;
+    char* native_name = NativeSymbolResolver::LookupSymbolName(pc, &start);
+    if (native_name != NULL) {
+      name_id = code_map_->InternName(native_name);
+      NativeSymbolResolver::FreeSymbolName(native_name);
+    } else {
+      name_id = code_map_->InternName("[Unknown]");
+    }
+  }
+  Location location;
+  location.address = pc;
+  location.function = FunctionFor(name_id);
+  const intptr_t result = locations_.length();
+  locations_.Add(location);
+
+  pc_keys_[index] = pc;
+  pc_values_[index] = result;
+  num_pcs_++;
+  if (2 * num_pcs_ >= pc_keys_.length()) {
+    const intptr_t size = 2 * pc_keys_.length();
+    MallocGrowableArray<uword> keys(size);
+    MallocGrowableArray<intptr_t> values(size);
+    for (intptr_t i = 0; i < pc_keys_.length(); i++) {
+      keys.Add(pc_keys_[i]);
+      values.Add(pc_values_[i]);
+    }
+    pc_keys_.SetLength(size);
+    pc_values_.SetLength(size);
+    for (intptr_t i = 0; i < size; i++) {
+      pc_keys_[i] = 0;
+    }
+    mask = size - 1;
+    for (intptr_t i = 0; i < keys.length(); i++) {
+      if (keys[i] == 0) {
+        continue;
+      }
+      index = HashWord(keys[i]) & mask;
+      while (pc_keys_[index] != 0) {
+        index = (index + 1) & mask;
+      }
+      pc_keys_[index] = keys[i];
+      pc_values_[index] = values[i];
+    }
+  }
+  return result;
+}
+
+
+intptr_t PprofBuilder::FunctionFor(intptr_t name_id) {
+  while (function_ids_.length() <= name_id) {
+    function_ids_.Add(-1);
+  }
+  if (function_ids_[name_id] == -1) {
+    function_ids_[name_id] = functions_.length();
+    functions_.Add(name_id);
+  }
+  return function_ids_[name_id];
+}
+
+
+void PprofBuilder::ForgetAddresses() {
+  const intptr_t kInitialSize = 1024;
+  pc_keys_.SetLength(kInitialSize);
+  pc_values_.SetLength(kInitialSize);
+  for (intptr_t i = 0; i < kInitialSize; i++) {
+    pc_keys_[i] = 0;
+  }
+  num_pcs_ = 0;
+}
+
+
+void PprofBuilder::Reset() {
+  const intptr_t kInitialSize = 1024;
+  num_samples_ = 0;
+  locations_.Clear();
+  ForgetAddresses();
+  functions_.Clear();
+  function_ids_.Clear();
+  stacks_.Clear();
+  stack_data_.Clear();
+  stack_table_.SetLength(kInitialSize);
+  for (intptr_t i = 0; i < kInitialSize; i++) {
+    stack_table_[i] = -1;
+  }
+}
+
+
+void PprofBuilder::Encode(int64_t start_micros,
+                          int64_t duration_micros,
+                          int64_t period_micros,
+                          MallocGrowableArray<uint8_t>* bytes) const {
+  const int64_t period_nanos = period_micros * kNanosecondsPerMicrosecond;
+  ProtobufWriter profile(bytes);
+  MallocGrowableArray<uint8_t> message;
+  ProtobufWriter message_writer(&message);
+  MallocGrowableArray<uint8_t> inner;
+  ProtobufWriter inner_writer(&inner);
+
+  message_writer.WriteInt(kValueTypeType, kSamplesString);
+  message_writer.WriteInt(kValueTypeUnit, kCountString);
+  profile.WriteMessage(kProfileSampleType, &message);
+  message_writer.WriteInt(kValueTypeType, kCpuString);
+  message_writer.WriteInt(kValueTypeUnit, kNanosecondsString);
+  profile.WriteMessage(kProfileSampleType, &message);
+
+  // Ids are indices plus one, as zero is not a valid id.
+  for (intptr_t i = 0; i < stacks_.length(); i++) {
+    const Stack& stack = stacks_[i];
+    for (intptr_t j = 0; j < stack.length; j++) {
+      inner_writer.WriteVarint(stack_data_[stack.offset + j] + 1);
+    }
+    message_writer.WriteMessage(kSampleLocationId, &inner);
+    inner_writer.WriteVarint(stack.count);
+    inner_writer.WriteVarint(stack.count * period_nanos);
+    message_writer.WriteMessage(kSampleValue, &inner);
+    profile.WriteMessage(kProfileSample, &message);
+  }
+
+  for (intptr_t i = 0; i < locations_.length(); i++) {
+    message_writer.WriteInt(kLocationId, i + 1);
+    message_writer.WriteInt(kLocationAddress, locations_[i].address);
+    inner_writer.WriteInt(kLineFunctionId, locations_[i].function + 1);
+    message_writer.WriteMessage(kLocationLine, &inner);
+    profile.WriteMessage(kProfileLocation, &message);
+  }
+
+  // Function names follow the fixed strings in the string table.
+  for (intptr_t i = 0; i < functions_.length(); i++) {
+    message_writer.WriteInt(kFunctionId, i + 1);
+    message_writer.WriteInt(kFunctionName, kNumFixedStrings + i);
+    message_writer.WriteInt(kFunctionSystemName, kNumFixedStrings + i);
+    profile.WriteMessage(kProfileFunction, &message);
+  }
+
+  for (intptr_t i = 0; i < kNumFixedStrings; i++) {
+    profile.WriteString(kProfileStringTable, kFixedStrings[i]);
+  }
+  for (intptr_t i = 0; i < functions_.length(); i++) {
+    profile.WriteString(kProfileStringTable,
+                        code_map_->NameAt(functions_[i]));
+  }
+
+  profile.WriteInt(kProfileTimeNanos,
+                   start_micros * kNanosecondsPerMicrosecond);
+  profile.WriteInt(kProfileDurationNanos,
+                   duration_micros * kNanosecondsPerMicrosecond);
+  message_writer.WriteInt(kValueTypeType, kCpuString);
+  message_writer.WriteInt(kValueTypeUnit, kNanosecondsString);
+  profile.WriteMessage(kProfilePeriodType, &message);
+  profile.WriteInt(kProfilePeriod, period_nanos);
+}
+
+
+ProfilerCodeMap* ProfileExporter::code_map_ = NULL;
+Monitor* ProfileExporter::monitor_ = NULL;
+bool ProfileExporter::shutdown_ = false;
+bool ProfileExporter::thread_running_ = false;
+uintptr_t ProfileExporter::cursor_ = 0;
+intptr_t ProfileExporter::profiles_written_ = 0;
+
+
+void ProfileExporter::InitOnce() {
+  if (FLAG_profile_export_dir == NULL) {
+    return;
+  }
+  if (FLAG_profile_export_period < 1) {
+    FLAG_profile_export_period = 1;
+  }
+  if (FLAG_profile_export_count < 1) {
+    FLAG_profile_export_count = 1;
+  }
+  ASSERT(code_map_ == NULL);
+  code_map_ = new ProfilerCodeMap();
+  CodeObservers::Register(new ProfilerExportCodeObserver(code_map_));
+  monitor_ = new Monitor();
+  MonitorLocker startup_ml(monitor_);
+  OSThread::Start(ThreadMain, 0);
+  while (!thread_running_) {
+    startup_ml.Wait();
+  }
+}
+
+
+void ProfileExporter::Shutdown() {
+  if (monitor_ == NULL) {
+    return;
+  }
+  MonitorLocker shutdown_ml(monitor_);
+  if (shutdown_) {
+    // Already shutdown.
+    return;
+  }
+  shutdown_ = true;
+  shutdown_ml.Notify();
+  // Wait for the last profile to be written.
+  while (thread_running_) {
+    shutdown_ml.Wait();
+  }
+}
+
+
+void ProfileExporter::ThreadMain(uword parameters) {
+  PprofBuilder builder(code_map_);
+  int64_t start_micros = OS::GetCurrentTimeMicros();
+  const int64_t export_period_micros =
+      static_cast<int64_t>(FLAG_profile_export_period) * kMicrosecondsPerSecond;
+  MonitorLocker ml(monitor_);
+  cursor_ = Profiler::sample_buffer()->cursor();
+  thread_running_ = true;
+  ml.Notify();
+  while (!shutdown_) {
+    ml.WaitMicros(kDrainPeriodMicros);
+    DrainSamples(&builder);
+    const int64_t now = OS::GetCurrentTimeMicros();
+    if (shutdown_ || (now - start_micros >= export_period_micros)) {
+      WriteProfile(&builder, start_micros, now);
+      start_micros = now;
+    }
+  }
+  thread_running_ = false;
+  ml.Notify();
+}
+
+
+void ProfileExporter::DrainSamples(PprofBuilder* builder) {
+  if (code_map_->Update()) {
+    builder->ForgetAddresses();
+  }
+  SampleBuffer* sample_buffer = Profiler::sample_buffer();
+  const uintptr_t capacity = sample_buffer->capacity();
+  const uintptr_t cursor = sample_buffer->cursor();
+  if (cursor < kSamplesInFlight) {
+    return;
+  }
+  const uintptr_t end = cursor - kSamplesInFlight;
+  uintptr_t start = cursor_;
+  if (end <= start) {
+    return;
+  }
+  if (end - start > capacity - kSamplesInFlight) {
+    // Older samples have already been overwritten.
+    start = end - (capacity - kSamplesInFlight);
+  }
+  uword* pcs = new uword[FLAG_profile_depth];
+  for (uintptr_t i = start; i < end; i++) {
+    Sample* sample = sample_buffer->At(i % capacity);
+    if (sample->ignore_sample() ||
+        (sample->timestamp() == 0) ||
+        sample->is_continuation_sample() ||
+        sample->is_allocation_sample()) {
+      continue;
+    }
+    intptr_t length = 0;
+    for (Sample* current = sample;
+         current != NULL;
+         current = sample_buffer->Next(current)) {
+      for (intptr_t j = 0; j < Sample::pcs_length(); j++) {
+        if ((current->At(j) == 0) || (length == FLAG_profile_depth)) {
+          break;
+        }
+        pcs[length++] = current->At(j);
+      }
+    }
+    if (length > 0) {
+      builder->AddSample(pcs, length);
+    }
+  }
+  delete[] pcs;
+  cursor_ = end;
+}
+
+
+void ProfileExporter::WriteProfile(PprofBuilder* builder,
+                                   int64_t start_micros,
+                                   int64_t end_micros) {
+  if (builder->num_samples() == 0) {
+    // Keep the previous profiles rather than overwriting them with nothing.
+    return;
+  }
+  Dart_FileOpenCallback file_open = Isolate::file_open_callback();
+  Dart_FileWriteCallback file_write = Isolate::file_write_callback();
+  Dart_FileCloseCallback file_close = Isolate::file_close_callback();
+  if ((file_open == NULL) || (file_write == NULL) || (file_close == NULL)) {
+    builder->Reset();
+    return;
+  }
+  MallocGrowableArray<uint8_t> bytes(64 * KB);
+  builder->Encode(start_micros,
+                  end_micros - start_micros,
+                  FLAG_profile_period,
+                  &bytes);
+  builder->Reset();
+
+  const char* format = "%s/dart-profile-%" Pd "-%" Pd ".pb";
+  const intptr_t pid = OS::ProcessId();
+  const intptr_t index = profiles_written_++ % FLAG_profile_export_count;
+  intptr_t len = OS::SNPrint(NULL, 0, format,
+                             FLAG_profile_export_dir, pid, index);
+  char* filename = new char[len + 1];
+  OS::SNPrint(filename, len + 1, format, FLAG_profile_export_dir, pid, index);
+  void* file = (*file_open)(filename, true);
+  if (file == NULL) {
+    OS::PrintErr("Failed to write profile file: %s\n", filename);
+  } else {
+    (*file_write)(bytes.data(), bytes.length(), file);
+    (*file_close)(file);
+  }
+  delete[] filename;
+}
+
+}  // namespace dart
@@ -0,0 +1,181 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_PROFILER_EXPORT_H_
+#define VM_PROFILER_EXPORT_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/growable_array.h"
+
+// Continuous export of the samples collected by the profiler.
+// NOTE: For the service protocol profiles, see profiler_service.h.
+
+namespace dart {
+
+class Monitor;
+class Mutex;
+
+// Maps addresses of generated code to the names of their functions, without
+// looking at the heap. Code is added by a code observer as it is created on
+// any thread, and is merged into the map by |Update|. All other methods must
+// only be called by the thread that owns the map.
+class ProfilerCodeMap {
+ public:
+  ProfilerCodeMap();
+  ~ProfilerCodeMap();
+
+  // Records code created at [start, start + size). Thread safe.
+  void Add(const char* name, uword start, uword size);
+
+  // Records that the code at [start, start + size) has been collected.
+  // Thread safe.
+  void Remove(uword start, uword size);
+
+  // Merges the code added and removed since the last update. Returns true if
+  // code that was already in the map has been replaced or removed.
+  bool Update();
+
+  // Returns the id of the name of the code containing |pc|, or -1.
+  intptr_t Lookup(uword pc) const;
+
+  // Returns the id of |name|, adding a copy of |name| if needed.
+  intptr_t InternName(const char* name);
+
+  const char* NameAt(intptr_t id) const {
+    return names_[id];
+  }
+
+ private:
+  struct Entry {
+    uword start;
+    uword end;
+    intptr_t name_id;
+  };
+
+  // A NULL name marks collected code.
+  struct PendingEntry {
+    uword start;
+    uword end;
+    char* name;
+  };
+
+  static int CompareEntries(const Entry* a, const Entry* b);
+  static bool IsRemoved(const MallocGrowableArray<uword>& removed,
+                        uword start);
+  void GrowNameTable();
+
+  Mutex* mutex_;
+  // Guarded by |mutex_|.
+  MallocGrowableArray<PendingEntry> pending_;
+  // Sorted by start address.
+  MallocGrowableArray<Entry> entries_;
+  MallocGrowableArray<char*> names_;
+  // Open addressed table of name ids, -1 marks an empty entry.
+  intptr_t* name_table_;
+  intptr_t name_table_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProfilerCodeMap);
+};
+
+
+// Aggregates stack traces, symbolized with a |ProfilerCodeMap|, and encodes
+// them as a pprof profile. Identical stack traces are counted once.
+class PprofBuilder {
+ public:
+  explicit PprofBuilder(ProfilerCodeMap* code_map);
+  ~PprofBuilder();
+
+  // Adds a stack trace of |length| pcs, leaf first.
+  void AddSample(const uword* pcs, intptr_t length);
+
+  // Forgets the symbols of the addresses seen so far. Called when code has
+  // been replaced, so that new samples are symbolized again.
+  void ForgetAddresses();
+
+  // Appends the profile to |bytes|. Every sample is counted as |period| of
+  // cpu time, in microseconds.
+  void Encode(int64_t start_micros,
+              int64_t duration_micros,
+              int64_t period_micros,
+              MallocGrowableArray<uint8_t>* bytes) const;
+
+  // Forgets all samples.
+  void Reset();
+
+  intptr_t num_samples() const {
+    return num_samples_;
+  }
+
+  intptr_t num_stacks() const {
+    return stacks_.length();
+  }
+
+ private:
+  struct Location {
+    uword address;
+    intptr_t function;
+  };
+
+  struct Stack {
+    uword hash;
+    intptr_t offset;
+    intptr_t length;
+    int64_t count;
+  };
+
+  intptr_t LocationFor(uword pc);
+  intptr_t FunctionFor(intptr_t name_id);
+  bool StackEquals(const Stack& stack, intptr_t offset, intptr_t length) const;
+  void GrowStackTable();
+
+  ProfilerCodeMap* code_map_;
+  intptr_t num_samples_;
+  // Symbolized addresses.
+  MallocGrowableArray<Location> locations_;
+  MallocGrowableArray<uword> pc_keys_;
+  MallocGrowableArray<intptr_t> pc_values_;
+  intptr_t num_pcs_;
+  // Functions, as ids of their names in |code_map_|.
+  MallocGrowableArray<intptr_t> functions_;
+  MallocGrowableArray<intptr_t> function_ids_;
+  // Aggregated stack traces, as indices into |locations_|.
+  MallocGrowableArray<Stack> stacks_;
+  MallocGrowableArray<intptr_t> stack_data_;
+  MallocGrowableArray<intptr_t> stack_table_;
+
+  DISALLOW_COPY_AND_ASSIGN(PprofBuilder);
+};
+
+
+// Periodically drains the shared sample buffer on a background thread and
+// writes the samples as rolling pprof profiles to --profile_export_dir.
+class ProfileExporter : public AllStatic {
+ public:
+  static void InitOnce();
+  static void Shutdown();
+
+  static ProfilerCodeMap* code_map() {
+    return code_map_;
+  }
+
+ private:
+  static void ThreadMain(uword parameters);
+  static void DrainSamples(PprofBuilder* builder);
+  static void WriteProfile(PprofBuilder* builder,
+                           int64_t start_micros,
+                           int64_t end_micros);
+
+  static ProfilerCodeMap* code_map_;
+  static Monitor* monitor_;
+  static bool shutdown_;
+  static bool thread_running_;
+  // Raw cursor of the sample buffer up to which samples have been drained.
+  static uintptr_t cursor_;
+  static intptr_t profiles_written_;
+};
+
+}  // namespace dart
+
+#endif  // VM_PROFILER_EXPORT_H_
@@ -0,0 +1,85 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+
+#include "vm/globals.h"
+#include "vm/profiler_export.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static bool ContainsString(const MallocGrowableArray<uint8_t>& bytes,
+                           const char* string) {
+  const intptr_t length = strlen(string);
+  for (intptr_t i = 0; i + length <= bytes.length(); i++) {
+    if (memcmp(bytes.data() + i, string, length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+TEST_CASE(Profiler_ExportCodeMap) {
+  ProfilerCodeMap code_map;
+  code_map.Add("foo", 0x1000, 0x100);
+  code_map.Add("bar", 0x3000, 0x80);
+  EXPECT(!code_map.Update());
+  EXPECT_EQ(-1, code_map.Lookup(0xfff));
+  EXPECT_STREQ("foo", code_map.NameAt(code_map.Lookup(0x1000)));
+  EXPECT_STREQ("foo", code_map.NameAt(code_map.Lookup(0x10ff)));
+  EXPECT_EQ(-1, code_map.Lookup(0x1100));
+  EXPECT_STREQ("bar", code_map.NameAt(code_map.Lookup(0x3040)));
+  EXPECT_EQ(-1, code_map.Lookup(0x3080));
+
+  // New code at the address of collected code replaces it.
+  code_map.Add("baz", 0x2000, 0x100);
+  EXPECT(!code_map.Update());
+  code_map.Add("qux", 0x1080, 0x40);
+  EXPECT(code_map.Update());
+  EXPECT_EQ(-1, code_map.Lookup(0x1000));
+  EXPECT_STREQ("qux", code_map.NameAt(code_map.Lookup(0x1090)));
+  EXPECT_STREQ("baz", code_map.NameAt(code_map.Lookup(0x2000)));
+  EXPECT_EQ(code_map.InternName("bar"), code_map.Lookup(0x3000));
+
+  // Collected code is dropped, also if it was added since the last update.
+  code_map.Remove(0x2000, 0x100);
+  code_map.Add("quux", 0x4000, 0x100);
+  code_map.Remove(0x4000, 0x100);
+  EXPECT(code_map.Update());
+  EXPECT_EQ(-1, code_map.Lookup(0x2000));
+  EXPECT_EQ(-1, code_map.Lookup(0x4000));
+  EXPECT_STREQ("bar", code_map.NameAt(code_map.Lookup(0x3000)));
+}
+
+
+TEST_CASE(Profiler_ExportPprof) {
+  ProfilerCodeMap code_map;
+  code_map.Add("leafFunction", 0x1000, 0x100);
+  code_map.Add("callerFunction", 0x2000, 0x100);
+  code_map.Update();
+  PprofBuilder builder(&code_map);
+  const uword stack1[] = { 0x1010, 0x2010 };
+  const uword stack2[] = { 0x1020, 0x2010 };
+  builder.AddSample(stack1, ARRAY_SIZE(stack1));
+  builder.AddSample(stack2, ARRAY_SIZE(stack2));
+  builder.AddSample(stack1, ARRAY_SIZE(stack1));
+  EXPECT_EQ(3, builder.num_samples());
+  EXPECT_EQ(2, builder.num_stacks());
+
+  MallocGrowableArray<uint8_t> bytes;
+  builder.Encode(0, 1000, 1000, &bytes);
+  // Starts with the first sample type.
+  EXPECT_EQ(0x0a, bytes[0]);
+  EXPECT(ContainsString(bytes, "leafFunction"));
+  EXPECT(ContainsString(bytes, "callerFunction"));
+  EXPECT(ContainsString(bytes, "nanoseconds"));
+
+  builder.Reset();
+  EXPECT_EQ(0, builder.num_samples());
+  EXPECT_EQ(0, builder.num_stacks());
+}
+
+}  // namespace dart
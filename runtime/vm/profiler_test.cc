@@ -120,6 +120,27 @@ TEST_CASE(Profiler_AllocationSampleTest) {
   delete sample_buffer;
 }
 
+
+TEST_CASE(Profiler_SampleBufferContinuationTest) {
+  SampleBuffer* sample_buffer = new SampleBuffer(3);
+  Isolate* i = reinterpret_cast<Isolate*>(0x1);
+  Sample* sample = sample_buffer->ReserveSample();
+  sample->Init(i, 100, 0);
+  EXPECT(sample_buffer->Next(sample) == NULL);
+  Sample* continuation = sample_buffer->ReserveSampleAndLink(sample);
+  EXPECT(continuation->is_continuation_sample());
+  EXPECT(!sample->is_continuation_sample());
+  EXPECT(sample_buffer->Next(sample) == continuation);
+  EXPECT(sample_buffer->Next(continuation) == NULL);
+  // Overwriting the continuation breaks the link.
+  sample_buffer->ReserveSample();
+  Sample* overwritten = sample_buffer->ReserveSample();
+  EXPECT(overwritten == continuation);
+  overwritten->Init(i, 200, 0);
+  EXPECT(sample_buffer->Next(sample) == NULL);
+  delete sample_buffer;
+}
+
 static RawClass* GetClass(const Library& lib, const char* name) {
   const Class& cls = Class::Handle(
       lib.LookupClassAllowPrivate(String::Handle(Symbols::New(name))));
@@ -410,6 +410,9 @@ class RawObject {
   bool IsFunction() {
     return ((GetClassId() == kFunctionCid));
   }
+  bool IsInstructions() {
+    return ((GetClassId() == kInstructionsCid));
+  }
 
   intptr_t Size() const {
     uword tags = ptr()->tags_;
@@ -583,6 +586,7 @@ class RawObject {
   friend class ScavengerVisitor;
   friend class SizeExcludingClassVisitor;  // GetClassId
   friend class RetainingPathVisitor;  // GetClassId
+  friend class WritePageVisitor;  // GetClassId
   friend class SnapshotReader;
   friend class SnapshotWriter;
   friend class String;
@@ -428,6 +428,7 @@ Scavenger::Scavenger(Heap* heap,
   top_ = FirstObjectStart();
   resolved_top_ = top_;
   end_ = to_->end();
+  allocation_limit_ = 0;
 
   survivor_end_ = FirstObjectStart();
 }
@@ -471,6 +472,7 @@ void Scavenger::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   top_ = FirstObjectStart();
   resolved_top_ = top_;
   end_ = to_->end();
+  allocation_limit_ = 0;
 }
 
 
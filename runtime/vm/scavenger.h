@@ -140,6 +140,11 @@ class Scavenger {
 #endif
     uword result = top_;
     intptr_t remaining = end_ - top_;
+    if ((remaining < size) && (allocation_limit_ != 0)) {
+      // Only generated code stops at the allocation limit.
+      ASSERT(!scavenging_);
+      remaining = to_->end() - top_;
+    }
     if (remaining < size) {
       return 0;
     }
@@ -162,6 +167,23 @@ class Scavenger {
     ASSERT(UsedInWords() == 0);
   }
 
+  // Makes generated code call into the runtime for the allocation that
+  // crosses |size| more bytes. The limit is removed by a scavenge.
+  void SetAllocationLimit(intptr_t size) {
+    ASSERT(!scavenging_);
+    ASSERT(size > 0);
+    allocation_limit_ = top_ + Utils::RoundUp(size, kObjectAlignment);
+    end_ = Utils::Minimum(allocation_limit_, to_->end());
+  }
+
+  bool HasAllocationLimit() const {
+    return allocation_limit_ != 0;
+  }
+
+  bool AllocationLimitReached() const {
+    return (allocation_limit_ != 0) && (top_ >= allocation_limit_);
+  }
+
   // Accessors to generate code for inlined allocation.
   uword* TopAddress() { return &top_; }
   uword* EndAddress() { return &end_; }
@@ -287,6 +309,9 @@ class Scavenger {
   uword top_;
   uword end_;
 
+  // Limit for allocation sampling, or 0. Lowers |end_| when inside to-space.
+  uword allocation_limit_;
+
   // A pointer to the first unscanned object.  Scanning completes when
   // this value meets the allocation top.
   uword resolved_top_;
@@ -7,13 +7,18 @@
 #include "include/dart_api.h"
 #include "include/dart_native_api.h"
 #include "platform/globals.h"
+#include "vm/allocation_sampler.h"
 
 #include "vm/compiler.h"
 #include "vm/coverage.h"
 #include "vm/cpu.h"
 #include "vm/dart_api_impl.h"
+#include "vm/dart_api_message.h"
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
+#include "vm/deopt_instructions.h"
+#include "vm/dominator_tree.h"
+#include "vm/ic_stats.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
 #include "vm/message.h"
@@ -32,6 +37,7 @@
 #include "vm/service_isolate.h"
 #include "vm/stack_frame.h"
 #include "vm/symbols.h"
+#include "vm/thread_pool.h"
 #include "vm/unicode.h"
 #include "vm/version.h"
 
@@ -1681,8 +1687,20 @@ static bool GetRetainedSize(Isolate* isolate, JSONStream* js) {
     return true;
   }
 
-  ObjectGraph graph(isolate);
-  intptr_t retained_size = graph.SizeRetainedByInstance(obj);
+  // Answered from the dominator tree of the heap, which is computed again
+  // when the heap may have changed since.
+  HeapDominatorTree* tree = HeapDominatorTree::ForIsolate(isolate);
+  intptr_t retained_size = tree->SizeRetainedByObject(obj.raw());
+  if (retained_size < 0) {
+    // The object has been allocated since the tree was computed.
+    tree = HeapDominatorTree::Recompute(isolate);
+    retained_size = tree->SizeRetainedByObject(obj.raw());
+  }
+  if (retained_size < 0) {
+    // Not in the heap of the isolate.
+    ObjectGraph graph(isolate);
+    retained_size = graph.SizeRetainedByInstance(obj);
+  }
   const Object& result = Object::Handle(Integer::New(retained_size));
   result.PrintJSON(js, true);
   return true;
@@ -2265,7 +2283,17 @@ static const MethodParameter* get_vm_metric_list_params[] = {
 
 
 static bool GetVMMetricList(Isolate* isolate, JSONStream* js) {
-  return false;
+  JSONObject obj(js);
+  obj.AddProperty("type", "MetricList");
+  {
+    JSONArray metrics(&obj, "metrics");
+    Metric* current = Metric::vm_head();
+    while (current != NULL) {
+      metrics.AddValue(current);
+      current = current->next();
+    }
+  }
+  return true;
 }
 
 
@@ -2279,8 +2307,23 @@ static bool GetVMMetric(Isolate* isolate, JSONStream* js) {
   const char* metric_id = js->LookupParam("metricId");
   if (metric_id == NULL) {
     PrintMissingParamError(js, "metricId");
+    return true;
   }
-  return false;
+  static const char* kVMMetricIdPrefix = "vm/metrics/";
+  static intptr_t kVMMetricIdPrefixLen = strlen(kVMMetricIdPrefix);
+  if (strncmp(metric_id, kVMMetricIdPrefix, kVMMetricIdPrefixLen) == 0) {
+    const char* id = metric_id + kVMMetricIdPrefixLen;
+    Metric* current = Metric::vm_head();
+    while (current != NULL) {
+      if (strcmp(current->name(), id) == 0) {
+        current->PrintJSON(js);
+        return true;
+      }
+      current = current->next();
+    }
+  }
+  PrintInvalidParamError(js, "metricId");
+  return true;
 }
 
 
@@ -2479,6 +2522,92 @@ static bool GetAllocationProfile(Isolate* isolate, JSONStream* js) {
 }
 
 
+static const MethodParameter* get_allocation_sites_params[] = {
+  ISOLATE_PARAMETER,
+  NULL,
+};
+
+
+static bool GetAllocationSites(Isolate* isolate, JSONStream* js) {
+  if (js->HasParam("gc")) {
+    if (js->ParamIs("gc", "full")) {
+      isolate->heap()->CollectAllGarbage();
+    } else {
+      PrintInvalidParamError(js, "gc");
+      return true;
+    }
+  }
+  isolate->heap()->allocation_sampler()->PrintJSON(js);
+  return true;
+}
+
+
+static const MethodParameter* get_deoptimization_stats_params[] = {
+  ISOLATE_PARAMETER,
+  NULL,
+};
+
+
+static bool GetDeoptimizationStats(Isolate* isolate, JSONStream* js) {
+  isolate->deopt_stats()->PrintJSON(js);
+  return true;
+}
+
+
+static const MethodParameter* get_gc_histograms_params[] = {
+  ISOLATE_PARAMETER,
+  NULL,
+};
+
+
+static bool GetGCHistograms(Isolate* isolate, JSONStream* js) {
+  bool should_reset = false;
+  if (js->HasParam("reset")) {
+    if (js->ParamIs("reset", "true")) {
+      should_reset = true;
+    } else {
+      PrintInvalidParamError(js, "reset");
+      return true;
+    }
+  }
+  isolate->heap()->PrintGCHistogramsJSON(js);
+  if (should_reset) {
+    isolate->heap()->ResetGCHistograms();
+  }
+  return true;
+}
+
+
+static const MethodParameter* get_ic_stats_params[] = {
+  ISOLATE_PARAMETER,
+  new UIntParameter("limit", false),
+  NULL,
+};
+
+
+static bool GetICStats(Isolate* isolate, JSONStream* js) {
+  const intptr_t kDefaultLimit = 20;
+  intptr_t limit = kDefaultLimit;
+  if (js->HasParam("limit")) {
+    limit = UIntParameter::Parse(js->LookupParam("limit"));
+  }
+  bool should_reset = false;
+  if (js->HasParam("reset")) {
+    if (js->ParamIs("reset", "true")) {
+      should_reset = true;
+    } else {
+      PrintInvalidParamError(js, "reset");
+      return true;
+    }
+  }
+  ICStats::PrintJSON(isolate, js, limit);
+  if (should_reset) {
+    ICStats::Reset(isolate);
+  }
+  return true;
+}
+
+
 static const MethodParameter* get_heap_map_params[] = {
   ISOLATE_PARAMETER,
   NULL,
@@ -2508,17 +2637,101 @@ static bool RequestHeapSnapshot(Isolate* isolate, JSONStream* js) {
 }
 
 
+// Posts the chunks of a heap snapshot to the service isolate. Runs on the
+// thread pool, so that the snapshotted isolate can resume as soon as its
+// heap has been serialized.
+class SendGraphChunksTask : public ThreadPool::Task {
+ public:
+  SendGraphChunksTask(SerializedGraph* graph,
+                      char** metas,
+                      intptr_t num_chunks,
+                      intptr_t chunk_size)
+      : graph_(graph),
+        metas_(metas),
+        num_chunks_(num_chunks),
+        chunk_size_(chunk_size) { }
+
+  virtual void Run() {
+    for (intptr_t i = 0; i < num_chunks_; i++) {
+      if (ServiceIsolate::IsRunning()) {
+        SendChunk(i);
+      }
+      free(metas_[i]);
+    }
+    free(metas_);
+    delete graph_;
+  }
+
+ private:
+  void SendChunk(intptr_t index) {
+    const intptr_t offset = index * chunk_size_;
+    const intptr_t size = Utils::Minimum(chunk_size_, graph_->size() - offset);
+    // Same bitstream as Service::SendEventWithData:
+    // [meta data size (big-endian 64 bit)] [meta data (UTF-8)] [data]
+    const intptr_t meta_bytes = strlen(metas_[index]);
+    const intptr_t total_bytes = sizeof(uint64_t) + meta_bytes + size;
+    uint8_t* data = reinterpret_cast<uint8_t*>(malloc(total_bytes));
+    const uint64_t meta_size = Utils::HostToBigEndian64(meta_bytes);
+    memmove(data, &meta_size, sizeof(meta_size));
+    memmove(data + sizeof(uint64_t), metas_[index], meta_bytes);
+    graph_->CopyTo(data + sizeof(uint64_t) + meta_bytes, offset, size);
+
+    Dart_CObject stream_id;
+    stream_id.type = Dart_CObject_kString;
+    stream_id.value.as_string = const_cast<char*>(Service::graph_stream.id());
+    Dart_CObject message;
+    message.type = Dart_CObject_kTypedData;
+    message.value.as_typed_data.type = Dart_TypedData_kUint8;
+    message.value.as_typed_data.length = total_bytes;
+    message.value.as_typed_data.values = data;
+    Dart_CObject* elements[] = { &stream_id, &message };
+    Dart_CObject list;
+    list.type = Dart_CObject_kArray;
+    list.value.as_array.length = ARRAY_SIZE(elements);
+    list.value.as_array.values = elements;
+
+    uint8_t* buffer = NULL;
+    ApiMessageWriter writer(&buffer, &allocator);
+    const bool success = writer.WriteCMessage(&list);
+    free(data);
+    if (!success) {
+      return;
+    }
+    if (FLAG_trace_service) {
+      OS::Print("vm-service: Pushing event of type _Graph to stream %s, "
+                "len %" Pd "\n",
+                Service::graph_stream.id(), writer.BytesWritten());
+    }
+    PortMap::PostMessage(new Message(ServiceIsolate::Port(),
+                                     buffer,
+                                     writer.BytesWritten(),
+                                     Message::kNormalPriority));
+  }
+
+  SerializedGraph* graph_;
+  char** metas_;
+  const intptr_t num_chunks_;
+  const intptr_t chunk_size_;
+
+  DISALLOW_COPY_AND_ASSIGN(SendGraphChunksTask);
+};
+
+
 void Service::SendGraphEvent(Isolate* isolate) {
-  uint8_t* buffer = NULL;
-  WriteStream stream(&buffer, &allocator, 1 * MB);
-  ObjectGraph graph(isolate);
-  intptr_t node_count = graph.Serialize(&stream);
+  // The isolate is only stopped while its pages are copied by several
+  // threads. Posting the snapshot happens in the background.
+  SerializedGraph* graph = NULL;
+  {
+    ObjectGraph object_graph(isolate);
+    graph = object_graph.SerializeParallel();
+  }
+  const intptr_t node_count = graph->node_count();
 
   // Chrome crashes receiving a single tens-of-megabytes blob, so send the
   // snapshot in megabyte-sized chunks instead.
   const intptr_t kChunkSize = 1 * MB;
-  intptr_t num_chunks =
-      (stream.bytes_written() + (kChunkSize - 1)) / kChunkSize;
+  intptr_t num_chunks = (graph->size() + (kChunkSize - 1)) / kChunkSize;
+  char** metas = reinterpret_cast<char**>(malloc(num_chunks * sizeof(char*)));
   for (intptr_t i = 0; i < num_chunks; i++) {
     JSONStream js;
     {
@@ -2540,17 +2753,10 @@ void Service::SendGraphEvent(Isolate* isolate) {
         }
       }
     }
-
-    const String& message = String::Handle(String::New(js.ToCString()));
-
-    uint8_t* chunk_start = buffer + (i * kChunkSize);
-    intptr_t chunk_size = (i + 1 == num_chunks)
-        ? stream.bytes_written() - (i * kChunkSize)
-        : kChunkSize;
-
-    SendEventWithData(graph_stream.id(), "_Graph", message,
-                      chunk_start, chunk_size);
+    metas[i] = strdup(js.ToCString());
   }
+  Dart::thread_pool()->Run(
+      new SendGraphChunksTask(graph, metas, num_chunks, kChunkSize));
 }
 
 
@@ -3050,6 +3256,8 @@ static ServiceMethodDescriptor service_methods_[] = {
     get_allocation_profile_params },
   { "_getAllocationSamples", GetAllocationSamples,
       get_allocation_samples_params },
+  { "_getAllocationSites", GetAllocationSites,
+    get_allocation_sites_params },
   { "_getCallSiteData", GetCallSiteData,
     get_call_site_data_params },
   { "getClassList", GetClassList,
@@ -3058,10 +3266,16 @@ static ServiceMethodDescriptor service_methods_[] = {
     get_coverage_params },
   { "_getCpuProfile", GetCpuProfile,
     get_cpu_profile_params },
+  { "_getDeoptimizationStats", GetDeoptimizationStats,
+    get_deoptimization_stats_params },
   { "getFlagList", GetFlagList,
     get_flag_list_params },
+  { "_getGCHistograms", GetGCHistograms,
+    get_gc_histograms_params },
   { "_getHeapMap", GetHeapMap,
     get_heap_map_params },
+  { "_getICStats", GetICStats,
+    get_ic_stats_params },
   { "_getInboundReferences", GetInboundReferences,
     get_inbound_references_params },
   { "_getInstances", GetInstances,
@@ -8,6 +8,7 @@
 #include "vm/dart_api_impl.h"
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
+#include "vm/deopt_instructions.h"
 #include "vm/globals.h"
 #include "vm/message_handler.h"
 #include "vm/object_id_ring.h"
@@ -630,6 +631,41 @@ TEST_CASE(Service_Profile) {
   EXPECT_SUBSTRING("\"error\"", handler.msg());
 }
 
+
+TEST_CASE(Service_DeoptimizationStats) {
+  const char* kScript =
+      "var port;\n"  // Set to our mock port by C++.
+      "\n"
+      "main() {\n"
+      "}";
+
+  Isolate* isolate = Isolate::Current();
+  Dart_Handle lib = TestCase::LoadTestScript(kScript, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+
+  // Build a mock message handler and wrap it in a dart port.
+  ServiceTestMessageHandler handler;
+  Dart_Port port_id = PortMap::CreatePort(&handler);
+  Dart_Handle port = Api::NewHandle(isolate, SendPort::New(port_id));
+  EXPECT_VALID(port);
+  EXPECT_VALID(Dart_SetField(lib, NewString("port"), port));
+
+  isolate->deopt_stats()->AddDeoptimization(ICData::kDeoptCheckClass);
+  isolate->deopt_stats()->AddDeoptimization(ICData::kDeoptCheckClass);
+  isolate->deopt_stats()->AddStorm();
+
+  Array& service_msg = Array::Handle();
+  service_msg = Eval(lib, "[0, port, '0', '_getDeoptimizationStats', [], []]");
+  Service::HandleIsolateMessage(isolate, service_msg);
+  handler.HandleNextMessage();
+  EXPECT_SUBSTRING("\"type\":\"_DeoptimizationStats\"", handler.msg());
+  EXPECT_SUBSTRING("\"storms\":1", handler.msg());
+  EXPECT_SUBSTRING("{\"reason\":\"CheckClass\",\"count\":2}",
+                   handler.msg());
+}
+
 #endif  // !defined(TARGET_ARCH_ARM64)
 
 }  // namespace dart
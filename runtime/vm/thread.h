@@ -20,6 +20,7 @@ class Object;
 class RawBool;
 class RawObject;
 class StackResource;
+class TimelineCompactBlock;
 class TimelineEventBlock;
 class Zone;
 
@@ -199,6 +200,7 @@ class Thread {
     uword top_exit_frame_info;
     StackResource* top_resource;
     TimelineEventBlock* timeline_block;
+    TimelineCompactBlock* timeline_compact_block;
     // TODO(koda): Migrate individual fields of InterruptableThreadState.
     InterruptableThreadState* thread_state;
 #if defined(DEBUG)
@@ -226,6 +228,14 @@ CACHED_CONSTANTS_LIST(DEFINE_OFFSET_METHOD)
     state_.timeline_block = block;
   }
 
+  TimelineCompactBlock* timeline_compact_block() const {
+    return state_.timeline_compact_block;
+  }
+
+  void set_timeline_compact_block(TimelineCompactBlock* block) {
+    state_.timeline_compact_block = block;
+  }
+
  private:
   static ThreadLocalKey thread_key_;
 
@@ -4,6 +4,7 @@
 
 #include <cstdlib>
 
+#include "vm/atomic.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/lockers.h"
@@ -15,6 +16,8 @@ namespace dart {
 
 DEFINE_FLAG(bool, trace_timeline, false, "Trace timeline code.");
 DEFINE_FLAG(bool, complete_timeline, false, "Record the complete timeline");
+DEFINE_FLAG(bool, compact_timeline, false,
+            "Record the timeline in compact per-thread buffers");
 
 TimelineEvent::TimelineEvent()
     : timestamp0_(0),
@@ -366,9 +369,6 @@ void TimelineEventRecorder::WriteTo(const char* directory) {
     return;
   }
 
-  JSONStream js;
-  PrintJSON(&js);
-
   const char* format = "%s/dart-timeline-%" Pd "-%" Pd ".json";
   intptr_t pid = OS::ProcessId();
   intptr_t len = OS::SNPrint(NULL, 0, format,
@@ -381,11 +381,19 @@ void TimelineEventRecorder::WriteTo(const char* directory) {
     OS::Print("Failed to write timeline file: %s\n", filename);
     return;
   }
-  (*file_write)(js.buffer()->buf(), js.buffer()->length(), file);
+  WriteTrace(file_write, file);
   (*file_close)(file);
 }
 
 
+void TimelineEventRecorder::WriteTrace(Dart_FileWriteCallback file_write,
+                                       void* file) {
+  JSONStream js;
+  PrintJSON(&js);
+  (*file_write)(js.buffer()->buf(), js.buffer()->length(), file);
+}
+
+
 intptr_t TimelineEventRingRecorder::SizeForCapacity(intptr_t capacity) {
   return sizeof(TimelineEvent) * capacity;
 }
@@ -610,4 +618,400 @@ TimelineEvent* TimelineEventBlock::StartEvent() {
   return &events_[length_++];
 }
 
+
+// Events are encoded in blocks as a sequence of unsigned LEB128 values:
+//   (number of arguments << 3) | event type
+//   id of the category
+//   id of the label
+//   zigzag encoded difference to the timestamp of the previous event
+//   zigzag encoded duration or async id, unless the event is an instant
+// followed by, for each argument, the id of its name, the length of its value
+// and the bytes of its value.
+static const intptr_t kMaxUnsignedLength = 10;
+// Longer argument values are truncated.
+static const intptr_t kMaxArgumentLength = 1 * KB;
+// Size at which a trace being written to a file is flushed.
+static const intptr_t kTraceFlushSize = 64 * KB;
+
+
+static uint8_t* WriteUnsigned(uint8_t* p, uint64_t value) {
+  while (value >= 0x80) {
+    *p++ = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *p++ = static_cast<uint8_t>(value);
+  return p;
+}
+
+
+static const uint8_t* ReadUnsigned(const uint8_t* p, uint64_t* value) {
+  uint64_t result = 0;
+  intptr_t shift = 0;
+  while (*p >= 0x80) {
+    result |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+    shift += 7;
+  }
+  result |= static_cast<uint64_t>(*p++) << shift;
+  *value = result;
+  return p;
+}
+
+
+static uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+
+static int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+
+static intptr_t ArgumentLength(const char* value) {
+  if (value == NULL) {
+    return 0;
+  }
+  intptr_t length = strlen(value);
+  return (length < kMaxArgumentLength) ? length : kMaxArgumentLength;
+}
+
+
+static intptr_t NameHash(const char* name) {
+  // Names are interned by address.
+  return static_cast<intptr_t>(reinterpret_cast<uword>(name) >> 3);
+}
+
+
+TimelineCompactBlock::TimelineCompactBlock(
+    TimelineEventCompactRecorder* recorder)
+    : recorder_(recorder),
+      next_(NULL),
+      thread_(NULL),
+      in_use_(false),
+      retired_(0),
+      timestamp_(0),
+      length_(0) {
+}
+
+
+void TimelineCompactBlock::Reset(Thread* thread) {
+  thread_ = thread;
+  in_use_ = true;
+  timestamp_ = 0;
+  length_ = 0;
+  for (intptr_t i = 0; i < kNameCacheSize; i++) {
+    name_cache_keys_[i] = NULL;
+  }
+}
+
+
+TimelineEventCompactRecorder::TimelineEventCompactRecorder(intptr_t capacity)
+    : head_(NULL),
+      num_blocks_(0),
+      max_blocks_(Utils::Maximum(capacity / TimelineCompactBlock::kBlockSize,
+                                 static_cast<intptr_t>(1))),
+      num_retired_(0),
+      names_(NULL),
+      num_names_(0),
+      name_table_(NULL),
+      name_table_size_(0) {
+  COMPILE_ASSERT(TimelineEvent::kNumEventTypes <= 8);
+  GrowNameTable();
+}
+
+
+TimelineEventCompactRecorder::~TimelineEventCompactRecorder() {
+  Thread* thread = Thread::Current();
+  if ((thread != NULL) &&
+      (thread->timeline_compact_block() != NULL) &&
+      (thread->timeline_compact_block()->recorder_ == this)) {
+    thread->set_timeline_compact_block(NULL);
+  }
+  TimelineCompactBlock* block = head_;
+  while (block != NULL) {
+    TimelineCompactBlock* next = block->next_;
+    delete block;
+    block = next;
+  }
+  free(names_);
+  free(name_table_);
+}
+
+
+void TimelineEventCompactRecorder::PrintJSON(JSONStream* js) {
+  MutexLocker ml(&lock_);
+  JSONObject topLevel(js);
+  topLevel.AddProperty("type", "_Timeline");
+  {
+    JSONArray events(&topLevel, "traceEvents");
+    PrintJSONMeta(&events);
+    PrintTraceEvents(js->buffer(), NULL, NULL);
+  }
+}
+
+
+void TimelineEventCompactRecorder::WriteTrace(
+    Dart_FileWriteCallback file_write, void* file) {
+  Isolate* isolate = Isolate::Current();
+  TextBuffer buffer(kTraceFlushSize + KB);
+  buffer.Printf("{\"type\":\"_Timeline\",\"traceEvents\":["
+                "{\"ph\":\"M\",\"pid\":%" Pd64 ",\"name\":\"process_name\","
+                "\"args\":{\"name\":\"", GetPid(isolate));
+  buffer.AddEscapedString(isolate->debugger_name());
+  buffer.AddString("\"}}");
+  {
+    MutexLocker ml(&lock_);
+    PrintTraceEvents(&buffer, file_write, file);
+  }
+  buffer.AddString("]}");
+  (*file_write)(buffer.buf(), buffer.length(), file);
+}
+
+
+void TimelineEventCompactRecorder::VisitObjectPointers(
+    ObjectPointerVisitor* visitor) {
+  // no-op.
+}
+
+
+TimelineEvent* TimelineEventCompactRecorder::StartEvent(const Object& object) {
+  return StartEvent();
+}
+
+
+TimelineEvent* TimelineEventCompactRecorder::StartEvent() {
+  // Events are only kept until they are complete and have been encoded.
+  return new TimelineEvent();
+}
+
+
+void TimelineEventCompactRecorder::CompleteEvent(TimelineEvent* event) {
+  if (event->IsValid()) {
+    Encode(event);
+  }
+  delete event;
+}
+
+
+void TimelineEventCompactRecorder::Encode(TimelineEvent* event) {
+  const intptr_t num_arguments = event->arguments_length_;
+  intptr_t size = (5 + 2 * num_arguments) * kMaxUnsignedLength;
+  for (intptr_t i = 0; i < num_arguments; i++) {
+    size += ArgumentLength(event->arguments_[i].value);
+  }
+  if (size > TimelineCompactBlock::kBlockSize) {
+    // The event does not fit in a block.
+    return;
+  }
+  Thread* thread = Thread::Current();
+  TimelineCompactBlock* block = thread->timeline_compact_block();
+  if ((block == NULL) ||
+      (block->recorder_ != this) ||
+      (block->length_ + size > TimelineCompactBlock::kBlockSize)) {
+    block = GetNewBlock(thread, block);
+  }
+  uint8_t* p = &block->data_[block->length_];
+  p = WriteUnsigned(p, (num_arguments << 3) | event->event_type());
+  p = WriteUnsigned(p, LookupName(block, event->stream_->name()));
+  p = WriteUnsigned(p, LookupName(block, event->label_));
+  p = WriteUnsigned(p, ZigZagEncode(event->TimeOrigin() - block->timestamp_));
+  block->timestamp_ = event->TimeOrigin();
+  switch (event->event_type()) {
+    case TimelineEvent::kDuration:
+      p = WriteUnsigned(p, ZigZagEncode(event->TimeDuration()));
+      break;
+    case TimelineEvent::kInstant:
+      break;
+    default:
+      p = WriteUnsigned(p, ZigZagEncode(event->AsyncId()));
+      break;
+  }
+  for (intptr_t i = 0; i < num_arguments; i++) {
+    const TimelineEvent::TimelineEventArgument& argument =
+        event->arguments_[i];
+    intptr_t length = ArgumentLength(argument.value);
+    p = WriteUnsigned(p, LookupName(block, argument.name));
+    p = WriteUnsigned(p, length);
+    memmove(p, argument.value, length);
+    p += length;
+  }
+  // Publishes the encoded event to PrintTraceEvents, which reads the block
+  // from another thread.
+  AtomicOperations::StoreRelease(reinterpret_cast<uword*>(&block->length_),
+                                 p - block->data_);
+}
+
+
+intptr_t TimelineEventCompactRecorder::LookupName(TimelineCompactBlock* block,
+                                                  const char* name) {
+  ASSERT(name != NULL);
+  intptr_t index =
+      NameHash(name) & (TimelineCompactBlock::kNameCacheSize - 1);
+  if (block->name_cache_keys_[index] != name) {
+    block->name_cache_ids_[index] = InternName(name);
+    block->name_cache_keys_[index] = name;
+  }
+  return block->name_cache_ids_[index];
+}
+
+
+intptr_t TimelineEventCompactRecorder::InternName(const char* name) {
+  MutexLocker ml(&lock_);
+  const intptr_t mask = name_table_size_ - 1;
+  intptr_t index = NameHash(name) & mask;
+  while (name_table_[index] != -1) {
+    if (names_[name_table_[index]] == name) {
+      return name_table_[index];
+    }
+    index = (index + 1) & mask;
+  }
+  intptr_t id = num_names_++;
+  names_[id] = name;
+  name_table_[index] = id;
+  if (2 * num_names_ >= name_table_size_) {
+    GrowNameTable();
+  }
+  return id;
+}
+
+
+void TimelineEventCompactRecorder::GrowNameTable() {
+  const intptr_t size =
+      (name_table_size_ == 0) ? 256 : (2 * name_table_size_);
+  const intptr_t mask = size - 1;
+  // The table is kept at most half full.
+  names_ = reinterpret_cast<const char**>(
+      realloc(names_, (size / 2) * sizeof(*names_)));
+  free(name_table_);
+  name_table_ = reinterpret_cast<intptr_t*>(
+      malloc(size * sizeof(*name_table_)));
+  name_table_size_ = size;
+  for (intptr_t i = 0; i < size; i++) {
+    name_table_[i] = -1;
+  }
+  for (intptr_t id = 0; id < num_names_; id++) {
+    intptr_t index = NameHash(names_[id]) & mask;
+    while (name_table_[index] != -1) {
+      index = (index + 1) & mask;
+    }
+    name_table_[index] = id;
+  }
+}
+
+
+TimelineCompactBlock* TimelineEventCompactRecorder::GetNewBlock(
+    Thread* thread, TimelineCompactBlock* full_block) {
+  MutexLocker ml(&lock_);
+  if ((full_block != NULL) && (full_block->recorder_ == this)) {
+    full_block->in_use_ = false;
+    full_block->retired_ = num_retired_++;
+  }
+  TimelineCompactBlock* block = NULL;
+  if (num_blocks_ >= max_blocks_) {
+    // Reuse the block that was retired first.
+    for (TimelineCompactBlock* current = head_;
+         current != NULL;
+         current = current->next_) {
+      if (!current->in_use_ &&
+          ((block == NULL) || (current->retired_ < block->retired_))) {
+        block = current;
+      }
+    }
+  }
+  if (block == NULL) {
+    // Blocks that are being filled are never reused, so the recorder may
+    // exceed its capacity when many threads record events.
+    block = new TimelineCompactBlock(this);
+    block->next_ = head_;
+    head_ = block;
+    num_blocks_++;
+  }
+  block->Reset(thread);
+  thread->set_timeline_compact_block(block);
+  return block;
+}
+
+
+void TimelineEventCompactRecorder::PrintTraceEvents(
+    TextBuffer* buffer, Dart_FileWriteCallback file_write, void* file) const {
+  const int64_t pid = GetPid(Isolate::Current());
+  for (TimelineCompactBlock* block = head_;
+       block != NULL;
+       block = block->next_) {
+    const int64_t tid = GetTid(block->thread_);
+    int64_t timestamp = 0;
+    const uint8_t* p = block->data_;
+    const uint8_t* end = p + AtomicOperations::LoadAcquire(
+        reinterpret_cast<uword*>(&block->length_));
+    while (p < end) {
+      uint64_t header;
+      uint64_t category;
+      uint64_t label;
+      uint64_t value;
+      p = ReadUnsigned(p, &header);
+      p = ReadUnsigned(p, &category);
+      p = ReadUnsigned(p, &label);
+      p = ReadUnsigned(p, &value);
+      timestamp += ZigZagDecode(value);
+      buffer->AddString(",{\"name\":\"");
+      buffer->AddEscapedString(names_[label]);
+      buffer->AddString("\",\"cat\":\"");
+      buffer->AddEscapedString(names_[category]);
+      buffer->Printf("\",\"tid\":%" Pd64 ",\"pid\":%" Pd64 ",\"ts\":%" Pd64,
+                     tid, pid, timestamp);
+      switch (header & 7) {
+        case TimelineEvent::kDuration:
+          p = ReadUnsigned(p, &value);
+          buffer->Printf(",\"ph\":\"X\",\"dur\":%" Pd64, ZigZagDecode(value));
+          break;
+        case TimelineEvent::kInstant:
+          buffer->AddString(",\"ph\":\"i\",\"s\":\"p\"");
+          break;
+        case TimelineEvent::kAsyncBegin:
+          p = ReadUnsigned(p, &value);
+          buffer->Printf(",\"ph\":\"b\",\"id\":\"%" Px64 "\"",
+                         ZigZagDecode(value));
+          break;
+        case TimelineEvent::kAsyncInstant:
+          p = ReadUnsigned(p, &value);
+          buffer->Printf(",\"ph\":\"n\",\"id\":\"%" Px64 "\"",
+                         ZigZagDecode(value));
+          break;
+        case TimelineEvent::kAsyncEnd:
+          p = ReadUnsigned(p, &value);
+          buffer->Printf(",\"ph\":\"e\",\"id\":\"%" Px64 "\"",
+                         ZigZagDecode(value));
+          break;
+        default:
+          UNREACHABLE();
+      }
+      buffer->AddString(",\"args\":{");
+      const uint64_t num_arguments = header >> 3;
+      for (uint64_t i = 0; i < num_arguments; i++) {
+        uint64_t name;
+        uint64_t length;
+        p = ReadUnsigned(p, &name);
+        p = ReadUnsigned(p, &length);
+        if (i > 0) {
+          buffer->AddChar(',');
+        }
+        buffer->AddChar('"');
+        buffer->AddEscapedString(names_[name]);
+        buffer->AddString("\":\"");
+        for (uint64_t j = 0; j < length; j++) {
+          buffer->EscapeAndAddCodeUnit(p[j]);
+        }
+        p += length;
+        buffer->AddChar('"');
+      }
+      buffer->AddString("}}");
+      if ((file != NULL) && (buffer->length() >= kTraceFlushSize)) {
+        (*file_write)(buffer->buf(), buffer->length(), file);
+        buffer->Clear();
+      }
+    }
+  }
+}
+
 }  // namespace dart
@@ -5,6 +5,7 @@
 #ifndef VM_TIMELINE_H_
 #define VM_TIMELINE_H_
 
+#include "include/dart_api.h"
 #include "vm/bitfield.h"
 
 namespace dart {
@@ -12,8 +13,10 @@ namespace dart {
 class JSONStream;
 class Object;
 class RawArray;
+class TextBuffer;
 class Thread;
 class TimelineEvent;
+class TimelineEventCompactRecorder;
 class TimelineEventBlock;
 class TimelineEventRecorder;
 class TimelineStream;
@@ -115,6 +118,7 @@ class TimelineEvent {
 
   class EventTypeField : public BitField<EventType, kEventTypeBit, 4> {};
 
+  friend class TimelineEventCompactRecorder;
   friend class TimelineTestHelper;
   friend class TimelineStream;
   DISALLOW_COPY_AND_ASSIGN(TimelineEvent);
@@ -323,6 +327,10 @@ class TimelineEventRecorder {
   virtual TimelineEvent* StartEvent() = 0;
   virtual void CompleteEvent(TimelineEvent* event) = 0;
 
+  // Writes the trace to |file|. The default implementation prints the trace
+  // to a |JSONStream| and writes it out in one go.
+  virtual void WriteTrace(Dart_FileWriteCallback file_write, void* file);
+
   // Utility method(s).
   void PrintJSONMeta(JSONArray* array) const;
 
@@ -419,6 +427,96 @@ class TimelineEventEndlessRecorder : public TimelineEventRecorder {
   TimelineEventBlock* head_;
 };
 
+
+// A block of compactly encoded events of one thread. The block is filled by
+// only its thread, without taking any locks, and each event is published by
+// a release store of |length_|.
+class TimelineCompactBlock {
+ public:
+  static const intptr_t kBlockSize = 16 * KB;
+
+  explicit TimelineCompactBlock(TimelineEventCompactRecorder* recorder);
+
+  intptr_t length() const {
+    return length_;
+  }
+
+ private:
+  // Number of entries in the direct-mapped cache of name ids.
+  static const intptr_t kNameCacheSize = 64;
+
+  void Reset(Thread* thread);
+
+  TimelineEventCompactRecorder* recorder_;
+  TimelineCompactBlock* next_;
+  Thread* thread_;
+  // Whether |thread_| is still filling the block. Blocks that are no longer
+  // in use are reused oldest first once the recorder is at capacity.
+  bool in_use_;
+  int64_t retired_;
+  int64_t timestamp_;
+  intptr_t length_;
+  const char* name_cache_keys_[kNameCacheSize];
+  intptr_t name_cache_ids_[kNameCacheSize];
+  uint8_t data_[kBlockSize];
+
+  friend class TimelineEventCompactRecorder;
+  DISALLOW_COPY_AND_ASSIGN(TimelineCompactBlock);
+};
+
+
+// A recorder that encodes completed events into per-thread blocks of bytes.
+// Labels, categories and argument names are interned and timestamps are
+// stored as variable length deltas, so an event usually takes a dozen bytes.
+// Traces are decoded to JSON only when they are printed or written, and are
+// streamed to files in the Chrome trace event format.
+// This recorder does not track Dart objects.
+class TimelineEventCompactRecorder : public TimelineEventRecorder {
+ public:
+  static const intptr_t kDefaultCapacity = 1 * MB;
+
+  // The recorder reuses its oldest blocks once it holds |capacity| bytes of
+  // blocks. Blocks that threads are still filling are never reused.
+  explicit TimelineEventCompactRecorder(intptr_t capacity = kDefaultCapacity);
+  ~TimelineEventCompactRecorder();
+
+  // NOTE: Calling this while threads are filling in their blocks is not safe.
+  void PrintJSON(JSONStream* js);
+
+ protected:
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+  TimelineEvent* StartEvent(const Object& object);
+  TimelineEvent* StartEvent();
+  void CompleteEvent(TimelineEvent* event);
+  void WriteTrace(Dart_FileWriteCallback file_write, void* file);
+
+  void Encode(TimelineEvent* event);
+  intptr_t LookupName(TimelineCompactBlock* block, const char* name);
+  intptr_t InternName(const char* name);
+  void GrowNameTable();
+  TimelineCompactBlock* GetNewBlock(Thread* thread,
+                                    TimelineCompactBlock* full_block);
+
+  // Prints the events, each preceded by a comma, to |buffer|. When |file| is
+  // not NULL the buffer is written to |file| and cleared as it fills up.
+  // Must be called with |lock_| held.
+  void PrintTraceEvents(TextBuffer* buffer,
+                        Dart_FileWriteCallback file_write,
+                        void* file) const;
+
+  Mutex lock_;
+  TimelineCompactBlock* head_;
+  intptr_t num_blocks_;
+  intptr_t max_blocks_;
+  int64_t num_retired_;
+  // Interned names, indexed by id. Names are interned by address.
+  const char** names_;
+  intptr_t num_names_;
+  // Open addressed table of name ids, -1 marks an empty entry.
+  intptr_t* name_table_;
+  intptr_t name_table_size_;
+};
+
 }  // namespace dart
 
 #endif  // VM_TIMELINE_H_
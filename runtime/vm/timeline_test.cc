@@ -225,4 +225,81 @@ TEST_CASE(TimelineEventStreamingRecorderBasic) {
   EXPECT_EQ(1, recorder->CountFor(TimelineEvent::kAsyncEnd));
 }
 
+
+TEST_CASE(TimelineEventCompactRecorderPrintJSON) {
+  TimelineEventCompactRecorder* recorder = new TimelineEventCompactRecorder();
+
+  // Create a test stream.
+  TimelineStream stream;
+  stream.Init("testStream", true);
+  stream.set_recorder(recorder);
+
+  TimelineEvent* event = stream.StartEvent();
+  event->Duration("cabbage", 1000, 1500);
+  event->SetNumArguments(2);
+  event->CopyArgument(0, "arg1", "value1");
+  event->CopyArgument(1, "arg2", "\"quoted\"");
+  event->Complete();
+
+  event = stream.StartEvent();
+  event->Instant("instantCabbage");
+  event->Complete();
+
+  event = stream.StartEvent();
+  int64_t async_id = event->AsyncBegin("asyncBeginCabbage");
+  event->Complete();
+
+  event = stream.StartEvent();
+  event->AsyncEnd("asyncEndCabbage", async_id);
+  event->Complete();
+
+  {
+    JSONStream js;
+    recorder->PrintJSON(&js);
+    EXPECT_SUBSTRING("\"type\":\"_Timeline\"", js.ToCString());
+    EXPECT_SUBSTRING("\"traceEvents\":[", js.ToCString());
+    EXPECT_SUBSTRING("{\"name\":\"cabbage\",\"cat\":\"testStream\"",
+                     js.ToCString());
+    EXPECT_SUBSTRING("\"ts\":1000,\"ph\":\"X\",\"dur\":500",
+                     js.ToCString());
+    EXPECT_SUBSTRING(
+        "\"args\":{\"arg1\":\"value1\",\"arg2\":\"\\\"quoted\\\"\"}",
+        js.ToCString());
+    EXPECT_SUBSTRING("\"name\":\"instantCabbage\"", js.ToCString());
+    EXPECT_SUBSTRING("\"ph\":\"b\"", js.ToCString());
+    EXPECT_SUBSTRING("\"ph\":\"e\"", js.ToCString());
+  }
+  delete recorder;
+}
+
+
+TEST_CASE(TimelineEventCompactRecorderCapacity) {
+  // Only keep two blocks of events.
+  TimelineEventCompactRecorder* recorder =
+      new TimelineEventCompactRecorder(2 * TimelineCompactBlock::kBlockSize);
+
+  // Create a test stream.
+  TimelineStream stream;
+  stream.Init("testStream", true);
+  stream.set_recorder(recorder);
+
+  TimelineEvent* event = stream.StartEvent();
+  event->Instant("first");
+  event->Complete();
+  for (intptr_t i = 0; i < 20000; i++) {
+    event = stream.StartEvent();
+    event->Instant("filler");
+    event->Complete();
+  }
+
+  {
+    JSONStream js;
+    recorder->PrintJSON(&js);
+    // The oldest block has been reused.
+    EXPECT_NOTSUBSTRING("\"first\"", js.ToCString());
+    EXPECT_SUBSTRING("\"filler\"", js.ToCString());
+  }
+  delete recorder;
+}
+
 }  // namespace dart
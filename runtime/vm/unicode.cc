@@ -4,6 +4,12 @@
 
 #include "vm/unicode.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>  // NOLINT
+#elif defined(HOST_ARCH_X64) || defined(__SSE2__)
+#include <emmintrin.h>  // NOLINT
+#endif
+
 #include "vm/allocation.h"
 #include "vm/globals.h"
 #include "vm/object.h"
@@ -63,6 +69,12 @@ intptr_t Utf8::CodeUnitCount(const uint8_t* utf8_array,
   Type char_type = kLatin1;
   for (intptr_t i = 0; i < array_len; i++) {
     uint8_t code_unit = utf8_array[i];
+    if (code_unit <= kMaxOneByteChar) {
+      intptr_t ascii_len = AsciiPrefixLength(&utf8_array[i], array_len - i);
+      len += ascii_len;
+      i += ascii_len - 1;
+      continue;
+    }
     if (!IsTrailByte(code_unit)) {
       ++len;
       if (!IsLatin1SequenceStart(code_unit)) {  // > U+00FF
@@ -85,6 +97,10 @@ bool Utf8::IsValid(const uint8_t* utf8_array, intptr_t array_len) {
   intptr_t i = 0;
   while (i < array_len) {
     uint32_t ch = utf8_array[i] & 0xFF;
+    if (ch <= kMaxOneByteChar) {
+      i += AsciiPrefixLength(&utf8_array[i], array_len - i);
+      continue;
+    }
     intptr_t j = 1;
     if (ch >= 0x80) {
       int8_t num_trail_bytes = kTrailBytes[ch];
@@ -220,6 +236,15 @@ bool Utf8::DecodeToLatin1(const uint8_t* utf8_array,
   intptr_t j = 0;
   intptr_t num_bytes;
   for (; (i < array_len) && (j < len); i += num_bytes, ++j) {
+    if (utf8_array[i] <= kMaxOneByteChar) {
+      // Copy a run of ASCII characters in one go.
+      intptr_t ascii_len = AsciiPrefixLength(&utf8_array[i], array_len - i);
+      if (ascii_len > len - j) ascii_len = len - j;
+      memmove(&dst[j], &utf8_array[i], ascii_len);
+      num_bytes = ascii_len;
+      j += ascii_len - 1;
+      continue;
+    }
     int32_t ch;
     ASSERT(IsLatin1SequenceStart(utf8_array[i]));
     num_bytes = Utf8::Decode(&utf8_array[i], (array_len - i), &ch);
@@ -244,6 +269,17 @@ bool Utf8::DecodeToUTF16(const uint8_t* utf8_array,
   intptr_t j = 0;
   intptr_t num_bytes;
   for (; (i < array_len) && (j < len); i += num_bytes, ++j) {
+    if (utf8_array[i] <= kMaxOneByteChar) {
+      // Widen a run of ASCII characters in one go.
+      intptr_t ascii_len = AsciiPrefixLength(&utf8_array[i], array_len - i);
+      if (ascii_len > len - j) ascii_len = len - j;
+      for (intptr_t k = 0; k < ascii_len; k++) {
+        dst[j + k] = utf8_array[i + k];
+      }
+      num_bytes = ascii_len;
+      j += ascii_len - 1;
+      continue;
+    }
     int32_t ch;
     bool is_supplementary = IsSupplementarySequenceStart(utf8_array[i]);
     num_bytes = Utf8::Decode(&utf8_array[i], (array_len - i), &ch);
@@ -294,6 +330,108 @@ bool Utf8::DecodeCStringToUTF32(const char* str, int32_t* dst, intptr_t len) {
 }
 
 
+intptr_t Utf8::AsciiPrefixLength(const uint8_t* utf8_array,
+                                 intptr_t array_len) {
+  intptr_t i = 0;
+#if defined(__AVX2__)
+  for (; i + 32 <= array_len; i += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&utf8_array[i]));
+    uint32_t mask = _mm256_movemask_epi8(chunk);
+    if (mask != 0) {
+      return i + Utils::CountTrailingZeros(mask);
+    }
+  }
+#endif
+#if defined(__AVX2__) || defined(HOST_ARCH_X64) || defined(__SSE2__)
+  for (; i + 16 <= array_len; i += 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&utf8_array[i]));
+    uint32_t mask = _mm_movemask_epi8(chunk);
+    if (mask != 0) {
+      return i + Utils::CountTrailingZeros(mask);
+    }
+  }
+#else
+  // Check a word at a time for bytes with the high bit set.
+  const uword kHighBits = static_cast<uword>(0x8080808080808080ULL);
+  for (; i + kWordSize <= array_len; i += kWordSize) {
+    uword word;
+    memmove(&word, &utf8_array[i], kWordSize);
+    if ((word & kHighBits) != 0) break;
+  }
+#endif
+  while ((i < array_len) && (utf8_array[i] <= kMaxOneByteChar)) {
+    i++;
+  }
+  return i;
+}
+
+
+intptr_t Utf8::EncodedLength(const uint8_t* latin1_array,
+                             intptr_t array_len) {
+  intptr_t length = array_len;
+  intptr_t i = AsciiPrefixLength(latin1_array, array_len);
+  for (; i < array_len; i++) {
+    if (latin1_array[i] > kMaxOneByteChar) {
+      length++;
+    }
+  }
+  return length;
+}
+
+
+intptr_t Utf8::EncodedLength(const uint16_t* utf16_array,
+                             intptr_t array_len) {
+  intptr_t length = 0;
+  intptr_t i = 0;
+  while (i < array_len) {
+    int32_t ch = Utf16::Next(utf16_array, &i, array_len);
+    length += Utf8::Length(ch);
+  }
+  return length;
+}
+
+
+intptr_t Utf8::EncodeLatin1(const uint8_t* latin1_array,
+                            intptr_t array_len,
+                            uint8_t* dst) {
+  intptr_t i = 0;
+  intptr_t pos = 0;
+  while (i < array_len) {
+    intptr_t ascii_len = AsciiPrefixLength(&latin1_array[i], array_len - i);
+    memmove(&dst[pos], &latin1_array[i], ascii_len);
+    i += ascii_len;
+    pos += ascii_len;
+    if (i < array_len) {
+      uint8_t ch = latin1_array[i++];
+      dst[pos++] = 0xC0 | (ch >> 6);
+      dst[pos++] = 0x80 | (ch & 0x3F);
+    }
+  }
+  return pos;
+}
+
+
+intptr_t Utf8::EncodeUTF16(const uint16_t* utf16_array,
+                           intptr_t array_len,
+                           uint8_t* dst) {
+  intptr_t i = 0;
+  intptr_t pos = 0;
+  while (i < array_len) {
+    uint16_t code_unit = utf16_array[i];
+    if (code_unit <= kMaxOneByteChar) {
+      dst[pos++] = code_unit;
+      i++;
+    } else {
+      int32_t ch = Utf16::Next(utf16_array, &i, array_len);
+      pos += Utf8::Encode(ch, reinterpret_cast<char*>(&dst[pos]));
+    }
+  }
+  return pos;
+}
+
+
 void Utf16::Encode(int32_t codepoint, uint16_t* dst) {
   ASSERT(codepoint > Utf16::kMaxCodeUnit);
   ASSERT(dst != NULL);
@@ -79,6 +79,28 @@ class Utf8 : AllStatic {
                                    int32_t* dst,
                                    intptr_t len);
 
+  // Returns the number of leading ASCII bytes in 'utf8_array'. Scans 16 or
+  // 32 bytes at a time on hosts with SSE2 or AVX2.
+  static intptr_t AsciiPrefixLength(const uint8_t* utf8_array,
+                                    intptr_t array_len);
+
+  // Returns the number of bytes needed to encode the Latin-1 or UTF-16
+  // characters in UTF-8. Unpaired surrogates are encoded in three bytes,
+  // like any other BMP code point.
+  static intptr_t EncodedLength(const uint8_t* latin1_array,
+                                intptr_t array_len);
+  static intptr_t EncodedLength(const uint16_t* utf16_array,
+                                intptr_t array_len);
+
+  // Encodes the characters into 'dst', which must have room for the number
+  // of bytes returned by EncodedLength. Returns the number of bytes written.
+  static intptr_t EncodeLatin1(const uint8_t* latin1_array,
+                               intptr_t array_len,
+                               uint8_t* dst);
+  static intptr_t EncodeUTF16(const uint16_t* utf16_array,
+                              intptr_t array_len,
+                              uint8_t* dst);
+
   static const int32_t kMaxOneByteChar   = 0x7F;
   static const int32_t kMaxTwoByteChar   = 0x7FF;
   static const int32_t kMaxThreeByteChar = 0xFFFF;
@@ -1025,4 +1025,43 @@ TEST_CASE(Utf8Decode) {
   }
 }
 
+
+TEST_CASE(Utf8AsciiPrefixLength) {
+  uint8_t buffer[100];
+  memset(buffer, 'a', sizeof(buffer));
+  EXPECT_EQ(100, Utf8::AsciiPrefixLength(buffer, 100));
+  EXPECT_EQ(0, Utf8::AsciiPrefixLength(buffer, 0));
+  // Non-ASCII bytes at every position, including the tails that are not
+  // scanned a vector at a time.
+  for (intptr_t i = 0; i < 100; i++) {
+    buffer[i] = 0xC3;
+    EXPECT_EQ(i, Utf8::AsciiPrefixLength(buffer, 100));
+    EXPECT_EQ(i, Utf8::AsciiPrefixLength(buffer, i + 1));
+    buffer[i] = 'a';
+  }
+}
+
+
+TEST_CASE(Utf8EncodeLatin1AndUTF16) {
+  {
+    const uint8_t latin1[] = { 'a', 0xE6, 'b', 0xFF };
+    const uint8_t expected[] = { 'a', 0xC3, 0xA6, 'b', 0xC3, 0xBF };
+    uint8_t dst[ARRAY_SIZE(expected)];
+    EXPECT_EQ(6, Utf8::EncodedLength(latin1, ARRAY_SIZE(latin1)));
+    EXPECT_EQ(6, Utf8::EncodeLatin1(latin1, ARRAY_SIZE(latin1), dst));
+    EXPECT(!memcmp(expected, dst, sizeof(expected)));
+  }
+  {
+    // A surrogate pair is encoded in four bytes, an unpaired surrogate in
+    // three.
+    const uint16_t utf16[] = { 'a', 0x20AC, 0xD83D, 0xDE00, 0xD800 };
+    const uint8_t expected[] = { 'a', 0xE2, 0x82, 0xAC, 0xF0, 0x9F, 0x98,
+                                 0x80, 0xED, 0xA0, 0x80 };
+    uint8_t dst[ARRAY_SIZE(expected)];
+    EXPECT_EQ(11, Utf8::EncodedLength(utf16, ARRAY_SIZE(utf16)));
+    EXPECT_EQ(11, Utf8::EncodeUTF16(utf16, ARRAY_SIZE(utf16), dst));
+    EXPECT(!memcmp(expected, dst, sizeof(expected)));
+  }
+}
+
 }  // namespace dart
@@ -408,3 +408,28 @@ class _JsonDecoderSink extends _StringSinkConversionSink {
     return null;  // This call was not intercepted.
   }
 }
+
+@patch class _Utf8Decoder {
+  // Currently not intercepting UTF8 decoding.
+  @patch
+  static String _decodeIntercepted(List<int> codeUnits, int start, int end) {
+    return null;  // This call was not intercepted.
+  }
+}
+
+@patch class Utf8Encoder {
+  // Currently not intercepting UTF8 encoding.
+  @patch
+  static List<int> _convertIntercepted(String string, int start, int end) {
+    return null;  // This call was not intercepted.
+  }
+}
+
+@patch class _JsonUtf8Stringifier {
+  // Currently not intercepting JSON encoding.
+  @patch
+  static _encodeIntercepted(object, List<int> buffer, int index,
+                            List<int> indent) {
+    return null;  // This call was not intercepted.
+  }
+}
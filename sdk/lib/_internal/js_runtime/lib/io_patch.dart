@@ -188,6 +188,18 @@ class _RandomAccessFile {
   static _lock(int id, int lock, int start, int end) {
     throw new UnsupportedError("RandomAccessFile._lock");
   }
+  @patch
+  static _map(int id, int position, int length, int mode) {
+    throw new UnsupportedError("RandomAccessFile._map");
+  }
+  @patch
+  static _adviseMapping(Uint8List mapping, int advice) {
+    throw new UnsupportedError("RandomAccessFile._adviseMapping");
+  }
+  @patch
+  static _syncMapping(Uint8List mapping) {
+    throw new UnsupportedError("RandomAccessFile._syncMapping");
+  }
 }
 
 @patch
@@ -475,6 +487,11 @@ class _Filter {
     throw new UnsupportedError("_newZLibDeflateFilter");
   }
   @patch
+  static _Filter _newParallelGZipDeflateFilter(int level, int windowBits,
+                                               int memLevel, int strategy) {
+    throw new UnsupportedError("_newParallelGZipDeflateFilter");
+  }
+  @patch
   static _Filter _newZLibInflateFilter(int windowBits,
                                        List<int> dictionary, bool raw) {
     throw new UnsupportedError("_newZLibInflateFilter");
@@ -896,6 +896,8 @@ class _JsonUtf8Stringifier extends _JsonStringifier {
   final Function addChunk;
   Uint8List buffer;
   int index = 0;
+  /** Whether the next value written is the value being stringified. */
+  bool _isTopLevel = true;
 
   _JsonUtf8Stringifier(toEncodable, int bufferSize, this.addChunk)
       : super(toEncodable),
@@ -942,6 +944,55 @@ class _JsonUtf8Stringifier extends _JsonStringifier {
     index = 0;
   }
 
+  bool writeJsonValue(object) {
+    // Only the whole value is offered to the native encoder. If it declines,
+    // this stringifier writes everything, so no part is walked twice.
+    if (_isTopLevel) {
+      _isTopLevel = false;
+      if ((object is String || object is List || object is Map) &&
+          _writeNatively(object)) {
+        return true;
+      }
+    }
+    return super.writeJsonValue(object);
+  }
+
+  /** Indentation for the native encoder, `null` if not pretty. */
+  Uint8List get _nativeIndent => null;
+
+  /**
+   * Writes [object] with the platform's native encoder, if it has one.
+   *
+   * Returns false, without writing anything, if [object] or anything in it
+   * is left to this stringifier. That includes any object that needs
+   * [_toEncodable].
+   */
+  bool _writeNatively(object) {
+    var result = _encodeIntercepted(object, buffer, index, _nativeIndent);
+    if (result == null) return false;
+    if (result is int) {
+      index = result;
+      return true;
+    }
+    // The encoding did not fit in the buffer and becomes a chunk of its own.
+    if (index > 0) addChunk(buffer, 0, index);
+    addChunk(result, 0, result.length);
+    buffer = new Uint8List(bufferSize);
+    index = 0;
+    return true;
+  }
+
+  /**
+   * Encodes [object] into [buffer] from [index].
+   *
+   * Returns the index after the encoding, or a new [Uint8List] holding the
+   * encoding if it does not fit in [buffer]. Returns `null` if the call was
+   * not intercepted, or if [object] or anything in it cannot be encoded
+   * natively.
+   */
+  external static _encodeIntercepted(object, Uint8List buffer, int index,
+                                     Uint8List indent);
+
   void writeNumber(num number) {
     writeAsciiString(number.toString());
   }
@@ -1034,10 +1085,20 @@ class _JsonUtf8Stringifier extends _JsonStringifier {
 class _JsonUtf8StringifierPretty extends _JsonUtf8Stringifier
                                  with _JsonPrettyPrintMixin {
   final List<int> indent;
+  Uint8List _indentBytes;
+
   _JsonUtf8StringifierPretty(toEncodableFunction, this.indent,
                              bufferSize, addChunk)
       : super(toEncodableFunction, bufferSize, addChunk);
 
+  Uint8List get _nativeIndent {
+    if (_indentBytes == null) {
+      _indentBytes = (indent is Uint8List) ? indent
+                                           : new Uint8List.fromList(indent);
+    }
+    return _indentBytes;
+  }
+
   void writeIndentation(int count) {
     List<int> indent = this.indent;
     int indentLength = indent.length;
@@ -93,6 +93,9 @@ class Utf8Encoder extends Converter<String, List<int>> {
     if (end == null) end = stringLength;
     int length = end - start;
     if (length == 0) return new Uint8List(0);
+    // Allow the implementation to encode the whole string in one go.
+    List<int> result = _convertIntercepted(string, start, end);
+    if (result != null) return result;
     // Create a new encoder with a length that is guaranteed to be big enough.
     // A single code unit uses at most 3 bytes, a surrogate pair at most 4.
     _Utf8Encoder encoder = new _Utf8Encoder.withBufferSize(length * 3);
@@ -127,6 +130,11 @@ class Utf8Encoder extends Converter<String, List<int>> {
 
   // Override the base-classes bind, to provide a better type.
   Stream<List<int>> bind(Stream<String> stream) => super.bind(stream);
+
+  // Allow intercepting of UTF-8 encoding. Returns null if the call was not
+  // intercepted.
+  external static List<int> _convertIntercepted(
+      String string, int start, int end);
 }
 
 /**
@@ -273,6 +281,24 @@ class _Utf8EncoderSink extends _Utf8Encoder with StringConversionSinkMixin {
       if (wasCombined) start++;
       _carry = 0;
     }
+    if (start < end) {
+      // Let the implementation encode the slice in one go. A trailing lead
+      // surrogate is kept back unless this is the last slice.
+      int sliceEnd = end;
+      if (!isLast && _isLeadSurrogate(str.codeUnitAt(end - 1))) sliceEnd--;
+      List<int> encoded =
+          Utf8Encoder._convertIntercepted(str, start, sliceEnd);
+      if (encoded != null) {
+        if (_bufferIndex > 0) {
+          _sink.addSlice(_buffer, 0, _bufferIndex, false);
+          _bufferIndex = 0;
+        }
+        if (sliceEnd != end) _carry = str.codeUnitAt(sliceEnd);
+        _sink.addSlice(encoded, 0, encoded.length, isLast);
+        if (isLast) close();
+        return;
+      }
+    }
     do {
       start = _fillBuffer(str, start, end);
       bool isLastSlice = isLast && (start == end);
@@ -335,7 +361,7 @@ class Utf8Decoder extends Converter<List<int>, String> {
     // of codeUnits.
     String result = _convertIntercepted(_allowMalformed, codeUnits, start, end);
     if (result != null) {
-      return null;
+      return result;
     }
 
     int length = codeUnits.length;
@@ -441,7 +467,55 @@ class _Utf8Decoder {
     }
   }
 
+  // Allow the implementation to decode the code units from [start] to [end]
+  // in one go. Returns null if the call was not intercepted or the code
+  // units are malformed.
+  external static String _decodeIntercepted(
+      List<int> codeUnits, int start, int end);
+
+  /**
+   * Returns the end of the last complete UTF-8 sequence in [codeUnits] from
+   * [start] to [end].
+   */
+  static int _completeSequencesEnd(List<int> codeUnits, int start, int end) {
+    for (int i = end - 1; i >= start && i >= end - 3; i--) {
+      int unit = codeUnits[i];
+      if ((unit & 0xC0) == 0x80) continue;
+      int length = 1;
+      if ((unit & 0xE0) == 0xC0) {
+        length = 2;
+      } else if ((unit & 0xF0) == 0xE0) {
+        length = 3;
+      } else if ((unit & 0xF8) == 0xF0) {
+        length = 4;
+      }
+      return (i + length > end) ? i : end;
+    }
+    return end;
+  }
+
   void convert(List<int> codeUnits, int startIndex, int endIndex) {
+    if (_expectedUnits == 0 && startIndex < endIndex) {
+      // Decode the complete sequences of the chunk in one go if the
+      // implementation supports it. The loop below handles an incomplete
+      // sequence at the end, and everything if the chunk is malformed.
+      int completeEnd =
+          _completeSequencesEnd(codeUnits, startIndex, endIndex);
+      String decoded =
+          _decodeIntercepted(codeUnits, startIndex, completeEnd);
+      if (decoded != null) {
+        if (decoded.isNotEmpty) {
+          if (_isFirstCharacter &&
+              decoded.codeUnitAt(0) == UNICODE_BOM_CHARACTER_RUNE) {
+            decoded = decoded.substring(1);
+          }
+          _isFirstCharacter = false;
+          _stringSink.write(decoded);
+        }
+        startIndex = completeEnd;
+      }
+    }
+
     int value = _value;
     int expectedUnits = _expectedUnits;
     int extraUnits = _extraUnits;
@@ -234,13 +234,23 @@ class GZipCodec extends Codec<List<int>, List<int>> {
    */
   final bool raw;
 
+  /**
+   * When true, the input is split into blocks that are compressed on several
+   * threads and concatenated into a single `GZip` stream. This speeds up the
+   * compression of large inputs at the cost of a slightly lower compression
+   * rate. Ignored unless [gzip] is true, [raw] is false, no [dictionary] is
+   * given and [windowBits] is above [ZLibOption.MIN_WINDOW_BITS].
+   */
+  final bool parallel;
+
   GZipCodec({this.level: ZLibOption.DEFAULT_LEVEL,
             this.windowBits: ZLibOption.DEFAULT_WINDOW_BITS,
             this.memLevel: ZLibOption.DEFAULT_MEM_LEVEL,
             this.strategy: ZLibOption.STRATEGY_DEFAULT,
             this.dictionary: null,
             this.raw: false,
-            this.gzip: true}) {
+            this.gzip: true,
+            this.parallel: false}) {
     _validateZLibeLevel(level);
     _validateZLibMemLevel(memLevel);
     _validateZLibStrategy(strategy);
@@ -254,6 +264,7 @@ class GZipCodec extends Codec<List<int>, List<int>> {
         strategy = ZLibOption.STRATEGY_DEFAULT,
         raw = false,
         gzip = true,
+        parallel = false,
         dictionary = null;
 
   /**
@@ -262,7 +273,7 @@ class GZipCodec extends Codec<List<int>, List<int>> {
   Converter<List<int>, List<int>> get encoder =>
       new ZLibEncoder(gzip: true, level: level, windowBits: windowBits,
                       memLevel: memLevel, strategy: strategy,
-                      dictionary: dictionary, raw: raw);
+                      dictionary: dictionary, raw: raw, parallel: parallel);
 
   /**
    * Get a [ZLibDecoder] for decoding `GZip` compressed data.
@@ -337,13 +348,23 @@ class ZLibEncoder extends Converter<List<int>, List<int>> {
    */
   final bool raw;
 
+  /**
+   * When true, the input is split into blocks that are compressed on several
+   * threads and concatenated into a single `GZip` stream. This speeds up the
+   * compression of large inputs at the cost of a slightly lower compression
+   * rate. Ignored unless [gzip] is true, [raw] is false, no [dictionary] is
+   * given and [windowBits] is above [ZLibOption.MIN_WINDOW_BITS].
+   */
+  final bool parallel;
+
   ZLibEncoder({this.gzip: false,
               this.level: ZLibOption.DEFAULT_LEVEL,
               this.windowBits: ZLibOption.DEFAULT_WINDOW_BITS,
               this.memLevel: ZLibOption.DEFAULT_MEM_LEVEL,
               this.strategy: ZLibOption.STRATEGY_DEFAULT,
               this.dictionary: null,
-              this.raw: false}) {
+              this.raw: false,
+              this.parallel: false}) {
     _validateZLibeLevel(level);
     _validateZLibMemLevel(memLevel);
     _validateZLibStrategy(strategy);
@@ -370,7 +391,7 @@ class ZLibEncoder extends Converter<List<int>, List<int>> {
       sink = new ByteConversionSink.from(sink);
     }
     return new _ZLibEncoderSink(sink, gzip, level, windowBits, memLevel,
-                                strategy, dictionary, raw);
+                                strategy, dictionary, raw, parallel);
   }
 }
 
@@ -456,10 +477,21 @@ class _BufferSink extends ByteConversionSink {
 class _ZLibEncoderSink extends _FilterSink {
   _ZLibEncoderSink(ByteConversionSink sink, bool gzip, int level,
                    int windowBits, int memLevel, int strategy,
-                   List<int> dictionary, bool raw)
-      : super(sink, _Filter._newZLibDeflateFilter(gzip, level, windowBits,
-                                                  memLevel, strategy,
-                                                  dictionary, raw));
+                   List<int> dictionary, bool raw, bool parallel)
+      : super(sink, _makeFilter(gzip, level, windowBits, memLevel, strategy,
+                                dictionary, raw, parallel));
+
+  static _Filter _makeFilter(bool gzip, int level, int windowBits,
+                             int memLevel, int strategy,
+                             List<int> dictionary, bool raw, bool parallel) {
+    if (parallel && gzip && !raw && dictionary == null &&
+        windowBits > ZLibOption.MIN_WINDOW_BITS) {
+      return _Filter._newParallelGZipDeflateFilter(level, windowBits,
+                                                   memLevel, strategy);
+    }
+    return _Filter._newZLibDeflateFilter(gzip, level, windowBits, memLevel,
+                                         strategy, dictionary, raw);
+  }
 }
 
 class _ZLibDecoderSink extends _FilterSink {
@@ -557,6 +589,11 @@ abstract class _Filter {
                                                 int strategy,
                                                 List<int> dictionary, bool raw);
 
+  external static _Filter _newParallelGZipDeflateFilter(int level,
+                                                        int windowBits,
+                                                        int memLevel,
+                                                        int strategy);
+
   external static _Filter _newZLibInflateFilter(int windowBits,
                                                 List<int> dictionary, bool raw);
 }
@@ -306,8 +306,52 @@ abstract class Directory implements FileSystemEntity {
   List<FileSystemEntity> listSync({bool recursive: false,
                                    bool followLinks: true});
 
+  /**
+   * Recursively lists the sub-directories and files of this [Directory],
+   * reading several sub-directories at once where the platform supports it.
+   *
+   * Symbolic links are reported as [Link] objects and are not followed.
+   * Entries of different sub-directories may be interleaved, but a
+   * directory is always reported before its contents.
+   *
+   * If [stat] is true, the size and modification time of each entry are
+   * read in the same pass and are available from the returned
+   * [DirectoryWalkEntry] objects. As with [FileSystemEntity.stat], they are
+   * those of the target for a link. Otherwise the file system is only asked
+   * for the types of the entries, which many file systems provide without a
+   * separate call per entry.
+   */
+  Stream<DirectoryWalkEntry> walk({bool stat: false});
+
   /**
    * Returns a human readable string for this Directory instance.
    */
   String toString();
 }
+
+
+/**
+ * An entry found by [Directory.walk].
+ */
+class DirectoryWalkEntry {
+  /**
+   * The file, directory or link found.
+   */
+  final FileSystemEntity entity;
+
+  /**
+   * The size of the entry in bytes, or -1 if the walk did not stat it or if
+   * the entry is a broken link.
+   */
+  final int size;
+
+  /**
+   * The time of the last change to the data of the entry, or `null` if the
+   * walk did not stat it or if the entry is a broken link.
+   */
+  final DateTime modified;
+
+  DirectoryWalkEntry._(this.entity, this.size, this.modified);
+
+  String toString() => "DirectoryWalkEntry: '${entity.path}'";
+}
@@ -232,6 +232,13 @@ class _Directory extends FileSystemEntity implements Directory {
         followLinks);
   }
 
+  Stream<DirectoryWalkEntry> walk({bool stat: false}) {
+    return new _DirectoryWalker(
+        this,
+        FileSystemEntity._ensureTrailingPathSeparators(path),
+        stat).stream;
+  }
+
   String toString() => "Directory: '$path'";
 
   bool _isErrorResponse(response) =>
@@ -277,6 +284,7 @@ class _AsyncDirectoryLister {
 
   _AsyncDirectoryLister(this.path, this.recursive, this.followLinks) {
     controller = new StreamController(onListen: onListen,
+                                      onPause: onPause,
                                       onResume: onResume,
                                       onCancel: onCancel,
                                       sync: true);
@@ -284,22 +292,34 @@ class _AsyncDirectoryLister {
 
   Stream get stream => controller.stream;
 
+  // The IO service requests used for the listing.
+  int get startRequest => _DIRECTORY_LIST_START;
+  List get startArguments => [path, recursive, followLinks];
+  int get nextRequest => _DIRECTORY_LIST_NEXT;
+  int get stopRequest => _DIRECTORY_LIST_STOP;
+
+  // The number of elements per entry in the results of nextRequest.
+  int get entryLength => 2;
+
   void onListen() {
-    _IOService._dispatch(_DIRECTORY_LIST_START, [path, recursive, followLinks])
-        .then((response) {
-          if (response is int) {
-            id = response;
-            next();
-          } else if (response is Error) {
-            controller.addError(response, response.stackTrace);
-            close();
-          } else {
-            error(response);
-            close();
-          }
-        });
+    _IOService._dispatch(startRequest, startArguments).then(started);
+  }
+
+  void started(response) {
+    if (response is int) {
+      id = response;
+      next();
+    } else if (response is Error) {
+      controller.addError(response, response.stackTrace);
+      close();
+    } else {
+      error(response);
+      close();
+    }
   }
 
+  void onPause() {}
+
   void onResume() {
     if (!nextRunning) next();
   }
@@ -323,25 +343,24 @@ class _AsyncDirectoryLister {
     if (controller.isPaused) return;
     if (nextRunning) return;
     nextRunning = true;
-    _IOService._dispatch(_DIRECTORY_LIST_NEXT, [id]).then((result) {
+    _IOService._dispatch(nextRequest, [id]).then((result) {
       nextRunning = false;
       if (result is List) {
         next();
-        assert(result.length % 2 == 0);
-        for (int i = 0; i < result.length; i++) {
-          assert(i % 2 == 0);
-          switch (result[i++]) {
+        assert(result.length % entryLength == 0);
+        for (int i = 0; i < result.length; i += entryLength) {
+          switch (result[i]) {
             case LIST_FILE:
-              controller.add(new File(result[i]));
+              addEntry(new File(result[i + 1]), result, i);
               break;
             case LIST_DIRECTORY:
-              controller.add(new Directory(result[i]));
+              addEntry(new Directory(result[i + 1]), result, i);
               break;
             case LIST_LINK:
-              controller.add(new Link(result[i]));
+              addEntry(new Link(result[i + 1]), result, i);
               break;
             case LIST_ERROR:
-              error(result[i]);
+              error(result[i + 1]);
               break;
             case LIST_DONE:
               canceled = true;
@@ -354,6 +373,11 @@ class _AsyncDirectoryLister {
     });
   }
 
+  // Adds the entity of the entry at [index] in [result].
+  void addEntry(FileSystemEntity entity, List result, int index) {
+    controller.add(entity);
+  }
+
   void close() {
     if (closed) return;
     if (nextRunning) return;
@@ -363,7 +387,7 @@ class _AsyncDirectoryLister {
     }
     closed = true;
     if (id != null) {
-      _IOService._dispatch(_DIRECTORY_LIST_STOP, [id]).whenComplete(cleanup);
+      _IOService._dispatch(stopRequest, [id]).whenComplete(cleanup);
     } else {
       cleanup();
     }
@@ -391,3 +415,91 @@ class _AsyncDirectoryLister {
     }
   }
 }
+
+
+// A recursive listing that does not follow links, with the entries stat'ed
+// if asked for. Where the platform has no native walks, the directory is
+// listed with [Directory.list] and each entry is stat'ed separately.
+class _DirectoryWalker extends _AsyncDirectoryLister {
+  final Directory directory;
+  final bool stat;
+
+  // The listing used where walks are not supported.
+  StreamSubscription subscription;
+
+  _DirectoryWalker(Directory directory, String path, bool stat)
+      : directory = directory,
+        stat = stat,
+        super(path, true, false);
+
+  int get startRequest => _DIRECTORY_WALK_START;
+  List get startArguments => [path, stat];
+  int get nextRequest => _DIRECTORY_WALK_NEXT;
+  int get stopRequest => _DIRECTORY_WALK_STOP;
+  int get entryLength => stat ? 4 : 2;
+
+  void started(response) {
+    if (response == null) {
+      // Walks are not supported on this platform.
+      listSequentially();
+    } else {
+      super.started(response);
+    }
+  }
+
+  void addEntry(FileSystemEntity entity, List result, int index) {
+    if (stat) {
+      int modified = result[index + 3];
+      controller.add(new DirectoryWalkEntry._(
+          entity,
+          result[index + 2],
+          (modified < 0)
+              ? null : new DateTime.fromMillisecondsSinceEpoch(modified)));
+    } else {
+      controller.add(new DirectoryWalkEntry._(entity, -1, null));
+    }
+  }
+
+  void listSequentially() {
+    if (canceled) {
+      close();
+      return;
+    }
+    var entries = directory.list(recursive: true, followLinks: false);
+    if (stat) {
+      entries = entries.asyncMap((entity) {
+        return entity.stat().then((FileStat fileStat) {
+          return new DirectoryWalkEntry._(
+              entity, fileStat.size, fileStat.modified);
+        });
+      });
+    } else {
+      entries = entries.map(
+          (entity) => new DirectoryWalkEntry._(entity, -1, null));
+    }
+    subscription = entries.listen(controller.add,
+                                  onError: controller.addError,
+                                  onDone: close);
+    if (controller.isPaused) subscription.pause();
+  }
+
+  void onPause() {
+    if (subscription != null) subscription.pause();
+  }
+
+  void onResume() {
+    if (subscription != null) {
+      subscription.resume();
+    } else {
+      super.onResume();
+    }
+  }
+
+  Future onCancel() {
+    if (subscription == null) return super.onCancel();
+    canceled = true;
+    subscription.cancel();
+    close();
+    return closeCompleter.future;
+  }
+}
@@ -55,6 +55,35 @@ enum FileLock {
   EXCLUSIVE
 }
 
+
+/// Mode for mapping a region of a file into memory with
+/// [RandomAccessFile.mapSync].
+enum FileMapMode {
+  /// Private mapping. Changes made through the mapping are not written back
+  /// to the file and are not visible to other processes.
+  READ,
+  /// Shared mapping. Changes made through the mapping are written back to
+  /// the file. The file must be opened for writing.
+  READ_WRITE
+}
+
+
+/// Expected access pattern of a file mapping, passed to
+/// [RandomAccessFile.adviseMappingSync].
+enum FileMapAdvice {
+  /// No particular access pattern.
+  NORMAL,
+  /// Pages will be accessed in order, so read ahead aggressively.
+  SEQUENTIAL,
+  /// Pages will be accessed in random order, so do not read ahead.
+  RANDOM,
+  /// Pages will be accessed soon, so start reading them in.
+  WILL_NEED,
+  /// Pages will not be accessed soon, so they can be dropped. For a
+  /// [FileMapMode.READ] mapping this discards any changes made through it.
+  DONT_NEED
+}
+
 /**
  * A reference to a file on the file system.
  *
@@ -819,6 +848,43 @@ abstract class RandomAccessFile {
    */
   void unlockSync([int start = 0, int end]);
 
+  /**
+   * Synchronously maps [length] bytes of the file starting at byte
+   * [position] into memory.
+   *
+   * Returns a [Uint8List] backed directly by the mapped pages, so the
+   * contents are read from the file on demand without being copied. The
+   * region must lie within the file. With [FileMapMode.READ] changes made to
+   * the list are private to this process. With [FileMapMode.READ_WRITE]
+   * they are written back to the file, which must be opened for writing.
+   *
+   * The mapping stays valid after the file is closed and is removed when
+   * the returned list is garbage collected. If the file is truncated while
+   * mapped, accessing the pages beyond its new end crashes the process.
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  Uint8List mapSync(int position, int length,
+                    [FileMapMode mode = FileMapMode.READ]);
+
+  /**
+   * Advises the operating system about how a [mapping] returned by
+   * [mapSync] on this file will be accessed.
+   *
+   * The advice is a hint and is ignored on platforms that do not support
+   * it. Throws a [FileSystemException] if the operation fails.
+   */
+  void adviseMappingSync(Uint8List mapping, FileMapAdvice advice);
+
+  /**
+   * Synchronously writes the changes made through a
+   * [FileMapMode.READ_WRITE] [mapping] returned by [mapSync] on this file
+   * back to the file.
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  void flushMappingSync(Uint8List mapping);
+
   /**
    * Returns a human-readable string for this RandomAccessFile instance.
    */
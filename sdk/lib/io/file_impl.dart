@@ -1017,6 +1017,51 @@ class _RandomAccessFile
     }
   }
 
+  external static _map(int id, int position, int length, int mode);
+
+  Uint8List mapSync(int position, int length,
+                    [FileMapMode mode = FileMapMode.READ]) {
+    _checkAvailable();
+    if (position is !int || length is !int || mode is !FileMapMode) {
+      throw new ArgumentError();
+    }
+    if (position < 0 || length <= 0) {
+      throw new RangeError("Invalid region: position $position, "
+                           "length $length");
+    }
+    var result = _map(_id, position, length, mode.index);
+    if (result is OSError) {
+      throw new FileSystemException('map failed', path, result);
+    }
+    return result;
+  }
+
+  external static _adviseMapping(Uint8List mapping, int advice);
+
+  void adviseMappingSync(Uint8List mapping, FileMapAdvice advice) {
+    _checkAvailable();
+    if (mapping is !Uint8List || advice is !FileMapAdvice) {
+      throw new ArgumentError();
+    }
+    var result = _adviseMapping(mapping, advice.index);
+    if (result is OSError) {
+      throw new FileSystemException('adviseMapping failed', path, result);
+    }
+  }
+
+  external static _syncMapping(Uint8List mapping);
+
+  void flushMappingSync(Uint8List mapping) {
+    _checkAvailable();
+    if (mapping is !Uint8List) {
+      throw new ArgumentError();
+    }
+    var result = _syncMapping(mapping);
+    if (result is OSError) {
+      throw new FileSystemException('flushMapping failed', path, result);
+    }
+  }
+
   bool get closed => _id == 0;
 
   Future _dispatch(int request, List data, { bool markClosed: false }) {
@@ -2585,6 +2585,14 @@ class _DetachedSocket extends Stream<List<int>> implements Socket {
     return _socket.addStream(stream);
   }
 
+  Future<int> sendFile(RandomAccessFile file,
+                       {int offset: 0, int length, void onProgress(int sent)}) {
+    return _socket.sendFile(file,
+                            offset: offset,
+                            length: length,
+                            onProgress: onProgress);
+  }
+
   void destroy() => _socket.destroy();
 
   Future flush() => _socket.flush();
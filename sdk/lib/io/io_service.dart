@@ -45,6 +45,9 @@ const int _DIRECTORY_LIST_NEXT = 36;
 const int _DIRECTORY_LIST_STOP = 37;
 const int _DIRECTORY_RENAME = 38;
 const int _SSL_PROCESS_FILTER = 39;
+const int _DIRECTORY_WALK_START = 40;
+const int _DIRECTORY_WALK_NEXT = 41;
+const int _DIRECTORY_WALK_STOP = 42;
 
 class _IOService {
   external static Future _dispatch(int request, List data);
@@ -883,6 +883,11 @@ class _RawSecureSocket extends Stream<RawSocketEvent>
     return written;
   }
 
+  int sendFile(RandomAccessFile file, int offset, int count) {
+    // The data has to be encrypted, so it cannot bypass user space.
+    throw new UnsupportedError("sendFile is not supported on secure sockets");
+  }
+
   X509Certificate get peerCertificate => _secureFilter.peerCertificate;
 
   String get selectedProtocol => _selectedProtocol;
@@ -514,6 +514,22 @@ abstract class RawSocket implements Stream<RawSocketEvent> {
    */
   int write(List<int> buffer, [int offset, int count]);
 
+  /**
+   * Writes up to [count] bytes of [file] starting at byte [offset] to the
+   * socket. The number of successfully written bytes is returned. Like
+   * [write] this function is non-blocking and will only write data if buffer
+   * space is available in the socket.
+   *
+   * Where the platform supports it the data is sent directly from the file
+   * to the socket by the operating system, without being copied into the
+   * Dart heap. The position of [file] is not changed. Secure sockets do not
+   * support this and throw an [UnsupportedError].
+   *
+   * Throws a [FileSystemException] if [offset] is at or past the end of
+   * [file].
+   */
+  int sendFile(RandomAccessFile file, int offset, int count);
+
   /**
    * Returns the port used by this socket.
    */
@@ -604,6 +620,29 @@ abstract class Socket implements Stream<List<int>>, IOSink {
    */
   bool setOption(SocketOption option, bool enabled);
 
+  /**
+   * Sends [length] bytes of [file] starting at byte [offset] on the socket.
+   * If [length] is omitted the rest of the file is sent.
+   *
+   * Data added to the socket before the call is sent first. Like
+   * [addStream], no other data can be added until the returned [Future]
+   * completes with the number of bytes sent. [onProgress] is called with the
+   * total number of bytes sent so far each time a part of the file has been
+   * written.
+   *
+   * Where the platform supports it the data is sent directly from the file
+   * to the socket by the operating system, without being copied into the
+   * Dart heap. The position of [file] is not changed, and [file] must not be
+   * closed before the returned [Future] completes. Secure sockets read the
+   * file and send it through the normal write path.
+   *
+   * If the file ends before [length] bytes have been sent, the returned
+   * [Future] completes with a [FileSystemException] and the socket is
+   * destroyed.
+   */
+  Future<int> sendFile(RandomAccessFile file,
+                       {int offset: 0, int length, void onProgress(int sent)});
+
   /**
    * Returns the port used by this socket.
    */
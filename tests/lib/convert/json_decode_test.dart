@@ -0,0 +1,188 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Tests decoding JSON from strings and typed data, which implementations
+// may parse in one go instead of a character at a time, and from chunks.
+
+import 'package:expect/expect.dart';
+import 'dart:convert';
+import 'dart:typed_data';
+
+const String source = '''
+  {"name": "caf\\u00e9 crème", "tags": ["a", "b", "a"],
+   "nested": {"list": [[], {}, [1, [2, [3]]]], "empty": ""},
+   "numbers": [0, 1, -12, 123456789012345678, 1234567890123456789012,
+               0.5, -0.0, 1e3, 1E-3, 2.5e+2, 9007199254740993.0, 1e400],
+   "literals": [true, false, null],
+   "escapes": "\\"\\\\\\/\\b\\f\\n\\r\\t\\u0001\\uD83D\\uDE00\\ud800",
+   "unicode": "€ \u{1F600}"}
+''';
+
+final Map expected = {
+  "name": "café crème",
+  "tags": ["a", "b", "a"],
+  "nested": {"list": [[], {}, [1, [2, [3]]]], "empty": ""},
+  "numbers": [0, 1, -12, 123456789012345678, 1234567890123456789012,
+              0.5, -0.0, 1000.0, 0.001, 250.0, 9007199254740992.0,
+              double.INFINITY],
+  "literals": [true, false, null],
+  "escapes": "\"\\/\b\f\n\r\t\u0001\u{1F600}\ud800",
+  "unicode": "€ \u{1F600}",
+};
+
+decodeBytes(List<int> bytes) =>
+    UTF8.decoder.fuse(JSON.decoder).convert(bytes);
+
+decodeChunked(String string, int chunkSize) {
+  var result;
+  var sink = JSON.decoder.startChunkedConversion(
+      new ChunkedConversionSink.withCallback((values) {
+        result = values.single;
+      }));
+  for (int i = 0; i < string.length; i += chunkSize) {
+    int end = i + chunkSize;
+    if (end > string.length) end = string.length;
+    sink.addSlice(string, i, end, false);
+  }
+  sink.close();
+  return result;
+}
+
+decodeBytesChunked(List<int> bytes, int chunkSize) {
+  var result;
+  var sink = JSON.decoder.startChunkedConversion(
+      new ChunkedConversionSink.withCallback((values) {
+        result = values.single;
+      })).asUtf8Sink(false);
+  for (int i = 0; i < bytes.length; i += chunkSize) {
+    int end = i + chunkSize;
+    if (end > bytes.length) end = bytes.length;
+    sink.addSlice(bytes, i, end, false);
+  }
+  sink.close();
+  return result;
+}
+
+void checkValue(expected, actual) {
+  if (expected is Map) {
+    Expect.isTrue(actual is Map);
+    Expect.listEquals(expected.keys.toList(), actual.keys.toList());
+    for (var key in expected.keys) {
+      checkValue(expected[key], actual[key]);
+    }
+  } else if (expected is List) {
+    Expect.isTrue(actual is List);
+    Expect.equals(expected.length, actual.length);
+    for (int i = 0; i < expected.length; i++) {
+      checkValue(expected[i], actual[i]);
+    }
+  } else if (expected is num) {
+    Expect.equals(expected is int, actual is int);
+    Expect.equals(expected, actual);
+    Expect.equals(expected.isNegative, actual.isNegative);
+  } else {
+    Expect.equals(expected, actual);
+  }
+}
+
+void testDecode() {
+  var bytes = new Uint8List.fromList(UTF8.encode(source));
+  checkValue(expected, JSON.decode(source));
+  checkValue(expected, decodeBytes(bytes));
+  var padded = new Uint8List(bytes.length + 6);
+  padded.setRange(3, 3 + bytes.length, bytes);
+  checkValue(expected,
+             decodeBytes(new Uint8List.view(padded.buffer, 3, bytes.length)));
+  // A string that is not one-byte.
+  checkValue(["€"], JSON.decode('["€"]'));
+  for (int chunkSize in [1, 7, 1000]) {
+    checkValue(expected, decodeChunked(source, chunkSize));
+    checkValue(expected, decodeBytesChunked(bytes, chunkSize));
+  }
+}
+
+void testResultsAreModifiable() {
+  Map map = JSON.decode('{"a": 1, "b": [1], "a": 2, "c": 3, "b": 4}');
+  // The last value of a duplicated key wins, in the first key's position.
+  Expect.listEquals(["a", "b", "c"], map.keys.toList());
+  Expect.listEquals([2, 4, 3], map.values.toList());
+  Expect.equals(3, map.length);
+  map["d"] = 5;
+  Expect.equals(2, map.remove("a"));
+  Expect.listEquals(["b", "c", "d"], map.keys.toList());
+  Expect.isTrue(map.containsKey("c"));
+  Expect.isFalse(map.containsKey("a"));
+
+  List list = JSON.decode('[1, 2]');
+  list.add(3);
+  Expect.listEquals([1, 2, 3], list);
+
+  // Keys written with and without escapes are the same key.
+  Expect.equals(1, JSON.decode('{"a": 0, "\\u0061": 1}').length);
+}
+
+void testDeepNesting() {
+  int depth = 5000;
+  var string = "${'[' * depth}${']' * depth}";
+  var value = JSON.decode(string);
+  for (int i = 1; i < depth; i++) {
+    value = value.single;
+  }
+  Expect.isTrue(value is List && value.isEmpty);
+}
+
+void testErrors() {
+  for (var bad in ['', ' ', '[1,]', '{"a":1,}', '01', '-', '1.', '.5', '1e',
+                   '"\t"', '"\\x"', '"\\u12"', 'tru', '[1] x', '{1: 2}',
+                   '{"a" 1}', '[', '"abc']) {
+    Expect.throws(() => JSON.decode(bad), (e) => e is FormatException, bad);
+    var bytes = new Uint8List.fromList(UTF8.encode(bad));
+    Expect.throws(() => decodeBytes(bytes), (e) => e is FormatException, bad);
+    Expect.throws(() => decodeChunked(bad, 1),
+                  (e) => e is FormatException, bad);
+  }
+  // Malformed UTF-8 is reported, or replaced if that is allowed.
+  var malformed = new Uint8List.fromList([0x22, 0x61, 0xC0, 0x80, 0x22]);
+  Expect.throws(() => decodeBytes(malformed), (e) => e is FormatException);
+  String replaced = new Utf8Decoder(allowMalformed: true)
+      .fuse(JSON.decoder).convert(malformed);
+  Expect.isTrue(replaced.startsWith("a\ufffd"));
+}
+
+// Chunks are parsed as they are added, so an error is reported by the
+// chunk that contains it, before the sink is closed.
+void testChunkedErrorsAreEager() {
+  var sink = JSON.decoder.startChunkedConversion(
+      new ChunkedConversionSink.withCallback((_) {
+        Expect.fail("Unexpected result");
+      }));
+  sink.add('[1, 2');
+  Expect.throws(() => sink.add(', x]'), (e) => e is FormatException);
+
+  var byteSink = JSON.decoder.startChunkedConversion(
+      new ChunkedConversionSink.withCallback((_) {
+        Expect.fail("Unexpected result");
+      })).asUtf8Sink(false);
+  byteSink.add(UTF8.encode('{"a": 1'));
+  Expect.throws(() => byteSink.add(UTF8.encode(', 2}')),
+                (e) => e is FormatException);
+}
+
+void testReviver() {
+  var decoded = JSON.decode('{"a": [1, 2], "b": 3}',
+                            reviver: (key, value) {
+                              return value is int ? -value : value;
+                            });
+  Expect.listEquals([-1, -2], decoded["a"]);
+  Expect.equals(-3, decoded["b"]);
+}
+
+void main() {
+  testDecode();
+  testResultsAreModifiable();
+  testDeepNesting();
+  testErrors();
+  testChunkedErrorsAreEager();
+  testReviver();
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Tests that encoding JSON directly to UTF-8 gives the same bytes as
+// encoding to a string first, including when implementations encode parts
+// of the value natively.
+
+import 'package:expect/expect.dart';
+import 'dart:convert';
+
+class Point {
+  final int x;
+  final int y;
+  Point(this.x, this.y);
+  toJson() => {"x": x, "y": [y, "\u{1F600}"]};
+}
+
+class NotEncodable {}
+
+List<int> encodeChunked(value, String indent, int bufferSize) {
+  var result = [];
+  var sink = new JsonUtf8Encoder(indent, null, bufferSize)
+      .startChunkedConversion(new ChunkedConversionSink.withCallback(
+          (chunks) => chunks.forEach(result.addAll)));
+  sink.add(value);
+  sink.close();
+  return result;
+}
+
+void check(value) {
+  for (var indent in [null, "", " ", "\t-"]) {
+    var encoder = (indent == null) ? const JsonEncoder()
+                                   : new JsonEncoder.withIndent(indent);
+    var expected = UTF8.encode(encoder.convert(value));
+    Expect.listEquals(expected, new JsonUtf8Encoder(indent).convert(value));
+    for (int bufferSize in [1, 16, 4096]) {
+      Expect.listEquals(expected, encodeChunked(value, indent, bufferSize));
+    }
+  }
+}
+
+void testValues() {
+  var deleted = {"a": 1, "b": 2, "c": 3};
+  deleted.remove("b");
+  var values = [
+    0, -1, 1 << 40, -(1 << 62), 1 << 70, 0.0, -0.0, 1.5, 1e21, 1e-7, 123.456,
+    true, false, null,
+    "", "plain", "\"\\/\b\f\n\r\t\u0000\u001f\u007f",
+    "café €  \u{1F600}", "\ud800 \udc00 a\ud800",
+    [], {}, [[], {}], [1, [2, [3, []]]],
+    {"key": "value", "list": [1, 2.5, "three", null]},
+    new List.filled(3, "fixed"), const ["const", 1], deleted,
+    {"nested": {"deep": {"deeper": [{}]}}},
+    new List.generate(1000, (i) => {"id": i, "name": "item $i"}),
+  ];
+  for (var value in values) {
+    check(value);
+  }
+  check(values);
+}
+
+void testToEncodable() {
+  check(new Point(1, 2));
+  check([1, new Point(3, 4), {"p": new Point(5, 6)}, "end"]);
+  var encoder = new JsonUtf8Encoder(null, (object) => "custom");
+  Expect.listEquals(UTF8.encode('["custom",{"a":"custom"}]'),
+                    encoder.convert([new NotEncodable(),
+                                     {"a": double.NAN}]));
+  Expect.listEquals(UTF8.encode('"custom"'), encoder.convert({1: 2}));
+}
+
+void testDeepNesting() {
+  var value = [];
+  for (int i = 0; i < 1000; i++) {
+    value = [value, {"level": i}];
+  }
+  check(value);
+}
+
+void testErrors() {
+  var cyclic = [1];
+  cyclic.add([cyclic]);
+  Expect.throws(() => new JsonUtf8Encoder().convert(cyclic),
+                (e) => e is JsonCyclicError);
+  var cyclicMap = {};
+  cyclicMap["self"] = cyclicMap;
+  Expect.throws(() => new JsonUtf8Encoder().convert(cyclicMap),
+                (e) => e is JsonCyclicError);
+  Expect.throws(() => new JsonUtf8Encoder().convert([double.INFINITY]),
+                (e) => e is JsonUnsupportedObjectError);
+  Expect.throws(() => new JsonUtf8Encoder().convert({"a": new NotEncodable()}),
+                (e) => e is JsonUnsupportedObjectError);
+}
+
+void main() {
+  testValues();
+  testToEncodable();
+  testDeepNesting();
+  testErrors();
+}
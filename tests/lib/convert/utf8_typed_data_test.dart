@@ -0,0 +1,109 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Tests UTF-8 conversion of typed data, which implementations may decode and
+// encode in one go instead of a code unit at a time.
+
+import 'package:expect/expect.dart';
+import 'dart:convert';
+import 'dart:typed_data';
+
+const List<String> strings = const [
+    "",
+    "ascii only, long enough to be scanned a vector at a time",
+    "café crème brûlée",
+    "€ and \u{1F600} beyond the basic plane",
+    "æøå"];
+
+String decodeChunked(List<int> bytes, int chunkSize,
+                     {bool allowMalformed: false}) {
+  var result = new StringBuffer();
+  var sink = new Utf8Decoder(allowMalformed: allowMalformed)
+      .startChunkedConversion(new StringConversionSink.fromStringSink(result));
+  for (int i = 0; i < bytes.length; i += chunkSize) {
+    int end = i + chunkSize;
+    if (end > bytes.length) end = bytes.length;
+    sink.addSlice(bytes, i, end, false);
+  }
+  sink.close();
+  return result.toString();
+}
+
+List<int> encodeChunked(String string, int chunkSize) {
+  var result = [];
+  var sink = new Utf8Encoder().startChunkedConversion(
+      new ChunkedConversionSink.withCallback((chunks) {
+        chunks.forEach(result.addAll);
+      }));
+  for (int i = 0; i < string.length; i += chunkSize) {
+    int end = i + chunkSize;
+    if (end > string.length) end = string.length;
+    sink.addSlice(string, i, end, false);
+  }
+  sink.close();
+  return result;
+}
+
+void testRoundTrip() {
+  for (var string in strings) {
+    List<int> expected = UTF8.encode(string).toList();
+    Uint8List bytes = new Uint8List.fromList(expected);
+    Expect.listEquals(expected, new Utf8Encoder().convert(string));
+    Expect.equals(string, UTF8.decode(bytes));
+    // A view on a larger buffer.
+    var padded = new Uint8List(bytes.length + 6);
+    padded.setRange(3, 3 + bytes.length, bytes);
+    var view = new Uint8List.view(padded.buffer, 3, bytes.length);
+    Expect.equals(string, UTF8.decode(view));
+    Expect.equals(string,
+                  new Utf8Decoder().convert(padded, 3, 3 + bytes.length));
+    // Chunks that split multi-byte sequences and surrogate pairs.
+    for (int chunkSize in [1, 2, 3, 5, 64]) {
+      Expect.equals(string, decodeChunked(bytes, chunkSize));
+      Expect.listEquals(expected, encodeChunked(string, chunkSize));
+    }
+  }
+}
+
+void testByteOrderMark() {
+  var bytes =
+      new Uint8List.fromList([0xEF, 0xBB, 0xBF, 0x61, 0xEF, 0xBB, 0xBF]);
+  Expect.equals("a\ufeff", UTF8.decode(bytes));
+  Expect.equals("a\ufeff", decodeChunked(bytes, 1));
+  Expect.equals("a\ufeff", decodeChunked(bytes, 4));
+}
+
+void testMalformed() {
+  // Malformed input is reported or replaced as before.
+  var truncated = new Uint8List.fromList([0x61, 0xE2, 0x82]);
+  Expect.throws(() => UTF8.decode(truncated), (e) => e is FormatException);
+  Expect.equals("a\ufffd", UTF8.decode(truncated, allowMalformed: true));
+  var overlong = new Uint8List.fromList([0x61, 0xC0, 0x80, 0x62]);
+  Expect.throws(() => decodeChunked(overlong, 2),
+                (e) => e is FormatException);
+  Expect.equals("a\ufffdb",
+                decodeChunked(overlong, 2, allowMalformed: true));
+  // Encoded surrogates are decoded as they were before.
+  var surrogate = new Uint8List.fromList([0xED, 0xA0, 0x80]);
+  Expect.equals("\ud800", UTF8.decode(surrogate));
+  // Unpaired surrogates are encoded in three bytes.
+  Expect.listEquals([0x61, 0xED, 0xA0, 0x80],
+                    new Utf8Encoder().convert("a\ud800"));
+  Expect.listEquals([0x61, 0xED, 0xA0, 0x80], encodeChunked("a\ud800", 2));
+}
+
+void testRanges() {
+  var bytes = new Uint8List.fromList(UTF8.encode("hello"));
+  Expect.throws(() => new Utf8Decoder().convert(bytes, 2, 6),
+                (e) => e is RangeError);
+  Expect.throws(() => new Utf8Encoder().convert("hello", 4, 2),
+                (e) => e is RangeError);
+}
+
+void main() {
+  testRoundTrip();
+  testByteOrderMark();
+  testMalformed();
+  testRanges();
+}
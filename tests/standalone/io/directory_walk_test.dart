@@ -0,0 +1,98 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+import "dart:async";
+import "dart:io";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+
+Directory createTree() {
+  var root = Directory.systemTemp.createTempSync('dart_directory_walk');
+  for (int i = 0; i < 20; i++) {
+    var dir = new Directory("${root.path}/dir$i")..createSync();
+    for (int j = 0; j < 10; j++) {
+      new File("${dir.path}/file$j").writeAsStringSync("x" * j);
+      new Directory("${dir.path}/sub$j/subsub").createSync(recursive: true);
+      new File("${dir.path}/sub$j/subsub/file").writeAsStringSync("data");
+    }
+  }
+  new Link("${root.path}/link").createSync("${root.path}/dir0");
+  new Link("${root.path}/broken").createSync("${root.path}/missing");
+  return root;
+}
+
+
+Future testWalk(bool stat) {
+  var root = createTree();
+  var expected = root.listSync(recursive: true, followLinks: false);
+  var seen = new Set<String>();
+  return root.walk(stat: stat).forEach((DirectoryWalkEntry entry) {
+    var entity = entry.entity;
+    Expect.isTrue(seen.add(entity.path));
+    // The parent directory has already been reported.
+    var parent = entity.parent.path;
+    Expect.isTrue(parent == root.path || seen.contains(parent));
+    var type = FileSystemEntity.typeSync(entity.path, followLinks: false);
+    if (entity is File) {
+      Expect.equals(FileSystemEntityType.FILE, type);
+    } else if (entity is Link) {
+      Expect.equals(FileSystemEntityType.LINK, type);
+    } else {
+      Expect.equals(FileSystemEntityType.DIRECTORY, type);
+    }
+    if (stat) {
+      // Links report the stat of their target, or none if they are broken.
+      var fileStat = entity.statSync();
+      Expect.equals(fileStat.size, entry.size);
+      Expect.equals(fileStat.modified, entry.modified);
+    } else {
+      Expect.equals(-1, entry.size);
+      Expect.isNull(entry.modified);
+    }
+  }).then((_) {
+    Expect.setEquals(expected.map((e) => e.path).toSet(), seen);
+    root.deleteSync(recursive: true);
+  });
+}
+
+
+Future testCancel() {
+  var root = createTree();
+  var completer = new Completer();
+  var subscription;
+  int count = 0;
+  subscription = root.walk(stat: true).listen((entry) {
+    if (++count == 10) {
+      subscription.cancel().then((_) {
+        root.deleteSync(recursive: true);
+        completer.complete();
+      });
+    }
+  });
+  return completer.future;
+}
+
+
+Future testNonexistent() {
+  var root = Directory.systemTemp.createTempSync('dart_directory_walk');
+  var missing = new Directory("${root.path}/missing");
+  return missing.walk().toList().then((_) {
+    Expect.fail("Walking a missing directory should fail");
+  }, onError: (e) {
+    Expect.isTrue(e is FileSystemException);
+    root.deleteSync();
+  });
+}
+
+
+void main() {
+  asyncStart();
+  testWalk(false)
+      .then((_) => testWalk(true))
+      .then((_) => testCancel())
+      .then((_) => testNonexistent())
+      .then((_) => asyncEnd());
+}
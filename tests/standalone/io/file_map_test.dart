@@ -0,0 +1,105 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Dart test program for testing RandomAccessFile.mapSync.
+
+import 'dart:io';
+import 'dart:typed_data';
+
+import "package:expect/expect.dart";
+
+const FILE_SIZE = 3 * 65536 + 17;
+
+List<int> contents() => new List<int>.generate(FILE_SIZE, (i) => i & 0xFF);
+
+
+void testMapRead(Directory tmp) {
+  var file = new File('${tmp.path}/read');
+  file.writeAsBytesSync(contents());
+  var raf = file.openSync();
+
+  // Map the whole file.
+  var mapping = raf.mapSync(0, FILE_SIZE);
+  Expect.isTrue(mapping is Uint8List);
+  Expect.listEquals(contents(), mapping);
+  raf.adviseMappingSync(mapping, FileMapAdvice.SEQUENTIAL);
+
+  // Map a region that does not start at a page boundary.
+  var region = raf.mapSync(65536 + 3, 1000);
+  Expect.equals(1000, region.length);
+  for (int i = 0; i < region.length; i++) {
+    Expect.equals((65536 + 3 + i) & 0xFF, region[i]);
+  }
+  raf.adviseMappingSync(region, FileMapAdvice.WILL_NEED);
+
+  // Writes to a private mapping do not reach the file.
+  region[0] = 42;
+  Expect.equals(42, region[0]);
+  raf.closeSync();
+  Expect.listEquals(contents(), file.readAsBytesSync());
+
+  // The mapping stays valid after the file is closed.
+  Expect.equals(3, mapping[3]);
+}
+
+
+void testMapReadWrite(Directory tmp) {
+  var file = new File('${tmp.path}/write');
+  file.writeAsBytesSync(contents());
+  var raf = file.openSync(mode: FileMode.APPEND);
+  var mapping = raf.mapSync(100, 200, FileMapMode.READ_WRITE);
+  for (int i = 0; i < mapping.length; i++) {
+    mapping[i] = 0xAB;
+  }
+  raf.flushMappingSync(mapping);
+  raf.closeSync();
+
+  var expected = contents();
+  expected.fillRange(100, 300, 0xAB);
+  Expect.listEquals(expected, file.readAsBytesSync());
+}
+
+
+void testMapErrors(Directory tmp) {
+  var file = new File('${tmp.path}/errors');
+  file.writeAsBytesSync(contents());
+  var raf = file.openSync();
+  Expect.throws(() => raf.mapSync(-1, 10), (e) => e is RangeError);
+  Expect.throws(() => raf.mapSync(0, 0), (e) => e is RangeError);
+  // The region must lie within the file.
+  Expect.throws(() => raf.mapSync(FILE_SIZE - 10, 11),
+                (e) => e is FileSystemException);
+  // A shared writable mapping needs a file opened for writing.
+  Expect.throws(() => raf.mapSync(0, 10, FileMapMode.READ_WRITE),
+                (e) => e is FileSystemException);
+  // Only lists returned by mapSync can be advised or flushed.
+  Expect.throws(() => raf.flushMappingSync(new Uint8List(10)),
+                (e) => e is FileSystemException);
+  Expect.throws(() => raf.adviseMappingSync(
+                          new Uint8List(10), FileMapAdvice.RANDOM),
+                (e) => e is FileSystemException);
+  var mapping = raf.mapSync(0, 10);
+  raf.closeSync();
+  Expect.throws(() => raf.mapSync(0, 10), (e) => e is FileSystemException);
+  Expect.throws(() => raf.adviseMappingSync(mapping, FileMapAdvice.RANDOM),
+                (e) => e is FileSystemException);
+}
+
+
+main() {
+  var tmp = Directory.systemTemp.createTempSync('dart-file-map');
+  try {
+    testMapRead(tmp);
+    testMapReadWrite(tmp);
+    testMapErrors(tmp);
+  } finally {
+    try {
+      tmp.deleteSync(recursive: true);
+    } on FileSystemException catch (e) {
+      // On Windows mapped files cannot be deleted until the mappings have
+      // been garbage collected.
+      if (!Platform.isWindows) rethrow;
+    }
+  }
+}
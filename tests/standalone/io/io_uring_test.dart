@@ -0,0 +1,168 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Asynchronous file reads and writes go to an io_uring with --io-uring when
+// the kernel supports it, and to the synchronous handlers otherwise. Both
+// must give the same results, also while sockets are busy.
+//
+// VMOptions=
+// VMOptions=--io-uring
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_SIZE = 256 * 1024 + 7;
+const int CHUNK_SIZE = 4096;
+const int FILE_COUNT = 8;
+// More concurrent requests than the ring's submission and completion queues
+// hold.
+const int RING_OVERFLOW_COUNT = 600;
+
+List<int> contents(int seed) =>
+    new List<int>.generate(FILE_SIZE, (i) => (i + seed) % 251);
+
+
+// Writes the file in chunks with writeFrom, from both typed data (which may
+// be submitted to the ring) and plain lists (which never are).
+Future writeFile(File file, List<int> data) {
+  var typedData = new Uint8List.fromList(data);
+  return file.open(mode: FileMode.WRITE).then((raf) {
+    int offset = 0;
+    Future writeChunk(_) {
+      if (offset == data.length) return raf.close();
+      int end = offset + CHUNK_SIZE;
+      if (end > data.length) end = data.length;
+      List<int> buffer = ((offset ~/ CHUNK_SIZE) % 2 == 0) ? typedData : data;
+      var future = raf.writeFrom(buffer, offset, end);
+      offset = end;
+      return future.then(writeChunk);
+    }
+    return writeChunk(null);
+  });
+}
+
+
+// Reads the file back in chunks, alternating read and readInto.
+Future<List<int>> readFile(File file) {
+  return file.open().then((raf) {
+    var result = <int>[];
+    Future readChunk(int i) {
+      Future<int> read;
+      if (i % 2 == 0) {
+        read = raf.read(CHUNK_SIZE).then((bytes) {
+          result.addAll(bytes);
+          return bytes.length;
+        });
+      } else {
+        var buffer = new Uint8List(CHUNK_SIZE);
+        read = raf.readInto(buffer, 0, CHUNK_SIZE).then((count) {
+          result.addAll(buffer.sublist(0, count));
+          return count;
+        });
+      }
+      return read.then((count) {
+        if (count == 0) {
+          return raf.close().then((_) => result);
+        }
+        return readChunk(i + 1);
+      });
+    }
+    return readChunk(0);
+  });
+}
+
+
+// Many files written and read back at the same time.
+Future testFiles(Directory tmp) {
+  var futures = [];
+  for (int i = 0; i < FILE_COUNT; i++) {
+    var file = new File('${tmp.path}/file$i');
+    var data = contents(i);
+    futures.add(writeFile(file, data)
+        .then((_) {
+          Expect.equals(FILE_SIZE, file.lengthSync());
+          return readFile(file);
+        })
+        .then((read) => Expect.listEquals(data, read)));
+  }
+  return Future.wait(futures);
+}
+
+
+// Reads from many files at once so that the ring fills up. Requests that do
+// not fit are handled synchronously and all of them must complete.
+Future testRingOverflow(Directory tmp) {
+  var data = contents(7);
+  var file = new File('${tmp.path}/overflow');
+  file.writeAsBytesSync(data);
+  var files = [];
+  for (int i = 0; i < RING_OVERFLOW_COUNT; i++) {
+    files.add(file.open());
+  }
+  return Future.wait(files).then((rafs) {
+    var reads = [];
+    for (int i = 0; i < rafs.length; i++) {
+      int position = (i * CHUNK_SIZE) % (FILE_SIZE - CHUNK_SIZE);
+      reads.add(rafs[i].setPosition(position)
+          .then((raf) => raf.read(CHUNK_SIZE))
+          .then((bytes) {
+            Expect.listEquals(data.sublist(position, position + CHUNK_SIZE),
+                              bytes);
+            return rafs[i].close();
+          }));
+    }
+    return Future.wait(reads);
+  });
+}
+
+
+// Sends a file over a socket, reading it chunk by chunk while the other end
+// echoes the data back, and checks what comes back.
+Future testFileOverSocket(Directory tmp) {
+  var data = contents(42);
+  var file = new File('${tmp.path}/socket');
+  file.writeAsBytesSync(data);
+  return ServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      client.pipe(client);
+    });
+    return Socket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+          var received = <int>[];
+          var done = socket.listen(received.addAll).asFuture();
+          return file.open().then((raf) {
+            Future sendChunk(_) {
+              return raf.read(CHUNK_SIZE).then((bytes) {
+                if (bytes.isEmpty) return raf.close();
+                socket.add(bytes);
+                return socket.flush().then(sendChunk);
+              });
+            }
+            return sendChunk(null);
+          })
+          .then((_) => socket.close())
+          .then((_) => done)
+          .then((_) {
+            Expect.listEquals(data, received);
+            server.close();
+          });
+        });
+  });
+}
+
+
+main() {
+  asyncStart();
+  var tmp = Directory.systemTemp.createTempSync('dart-io-uring');
+  Future.wait([testFiles(tmp),
+               testFileOverSocket(tmp),
+               testRingOverflow(tmp)]).then((_) {
+    tmp.deleteSync(recursive: true);
+    asyncEnd();
+  });
+}
@@ -0,0 +1,126 @@
+// Copyright (c) 2015, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// VMOptions=
+// VMOptions=--short_socket_write
+
+import "dart:async";
+import "dart:io";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const FILE_SIZE = 1024 * 1024 + 13;
+
+List<int> contents() => new List<int>.generate(FILE_SIZE, (i) => i % 251);
+
+
+// Sends a prefix, a region of the file and a suffix on the same socket and
+// checks that they arrive in order.
+Future testSendFile(RandomAccessFile file, int offset, int length) {
+  var completer = new Completer();
+  ServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      var received = [];
+      client.listen(received.addAll, onDone: () {
+        var expected = [1, 2, 3]
+            ..addAll(contents().sublist(offset, offset + length))
+            ..addAll([4, 5]);
+        Expect.listEquals(expected, received);
+        client.close();
+        server.close();
+        completer.complete();
+      });
+    });
+    Socket.connect(InternetAddress.LOOPBACK_IP_V4, server.port).then((socket) {
+      int progress = 0;
+      socket.add([1, 2, 3]);
+      socket.sendFile(file,
+                      offset: offset,
+                      length: length,
+                      onProgress: (sent) {
+                        Expect.isTrue(sent > progress);
+                        progress = sent;
+                      })
+          .then((sent) {
+            Expect.equals(length, sent);
+            Expect.equals(length, progress);
+            // The file position is not changed.
+            Expect.equals(0, file.positionSync());
+            socket.add([4, 5]);
+            return socket.close();
+          });
+    });
+  });
+  return completer.future;
+}
+
+
+// Sends a region that extends past the end of the file. The part of the
+// file that exists is sent, then the future fails instead of waiting for
+// more data.
+Future testSendPastEnd(RandomAccessFile file, int offset) {
+  var completer = new Completer();
+  ServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      var received = [];
+      client.listen(received.addAll, onError: (_) {}, onDone: () {
+        Expect.listEquals(contents().sublist(offset), received);
+        client.close();
+        server.close();
+        completer.complete();
+      });
+    });
+    Socket.connect(InternetAddress.LOOPBACK_IP_V4, server.port).then((socket) {
+      socket.sendFile(file, offset: offset, length: FILE_SIZE)
+          .then((_) => Expect.fail("sendFile past the end of the file"),
+                onError: (e) {
+                  Expect.isTrue(e is FileSystemException);
+                });
+    });
+  });
+  return completer.future;
+}
+
+
+// RawSocket.sendFile throws when there is nothing left to send.
+Future testRawSendAtEnd(RandomAccessFile file) {
+  var completer = new Completer();
+  ServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      client.listen((_) {}, onDone: () {
+        client.close();
+        server.close();
+        completer.complete();
+      });
+    });
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+          Expect.throws(() => socket.sendFile(file, FILE_SIZE, 10),
+                        (e) => e is FileSystemException);
+          socket.close();
+        });
+  });
+  return completer.future;
+}
+
+
+main() {
+  asyncStart();
+  var tmp = Directory.systemTemp.createTempSync('dart-socket-send-file');
+  var file = new File('${tmp.path}/data');
+  file.writeAsBytesSync(contents());
+  var raf = file.openSync();
+  testSendFile(raf, 0, FILE_SIZE)
+      .then((_) => testSendFile(raf, 4097, 100000))
+      .then((_) => testSendFile(raf, 10, 0))
+      .then((_) => testSendPastEnd(raf, FILE_SIZE - 1000))
+      .then((_) => testSendPastEnd(raf, 0))
+      .then((_) => testRawSendAtEnd(raf))
+      .then((_) {
+        raf.closeSync();
+        tmp.deleteSync(recursive: true);
+        asyncEnd();
+      });
+}
@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 import 'dart:async';
+import 'dart:convert';
 import 'dart:io';
 
 import "package:async_helper/async_helper.dart";
@@ -219,12 +220,85 @@ void testZlibWithDictionary() {
   });
 }
 
+void testZLibDeflateGZipParallel() {
+  // Large enough to be split into several blocks.
+  var data = new List<int>.generate(1000000, (i) => (i * i ~/ 7) % 256);
+
+  [1, 6, 9].forEach((level) {
+    var codec = new GZipCodec(level: level, parallel: true);
+    var encoded = codec.encode(data);
+    Expect.listEquals([0x1f, 0x8b, 8], encoded.sublist(0, 3));
+    Expect.listEquals(data, codec.decode(encoded));
+    Expect.listEquals(data, new ZLibDecoder().convert(encoded));
+  });
+
+  // Empty input and input added in small chunks.
+  var codec = new GZipCodec(parallel: true);
+  Expect.listEquals([], codec.decode(codec.encode([])));
+  asyncStart();
+  var controller = new StreamController(sync: true);
+  controller.stream
+      .transform(codec.encoder)
+      .transform(codec.decoder)
+      .fold([], (buffer, data) {
+        buffer.addAll(data);
+        return buffer;
+      })
+      .then((inflated) {
+        Expect.listEquals(data, inflated);
+        asyncEnd();
+      });
+  for (int i = 0; i < data.length; i += 10000) {
+    controller.add(data.sublist(i, i + 10000));
+  }
+  controller.close();
+}
+
+// Memory mapped lists are external typed data, which the filters read in
+// place instead of copying.
+void testZLibDeflateExternalInput() {
+  var data = new List<int>.generate(300000, (i) => (i * i ~/ 7) % 256);
+  var tmp = Directory.systemTemp.createTempSync('dart-zlib');
+  var file = new File('${tmp.path}/input');
+  file.writeAsBytesSync(data);
+  var raf = file.openSync();
+  var mapping = raf.mapSync(0, data.length);
+  raf.closeSync();
+
+  [new ZLibCodec(), new GZipCodec(), new GZipCodec(parallel: true)]
+      .forEach((codec) {
+        Expect.listEquals(data, codec.decode(codec.encode(mapping)));
+
+        // Slices of the mapping are processed without copying them first.
+        var encoded = [];
+        var sink = codec.encoder.startChunkedConversion(
+            new ChunkedConversionSink.withCallback((chunks) {
+              chunks.forEach(encoded.addAll);
+            }));
+        for (int i = 0; i < mapping.length; i += 70000) {
+          int end = i + 70000;
+          if (end > mapping.length) end = mapping.length;
+          sink.addSlice(mapping, i, end, end == mapping.length);
+        }
+        Expect.listEquals(data, codec.decode(encoded));
+      });
+  try {
+    tmp.deleteSync(recursive: true);
+  } on FileSystemException catch (e) {
+    // On Windows mapped files cannot be deleted until the mapping has been
+    // garbage collected.
+    if (!Platform.isWindows) rethrow;
+  }
+}
+
 void main() {
   asyncStart();
   testZLibDeflate();
   testZLibDeflateEmpty();
   testZLibDeflateEmptyGzip();
   testZLibDeflateGZip();
+  testZLibDeflateGZipParallel();
+  testZLibDeflateExternalInput();
   testZLibDeflateInvalidLevel();
   testZLibInflate();
   testZLibInflateSync();